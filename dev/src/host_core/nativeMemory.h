@@ -13,6 +13,13 @@ namespace native
 
 		/// free virtual memory
 		virtual void FreeVirtualMemory(void* address, const uint64_t size) = 0;
+
+		/// allocate and commit memory block with the OS write tracking enabled, returns nullptr if not supported
+		virtual void* AllocWatchedVirtualMemory(const uint64_t prefferedBaseAddres, const uint64_t size) = 0;
+
+		/// get pages written since the last call for given range of the watched memory, tracking is reset for the returned pages
+		/// on input the inOutNumPages is the capacity of the outPages table, returns false if tracking failed
+		virtual bool GetWrittenPages(void* address, const uint64_t size, void** outPages, uint64_t& inOutNumPages) = 0;
 	};
 
 } // native
\ No newline at end of file
@@ -1,6 +1,6 @@
 #pragma once
 
-#include <exception>
+#include <stdexcept>
 
 #define USE_EXCEPTIONS
 
@@ -13,11 +13,11 @@ namespace runtime
 	//------------
 
 	// base runtime exception
-	class Exception : public std::exception
+	class Exception : public std::runtime_error
 	{
 	public:
 		inline Exception(const uint64_t ip, const char* message)
-			: std::exception(message)
+			: std::runtime_error(message)
 			, m_ip(ip)
 		{}
 
@@ -176,7 +176,7 @@ namespace runtime
 	class UnhandledPortReadException : public Exception
 	{
 	public:
-		inline UnhandledPortReadException::UnhandledPortReadException(const uint64_t ip, const uint16_t port, const uint64_t size)
+		inline UnhandledPortReadException(const uint64_t ip, const uint16_t port, const uint64_t size)
 			: Exception(ip, "UnhandledPortRead")
 			, m_port(port)
 			, m_size(size)
@@ -197,7 +197,7 @@ namespace runtime
 	class UnhandledPortWriteException : public Exception
 	{
 	public:
-		inline UnhandledPortWriteException::UnhandledPortWriteException(const uint64_t ip, const uint16_t port, const uint64_t size)
+		inline UnhandledPortWriteException(const uint64_t ip, const uint16_t port, const uint64_t size)
 			: Exception(ip, "UnhandledPortWrite")
 			, m_port(port)
 			, m_size(size)
@@ -32,4 +32,29 @@ namespace win
 		::VirtualFree(address, size, MEM_DECOMMIT | MEM_RELEASE);
 	}
 
+	void* Memory::AllocWatchedVirtualMemory(const uint64_t prefferedBaseAddres, const uint64_t size)
+	{
+		GLog.Log("Win: Requested OS to allocate %u bytes of write watched virtual memory", size);
+
+		const auto ret = ::VirtualAlloc((void*)prefferedBaseAddres, size, MEM_RESERVE | MEM_COMMIT | MEM_WRITE_WATCH, PAGE_READWRITE);
+		if (!ret)
+		{
+			GLog.Err("Win: OS write watched virtual memory allocation has failed");
+			return nullptr;
+		}
+
+		return ret;
+	}
+
+	bool Memory::GetWrittenPages(void* address, const uint64_t size, void** outPages, uint64_t& inOutNumPages)
+	{
+		ULONG_PTR numPages = (ULONG_PTR)inOutNumPages;
+		ULONG pageSize = 0;
+		if (0 != ::GetWriteWatch(WRITE_WATCH_FLAG_RESET, address, (SIZE_T)size, outPages, &numPages, &pageSize))
+			return false;
+
+		inOutNumPages = numPages;
+		return true;
+	}
+
 } // win
\ No newline at end of file
@@ -13,6 +13,8 @@ namespace win
 
 		virtual void* AllocVirtualMemory(const uint64_t prefferedBaseAddres, const uint64_t size) override final;
 		virtual void FreeVirtualMemory(void* address, const uint64_t size) override final;
+		virtual void* AllocWatchedVirtualMemory(const uint64_t prefferedBaseAddres, const uint64_t size) override final;
+		virtual bool GetWrittenPages(void* address, const uint64_t size, void** outPages, uint64_t& inOutNumPages) override final;
 	};
 
 } // win
\ No newline at end of file
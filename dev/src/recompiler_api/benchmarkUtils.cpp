@@ -0,0 +1,98 @@
+#include "build.h"
+
+#include "../recompiler_core/internalUtils.h"
+
+#include "benchmarkUtils.h"
+
+#include <Windows.h>
+#include <Psapi.h>
+
+#pragma comment ( lib, "psapi.lib" )
+
+///--
+
+namespace benchmark
+{
+	// get peak memory usage of the process so far
+	const uint64 GetPeakRSS()
+	{
+		PROCESS_MEMORY_COUNTERS counters;
+		memset(&counters, 0, sizeof(counters));
+		if (!GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)))
+			return 0;
+
+		return counters.PeakWorkingSetSize;
+	}
+
+	// get size of file on disk
+	const uint64 GetFileSizeOnDisk(const std::wstring& path)
+	{
+		std::ifstream f(path, std::ios::in | std::ios::binary | std::ios::ate);
+		if (f.fail())
+			return 0;
+
+		return (uint64)f.tellg();
+	}
+
+	// run a benchmark stage
+	void RunStage(ILogOutput& log, std::vector<BenchmarkStage>& outStages, const char* name, const std::function<bool(uint64& outFrames, uint64& outBytes)>& func)
+	{
+		log.Log("Benchmark: Running '%hs'...", name);
+
+		BenchmarkStage stage;
+		stage.m_name = name;
+		stage.m_frames = 0;
+		stage.m_bytes = 0;
+
+		BenchmarkTimer timer;
+		stage.m_ok = func(stage.m_frames, stage.m_bytes);
+		stage.m_seconds = timer.GetSeconds();
+		stage.m_peakRSS = GetPeakRSS();
+
+		if (!stage.m_ok)
+			log.Error("Benchmark: Stage '%hs' failed", name);
+		else
+			log.Log("Benchmark: '%hs' took %1.3fs", name, stage.m_seconds);
+
+		outStages.push_back(stage);
+	}
+
+	// write the results as JSON
+	const bool WriteResults(ILogOutput& log, const std::wstring& outputPath, const std::vector<BenchmarkStage>& stages)
+	{
+		FILE* f = nullptr;
+		_wfopen_s(&f, outputPath.c_str(), L"w");
+		if (!f)
+		{
+			log.Error("Benchmark: Unable to create file '%ls'", outputPath.c_str());
+			return false;
+		}
+
+		fprintf(f, "{\n");
+		fprintf(f, "  \"peakRSS\": %llu,\n", GetPeakRSS());
+		fprintf(f, "  \"stages\": [\n");
+		for (size_t i = 0; i < stages.size(); ++i)
+		{
+			const auto& stage = stages[i];
+			const double framesPerSecond = (stage.m_seconds > 0.0) ? (stage.m_frames / stage.m_seconds) : 0.0;
+			const double bytesPerSecond = (stage.m_seconds > 0.0) ? (stage.m_bytes / stage.m_seconds) : 0.0;
+
+			fprintf(f, "    {\n");
+			fprintf(f, "      \"name\": \"%hs\",\n", stage.m_name.c_str());
+			fprintf(f, "      \"ok\": %hs,\n", stage.m_ok ? "true" : "false");
+			fprintf(f, "      \"seconds\": %f,\n", stage.m_seconds);
+			fprintf(f, "      \"frames\": %llu,\n", stage.m_frames);
+			fprintf(f, "      \"bytes\": %llu,\n", stage.m_bytes);
+			fprintf(f, "      \"framesPerSecond\": %f,\n", framesPerSecond);
+			fprintf(f, "      \"bytesPerSecond\": %f,\n", bytesPerSecond);
+			fprintf(f, "      \"peakRSS\": %llu\n", stage.m_peakRSS);
+			fprintf(f, "    }%hs\n", (i + 1 < stages.size()) ? "," : "");
+		}
+		fprintf(f, "  ]\n");
+		fprintf(f, "}\n");
+
+		fclose(f);
+		return true;
+	}
+
+} // benchmark
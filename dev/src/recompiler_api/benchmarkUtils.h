@@ -0,0 +1,50 @@
+#pragma once
+
+#include <chrono>
+
+// Helpers shared by the benchmarks (timing, memory stats and the JSON results)
+
+namespace benchmark
+{
+	// measured stage of the benchmark
+	struct BenchmarkStage
+	{
+		std::string m_name;
+		double m_seconds;
+		uint64 m_frames;
+		uint64 m_bytes;
+		uint64 m_peakRSS;
+		bool m_ok;
+	};
+
+	// simple stopwatch
+	class BenchmarkTimer
+	{
+	public:
+		BenchmarkTimer()
+			: m_start(std::chrono::high_resolution_clock::now())
+		{}
+
+		inline const double GetSeconds() const
+		{
+			const auto delta = std::chrono::high_resolution_clock::now() - m_start;
+			return std::chrono::duration<double>(delta).count();
+		}
+
+	private:
+		std::chrono::high_resolution_clock::time_point m_start;
+	};
+
+	// get peak memory usage of the process so far
+	extern const uint64 GetPeakRSS();
+
+	// get size of file on disk
+	extern const uint64 GetFileSizeOnDisk(const std::wstring& path);
+
+	// run a benchmark stage, the stage is added to the list
+	extern void RunStage(ILogOutput& log, std::vector<BenchmarkStage>& outStages, const char* name, const std::function<bool(uint64& outFrames, uint64& outBytes)>& func);
+
+	// write the results as JSON
+	extern const bool WriteResults(ILogOutput& log, const std::wstring& outputPath, const std::vector<BenchmarkStage>& stages);
+
+} // benchmark
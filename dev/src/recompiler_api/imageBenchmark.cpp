@@ -0,0 +1,70 @@
+#include "build.h"
+
+#include "../recompiler_core/internalUtils.h"
+#include "../recompiler_core/platformDefinition.h"
+#include "../recompiler_core/platformLibrary.h"
+#include "../recompiler_core/image.h"
+
+#include "imageBenchmark.h"
+#include "benchmarkUtils.h"
+
+///--
+
+using namespace benchmark;
+
+const int RunImageLoadBenchmark(const Commandline& cmdLine, ILogOutput& log)
+{
+	// get the image
+	const auto imagePath = cmdLine.GetOptionValueW("in");
+	if (imagePath.empty())
+	{
+		log.Error("Benchmark: Input path to image (-in) not specified");
+		return -2;
+	}
+
+	// get the output file
+	const auto outputPath = cmdLine.GetOptionValueW("out");
+	if (outputPath.empty())
+	{
+		log.Error("Benchmark: Output path to JSON results (-out) not specified");
+		return -2;
+	}
+
+	// number of loads, the first one also warms up the file cache
+	uint32 numRuns = 5;
+	if (cmdLine.HasOption("runs"))
+		numRuns = std::max<uint32>(1, atoi(cmdLine.GetOptionValueA("runs").c_str()));
+
+	// only one platform is supported by the command line API
+	const auto* platformDefinition = platform::Library::GetInstance().GetPlatform(0);
+	const auto imageFileSize = GetFileSizeOnDisk(imagePath);
+
+	std::vector<BenchmarkStage> stages;
+	for (uint32 i = 0; i < numRuns; ++i)
+	{
+		char stageName[64];
+		sprintf_s(stageName, "Image::Load (run %u)", i);
+
+		RunStage(log, stages, stageName, [&](uint64& outFrames, uint64& outBytes)
+		{
+			const auto image = platformDefinition->LoadImageFromFile(ILogOutput::DevNull(), imagePath);
+			if (!image)
+				return false;
+
+			outFrames = 1;
+			outBytes = std::max<uint64>(imageFileSize, image->GetMemorySize());
+			return true;
+		});
+	}
+
+	// save results
+	if (!WriteResults(log, outputPath, stages))
+		return -2;
+
+	// report failed stages
+	for (const auto& stage : stages)
+		if (!stage.m_ok)
+			return -2;
+
+	return 0;
+}
@@ -0,0 +1,5 @@
+#pragma once
+
+// run the image loading benchmark (decryption and decompression of the executable image)
+// -in=<image> -out=<results.json> [-runs=<count>]
+extern const int RunImageLoadBenchmark(const Commandline& cmdLine, ILogOutput& log);
@@ -9,6 +9,9 @@
 #include "../recompiler_core/platformLibrary.h"
 #include "../recompiler_core/externalApp.h"
 
+#include "traceBenchmark.h"
+#include "imageBenchmark.h"
+
 ///--
 
 class ExternalAppRunner : public code::IGeneratorRemoteExecutor
@@ -69,9 +72,10 @@ const int RunRecompiler(const Commandline& cmdLine, ILogOutput& log)
 	if (!gen)
 		return -2;
 
-	// create the temp path
+	// create the temp path, generated files are written there as soon as they are finished
 	const auto tempPath = outputDirPath + L"temp/";
 	const auto outPath = outputDirPath + L"code.bin";
+	gen->SetTempPath(tempPath);
 
 	// generate the temp code
 	auto* decompilation = env->GetDecodingContext()->GetPlatform()->GetDecompilationInterface();
@@ -181,6 +185,8 @@ int main(int argc, const char** argv)
 		fprintf(stdout, "Commands:\n");
 		fprintf(stdout, "  decompile -platform=<platform> -in=<image> -out=<path> [options]\n");
 		fprintf(stdout, "  recompile -in=<image> -out=<path> -generator=<generatorName> [options]\n");
+		fprintf(stdout, "  benchmark-trace -in=<raw trace> -project=<project> -out=<results.json> [-temp=<path>] [-samples=<count>]\n");
+		fprintf(stdout, "  benchmark-load -in=<image> -out=<results.json> [-runs=<count>]\n");
 		return -1;
 	}
 
@@ -219,6 +225,14 @@ int main(int argc, const char** argv)
     {
         return RunDecompiler(cmdLine, log);
     }
+	else if (commandName == "benchmark-trace")
+	{
+		return RunTraceBenchmark(cmdLine, log);
+	}
+	else if (commandName == "benchmark-load")
+	{
+		return RunImageLoadBenchmark(cmdLine, log);
+	}
 	else
 	{
 		log.Error("Command '%hs' was not recognized", commandName.c_str());
@@ -0,0 +1,266 @@
+#include "build.h"
+
+#include "../recompiler_core/internalUtils.h"
+#include "../recompiler_core/decodingEnvironment.h"
+#include "../recompiler_core/decodingContext.h"
+#include "../recompiler_core/platformDefinition.h"
+#include "../recompiler_core/traceRawReader.h"
+#include "../recompiler_core/traceDataFile.h"
+#include "../recompiler_core/traceMemoryHistoryBuilder.h"
+#include "../recompiler_core/platformLibrary.h"
+
+#include "traceBenchmark.h"
+#include "benchmarkUtils.h"
+
+///--
+
+using namespace benchmark;
+
+namespace
+{
+	// visitor that only counts what is in the raw trace
+	class CountingTraceVisitor : public trace::IRawTraceVisitor
+	{
+	public:
+		CountingTraceVisitor()
+			: m_numFrames(0)
+			, m_numBytes(0)
+		{}
+
+		virtual void StartContext(ILogOutput& log, const uint32 writerId, const uint32 threadId, const uint64 ip, const TraceFrameID seq, const char* name) override final {}
+		virtual void EndContext(ILogOutput& log, const uint32 writerId, const uint64 ip, const TraceFrameID seq, const uint32 numFrames) override final {}
+
+		virtual void ConsumeFrame(ILogOutput& log, const uint32 writerId, const TraceFrameID seq, const trace::RawTraceFrame& frame) override final
+		{
+			m_numFrames += 1;
+			m_numBytes += frame.m_data.size();
+		}
+
+		uint64 m_numFrames;
+		uint64 m_numBytes;
+	};
+
+	// simple deterministic random number generator so the runs are comparable
+	class BenchmarkRandom
+	{
+	public:
+		BenchmarkRandom()
+			: m_state(0x2545F4914F6CDD1DULL)
+		{}
+
+		inline const uint64 Next(const uint64 max)
+		{
+			m_state ^= m_state << 13;
+			m_state ^= m_state >> 7;
+			m_state ^= m_state << 17;
+			return max ? (m_state % max) : 0;
+		}
+
+	private:
+		uint64 m_state;
+	};
+
+} // namespace
+
+///--
+
+const int RunTraceBenchmark(const Commandline& cmdLine, ILogOutput& log)
+{
+	// get the raw trace
+	const auto rawTracePath = cmdLine.GetOptionValueW("in");
+	if (rawTracePath.empty())
+	{
+		log.Error("Benchmark: Input path to raw trace file (-in) not specified");
+		return -2;
+	}
+
+	// get the decoding environment
+	const auto projectPath = cmdLine.GetOptionValueW("project");
+	if (projectPath.empty())
+	{
+		log.Error("Benchmark: Path to decoding environment (-project) not specified");
+		return -2;
+	}
+
+	// get the output file
+	const auto outputPath = cmdLine.GetOptionValueW("out");
+	if (outputPath.empty())
+	{
+		log.Error("Benchmark: Output path to JSON results (-out) not specified");
+		return -2;
+	}
+
+	// temporary files are by default created next to the raw trace
+	auto tempPath = cmdLine.GetOptionValueW("temp");
+	if (tempPath.empty())
+		tempPath = rawTracePath + L".bench";
+
+	// number of random samples
+	uint32 numSamples = 100000;
+	if (cmdLine.HasOption("samples"))
+		numSamples = std::max<uint32>(1, atoi(cmdLine.GetOptionValueA("samples").c_str()));
+
+	// load the decoding environment
+	const auto env = decoding::Environment::Load(log, projectPath);
+	if (!env)
+	{
+		log.Error("Benchmark: Decoding environment failed to load from '%ls'", projectPath.c_str());
+		return -2;
+	}
+
+	const auto* cpuInfo = env->GetPlatform()->GetCPU(0);
+	auto* decodingContext = env->GetDecodingContext();
+
+	// load the raw trace
+	const auto rawTrace = trace::RawTraceReader::Load(log, rawTracePath);
+	if (!rawTrace)
+	{
+		log.Error("Benchmark: Failed to load raw trace from '%ls'", rawTracePath.c_str());
+		return -2;
+	}
+
+	std::vector<BenchmarkStage> stages;
+	const auto rawTraceSize = GetFileSizeOnDisk(rawTracePath);
+	const auto compiledTracePath = tempPath + L".trace";
+	const auto memoryHistoryPath = tempPath + L".mem";
+
+	// scan
+	RunStage(log, stages, "RawTraceReader::Scan", [&](uint64& outFrames, uint64& outBytes)
+	{
+		CountingTraceVisitor visitor;
+		rawTrace->Scan(ILogOutput::DevNull(), visitor);
+		outFrames = visitor.m_numFrames;
+		outBytes = rawTraceSize;
+		return true;
+	});
+
+	// build
+	std::unique_ptr<trace::DataFile> traceData;
+	RunStage(log, stages, "DataFile::Build", [&](uint64& outFrames, uint64& outBytes)
+	{
+		auto decodingContextFunc = [decodingContext](const uint64_t ip) { return decodingContext; };
+		traceData = trace::DataFile::Build(ILogOutput::DevNull(), *cpuInfo, *rawTrace, decodingContextFunc);
+		if (!traceData)
+			return false;
+
+		outFrames = traceData->GetNumDataFrames();
+		outBytes = rawTraceSize;
+		return true;
+	});
+
+	if (!traceData)
+	{
+		WriteResults(log, outputPath, stages);
+		return -2;
+	}
+
+	// save
+	RunStage(log, stages, "DataFile::Save", [&](uint64& outFrames, uint64& outBytes)
+	{
+		if (!traceData->Save(ILogOutput::DevNull(), compiledTracePath))
+			return false;
+
+		outFrames = traceData->GetNumDataFrames();
+		outBytes = GetFileSizeOnDisk(compiledTracePath);
+		return true;
+	});
+
+	// load, the loaded trace is used for the rest of the tests
+	RunStage(log, stages, "DataFile::Load", [&](uint64& outFrames, uint64& outBytes)
+	{
+		traceData = trace::DataFile::Load(ILogOutput::DevNull(), *cpuInfo, compiledTracePath);
+		if (!traceData)
+			return false;
+
+		outFrames = traceData->GetNumDataFrames();
+		outBytes = GetFileSizeOnDisk(compiledTracePath);
+		return true;
+	});
+
+	if (!traceData)
+	{
+		WriteResults(log, outputPath, stages);
+		return -2;
+	}
+
+	// sequential access
+	RunStage(log, stages, "DataFile::GetFrame (sequential)", [&](uint64& outFrames, uint64& outBytes)
+	{
+		const auto numFrames = traceData->GetNumDataFrames();
+		for (uint64 i = 0; i < numFrames; ++i)
+		{
+			traceData->GetFrame(i);
+			traceData->ManageCache();
+		}
+
+		outFrames = numFrames;
+		return true;
+	});
+
+	// random access
+	traceData->PurgeCache();
+	RunStage(log, stages, "DataFile::GetFrame (random)", [&](uint64& outFrames, uint64& outBytes)
+	{
+		BenchmarkRandom random;
+		const auto numFrames = traceData->GetNumDataFrames();
+		for (uint32 i = 0; i < numSamples; ++i)
+		{
+			traceData->GetFrame(random.Next(numFrames));
+			traceData->ManageCache();
+		}
+
+		outFrames = numSamples;
+		return true;
+	});
+
+	// memory history of random memory locations that were written to
+	RunStage(log, stages, "DataFile::GetMemoryWriteHistory", [&](uint64& outFrames, uint64& outBytes)
+	{
+		const auto& pages = traceData->GetMemoryTracePages();
+		if (pages.empty())
+			return true;
+
+		BenchmarkRandom random;
+		std::vector<trace::MemoryAccessInfo> history;
+		for (uint32 i = 0; i < numSamples; ++i)
+		{
+			const auto& page = pages[(size_t)random.Next(pages.size())];
+			const auto address = page.m_baseAddress + (random.Next(trace::MemoryTracePage::NUM_ADDRESSES_PER_PAGE) & ~3ULL);
+
+			history.clear();
+			traceData->GetMemoryWriteHistory(address, 4, history);
+			outFrames += history.size();
+			outBytes += 4;
+		}
+
+		return true;
+	});
+
+	// memory history file
+	RunStage(log, stages, "MemoryHistoryBuilder::BuildFile", [&](uint64& outFrames, uint64& outBytes)
+	{
+		trace::MemoryHistoryBuilder builder;
+		if (!builder.BuildFile(ILogOutput::DevNull(), *decodingContext, *traceData, memoryHistoryPath.c_str()))
+			return false;
+
+		outFrames = traceData->GetNumDataFrames();
+		outBytes = GetFileSizeOnDisk(memoryHistoryPath);
+		return true;
+	});
+
+	// cleanup
+	traceData.reset();
+	_wremove(compiledTracePath.c_str());
+	_wremove(memoryHistoryPath.c_str());
+
+	// save results
+	if (!WriteResults(log, outputPath, stages))
+		return -2;
+
+	// report failed stages
+	for (const auto& stage : stages)
+		if (!stage.m_ok)
+			return -2;
+
+	return 0;
+}
@@ -0,0 +1,5 @@
+#pragma once
+
+// run the trace pipeline benchmark
+// -in=<raw trace> -project=<decoding environment> -out=<results.json> [-temp=<path>] [-samples=<count>]
+extern const int RunTraceBenchmark(const Commandline& cmdLine, ILogOutput& log);
@@ -1,6 +1,7 @@
 #include "build.h"
 #include "codeGenerator.h"
 #include "codeGeneratorMSVC.h"
+#include "codeGeneratorClang.h"
 #include "internalUtils.h"
 
 namespace code
@@ -12,7 +13,7 @@ namespace code
 	void IGenerator::ListGenerators(std::vector<std::string>& outCodeGenerators)
 	{
 		outCodeGenerators.push_back("cpp_msvc");
-		outCodeGenerators.push_back("cpp_clang"); // TODO
+		outCodeGenerators.push_back("cpp_clang");
 		outCodeGenerators.push_back("llvm"); // TODO
 	}
 
@@ -32,6 +33,10 @@ namespace code
 		{
 			gen = std::make_shared<msvc::Generator>(log, parameters);
 		}
+		else if (generatorName == "cpp_clang")
+		{
+			gen = std::make_shared<clang::Generator>(log, parameters);
+		}
 		else
 		{
 			log.Error("CodeGen: Unknown code generator '%hs'", generatorName.c_str());
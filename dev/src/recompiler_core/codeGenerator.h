@@ -23,6 +23,9 @@ namespace code
 		// set entry address for converted image
 		virtual void SetEntryAddress(const uint64 entryAddress) = 0;
 
+		// set directory for the generated files, finished files are written there right away instead of being kept in memory until the compilation
+		virtual void SetTempPath(const std::wstring& tempPath) = 0;
+
 		// add global include (added to all files)
 		virtual void AddPlatformInclude(const std::wstring& path) = 0;
 
@@ -38,12 +41,18 @@ namespace code
 		// print instruction, formated
 		virtual void AddCodef(const uint64 addr, const char* code, ...) = 0;
 
-		// start new block
-		virtual void StartBlock(const uint64 addr, const bool multiAddress, const char* optionalFunctionName) = 0;
+		// start new block, optional prologue code is executed on every block entry (before the address dispatch)
+		virtual void StartBlock(const uint64 addr, const bool multiAddress, const char* optionalFunctionName, const char* optionalPrologueCode) = 0;
 
 		// close current block
 		virtual void CloseBlock() = 0;
 
+		// add block with the same code as already emitted block at different address, the code of the source block is reused
+		virtual void AddBlockAlias(const uint64 addr, const uint64 endAddr, const uint64 sourceAddr, const char* optionalFunctionName) = 0;
+
+		// get size of the code generated so far (in bytes)
+		virtual const uint64 GetCodeSize() const = 0;
+
 		// generate the final stuff
 		virtual const bool CompileModule(IGeneratorRemoteExecutor& executor, const std::wstring& tempPath, const std::wstring& outputFilePath) = 0;
 
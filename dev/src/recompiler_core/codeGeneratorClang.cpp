@@ -0,0 +1,208 @@
+#include "build.h"
+#include "codeGeneratorClang.h"
+#include "codePrinter.h"
+#include "internalUtils.h"
+
+#include <thread>
+
+namespace code
+{
+	namespace clang
+	{
+
+		//----------------------------------------------------------------------
+
+		Generator::Generator(class ILogOutput& log, const Commandline& params)
+			: cpp::GeneratorBase(log, params)
+			, m_isGCC(false)
+			, m_numJobs(std::max<uint32>(1, std::thread::hardware_concurrency()))
+			, m_compilerPath("clang++")
+			, m_makePath(L"make")
+		{
+			// custom tools
+			if (params.HasOption("compiler"))
+				m_compilerPath = params.GetOptionValueA("compiler");
+			if (params.HasOption("make"))
+				m_makePath = params.GetOptionValueW("make");
+
+			// gcc has no ThinLTO
+			m_isGCC = (m_compilerPath.find("g++") != std::string::npos) && (m_compilerPath.find("clang") == std::string::npos);
+
+			// number of parallel compiler jobs
+			if (params.HasOption("jobs"))
+				m_numJobs = std::max<uint32>(1, (uint32)atoi(params.GetOptionValueA("jobs").c_str()));
+		}
+
+		Generator::~Generator()
+		{
+		}
+
+		const bool Generator::IsSourceFile(const wchar_t* fileName)
+		{
+			const size_t length = wcslen(fileName);
+			return (length > 4) && (0 == wcscmp(fileName + length - 4, L".cpp"));
+		}
+
+		void Generator::AddPlatformInclude(const std::wstring& path)
+		{
+			// the compiler does not understand the windows path separators
+			std::wstring includePath = path;
+			std::replace(includePath.begin(), includePath.end(), L'\\', L'/');
+			cpp::GeneratorBase::AddPlatformInclude(includePath);
+		}
+
+		void Generator::AddCompatibilityFiles()
+		{
+			// force included before everything else
+			StartFile("portable.h", false);
+			{
+				Printer& p = *m_currentFile->m_codePrinter;
+				p.Print("// MSVC specific stuff used by the platform includes mapped to the clang/gcc builtins\n");
+				p.Print("#pragma once\n\n");
+				p.Print("#include <stdint.h>\n");
+				p.Print("#include <string.h>\n");
+				p.Print("#include <math.h>\n\n");
+				p.Print("#define __forceinline inline __attribute__((always_inline))\n");
+				p.Print("#define __fastcall\n");
+				p.Print("#define __stdcall\n");
+				p.Print("#define __int64 long long\n");
+				p.Print("#define dllexport visibility(\"default\")\n");
+				p.Print("#define __declspec(x) __attribute__((x))\n\n");
+				p.Print("static __forceinline uint16_t _byteswap_ushort(const uint16_t x) { return __builtin_bswap16(x); }\n");
+				p.Print("static __forceinline uint32_t _byteswap_ulong(const uint32_t x) { return __builtin_bswap32(x); }\n");
+				p.Print("static __forceinline uint64_t _byteswap_uint64(const uint64_t x) { return __builtin_bswap64(x); }\n");
+				p.Print("static __forceinline uint32_t _rotl(const uint32_t x, const int s) { return (x << (s & 31)) | (x >> ((32 - s) & 31)); }\n");
+				p.Print("static __forceinline uint64_t _rotl64(const uint64_t x, const int s) { return (x << (s & 63)) | (x >> ((64 - s) & 63)); }\n");
+				p.Print("static __forceinline uint32_t __lzcnt(const uint32_t x) { return x ? __builtin_clz(x) : 32; }\n");
+				p.Print("static __forceinline uint64_t __lzcnt64(const uint64_t x) { return x ? __builtin_clzll(x) : 64; }\n");
+				p.Print("static __forceinline int _isnan(const double x) { return __builtin_isnan(x); }\n");
+				p.Print("static __forceinline int _finite(const double x) { return __builtin_isfinite(x); }\n\n");
+				p.Print("// NOTE: long is 64-bit here, the size of the exchange is fixed regardless of the pointer type\n");
+				p.Print("static __forceinline uint32_t InterlockedExchange(volatile void* ptr, const uint32_t value) { return __atomic_exchange_n((volatile uint32_t*)ptr, value, __ATOMIC_SEQ_CST); }\n");
+				p.Print("static __forceinline uint64_t InterlockedExchange64(volatile void* ptr, const uint64_t value) { return __atomic_exchange_n((volatile uint64_t*)ptr, value, __ATOMIC_SEQ_CST); }\n");
+			}
+
+			// stand-ins for the windows headers
+			StartFile("Windows.h", false);
+			{
+				Printer& p = *m_currentFile->m_codePrinter;
+				p.Print("#pragma once\n\n");
+				p.Print("#include <time.h>\n\n");
+				p.Print("typedef union _LARGE_INTEGER { struct { uint32_t LowPart; int32_t HighPart; }; long long QuadPart; } LARGE_INTEGER;\n\n");
+				p.Print("static inline int QueryPerformanceCounter(LARGE_INTEGER* value) { timespec ts; clock_gettime(CLOCK_MONOTONIC, &ts); value->QuadPart = (long long)ts.tv_sec * 1000000000LL + ts.tv_nsec; return 1; }\n");
+				p.Print("static inline int QueryPerformanceFrequency(LARGE_INTEGER* value) { value->QuadPart = 1000000000LL; return 1; }\n");
+			}
+
+			StartFile("intsafe.h", false);
+			{
+				Printer& p = *m_currentFile->m_codePrinter;
+				p.Print("#pragma once\n\n");
+				p.Print("#include <limits.h>\n\n");
+				p.Print("#define SHORT_MIN (-32768)\n");
+				p.Print("#define SHORT_MAX 32767\n");
+			}
+
+			StartFile("intrin.h", false);
+			{
+				Printer& p = *m_currentFile->m_codePrinter;
+				p.Print("#pragma once\n\n");
+				p.Print("#include <x86intrin.h>\n");
+			}
+
+			CloseFile();
+		}
+
+		void Generator::AddMakeFile(const std::wstring& outFilePath)
+		{
+			// create new file (makefile)
+			StartFile("Makefile", false);
+
+			Printer& p = *m_currentFile->m_codePrinter;
+
+			// compiler
+			p.Printf("CXX = %s\n", m_compilerPath.c_str());
+			p.Printf("OUTPUT = %ls\n", outFilePath.c_str());
+
+			// the platform includes are written for MSVC, the compatibility header maps the MSVC intrinsics and keywords
+			p.Print("CXXFLAGS = -std=c++17 -fPIC -fvisibility=hidden -msse4.1 -fno-operator-names -I. -include portable.h");
+
+			// release builds use the link time optimization, ThinLTO runs the backend jobs in parallel
+			if (m_forceMultiAddressBlocks)
+				p.Print(" -O0 -g\n");
+			else if (m_isGCC)
+				p.Print(" -O2 -flto=auto\n");
+			else
+				p.Print(" -O2 -flto=thin\n");
+
+			// linker
+			p.Print("LDFLAGS = -shared");
+			if (!m_forceMultiAddressBlocks)
+				p.Print(m_isGCC ? " -flto=auto" : " -fuse-ld=lld -flto=thin");
+			p.Print("\n\n");
+
+			// objects
+			p.Print("OBJECTS =");
+			for (uint32 i = 0; i < m_files.size() - 1; ++i)
+			{
+				const std::wstring fileName = m_files[i]->m_fileName;
+				if (IsSourceFile(fileName.c_str()))
+					p.Printf(" \\\n\t%ls", (fileName.substr(0, fileName.length() - 4) + L".o").c_str());
+			}
+			p.Print("\n\n");
+
+			// rules
+			p.Print("$(OUTPUT): $(OBJECTS)\n");
+			p.Print("\t$(CXX) $(CXXFLAGS) $(LDFLAGS) -o $@ $(OBJECTS)\n\n");
+			p.Print("%.o: %.cpp portable.h\n");
+			p.Print("\t$(CXX) $(CXXFLAGS) -c $< -o $@\n");
+
+			// save
+			CloseFile();
+		}
+
+		const bool Generator::CompileModule(IGeneratorRemoteExecutor& executor, const std::wstring& tempPath, const std::wstring& outputFilePath)
+		{
+			// the code files were already written somewhere else
+			if (!m_tempPath.empty() && m_tempPath != tempPath)
+			{
+				m_logOutput->Error("CodeGen: Code files were already written to '%ls'", m_tempPath.c_str());
+				return false;
+			}
+
+			const std::wstring codePath = tempPath + L"code/";
+
+			// generate glue file and the make file
+			AddCompatibilityFiles();
+			AddGlueFile();
+			AddMakeFile(outputFilePath);
+
+			// save files (most of them are already saved)
+			if (!SaveFiles(tempPath))
+				return false;
+
+			// compile, files are compiled in parallel
+			wchar_t jobs[32];
+			swprintf_s(jobs, L" -j%u", m_numJobs);
+
+			std::wstring commandLine;
+			commandLine = L" -C \"";
+			commandLine += codePath;
+			commandLine += L"\"";
+			commandLine += jobs;
+
+			// run the task
+			m_logOutput->Log("CodeGen: Compiling with '%hs', %u jobs", m_compilerPath.c_str(), m_numJobs);
+			const auto retCode = executor.RunExecutable(*m_logOutput, m_makePath, commandLine);
+			if (retCode != 0)
+			{
+				m_logOutput->Error("CodeGen: There were compilation errors");
+				return false;
+			}
+
+			// we are done
+			m_logOutput->Log("CodeGen: Stuff generated");
+			return true;
+		}
+
+	} // clang
+} // code
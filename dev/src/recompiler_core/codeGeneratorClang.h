@@ -0,0 +1,38 @@
+#pragma once
+
+#include "codeGeneratorCPP.h"
+
+namespace code
+{
+	namespace clang
+	{
+		/// Code generator for clang/gcc tool chain, generates a shared object
+		class Generator : public cpp::GeneratorBase
+		{
+		public:
+			Generator(class ILogOutput& log, const Commandline& params);
+			virtual ~Generator();
+
+		protected:
+			// IGenerator
+			virtual void AddPlatformInclude(const std::wstring& path) override final;
+			virtual const bool CompileModule(IGeneratorRemoteExecutor& executor, const std::wstring& tempPath, const std::wstring& outputFilePath) override final;
+
+		private:
+			// add the headers mapping the MSVC specific stuff used by the platform includes to the builtins
+			void AddCompatibilityFiles();
+
+			// generate the makefile
+			void AddMakeFile(const std::wstring& outFilePath);
+
+			// is the file compiled
+			static const bool IsSourceFile(const wchar_t* fileName);
+
+			bool			m_isGCC;
+			uint32			m_numJobs;
+			std::string		m_compilerPath;
+			std::wstring	m_makePath;
+		};
+
+	} // clang
+} // code
@@ -71,6 +71,8 @@ namespace code
 
 		m_currentPage = AllocPage();
 		m_allPages.push_back(m_currentPage);
+
+		m_totalSize = 0;
 	}
 
 	Printer::Page* Printer::AllocPage()
@@ -88,6 +90,7 @@ namespace code
 
 	void Printer::AppendRaw( const char ch )
 	{
+		m_totalSize += 1;
 		if ( !m_currentPage->Append( ch ) )
 		{
 			m_currentPage = AllocPage();
@@ -97,6 +100,8 @@ namespace code
 
 	void Printer::PrintRaw( const void* data, const uint32 length )
 	{
+		m_totalSize += length;
+
 		uint32 currentOffset = 0;
 		while ( currentOffset < length )
 		{
@@ -149,14 +154,20 @@ namespace code
 	{
 		while ( *txt != 0 )
 		{
-			const char ch = *txt++;
+			// copy the printable text in one go
+			const char* start = txt;
+			while ( *txt >= ' ' )
+				++txt;
 
-			if ( ch >= ' ' )
+			if ( txt > start )
 			{
 				FlushNewLine();
-				AppendRaw( ch );
+				PrintRaw( start, (uint32)( txt - start ) );
+				continue;
 			}
-			else if ( ch == '\r' )
+
+			const char ch = *txt++;
+			if ( ch == '\r' )
 			{
 				// nothing
 			}
@@ -184,6 +195,54 @@ namespace code
 		Print( buffer );
 	}
 
+	void Printer::PrintHex( const uint64 value, const uint32 numDigits )
+	{
+		static const char* digits = "0123456789ABCDEF";
+
+		char buffer[ 16 ];
+		uint32 length = 0;
+		uint64 left = value;
+		do
+		{
+			buffer[ 15 - length ] = digits[ left & 15 ];
+			left >>= 4;
+			length += 1;
+		}
+		while ( left && length < 16 );
+
+		while ( length < numDigits && length < 16 )
+		{
+			buffer[ 15 - length ] = '0';
+			length += 1;
+		}
+
+		FlushNewLine();
+		PrintRaw( buffer + 16 - length, length );
+	}
+
+	void Printer::PrintDec( const uint64 value, const uint32 width /*= 0*/ )
+	{
+		char buffer[ 24 ];
+		uint32 length = 0;
+		uint64 left = value;
+		do
+		{
+			buffer[ 23 - length ] = '0' + (char)( left % 10 );
+			left /= 10;
+			length += 1;
+		}
+		while ( left );
+
+		while ( length < width && length < 24 )
+		{
+			buffer[ 23 - length ] = ' ';
+			length += 1;
+		}
+
+		FlushNewLine();
+		PrintRaw( buffer + 24 - length, length );
+	}
+
 	bool Printer::Save( const wchar_t* filePath ) const
 	{
 		// compare content
@@ -216,6 +275,12 @@ namespace code
 					}
 				}
 
+				// existing file is longer
+				if ( !different && fgetc( f ) != EOF )
+				{
+					different = true;
+				}
+
 				fclose( f );
 
 				// do not resave if data is the same
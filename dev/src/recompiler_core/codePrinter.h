@@ -47,6 +47,15 @@ namespace code
 		//! Formatted print (uses the current indent)
 		void Printf( const char* txt, ... );
 
+		//! Print hexadecimal number (upper case) with given minimal number of digits, no printf formatting
+		void PrintHex( const uint64 value, const uint32 numDigits );
+
+		//! Print decimal number right aligned to given width, no printf formatting
+		void PrintDec( const uint64 value, const uint32 width = 0 );
+
+		//! Get size of the text printed so far
+		inline const uint32 GetSize() const { return m_totalSize; }
+
 		//! Save generated text to file, does not modify the file if it's the same
 		bool Save( const wchar_t* filePath ) const;
 
@@ -118,10 +118,47 @@ namespace decoding
 		}
 	}
 
+	const AddressMap::JumpTable* AddressMap::GetJumpTable(const uint64 addr) const
+	{
+		TJumpTables::const_iterator it = m_jumpTables.find(addr);
+		if (it != m_jumpTables.end())
+			return &(*it).second;
+
+		// not known
+		return NULL;
+	}
+
+	void AddressMap::SetJumpTable(const uint64 addr, const uint64 tableAddress, const uint32 tableSize, const std::vector<uint64>& targets)
+	{
+		if (targets.empty())
+		{
+			if (m_jumpTables.erase(addr))
+				m_isModified = true;
+			return;
+		}
+
+		JumpTable& table = m_jumpTables[addr];
+		table.m_tableAddress = tableAddress;
+		table.m_tableSize = tableSize;
+		table.m_targets = targets;
+		m_isModified = true;
+	}
+
 	void AddressMap::Save(ILogOutput& log, class IBinaryFileWriter& writer) const
 	{
-		FileChunk chunk(writer, "AddressMap", 2);
+		FileChunk chunk(writer, "AddressMap", 3);
 		writer << m_addressMap;
+
+		// jump tables
+		writer << (uint32)m_jumpTables.size();
+		for (const auto& it : m_jumpTables)
+		{
+			writer << it.first;
+			writer << it.second.m_tableAddress;
+			writer << it.second.m_tableSize;
+			writer << it.second.m_targets;
+		}
+
 		m_isModified = false;
 	}
 
@@ -144,6 +181,24 @@ namespace decoding
 			reader >> m_addressMap;
 		}
 
+		// jump tables
+		if (chunk.GetVersion() >= 3)
+		{
+			uint32 numJumpTables = 0;
+			reader >> numJumpTables;
+
+			for (uint32 i = 0; i < numJumpTables; ++i)
+			{
+				uint64 addr = 0;
+				reader >> addr;
+
+				JumpTable& table = m_jumpTables[addr];
+				reader >> table.m_tableAddress;
+				reader >> table.m_tableSize;
+				reader >> table.m_targets;
+			}
+		}
+
 		m_isModified = false;
 		return true;
 	}
@@ -14,6 +14,14 @@ namespace decoding
 		// are the comments modified ?
 		inline bool IsModified() const { return m_isModified; }
 
+		// jump table used by the indirect jump
+		struct JumpTable
+		{
+			uint64					m_tableAddress;	// address of the table data
+			uint32					m_tableSize;	// size of the table data (bytes)
+			std::vector<uint64>		m_targets;		// jump targets (absolute), in the table order
+		};
+
 	public:
 		AddressMap(class MemoryMap* map);
 		~AddressMap();
@@ -27,6 +35,12 @@ namespace decoding
 		// Set branch address for given line
 		void SetReferencedAddress(const uint64 addr, const uint64 targetAddress);
 
+		// Get the jump table recovered for the indirect jump at given code address, returns NULL if not known
+		const JumpTable* GetJumpTable(const uint64 addr) const;
+
+		// Set the jump table for the indirect jump at given code address, empty target list removes the table
+		void SetJumpTable(const uint64 addr, const uint64 tableAddress, const uint32 tableSize, const std::vector<uint64>& targets);
+
 		// Save the memory map
 		void Save(ILogOutput& log, IBinaryFileWriter& writer) const;
 
@@ -41,6 +55,10 @@ namespace decoding
 		typedef std::map<uint64, uint64> TAddressMap;
 		TAddressMap m_addressMap;
 
+		// jump tables
+		typedef std::map<uint64, JumpTable> TJumpTables;
+		TJumpTables m_jumpTables;
+
 		// internal dirty flag
 		mutable bool m_isModified;
 	};
@@ -13,6 +13,7 @@
 #include "traceUtils.h"
 
 #include "timemachine.h"
+#include "timemachineIndex.h"
 
 namespace timemachine
 {
@@ -22,6 +23,8 @@ namespace timemachine
 	Trace::Trace()
 		: m_rootEntry(nullptr)
 		, m_traceReader(nullptr)
+		, m_dataFlowIndex(nullptr)
+		, m_dataFlowIndexLoaded(false)
 	{
 	}
 
@@ -30,6 +33,12 @@ namespace timemachine
 		DeleteVector(m_entries);
 		m_rootEntry = nullptr;
 
+		if (m_dataFlowIndex)
+		{
+			delete m_dataFlowIndex;
+			m_dataFlowIndex = nullptr;
+		}
+
 		if (m_traceReader)
 		{
 			delete m_traceReader;
@@ -55,6 +64,30 @@ namespace timemachine
 		return newEntry;
 	}
 
+	const DataFlowIndex* Trace::GetDataFlowIndex(ILogOutput& log)
+	{
+		// already there (or failed)
+		if (m_dataFlowIndexLoaded)
+			return m_dataFlowIndex;
+		m_dataFlowIndexLoaded = true;
+
+		// try to use the index stored next to the trace
+		const auto indexPath = DataFlowIndex::GetIndexPath(*m_traceReader);
+		if (!indexPath.empty())
+		{
+			m_dataFlowIndex = DataFlowIndex::Load(log, *m_traceReader, indexPath);
+			if (m_dataFlowIndex)
+				return m_dataFlowIndex;
+		}
+
+		// build new index
+		m_dataFlowIndex = DataFlowIndex::Build(log, *m_context, *m_traceReader);
+		if (m_dataFlowIndex && !indexPath.empty())
+			m_dataFlowIndex->Save(log, indexPath);
+
+		return m_dataFlowIndex;
+	}
+
 	Trace* Trace::CreateTimeMachine(decoding::Context* context, trace::DataFile* traceData, const TraceFrameID traceFrameIndex)
 	{
 		// no or invalid trace data
@@ -151,6 +184,31 @@ namespace timemachine
 
 		virtual void Resolve(ILogOutput& log, Trace* trace, std::vector< const Entry::AbstractSource* >& outDependencies) const override
 		{
+			// use the memory trace if we have it
+			const auto& traceData = *trace->GetTraceReader();
+			if (!traceData.GetMemoryTracePages().empty())
+			{
+				std::vector<TraceFrameID> writers;
+				DataFlowIndex::FindLastMemoryWrites(traceData, m_memoryAddress, m_memorySize, m_traceFrame, writers);
+
+				for (const auto writerSeq : writers)
+				{
+					const Entry* otherEntry = trace->GetTraceEntry(log, writerSeq);
+					if (otherEntry)
+					{
+						const uint32 numSources = otherEntry->GetNumSources();
+						for (uint32 j = 0; j<numSources; ++j)
+						{
+							const Entry::AbstractSource* source = otherEntry->GetSource(j);
+							if (source->IsSourceFor(this))
+								outDependencies.push_back(source);
+						}
+					}
+				}
+
+				return;
+			}
+
 			// end of memory range we are testing
 			const uint64 memoryAddressEnd = m_memorySize + m_memoryAddress;
 
@@ -295,6 +353,29 @@ namespace timemachine
 
 		virtual void Resolve(ILogOutput& log, Trace* trace, std::vector< const Entry::AbstractSource* >& outDependencies) const override
 		{
+			// use the data flow index if we have it
+			if (const auto* index = trace->GetDataFlowIndex(log))
+			{
+				const auto contextId = trace->GetTraceReader()->GetFrame(m_traceFrame).GetLocationInfo().m_contextId;
+				const auto writerSeq = index->FindLastRegisterWrite(contextId, m_reg, m_traceFrame);
+				if (writerSeq != INVALID_TRACE_FRAME_ID)
+				{
+					const Entry* otherEntry = trace->GetTraceEntry(log, writerSeq);
+					if (otherEntry)
+					{
+						const uint32 numSources = otherEntry->GetNumSources();
+						for (uint32 j = 0; j<numSources; ++j)
+						{
+							const Entry::AbstractSource* source = otherEntry->GetSource(j);
+							if (source->IsSourceFor(this))
+								outDependencies.push_back(source);
+						}
+					}
+				}
+
+				return;
+			}
+
 			// while not at the end
 			TraceFrameID entryIndex = m_traceFrame - 1;
 			bool found = false;
@@ -6,6 +6,7 @@ namespace timemachine
 {
 	class Entry;
 	class Trace;
+	class DataFlowIndex;
 
 	/// trace - a collection of entries
 	class RECOMPILER_API Trace
@@ -30,11 +31,14 @@ namespace timemachine
 		// get the parent decoding context
 		inline decoding::Context& GetDecodingContext() const { return *m_context; }
 
+		// get the data flow index for the trace, loaded from disk or built (and saved) on first use, may return null
+		const DataFlowIndex* GetDataFlowIndex(ILogOutput& log);
+
 	private:
 		Trace();
 
 		typedef std::vector< Entry* > TEntries;
-		typedef std::map< TraceFrameID, Entry* > TEntriesMap;
+		typedef std::unordered_map< TraceFrameID, Entry* > TEntriesMap;
 
 		decoding::Context*		m_context;
 
@@ -42,6 +46,9 @@ namespace timemachine
 		Entry*					m_rootEntry;
 		TEntries				m_entries;
 		TEntriesMap				m_entriesMap;
+
+		DataFlowIndex*			m_dataFlowIndex;
+		bool					m_dataFlowIndexLoaded;
 	};
 
 	/// time machine entry - abstracted trace entry with "knowledge"
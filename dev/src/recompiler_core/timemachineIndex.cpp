@@ -0,0 +1,410 @@
+#include "build.h"
+
+#include "platformCPU.h"
+
+#include "decodingInstruction.h"
+#include "decodingInstructionInfo.h"
+#include "decodingContext.h"
+
+#include "traceDataFile.h"
+
+#include "timemachineIndex.h"
+
+#include <thread>
+#include <future>
+#include <mutex>
+#include <atomic>
+
+namespace timemachine
+{
+
+	//----
+
+	DataFlowIndex::DataFlowIndex()
+		: m_numFrames(0)
+	{
+	}
+
+	DataFlowIndex::~DataFlowIndex()
+	{
+	}
+
+	std::wstring DataFlowIndex::GetIndexPath(const trace::DataFile& traceData)
+	{
+		// trace was not loaded from file
+		if (traceData.GetFullPath().empty())
+			return std::wstring();
+
+		return traceData.GetFullPath() + L".dfi";
+	}
+
+	DataFlowIndex* DataFlowIndex::Build(ILogOutput& log, decoding::Context& context, const trace::DataFile& traceData)
+	{
+		// frame indices are stored on 32 bits
+		const uint64 numFrames = traceData.GetNumDataFrames();
+		if (numFrames >= 0xFFFFFFFFULL)
+		{
+			log.Error("TimeMachine: Trace is to big (%llu frames) to build data flow index", numFrames);
+			return nullptr;
+		}
+
+		std::unique_ptr<DataFlowIndex> ret(new DataFlowIndex());
+		ret->m_numFrames = numFrames;
+
+		// decoded instruction, only the modified registers are interesting
+		struct DecodedInstruction
+		{
+			std::vector<uint32> m_modifiedRegisters;
+		};
+
+		// shared instruction cache, the decoding context is not thread safe
+		std::mutex decodeLock;
+		std::unordered_map<uint64, std::unique_ptr<DecodedInstruction>> instructions;
+		auto getInstruction = [&](const uint64 codeAddress) -> const DecodedInstruction*
+		{
+			std::lock_guard<std::mutex> lock(decodeLock);
+
+			auto& entry = instructions[codeAddress];
+			if (!entry)
+			{
+				entry.reset(new DecodedInstruction());
+
+				decoding::Instruction op;
+				decoding::InstructionExtendedInfo info;
+				if (context.DecodeInstruction(ILogOutput::DevNull(), codeAddress, op) && op.GetExtendedInfo(codeAddress, context, info))
+				{
+					for (uint32 i = 0; i < info.m_registersModifiedCount; ++i)
+					{
+						const auto* reg = info.m_registersModified[i];
+
+						auto it = ret->m_registerMap.find(reg);
+						if (it == ret->m_registerMap.end())
+						{
+							it = ret->m_registerMap.insert(std::make_pair(reg, (uint32)ret->m_registers.size())).first;
+							ret->m_registers.push_back(reg);
+						}
+
+						entry->m_modifiedRegisters.push_back(it->second);
+					}
+				}
+			}
+
+			return entry.get();
+		};
+
+		// register writes found in single job, in frame order
+		struct RegisterWrite
+		{
+			uint64 m_key;
+			uint32 m_seq;
+		};
+
+		// process the frames in parallel
+		const uint32 numJobs = (uint32)((numFrames + FRAMES_PER_JOB - 1) / FRAMES_PER_JOB);
+		std::vector<std::vector<RegisterWrite>> jobResults(numJobs);
+		std::atomic<uint32> nextJob(0);
+		std::atomic<uint32> numFramesProcessed(0);
+		std::atomic<bool> canceled(false);
+
+		log.SetTaskName("Building data flow index...");
+		{
+			const uint32 numWorkers = std::max<uint32>(1, std::thread::hardware_concurrency());
+
+			std::vector<std::future<void>> workers;
+			for (uint32 i = 0; i < numWorkers; ++i)
+			{
+				workers.push_back(std::async(std::launch::async, [&]()
+				{
+					std::unordered_map<uint64, const DecodedInstruction*> localInstructions;
+
+					for (;;)
+					{
+						const auto jobIndex = nextJob++;
+						if (jobIndex >= numJobs || canceled)
+							break;
+
+						// frames are delta compressed, keep the last reference frame around
+						std::unique_ptr<trace::DataFrame> baseFrame;
+						TraceFrameID baseFrameId = INVALID_TRACE_FRAME_ID;
+
+						auto& writes = jobResults[jobIndex];
+						const auto firstFrame = jobIndex * FRAMES_PER_JOB;
+						const auto lastFrame = (uint32)std::min<uint64>(numFrames, (uint64)firstFrame + FRAMES_PER_JOB);
+						for (uint32 seq = firstFrame; seq < lastFrame; ++seq)
+						{
+							++numFramesProcessed;
+
+							// decode frame
+							const auto baseId = traceData.GetBaseFrame(seq);
+							if (baseId != INVALID_TRACE_FRAME_ID && baseId != baseFrameId)
+							{
+								baseFrame.reset(traceData.DecodeFrame(baseId, nullptr));
+								baseFrameId = baseId;
+							}
+
+							std::unique_ptr<trace::DataFrame> frame(traceData.DecodeFrame(seq, (baseId != INVALID_TRACE_FRAME_ID) ? baseFrame.get() : nullptr));
+							if (!frame || frame->GetType() != trace::FrameType::CpuInstruction || !frame->GetAddress())
+								continue;
+
+							// get the instruction
+							const auto codeAddress = frame->GetAddress();
+							const DecodedInstruction* instr = nullptr;
+							const auto it = localInstructions.find(codeAddress);
+							if (it != localInstructions.end())
+							{
+								instr = it->second;
+							}
+							else
+							{
+								instr = getInstruction(codeAddress);
+								localInstructions[codeAddress] = instr;
+							}
+
+							// emit register writes
+							const auto contextId = frame->GetLocationInfo().m_contextId;
+							for (const auto regIndex : instr->m_modifiedRegisters)
+							{
+								RegisterWrite write;
+								write.m_key = MakeKey(contextId, regIndex);
+								write.m_seq = seq;
+								writes.push_back(write);
+							}
+						}
+					}
+				}));
+			}
+
+			// wait for the workers, only this thread talks to the log
+			for (auto& worker : workers)
+			{
+				while (worker.wait_for(std::chrono::milliseconds(100)) != std::future_status::ready)
+				{
+					log.SetTaskProgress(numFramesProcessed, numFrames);
+					if (log.IsTaskCanceled())
+						canceled = true;
+				}
+			}
+		}
+
+		// canceled
+		if (canceled)
+			return nullptr;
+
+		// jobs are in frame order so the lists come out sorted
+		uint64 numWrites = 0;
+		for (auto& writes : jobResults)
+		{
+			for (const auto& write : writes)
+				ret->m_writeLists[write.m_key].push_back(write.m_seq);
+
+			numWrites += writes.size();
+			std::vector<RegisterWrite>().swap(writes);
+		}
+
+		log.Log("TimeMachine: Data flow index built, %llu register writes in %u lists", numWrites, (uint32)ret->m_writeLists.size());
+		return ret.release();
+	}
+
+	DataFlowIndex* DataFlowIndex::Load(ILogOutput& log, const trace::DataFile& traceData, const std::wstring& filePath)
+	{
+		// no file
+		std::ifstream file(filePath, std::ios::in | std::ios::binary);
+		if (file.fail())
+			return nullptr;
+
+		// load header
+		Header header;
+		memset(&header, 0, sizeof(header));
+		file.read((char*)&header, sizeof(header));
+		if (file.fail() || header.m_magic != MAGIC || header.m_version != VERSION)
+		{
+			log.Warn("TimeMachine: Data flow index '%ls' has invalid format", filePath.c_str());
+			return nullptr;
+		}
+
+		// index is for different trace
+		if (header.m_numFrames != traceData.GetNumDataFrames())
+		{
+			log.Warn("TimeMachine: Data flow index '%ls' is out of date", filePath.c_str());
+			return nullptr;
+		}
+
+		// we need the CPU to resolve the registers
+		const auto* cpu = traceData.GetCPU();
+		if (!cpu)
+			return nullptr;
+
+		std::unique_ptr<DataFlowIndex> ret(new DataFlowIndex());
+		ret->m_numFrames = header.m_numFrames;
+
+		// load register names
+		for (uint32 i = 0; i < header.m_numRegisters; ++i)
+		{
+			uint16 length = 0;
+			file.read((char*)&length, sizeof(length));
+
+			std::string name;
+			name.resize(length);
+			file.read(&name[0], length);
+			if (file.fail())
+			{
+				log.Error("TimeMachine: Failed to load data flow index from '%ls'", filePath.c_str());
+				return nullptr;
+			}
+
+			const auto* reg = cpu->FindRegister(name.c_str());
+			if (!reg)
+			{
+				log.Warn("TimeMachine: Data flow index '%ls' uses unknown register '%hs'", filePath.c_str(), name.c_str());
+				return nullptr;
+			}
+
+			ret->m_registerMap[reg] = i;
+			ret->m_registers.push_back(reg);
+		}
+
+		// load the lists
+		std::vector<uint8> data;
+		if (!trace::ReadCompressedChunk(log, file, data, header.m_chunkPos, header.m_chunkSize))
+			return nullptr;
+
+		// unpack lists, frame indices are delta encoded
+		const uint8* ptr = data.data();
+		const uint8* end = data.data() + data.size();
+		for (uint32 i = 0; i < header.m_numLists; ++i)
+		{
+			uint64 key = 0, count = 0;
+			if (!trace::ReadVarInt(ptr, end, key) || !trace::ReadVarInt(ptr, end, count))
+				break;
+
+			auto& list = ret->m_writeLists[key];
+			list.reserve((size_t)count);
+
+			uint64 seq = 0;
+			for (uint64 j = 0; j < count; ++j)
+			{
+				uint64 delta = 0;
+				if (!trace::ReadVarInt(ptr, end, delta))
+					break;
+
+				seq += delta;
+				list.push_back((uint32)seq);
+			}
+
+			if (list.size() != count)
+				break;
+		}
+
+		// damaged
+		if (ret->m_writeLists.size() != header.m_numLists)
+		{
+			log.Error("TimeMachine: Data flow index '%ls' is damaged", filePath.c_str());
+			return nullptr;
+		}
+
+		return ret.release();
+	}
+
+	const bool DataFlowIndex::Save(ILogOutput& log, const std::wstring& filePath) const
+	{
+		std::ofstream file(filePath, std::ios::out | std::ios::binary | std::ios::trunc);
+		if (file.fail())
+		{
+			log.Error("TimeMachine: Unable to create file '%ls'", filePath.c_str());
+			return false;
+		}
+
+		// write the header, it will be updated at the end
+		Header header;
+		memset(&header, 0, sizeof(header));
+		header.m_magic = MAGIC;
+		header.m_version = VERSION;
+		header.m_numFrames = m_numFrames;
+		header.m_numRegisters = (uint32)m_registers.size();
+		header.m_numLists = (uint32)m_writeLists.size();
+		file.write((const char*)&header, sizeof(header));
+
+		// registers are stored by name
+		for (const auto* reg : m_registers)
+		{
+			const auto length = (uint16)strlen(reg->GetName());
+			file.write((const char*)&length, sizeof(length));
+			file.write(reg->GetName(), length);
+		}
+
+		// pack lists
+		std::vector<uint8> data;
+		for (const auto& it : m_writeLists)
+		{
+			trace::WriteVarInt(data, it.first);
+			trace::WriteVarInt(data, it.second.size());
+
+			uint32 prevSeq = 0;
+			for (const auto seq : it.second)
+			{
+				trace::WriteVarInt(data, seq - prevSeq);
+				prevSeq = seq;
+			}
+		}
+
+		if (!trace::WriteCompressedChunk(log, file, data, header.m_chunkPos, header.m_chunkSize))
+			return false;
+
+		// update header
+		file.seekp(0);
+		file.write((const char*)&header, sizeof(header));
+		file.close();
+
+		// error ?
+		if (file.fail())
+		{
+			log.Error("TimeMachine: Failed to save data flow index to '%ls'", filePath.c_str());
+			return false;
+		}
+
+		return true;
+	}
+
+	const TraceFrameID DataFlowIndex::FindLastRegisterWrite(const uint32 contextId, const platform::CPURegister* reg, const TraceFrameID seq) const
+	{
+		// register was never modified
+		const auto regIt = m_registerMap.find(reg);
+		if (regIt == m_registerMap.end())
+			return INVALID_TRACE_FRAME_ID;
+
+		// register was never modified in this context
+		const auto listIt = m_writeLists.find(MakeKey(contextId, regIt->second));
+		if (listIt == m_writeLists.end())
+			return INVALID_TRACE_FRAME_ID;
+
+		// find last write before given frame
+		const auto& list = listIt->second;
+		const auto it = std::lower_bound(list.begin(), list.end(), seq, [](const uint32 a, const TraceFrameID b) { return a < b; });
+		if (it == list.begin())
+			return INVALID_TRACE_FRAME_ID;
+
+		return *(it - 1);
+	}
+
+	void DataFlowIndex::FindLastMemoryWrites(const trace::DataFile& traceData, const uint64 address, const uint32 size, const TraceFrameID seq, std::vector<TraceFrameID>& outWriters)
+	{
+		for (uint32 i = 0; i < size; ++i)
+		{
+			// history of the memory cell is sorted by the frame index
+			const auto cell = traceData.GetMemoryCell(address + i);
+			const auto* history = cell.GetHistoryEntries();
+			const auto* historyEnd = history + cell.GetHistoryCount();
+			const auto* it = std::lower_bound(history, historyEnd, seq, [](const trace::MemoryCellHistoryEntry& a, const TraceFrameID b) { return a.m_seq < b; });
+			if (it == history)
+				continue;
+
+			// report each writer once
+			const auto writerSeq = (it - 1)->m_seq;
+			if (std::find(outWriters.begin(), outWriters.end(), writerSeq) == outWriters.end())
+				outWriters.push_back(writerSeq);
+		}
+	}
+
+	//----
+
+} // timemachine
@@ -0,0 +1,75 @@
+#pragma once
+
+class ILogOutput;
+
+namespace timemachine
+{
+
+	/// precomputed data flow index for the trace
+	/// for every context and register the list of frames that modified the register is kept so the "last writer" query is a binary search instead of a backwards frame scan
+	/// memory dependencies are resolved directly from the memory trace stored in the trace file
+	class RECOMPILER_API DataFlowIndex
+	{
+	public:
+		~DataFlowIndex();
+
+		// build the index from trace data, frames are processed in parallel
+		static DataFlowIndex* Build(ILogOutput& log, decoding::Context& context, const trace::DataFile& traceData);
+
+		// load index from file, fails if the index does not match the trace data
+		static DataFlowIndex* Load(ILogOutput& log, const trace::DataFile& traceData, const std::wstring& filePath);
+
+		// save index to file
+		const bool Save(ILogOutput& log, const std::wstring& filePath) const;
+
+		// get the default path of the index file for given trace (stored next to the trace)
+		static std::wstring GetIndexPath(const trace::DataFile& traceData);
+
+		//--
+
+		// find last frame (before given one) in given context that modified the register, returns INVALID_TRACE_FRAME_ID if not found
+		const TraceFrameID FindLastRegisterWrite(const uint32 contextId, const platform::CPURegister* reg, const TraceFrameID seq) const;
+
+		// find last frames (before given one) that wrote to any of the bytes of given memory range, uses the memory trace
+		static void FindLastMemoryWrites(const trace::DataFile& traceData, const uint64 address, const uint32 size, const TraceFrameID seq, std::vector<TraceFrameID>& outWriters);
+
+	private:
+		DataFlowIndex();
+
+		static const uint32 MAGIC = 'TDFI';
+		static const uint32 VERSION = 1;
+		static const uint32 FRAMES_PER_JOB = 65536;
+
+		struct Header
+		{
+			uint32		m_magic;
+			uint32		m_version;
+			uint64		m_numFrames;
+			uint32		m_numRegisters;
+			uint32		m_numLists;
+			uint64		m_chunkPos;
+			uint64		m_chunkSize;
+		};
+
+		// list of frames that modified given register in given context, sorted
+		typedef std::vector< uint32 > TWriteList;
+
+		// lists, key is (context << 16) | register index
+		typedef std::unordered_map< uint64, TWriteList > TWriteLists;
+
+		// registers used in the index
+		typedef std::vector< const platform::CPURegister* > TRegisters;
+		typedef std::unordered_map< const platform::CPURegister*, uint32 > TRegisterMap;
+
+		uint64			m_numFrames;
+		TRegisters		m_registers;
+		TRegisterMap	m_registerMap;
+		TWriteLists		m_writeLists;
+
+		static inline const uint64 MakeKey(const uint32 contextId, const uint32 registerIndex)
+		{
+			return ((uint64)contextId << 16) | registerIndex;
+		}
+	};
+
+} // timemachine
@@ -0,0 +1,433 @@
+#include "build.h"
+#include "traceCompressedChunk.h"
+#include "zlib\zlib.h"
+#include <thread>
+#include <future>
+
+#if defined(_WIN64) || defined(_WIN32)
+	#include <Windows.h>
+#endif
+
+namespace trace
+{
+
+	//---
+
+	// reserve address space without allocating any memory
+	static uint8* ReserveMemory(const uint64 size)
+	{
+#if defined(_WIN64) || defined(_WIN32)
+		return (uint8*)VirtualAlloc(NULL, (SIZE_T)size, MEM_RESERVE, PAGE_NOACCESS);
+#else
+		// untouched pages of big allocations are not backed by memory anyway
+		return (uint8*)malloc((size_t)size);
+#endif
+	}
+
+	// commit memory for part of the reserved range
+	static const bool CommitMemory(uint8* ptr, const uint64 size)
+	{
+#if defined(_WIN64) || defined(_WIN32)
+		return NULL != VirtualAlloc(ptr, (SIZE_T)size, MEM_COMMIT, PAGE_READWRITE);
+#else
+		return true;
+#endif
+	}
+
+	// release the whole reserved range
+	static void ReleaseMemory(uint8* ptr)
+	{
+#if defined(_WIN64) || defined(_WIN32)
+		VirtualFree(ptr, 0, MEM_RELEASE);
+#else
+		free(ptr);
+#endif
+	}
+
+	//---
+
+	static voidpf ZlibFrameAlloc(voidpf opaque, uInt items, uInt size)
+	{
+		return malloc(items * size);
+	}
+
+	static void ZlibFrameFree(voidpf opaque, voidpf address)
+	{
+		free(address);
+	}
+
+	static const bool CompressFrame(const uint8* data, const uint32 size, std::vector<uint8>& outData)
+	{
+		// compress with the fastest setting, we care more about the throughput than the ratio
+		z_stream strm;
+		memset(&strm, 0, sizeof(strm));
+		strm.zalloc = &ZlibFrameAlloc;
+		strm.zfree = &ZlibFrameFree;
+		if (Z_OK != deflateInit(&strm, Z_BEST_SPEED))
+			return false;
+
+		// whole frame is compressed in one go
+		outData.resize(deflateBound(&strm, size));
+		strm.next_in = (Bytef*)data;
+		strm.avail_in = size;
+		strm.next_out = outData.data();
+		strm.avail_out = (uInt)outData.size();
+		const auto ret = deflate(&strm, Z_FINISH);
+		const auto compressedSize = (uint32)strm.total_out;
+		deflateEnd(&strm);
+
+		// not worth it, store the frame raw
+		if (ret != Z_STREAM_END || compressedSize >= size)
+			return false;
+
+		outData.resize(compressedSize);
+		return true;
+	}
+
+	static const bool DecompressFrame(const uint8* data, const uint32 size, uint8* outData, const uint32 outSize)
+	{
+		z_stream strm;
+		memset(&strm, 0, sizeof(strm));
+		strm.zalloc = &ZlibFrameAlloc;
+		strm.zfree = &ZlibFrameFree;
+		if (Z_OK != inflateInit(&strm))
+			return false;
+
+		// whole frame is decompressed in one go, we know the exact size
+		strm.next_in = (Bytef*)data;
+		strm.avail_in = size;
+		strm.next_out = outData;
+		strm.avail_out = outSize;
+		const auto ret = inflate(&strm, Z_FINISH);
+		const auto decompressedSize = (uint32)strm.total_out;
+		inflateEnd(&strm);
+
+		return (ret == Z_STREAM_END) && (decompressedSize == outSize);
+	}
+
+	//---
+
+	CompressedChunkWriter::CompressedChunkWriter(std::ofstream& f)
+		: m_file(&f)
+		, m_startPos((uint64)f.tellp())
+		, m_dataSize(0)
+	{}
+
+	void CompressedChunkWriter::AddFrame(const void* data, const uint32 size)
+	{
+		// frame data must be kept alive until flushed, make a copy
+		PendingFrame frame;
+		frame.m_source.assign((const uint8*)data, (const uint8*)data + size);
+		frame.m_data = nullptr;
+		frame.m_size = size;
+		m_pending.push_back(std::move(frame));
+
+		// compress in batches
+		if (m_pending.size() >= std::max<uint32>(1, std::thread::hardware_concurrency()))
+			FlushPending();
+	}
+
+	void CompressedChunkWriter::AddData(ILogOutput& log, const void* data, const uint64 size, const uint32 frameSize)
+	{
+		const auto batchSize = std::max<uint32>(1, std::thread::hardware_concurrency());
+
+		const auto* readPtr = (const uint8*)data;
+		uint64 pos = 0;
+		while (pos < size)
+		{
+			// update the visual progress
+			log.SetTaskProgress((uint32)(pos / frameSize), (uint32)(size / frameSize));
+
+			// add frame, data is owned by the caller
+			const auto sizeToWrite = (uint32)std::min<uint64>(frameSize, size - pos);
+			PendingFrame frame;
+			frame.m_data = readPtr + pos;
+			frame.m_size = sizeToWrite;
+			m_pending.push_back(std::move(frame));
+			pos += sizeToWrite;
+
+			// compress in batches
+			if (m_pending.size() >= batchSize)
+				FlushPending();
+		}
+
+		// we can't hold to the caller data
+		FlushPending();
+	}
+
+	void CompressedChunkWriter::FlushPending()
+	{
+		if (m_pending.empty())
+			return;
+
+		// compress all pending frames in parallel
+		std::vector<std::future<bool>> jobs;
+		for (auto& frame : m_pending)
+		{
+			if (!frame.m_data)
+				frame.m_data = frame.m_source.data();
+
+			auto* framePtr = &frame;
+			jobs.push_back(std::async(std::launch::async, [framePtr]() {
+				return CompressFrame(framePtr->m_data, framePtr->m_size, framePtr->m_compressed);
+			}));
+		}
+
+		// write frames in order
+		for (uint32 i = 0; i < m_pending.size(); ++i)
+		{
+			const auto& frame = m_pending[i];
+			const auto compressed = jobs[i].get();
+
+			CompressedChunkFrame info;
+			info.m_fileOffset = (uint64)m_file->tellp();
+			info.m_dataOffset = m_dataSize;
+			info.m_dataSize = frame.m_size;
+
+			if (compressed)
+			{
+				info.m_compressedSize = (uint32)frame.m_compressed.size();
+				m_file->write((const char*)frame.m_compressed.data(), frame.m_compressed.size());
+			}
+			else
+			{
+				info.m_compressedSize = frame.m_size;
+				m_file->write((const char*)frame.m_data, frame.m_size);
+			}
+
+			m_frames.push_back(info);
+			m_dataSize += frame.m_size;
+		}
+
+		m_pending.clear();
+	}
+
+	const bool CompressedChunkWriter::Finish(ILogOutput& log, uint64& outPos, uint64& outSize)
+	{
+		FlushPending();
+
+		// write the chunk index after the frame data
+		const auto indexPos = (uint64)m_file->tellp();
+		CompressedChunkHeader header;
+		header.m_magic = CompressedChunkHeader::MAGIC;
+		header.m_numFrames = (uint32)m_frames.size();
+		header.m_dataSize = m_dataSize;
+		m_file->write((const char*)&header, sizeof(header));
+		m_file->write((const char*)m_frames.data(), m_frames.size() * sizeof(CompressedChunkFrame));
+
+		// error ?
+		if (m_file->fail())
+		{
+			log.Error("Trace: Failed to save data to file. Check for disk space.");
+			return false;
+		}
+
+		// chunk position points to the index
+		outPos = indexPos;
+		outSize = (uint64)m_file->tellp() - m_startPos;
+		return true;
+	}
+
+	//---
+
+	CompressedChunkReader::CompressedChunkReader()
+	{
+		memset(&m_header, 0, sizeof(m_header));
+	}
+
+	const bool CompressedChunkReader::Open(ILogOutput& log, std::ifstream& f, const uint64 chunkPos, const uint64 chunkSize)
+	{
+		// load header
+		f.seekg(chunkPos);
+		f.read((char*)&m_header, sizeof(m_header));
+		if (f.fail() || m_header.m_magic != CompressedChunkHeader::MAGIC)
+		{
+			log.Error("Trace: Invalid compressed chunk header");
+			return false;
+		}
+
+		// load frame table
+		m_frames.resize(m_header.m_numFrames);
+		f.read((char*)m_frames.data(), m_frames.size() * sizeof(CompressedChunkFrame));
+		if (f.fail())
+		{
+			log.Error("Trace: Failed to load compressed chunk index");
+			return false;
+		}
+
+		return true;
+	}
+
+	const uint32 CompressedChunkReader::FindFrame(const uint64 dataOffset) const
+	{
+		const auto it = std::upper_bound(m_frames.begin(), m_frames.end(), dataOffset,
+			[](const uint64 offset, const CompressedChunkFrame& frame) { return offset < frame.m_dataOffset; });
+
+		if (it == m_frames.begin())
+			return 0;
+
+		return (uint32)((it - m_frames.begin()) - 1);
+	}
+
+	const bool CompressedChunkReader::ReadFrame(std::ifstream& f, const uint32 frameIndex, void* outData) const
+	{
+		const auto& frame = m_frames[frameIndex];
+
+		// raw data can be loaded directly
+		f.seekg(frame.m_fileOffset);
+		if (frame.m_compressedSize == frame.m_dataSize)
+		{
+			f.read((char*)outData, frame.m_dataSize);
+			return !f.fail();
+		}
+
+		// decompress
+		std::vector<uint8> compressedData;
+		compressedData.resize(frame.m_compressedSize);
+		f.read((char*)compressedData.data(), frame.m_compressedSize);
+		if (f.fail())
+			return false;
+
+		return DecompressFrame(compressedData.data(), frame.m_compressedSize, (uint8*)outData, frame.m_dataSize);
+	}
+
+	const bool CompressedChunkReader::ReadAll(ILogOutput& log, std::ifstream& f, std::vector<uint8>& outData) const
+	{
+		outData.resize(m_header.m_dataSize);
+
+		for (uint32 i = 0; i < m_frames.size(); ++i)
+		{
+			log.SetTaskProgress(i, (uint32)m_frames.size());
+
+			if (!ReadFrame(f, i, outData.data() + m_frames[i].m_dataOffset))
+			{
+				log.Error("Trace: Failed to load data from file");
+				return false;
+			}
+		}
+
+		return true;
+	}
+
+	//---
+
+	DataBlob::DataBlob()
+		: m_lazyData(nullptr)
+		, m_data(nullptr)
+		, m_size(0)
+		, m_numMissingFrames(0)
+	{}
+
+	DataBlob::~DataBlob()
+	{
+		ReleaseLazyData();
+	}
+
+	void DataBlob::ReleaseLazyData()
+	{
+		if (m_lazyData)
+		{
+			ReleaseMemory(m_lazyData);
+			m_lazyData = nullptr;
+		}
+	}
+
+	void DataBlob::Bind(std::vector<uint8>&& data)
+	{
+		m_residentData = std::move(data);
+		ReleaseLazyData();
+		m_loadedFrames.clear();
+		m_numMissingFrames = 0;
+
+		m_data = m_residentData.data();
+		m_size = m_residentData.size();
+	}
+
+	const bool DataBlob::Open(ILogOutput& log, const std::wstring& filePath, const uint64 chunkPos, const uint64 chunkSize)
+	{
+		// keep our own file handle, data is loaded on demand
+		m_file.open(filePath, std::ios::in | std::ios::binary);
+		if (m_file.fail())
+		{
+			log.Error("Trace: Unable to open file '%ls'", filePath.c_str());
+			return false;
+		}
+
+		// load the frame table
+		if (!m_reader.Open(log, m_file, chunkPos, chunkSize))
+			return false;
+
+		// reserve the address space only, pages are committed as we decompress the frames
+		m_residentData.clear();
+		ReleaseLazyData();
+		m_size = m_reader.GetDataSize();
+		m_lazyData = ReserveMemory(std::max<uint64>(1, m_size));
+		if (!m_lazyData)
+		{
+			log.Error("Trace: Unable to reserve %llu bytes of memory for trace data", m_size);
+			return false;
+		}
+		m_data = m_lazyData;
+
+		// nothing is loaded yet
+		m_loadedFrames.clear();
+		m_loadedFrames.resize(m_reader.GetFrames().size(), 0);
+		m_numMissingFrames = (uint32)m_reader.GetFrames().size();
+		return true;
+	}
+
+	void DataBlob::LoadFrames(const uint64 offset, const uint64 size) const
+	{
+		std::lock_guard<std::mutex> lock(m_lock);
+
+		const auto firstFrame = m_reader.FindFrame(offset);
+		const auto lastFrame = m_reader.FindFrame(offset + size - 1);
+		for (uint32 i = firstFrame; i <= lastFrame; ++i)
+		{
+			if (!m_loadedFrames[i])
+			{
+				const auto& frame = m_reader.GetFrames()[i];
+				if (frame.m_dataSize && !CommitMemory(m_data + frame.m_dataOffset, frame.m_dataSize))
+					throw std::bad_alloc(); // same as a failed allocation of the whole blob
+
+				if (!m_reader.ReadFrame(m_file, i, m_data + frame.m_dataOffset))
+				{
+					// keep going with garbage data, the trace is damaged
+					m_file.clear();
+					memset(m_data + frame.m_dataOffset, 0, frame.m_dataSize);
+				}
+
+				m_loadedFrames[i] = 1;
+				--m_numMissingFrames;
+			}
+		}
+	}
+
+	const uint8* DataBlob::GetData(const uint64 offset, const uint64 size) const
+	{
+		// out of range
+		if (offset >= m_size)
+			return nullptr;
+
+		// make sure data is loaded
+		if (m_numMissingFrames > 0)
+		{
+			const auto clampedSize = std::max<uint64>(1, std::min<uint64>(size, m_size - offset));
+			LoadFrames(offset, clampedSize);
+		}
+
+		return m_data + offset;
+	}
+
+	const bool DataBlob::Save(ILogOutput& log, std::ofstream& f, uint64& outPos, uint64& outSize) const
+	{
+		// make sure all the data is loaded
+		if (m_size > 0)
+			GetData(0, m_size);
+
+		CompressedChunkWriter writer(f);
+		writer.AddData(log, m_data, m_size);
+		return writer.Finish(log, outPos, outSize);
+	}
+
+} // trace
@@ -0,0 +1,220 @@
+#pragma once
+
+#include <mutex>
+#include <atomic>
+
+namespace trace
+{
+
+	// compressed data chunk stored in the trace file
+	// the data is split into independently compressed frames so any part of it can be loaded without decompressing the rest
+	// layout: [frame data...][CompressedChunkHeader][CompressedChunkFrame x numFrames]
+	struct CompressedChunkHeader
+	{
+		static const uint32 MAGIC = 'CHNK';
+		static const uint32 DEFAULT_FRAME_SIZE = 1 << 20; // 1MB of uncompressed data per frame
+
+		uint32 m_magic;
+		uint32 m_numFrames; // number of frames in the chunk
+		uint64 m_dataSize; // total size of uncompressed data
+	};
+
+	// single independently compressed frame of data
+	struct CompressedChunkFrame
+	{
+		uint64 m_fileOffset; // absolute position of the compressed data in the file
+		uint64 m_dataOffset; // position of the uncompressed data in the chunk
+		uint32 m_compressedSize; // size of the compressed data, equal to the uncompressed size if frame is stored raw
+		uint32 m_dataSize; // size of the uncompressed data
+	};
+
+	/// writer for the compressed chunk, frames are compressed in parallel
+	class CompressedChunkWriter
+	{
+	public:
+		CompressedChunkWriter(std::ofstream& f);
+
+		// add a single frame of data, the frame boundaries are up to the caller
+		void AddFrame(const void* data, const uint32 size);
+
+		// add data, it's split into frames of given size
+		void AddData(ILogOutput& log, const void* data, const uint64 size, const uint32 frameSize = CompressedChunkHeader::DEFAULT_FRAME_SIZE);
+
+		// flush frames and write the chunk index, returns the position of the chunk index in the file and total size of the chunk
+		const bool Finish(ILogOutput& log, uint64& outPos, uint64& outSize);
+
+	private:
+		std::ofstream* m_file;
+		uint64 m_startPos;
+		uint64 m_dataSize;
+
+		struct PendingFrame
+		{
+			const uint8* m_data; // data to compress, null if the frame owns the data
+			uint32 m_size;
+			std::vector<uint8> m_source; // owned copy of the data
+			std::vector<uint8> m_compressed;
+		};
+
+		std::vector<PendingFrame> m_pending;
+		std::vector<CompressedChunkFrame> m_frames;
+
+		void FlushPending();
+	};
+
+	/// reader for the compressed chunk, allows to decompress selected frames
+	class CompressedChunkReader
+	{
+	public:
+		CompressedChunkReader();
+
+		// load the chunk index
+		const bool Open(ILogOutput& log, std::ifstream& f, const uint64 chunkPos, const uint64 chunkSize);
+
+		// get total size of uncompressed data
+		inline const uint64 GetDataSize() const { return m_header.m_dataSize; }
+
+		// get the frame table
+		typedef std::vector<CompressedChunkFrame> TFrames;
+		inline const TFrames& GetFrames() const { return m_frames; }
+
+		// find frame containing given data offset
+		const uint32 FindFrame(const uint64 dataOffset) const;
+
+		// load and decompress single frame, output buffer must have at least frame's m_dataSize bytes
+		const bool ReadFrame(std::ifstream& f, const uint32 frameIndex, void* outData) const;
+
+		// load and decompress whole chunk
+		const bool ReadAll(ILogOutput& log, std::ifstream& f, std::vector<uint8>& outData) const;
+
+	private:
+		CompressedChunkHeader m_header;
+		TFrames m_frames;
+	};
+
+	// load whole compressed chunk into typed vector
+	template< typename T >
+	static inline const bool ReadCompressedChunk(ILogOutput& log, std::ifstream& f, std::vector<T>& data, const uint64 chunkPos, const uint64 chunkSize)
+	{
+		CompressedChunkReader reader;
+		if (!reader.Open(log, f, chunkPos, chunkSize))
+			return false;
+
+		if (reader.GetDataSize() % sizeof(T))
+		{
+			log.Error("Trace: Compressed chunk has invalid size");
+			return false;
+		}
+
+		std::vector<uint8> rawData;
+		if (!reader.ReadAll(log, f, rawData))
+			return false;
+
+		data.resize(rawData.size() / sizeof(T));
+		memcpy(data.data(), rawData.data(), rawData.size());
+		return true;
+	}
+
+	// save typed vector as compressed chunk
+	template< typename T >
+	static inline const bool WriteCompressedChunk(ILogOutput& log, std::ofstream& f, const std::vector<T>& data, uint64& outPos, uint64& outSize)
+	{
+		CompressedChunkWriter writer(f);
+		writer.AddData(log, data.data(), data.size() * sizeof(T));
+		return writer.Finish(log, outPos, outSize);
+	}
+
+	//--
+
+	/// data blob that can be loaded on demand from compressed file
+	/// NOTE: the memory for the data is never moved so pointers to the data are stable
+	class DataBlob
+	{
+	public:
+		DataBlob();
+		~DataBlob();
+
+		// get size of the data
+		inline const uint64 GetSize() const { return m_size; }
+
+		// bind fully resident data
+		void Bind(std::vector<uint8>&& data);
+
+		// bind data from compressed file, nothing is decompressed until requested
+		const bool Open(ILogOutput& log, const std::wstring& filePath, const uint64 chunkPos, const uint64 chunkSize);
+
+		// get data at given offset, makes sure the data range is loaded (range is clamped to the blob size)
+		const uint8* GetData(const uint64 offset, const uint64 size) const;
+
+		// get typed data at given offset
+		template< typename T >
+		inline const T& Get(const uint64 offset) const
+		{
+			return *(const T*)GetData(offset, sizeof(T));
+		}
+
+		// save the whole blob as compressed chunk, will load all missing data
+		const bool Save(ILogOutput& log, std::ofstream& f, uint64& outPos, uint64& outSize) const;
+
+	private:
+		std::vector<uint8> m_residentData; // data that is fully in memory
+		uint8* m_lazyData; // reserved address space for the data loaded on demand, pages are committed as frames are decompressed
+		uint8* m_data; // current data pointer
+		uint64 m_size; // size of the data
+
+		mutable std::ifstream m_file; // source file
+		mutable std::mutex m_lock; // access lock for loading
+		mutable std::vector<uint8> m_loadedFrames; // frames that were already decompressed
+		mutable std::atomic<uint32> m_numMissingFrames; // number of frames not yet loaded, zero means everything is in memory
+
+		CompressedChunkReader m_reader;
+
+		void LoadFrames(const uint64 offset, const uint64 size) const;
+		void ReleaseLazyData();
+	};
+
+	//--
+
+	// write variable length integer
+	static inline void WriteVarInt(std::vector<uint8>& data, uint64 value)
+	{
+		while (value >= 0x80)
+		{
+			data.push_back((uint8)(value | 0x80));
+			value >>= 7;
+		}
+		data.push_back((uint8)value);
+	}
+
+	// read variable length integer, returns false if we are outside the buffer
+	static inline const bool ReadVarInt(const uint8*& ptr, const uint8* end, uint64& outValue)
+	{
+		uint64 value = 0;
+		uint32 shift = 0;
+		while (ptr < end && shift < 64)
+		{
+			const auto byte = *ptr++;
+			value |= (uint64)(byte & 0x7F) << shift;
+			if (!(byte & 0x80))
+			{
+				outValue = value;
+				return true;
+			}
+			shift += 7;
+		}
+		return false;
+	}
+
+	// zig-zag encoding of signed deltas
+	static inline const uint64 ZigZagEncode(const int64 value)
+	{
+		return ((uint64)value << 1) ^ (uint64)(value >> 63);
+	}
+
+	// zig-zag decoding of signed deltas
+	static inline const int64 ZigZagDecode(const uint64 value)
+	{
+		return (int64)(value >> 1) ^ -(int64)(value & 1);
+	}
+
+} // trace
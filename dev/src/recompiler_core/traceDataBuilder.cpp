@@ -656,10 +656,9 @@ namespace trace
 		outFirstCodePage = (uint32_t)m_codeTracePages.size();
 		for (const auto* page : pages)
 		{
-			// initialize page
-			CodeTracePage tracePage;
-			memset(&tracePage, 0, sizeof(tracePage));
-			tracePage.m_baseAddress = page->m_baseMemoryAddress;
+			// offsets to the data, only used addresses will be stored in the page
+			uint64_t dataOffsets[CodeTracePage::NUM_ADDRESSES_PER_PAGE];
+			memset(dataOffsets, 0, sizeof(dataOffsets));
 
 			// export address chains
 			for (uint32 i = 0; i < CodeTracePage::NUM_ADDRESSES_PER_PAGE; ++i)
@@ -668,7 +667,7 @@ namespace trace
 				if (!seqChain.empty())
 				{
 					// write to blob (as everything else :P)
-					tracePage.m_dataOffsets[i] = m_blob.size();
+					dataOffsets[i] = m_blob.size();
 
 					// write count
 					WriteToBlob<uint32_t>((uint32_t)seqChain.size());
@@ -681,6 +680,8 @@ namespace trace
 			}
 
 			// write page data
+			CodeTracePage tracePage;
+			tracePage.Pack(page->m_baseMemoryAddress, dataOffsets, m_pageDataOffsets);
 			m_codeTracePages.push_back(tracePage);
 		}
 		outNumCodePages = (uint32_t) m_codeTracePages.size() - outFirstCodePage;
@@ -699,10 +700,9 @@ namespace trace
 		// pack pages
 		for (const auto* page : pages)
 		{
-			// initialize page
-			MemoryTracePage tracePage;
-			memset(&tracePage, 0, sizeof(tracePage));
-			tracePage.m_baseAddress = page->m_baseMemoryAddress;
+			// offsets to the data, only used addresses will be stored in the page
+			uint64_t dataOffsets[MemoryTracePage::NUM_ADDRESSES_PER_PAGE];
+			memset(dataOffsets, 0, sizeof(dataOffsets));
 
 			// export address chains
 			for (uint32 i = 0; i < MemoryTracePage::NUM_ADDRESSES_PER_PAGE; ++i)
@@ -712,7 +712,7 @@ namespace trace
 				if (!seqChain.empty())
 				{
 					// write to blob (as everything else :P)
-					tracePage.m_dataOffsets[i] = m_blob.size();
+					dataOffsets[i] = m_blob.size();
 
 					// write count
 					WriteToBlob<uint32_t>((uint32_t)seqChain.size());
@@ -729,6 +729,8 @@ namespace trace
 			}
 
 			// write page data
+			MemoryTracePage tracePage;
+			tracePage.Pack(page->m_baseMemoryAddress, dataOffsets, m_pageDataOffsets);
 			m_memoryTracePages.push_back(tracePage);
 		}
 	}
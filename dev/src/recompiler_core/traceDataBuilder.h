@@ -27,6 +27,7 @@ namespace trace
 		utils::big_vector<CallFrame> m_callFrames;
 		utils::big_vector<CodeTracePage> m_codeTracePages;
 		utils::big_vector<MemoryTracePage> m_memoryTracePages;
+		utils::big_vector<uint64_t> m_pageDataOffsets;
 
 	private:
 		virtual void StartContext(ILogOutput& log, const uint32 writerId, const uint32 threadId, const uint64 ip, const TraceFrameID seq, const char* name) override final;
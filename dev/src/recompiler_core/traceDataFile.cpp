@@ -121,7 +121,7 @@ namespace trace
 
 		// get context info
 		const auto& baseEntryInfo = m_entries[seq];
-		const auto& baseBlobInfo = *(const BlobInfo*)(m_dataBlob.data() + baseEntryInfo.m_offset);
+		const auto& baseBlobInfo = GetBlobInfo(baseEntryInfo);
 		const auto firstContextFrame = baseBlobInfo.m_localSeq;
 		const auto numContextFrames = m_contexts[baseEntryInfo.m_context].m_last.m_contextSeq - firstContextFrame;
 
@@ -135,7 +135,7 @@ namespace trace
 
 			// unpack data
 			const auto& entryInfo = m_entries[curSeq];
-			const auto& blobInfo = *(const BlobInfo*)(m_dataBlob.data() + entryInfo.m_offset);
+			const auto& blobInfo = GetBlobInfo(entryInfo);
 
 			// setup the location info
 			LocationInfo info;
@@ -168,7 +168,7 @@ namespace trace
 
 		// get context info
 		const auto& baseEntryInfo = m_entries[seq];
-		const auto& baseBlobInfo = *(const BlobInfo*)(m_dataBlob.data() + baseEntryInfo.m_offset);
+		const auto& baseBlobInfo = GetBlobInfo(baseEntryInfo);
 		const auto firstContextFrame = baseBlobInfo.m_localSeq;
 		const auto numContextFrames = m_contexts[baseEntryInfo.m_context].m_last.m_contextSeq - firstContextFrame;
 
@@ -182,7 +182,7 @@ namespace trace
 
 			// unpack data
 			const auto& entryInfo = m_entries[curSeq];
-			const auto& blobInfo = *(const BlobInfo*)(m_dataBlob.data() + entryInfo.m_offset);
+			const auto& blobInfo = GetBlobInfo(entryInfo);
 
 			// setup the location info
 			LocationInfo info;
@@ -216,28 +216,19 @@ namespace trace
 		if (!contextInfo.m_numCodePages)
 			return nullptr;
 
-		// find the first matching code page
-		/*const auto firstPageIt = m_codeTracePages.begin() + contextInfo.m_firstCodePage;
+		// find the last page starting at or before the address, pages in context are sorted by base address
+		const auto firstPageIt = m_codeTracePages.begin() + contextInfo.m_firstCodePage;
 		const auto lastPageIt = firstPageIt + contextInfo.m_numCodePages;
-		const auto tempshitComparand = CodeTracePage{ entryAddress };
-		const auto it = std::lower_bound(firstPageIt, lastPageIt, tempshitComparand, [](const CodeTracePage& a, const CodeTracePage& b) { return a.m_baseAddress < b.m_baseAddress; });
-		if (it == lastPageIt)
+		const auto it = std::upper_bound(firstPageIt, lastPageIt, entryAddress, [](const uint64_t address, const CodeTracePage& page) { return address < page.m_baseAddress; });
+		if (it == firstPageIt)
 			return nullptr;
 
-		// page found
-		return &*it;*/
-
-		// linear search
-		for (uint32 i = 0; i < contextInfo.m_numCodePages; ++i)
-		{
-			const auto& codePage = m_codeTracePages[contextInfo.m_firstCodePage + i];
-			if (entryAddress >= codePage.m_baseAddress && entryAddress < codePage.m_baseAddress + CodeTracePage::NUM_ADDRESSES_PER_PAGE)
-			{
-				return &codePage;
-			}
-		}
+		// page found ?
+		const auto& codePage = *(it - 1);
+		if (entryAddress >= codePage.m_baseAddress + CodeTracePage::NUM_ADDRESSES_PER_PAGE)
+			return nullptr;
 
-		return nullptr;
+		return &codePage;
 	}
 
 	const CodeTracePage* DataFile::GetCodeTracePage(const TraceFrameID id) const
@@ -250,7 +241,7 @@ namespace trace
 		const auto& entryInfo = m_entries[id];
 
 		// unpack basic data
-		const auto& blobInfo = *(const BlobInfo*)(m_dataBlob.data() + entryInfo.m_offset);
+		const auto& blobInfo = GetBlobInfo(entryInfo);
 		const auto entryAddress = blobInfo.m_ip;
 
 		// lookup by address
@@ -264,13 +255,13 @@ namespace trace
 			return false;
 
 		// get offset to data
-		const auto sequenceIdOffset = page.m_dataOffsets[address - page.m_baseAddress];
+		const auto sequenceIdOffset = GetPageDataOffset(page, address);
 		if (!sequenceIdOffset)
 			return false;
 
 		// load count
-		const auto* readPtr = (const uint32_t*)(m_dataBlob.data() + sequenceIdOffset);
-		const auto count = *readPtr++;
+		const auto count = m_dataBlob.Get<uint32_t>(sequenceIdOffset);
+		const auto* readPtr = (const uint32_t*)m_dataBlob.GetData(sequenceIdOffset, sizeof(uint32_t) + count * sizeof(TraceFrameID)) + 1;
 		
 		// find the entries
 		outBefore = 0;
@@ -300,13 +291,13 @@ namespace trace
 			return false;
 
 		// get offset to data
-		const auto sequenceIdOffset = page.m_dataOffsets[address - page.m_baseAddress];
+		const auto sequenceIdOffset = GetPageDataOffset(page, address);
 		if (!sequenceIdOffset)
 			return false;
 
 		// load count
-		const auto* readPtr = (const uint32_t*)(m_dataBlob.data() + sequenceIdOffset);
-		const auto count = *readPtr++;
+		const auto count = m_dataBlob.Get<uint32_t>(sequenceIdOffset);
+		const auto* readPtr = (const uint32_t*)m_dataBlob.GetData(sequenceIdOffset, sizeof(uint32_t) + count * sizeof(TraceFrameID)) + 1;
 
 		// find the entries
 		{
@@ -375,13 +366,17 @@ namespace trace
 
 	const MemoryTracePage* DataFile::GetMemoryTracePage(const uint64_t address) const
 	{
-		// linear search
-		// TODO: std::lower_bound
-		for (auto& memoryPage : m_memoryTracePages)
-			if (address >= memoryPage.m_baseAddress && address < memoryPage.m_baseAddress + MemoryTracePage::NUM_ADDRESSES_PER_PAGE)
-				return &memoryPage;
+		// find the last page starting at or before the address, pages are sorted by base address
+		const auto it = std::upper_bound(m_memoryTracePages.begin(), m_memoryTracePages.end(), address, [](const uint64_t address, const MemoryTracePage& page) { return address < page.m_baseAddress; });
+		if (it == m_memoryTracePages.begin())
+			return nullptr;
 
-		return nullptr;
+		// page found ?
+		const auto& memoryPage = *(it - 1);
+		if (address >= memoryPage.m_baseAddress + MemoryTracePage::NUM_ADDRESSES_PER_PAGE)
+			return nullptr;
+
+		return &memoryPage;
 	}
 
 	MemoryCell DataFile::GetMemoryCell(const uint64_t address) const
@@ -392,16 +387,18 @@ namespace trace
 			return MemoryCell::EMPTY();
 
 		// get the offset to data
-		const auto dataOffset = page->m_dataOffsets[address % MemoryTracePage::NUM_ADDRESSES_PER_PAGE];
+		const auto dataOffset = GetPageDataOffset(*page, address);
 		if (!dataOffset)
 			return MemoryCell::EMPTY();
 
 		// get number of entries
-		const auto* dataPtr = (const uint8_t*)m_dataBlob.data() + dataOffset;
-		const auto numEntries = *(const uint32_t*)dataPtr;
+		const auto numEntries = m_dataBlob.Get<uint32_t>(dataOffset);
 		if (!numEntries)
 			return MemoryCell::EMPTY();
 
+		// make sure the whole history is loaded
+		const auto* dataPtr = m_dataBlob.GetData(dataOffset, sizeof(uint32_t) + numEntries * sizeof(MemoryCellHistoryEntry));
+
 		// create the cell
 		const auto* historyEntries = (const MemoryCellHistoryEntry*)(dataPtr + 4);
 		return MemoryCell(historyEntries, numEntries);
@@ -489,11 +486,37 @@ namespace trace
 
 	DataFrame* DataFile::CompileFrame(const TraceFrameID id)
 	{
+		// get the base frame from cache
+		const auto baseId = GetBaseFrame(id);
+		const auto* baseFrame = (baseId != INVALID_TRACE_FRAME_ID) ? &GetFrame(baseId) : nullptr;
+		return DecodeFrame(id, baseFrame);
+	}
+
+	const TraceFrameID DataFile::GetBaseFrame(const TraceFrameID id) const
+	{
+		// invalid id
+		if (id >= m_entries.size())
+			return INVALID_TRACE_FRAME_ID;
+
+		// only instruction frames are delta compressed
+		const auto& entryInfo = m_entries[id];
+		if (entryInfo.m_type != (uint8_t)FrameType::CpuInstruction || entryInfo.m_base == id)
+			return INVALID_TRACE_FRAME_ID;
+
+		return entryInfo.m_base;
+	}
+
+	DataFrame* DataFile::DecodeFrame(const TraceFrameID id, const DataFrame* baseFrame) const
+	{
+		// invalid id
+		if (id >= m_entries.size())
+			return nullptr;
+
 		// get the entry info
 		const auto& entryInfo = m_entries[id];
 
 		// unpack data
-		const auto& blobInfo = *(const BlobInfo*)(m_dataBlob.data() + entryInfo.m_offset);
+		const auto& blobInfo = GetBlobInfo(entryInfo);
 
 		// setup the location info
 		LocationInfo info;
@@ -516,16 +539,15 @@ namespace trace
 			// prepare data buffer
 			data.resize(m_dataFrameSize, 0);
 
-			// get the base frame
-			if (entryInfo.m_base != INVALID_TRACE_FRAME_ID && (entryInfo.m_base != id))
-			{
-				const auto& baseFrame = GetFrame(entryInfo.m_base);
-				memcpy(data.data(), baseFrame.GetRawData(), m_dataFrameSize);
-			}
+			// start with the data from the base frame
+			if (baseFrame && baseFrame->GetType() == FrameType::CpuInstruction)
+				memcpy(data.data(), baseFrame->GetRawData(), m_dataFrameSize);
 
 			// unpack the packed data
 			{
-				const auto* readPtr = (const uint8_t*)&blobInfo + sizeof(blobInfo);
+				// the register data is never bigger than the register count, register indices and full frame
+				const auto maxPackedSize = 1 + m_registers.size() + m_dataFrameSize;
+				const auto* readPtr = m_dataBlob.GetData(entryInfo.m_offset + sizeof(blobInfo), maxPackedSize);
 
 				// read number of registers and the data for the registers
 				const auto numRegs = *readPtr++;
@@ -547,9 +569,9 @@ namespace trace
 		else if (entryInfo.m_type == (uint8_t)FrameType::ExternalMemoryWrite)
 		{
 			// load size of data
-			const auto* readPtr = (const uint8_t*)&blobInfo + sizeof(blobInfo);
-			const auto stringLength = readPtr[0];
+			const auto stringLength = m_dataBlob.Get<uint8_t>(entryInfo.m_offset + sizeof(blobInfo));
 			const auto totalLength = stringLength + 1 + 8 + 4;
+			const auto* readPtr = m_dataBlob.GetData(entryInfo.m_offset + sizeof(blobInfo), totalLength);
 
 			data.resize(totalLength);
 			memcpy(data.data(), readPtr, totalLength);
@@ -560,43 +582,139 @@ namespace trace
 		return new DataFrame(info, type, navi, data);
 	}
 
-	template< typename T >
-	static const bool WriteDataChunk(ILogOutput& log, std::ofstream& f, const std::vector<T>& data, uint64& outPos, uint64& outSize)
+	const DataFile::BlobInfo& DataFile::GetBlobInfo(const Entry& entry) const
 	{
-		const auto* readPtr = (const char*)data.data();
-		const auto dataSize = data.size() * sizeof(T);
-		const auto dataBlockSize = 64 * 1024;
+		return m_dataBlob.Get<BlobInfo>(entry.m_offset);
+	}
 
-		const auto startPos = (uint64)f.tellp();
+	const uint64_t DataFile::GetPageDataOffset(const SparseTracePage& page, const uint64_t address) const
+	{
+		uint64_t index = 0;
+		if (!page.GetDataOffsetIndex((uint32_t)(address - page.m_baseAddress), index))
+			return 0;
 
-		// TODO: add compression
+		return m_pageDataOffsets[index];
+	}
 
-		uint64_t pos = 0;
-		while (pos < dataSize)
+	void DataFile::ReportPageMemoryUsage(ILogOutput& log) const
+	{
+		const auto numPages = m_codeTracePages.size() + m_memoryTracePages.size();
+		const auto sparseSize = numPages * sizeof(SparseTracePage) + m_pageDataOffsets.size() * sizeof(uint64_t);
+		const auto denseSize = numPages * (sizeof(uint64_t) + SparseTracePage::NUM_ADDRESSES_PER_PAGE * sizeof(uint64_t));
+		log.Log("Trace: %u code and %u memory pages with %llu used addresses take %1.2fMB (%1.2fMB saved)",
+			(uint32)m_codeTracePages.size(), (uint32)m_memoryTracePages.size(), (uint64)m_pageDataOffsets.size(),
+			(double)sparseSize / (1024.0*1024.0), (double)(denseSize - sparseSize) / (1024.0*1024.0));
+	}
+
+	static inline const uint64 PackFrameLink(const TraceFrameID link, const TraceFrameID seq)
+	{
+		// most links point to frames nearby, 0 is reserved for the invalid link
+		return (link == INVALID_TRACE_FRAME_ID) ? 0 : (ZigZagEncode((int64)(seq - link)) + 1);
+	}
+
+	static inline const TraceFrameID UnpackFrameLink(const uint64 value, const TraceFrameID seq)
+	{
+		return value ? (TraceFrameID)(seq - (TraceFrameID)ZigZagDecode(value - 1)) : INVALID_TRACE_FRAME_ID;
+	}
+
+	void DataFile::PackEntries(const Entry* entries, const uint32 numEntries, const TraceFrameID firstSeq, std::vector<uint8>& outData)
+	{
+		// number of entries in the group
+		WriteVarInt(outData, numEntries);
+
+		// type column, raw
+		for (uint32 i = 0; i < numEntries; ++i)
+			outData.push_back((uint8)entries[i].m_type);
+
+		// context column
+		for (uint32 i = 0; i < numEntries; ++i)
+			WriteVarInt(outData, entries[i].m_context);
+
+		// data offset column, delta to previous entry
+		uint64 prevOffset = 0;
+		for (uint32 i = 0; i < numEntries; ++i)
 		{
-			// update the visual progress
-			log.SetTaskProgress((uint32)(pos / dataBlockSize), (uint32)(dataSize / dataBlockSize));
+			WriteVarInt(outData, ZigZagEncode((int64)(entries[i].m_offset - prevOffset)));
+			prevOffset = entries[i].m_offset;
+		}
 
-			// write the data block
-			auto sizeToWrite = (pos + dataBlockSize <= dataSize) ? dataBlockSize : (dataSize - pos);
-			f.write(readPtr, sizeToWrite);
-			pos += sizeToWrite;
-			readPtr += sizeToWrite;
+		// reference frame column
+		for (uint32 i = 0; i < numEntries; ++i)
+			WriteVarInt(outData, PackFrameLink(entries[i].m_base, firstSeq + i));
 
-			// error ?
-			if (f.fail())
-			{
-				log.Error("Trace: Failed to save data to file. Check for disk space.");
+		// previous frame in thread column
+		for (uint32 i = 0; i < numEntries; ++i)
+			WriteVarInt(outData, PackFrameLink(entries[i].m_prevThread, firstSeq + i));
+
+		// next frame in thread column
+		for (uint32 i = 0; i < numEntries; ++i)
+			WriteVarInt(outData, PackFrameLink(entries[i].m_nextThread, firstSeq + i));
+	}
+
+	const bool DataFile::UnpackEntries(const uint8* data, const uint32 dataSize, const TraceFrameID firstSeq, std::vector<Entry>& outEntries)
+	{
+		const auto* readPtr = data;
+		const auto* endPtr = data + dataSize;
+		uint64 value = 0;
+
+		// number of entries in the group
+		if (!ReadVarInt(readPtr, endPtr, value) || value > ENTRIES_PER_FRAME)
+			return false;
+		const auto numEntries = (uint32)value;
+
+		// allocate entries
+		outEntries.resize(firstSeq + numEntries);
+		auto* entries = outEntries.data() + firstSeq;
+
+		// type column
+		if (readPtr + numEntries > endPtr)
+			return false;
+		for (uint32 i = 0; i < numEntries; ++i)
+			entries[i].m_type = *readPtr++;
+
+		// context column
+		for (uint32 i = 0; i < numEntries; ++i)
+		{
+			if (!ReadVarInt(readPtr, endPtr, value))
 				return false;
-			}
+			entries[i].m_context = (uint32)value;
 		}
 
-		// update chunk data
-		outPos = startPos;
-		outSize = (uint64)f.tellp() - startPos;
+		// data offset column
+		uint64 prevOffset = 0;
+		for (uint32 i = 0; i < numEntries; ++i)
+		{
+			if (!ReadVarInt(readPtr, endPtr, value))
+				return false;
+			prevOffset += (uint64)ZigZagDecode(value);
+			entries[i].m_offset = prevOffset;
+		}
 
-		// data saved
-		return true;
+		// reference frame column
+		for (uint32 i = 0; i < numEntries; ++i)
+		{
+			if (!ReadVarInt(readPtr, endPtr, value))
+				return false;
+			entries[i].m_base = UnpackFrameLink(value, firstSeq + i);
+		}
+
+		// previous frame in thread column
+		for (uint32 i = 0; i < numEntries; ++i)
+		{
+			if (!ReadVarInt(readPtr, endPtr, value))
+				return false;
+			entries[i].m_prevThread = UnpackFrameLink(value, firstSeq + i);
+		}
+
+		// next frame in thread column
+		for (uint32 i = 0; i < numEntries; ++i)
+		{
+			if (!ReadVarInt(readPtr, endPtr, value))
+				return false;
+			entries[i].m_nextThread = UnpackFrameLink(value, firstSeq + i);
+		}
+
+		return (readPtr == endPtr);
 	}
 
 	const bool DataFile::Save(ILogOutput& log, const std::wstring& filePath) const
@@ -625,44 +743,64 @@ namespace trace
 		{
 			log.SetTaskName("Saving context table...");
 			auto& info = header.m_chunks[CHUNK_CONTEXTS];
-			if (!WriteDataChunk(log, file, m_contexts, info.m_dataOffset, info.m_dataSize))
+			if (!WriteCompressedChunk(log, file, m_contexts, info.m_dataOffset, info.m_dataSize))
 				return false;
 		}
 		{
 			log.SetTaskName("Saving entry offset table...");
 			auto& info = header.m_chunks[CHUNK_ENTRIES];
-			if (!WriteDataChunk(log, file, m_entries, info.m_dataOffset, info.m_dataSize))
+
+			// each group of entries is packed separately so it can be decoded on its own
+			CompressedChunkWriter writer(file);
+			std::vector<uint8> packedEntries;
+			for (uint64 firstEntry = 0; firstEntry < m_entries.size(); firstEntry += ENTRIES_PER_FRAME)
+			{
+				log.SetTaskProgress(firstEntry, m_entries.size());
+
+				const auto numEntries = (uint32)std::min<uint64>(ENTRIES_PER_FRAME, m_entries.size() - firstEntry);
+				packedEntries.clear();
+				PackEntries(m_entries.data() + firstEntry, numEntries, firstEntry, packedEntries);
+				writer.AddFrame(packedEntries.data(), (uint32)packedEntries.size());
+			}
+
+			if (!writer.Finish(log, info.m_dataOffset, info.m_dataSize))
 				return false;
 		}
 		{
 			log.SetTaskName("Saving data blob...");
 			auto& info = header.m_chunks[CHUNK_DATA_BLOB];
-			if (!WriteDataChunk(log, file, m_dataBlob, info.m_dataOffset, info.m_dataSize))
+			if (!m_dataBlob.Save(log, file, info.m_dataOffset, info.m_dataSize))
 				return false;
 		}
 		{
 			log.SetTaskName("Saving call frames...");
 			auto& info = header.m_chunks[CHUNK_CALL_FRAMES];
-			if (!WriteDataChunk(log, file, m_callFrames, info.m_dataOffset, info.m_dataSize))
+			if (!WriteCompressedChunk(log, file, m_callFrames, info.m_dataOffset, info.m_dataSize))
 				return false;
 		}
 		{
 			log.SetTaskName("Saving code trace pages...");
 			auto& info = header.m_chunks[CHUNK_CODE_TRACE];
-			if (!WriteDataChunk(log, file, m_codeTracePages, info.m_dataOffset, info.m_dataSize))
+			if (!WriteCompressedChunk(log, file, m_codeTracePages, info.m_dataOffset, info.m_dataSize))
 				return false;
 		}
 		{
 			log.SetTaskName("Saving memory trace pages...");
 			auto& info = header.m_chunks[CHUNK_MEMORY_TRACE];
-			if (!WriteDataChunk(log, file, m_memoryTracePages, info.m_dataOffset, info.m_dataSize))
+			if (!WriteCompressedChunk(log, file, m_memoryTracePages, info.m_dataOffset, info.m_dataSize))
+				return false;
+		}
+		{
+			log.SetTaskName("Saving page data offsets...");
+			auto& info = header.m_chunks[CHUNK_PAGE_DATA_OFFSETS];
+			if (!WriteCompressedChunk(log, file, m_pageDataOffsets, info.m_dataOffset, info.m_dataSize))
 				return false;
 		}
 
 		// patch the header
 		const auto fileDataSize = file.tellp();
 		file.seekp(0);
-		header.m_magic = MAGIC; // allows us to read the file
+		header.m_magic = MAGIC_COMPRESSED; // allows us to read the file
 		file.write((char*)&header, sizeof(header));
 
 		// set file path
@@ -670,7 +808,7 @@ namespace trace
 		m_displayName = UnicodeToAnsi(GetFileName(filePath));
 
 		// saved
-		log.Log("Trace: Saved %1.2fMB of data", (double)(uint64)file.tellp() / (1024.0*1024.0));
+		log.Log("Trace: Saved %1.2fMB of data (%1.2fMB uncompressed blob)", (double)(uint64)fileDataSize / (1024.0*1024.0), (double)m_dataBlob.GetSize() / (1024.0*1024.0));
 		return true;
 	}
 
@@ -716,6 +854,144 @@ namespace trace
 		return true;
 	}
 
+	// dense trace page from the legacy file format
+	struct LegacyTracePage
+	{
+		uint64_t m_baseAddress;
+		uint64_t m_dataOffsets[SparseTracePage::NUM_ADDRESSES_PER_PAGE];
+	};
+
+	template< typename T >
+	static void ConvertLegacyPages(const std::vector<LegacyTracePage>& legacyPages, std::vector<T>& outPages, std::vector<uint64_t>& outOffsetTable)
+	{
+		outPages.resize(legacyPages.size());
+		for (uint32 i = 0; i < legacyPages.size(); ++i)
+			outPages[i].Pack(legacyPages[i].m_baseAddress, legacyPages[i].m_dataOffsets, outOffsetTable);
+	}
+
+	const bool DataFile::LoadRawChunks(ILogOutput& log, std::ifstream& file, const FileHeader& header)
+	{
+		{
+			log.SetTaskName("Loading context table...");
+			auto& info = header.m_chunks[CHUNK_CONTEXTS];
+			if (!ReadDataChunk(log, file, m_contexts, info.m_dataOffset, info.m_dataSize))
+				return false;
+		}
+		{
+			log.SetTaskName("Loading entry offset table...");
+			auto& info = header.m_chunks[CHUNK_ENTRIES];
+			if (!ReadDataChunk(log, file, m_entries, info.m_dataOffset, info.m_dataSize))
+				return false;
+		}
+		{
+			log.SetTaskName("Loading data blob...");
+			auto& info = header.m_chunks[CHUNK_DATA_BLOB];
+			std::vector<uint8> blobData;
+			if (!ReadDataChunk(log, file, blobData, info.m_dataOffset, info.m_dataSize))
+				return false;
+			m_dataBlob.Bind(std::move(blobData));
+		}
+		{
+			log.SetTaskName("Loading call frames...");
+			auto& info = header.m_chunks[CHUNK_CALL_FRAMES];
+			if (!ReadDataChunk(log, file, m_callFrames, info.m_dataOffset, info.m_dataSize))
+				return false;
+		}
+		{
+			log.SetTaskName("Loading code trace...");
+			auto& info = header.m_chunks[CHUNK_CODE_TRACE];
+			std::vector<LegacyTracePage> legacyPages;
+			if (!ReadDataChunk(log, file, legacyPages, info.m_dataOffset, info.m_dataSize))
+				return false;
+			ConvertLegacyPages(legacyPages, m_codeTracePages, m_pageDataOffsets);
+		}
+		{
+			log.SetTaskName("Loading memory trace...");
+			auto& info = header.m_chunks[CHUNK_MEMORY_TRACE];
+			std::vector<LegacyTracePage> legacyPages;
+			if (!ReadDataChunk(log, file, legacyPages, info.m_dataOffset, info.m_dataSize))
+				return false;
+			ConvertLegacyPages(legacyPages, m_memoryTracePages, m_pageDataOffsets);
+		}
+
+		return true;
+	}
+
+	const bool DataFile::LoadCompressedChunks(ILogOutput& log, std::ifstream& file, const FileHeader& header, const std::wstring& filePath)
+	{
+		{
+			log.SetTaskName("Loading context table...");
+			auto& info = header.m_chunks[CHUNK_CONTEXTS];
+			if (!ReadCompressedChunk(log, file, m_contexts, info.m_dataOffset, info.m_dataSize))
+				return false;
+		}
+		{
+			log.SetTaskName("Loading entry offset table...");
+			auto& info = header.m_chunks[CHUNK_ENTRIES];
+
+			CompressedChunkReader reader;
+			if (!reader.Open(log, file, info.m_dataOffset, info.m_dataSize))
+				return false;
+
+			// unpack the entry groups
+			const auto numGroups = (uint32)reader.GetFrames().size();
+			m_entries.reserve((uint64)numGroups * ENTRIES_PER_FRAME);
+			std::vector<uint8> packedEntries;
+			for (uint32 i = 0; i < numGroups; ++i)
+			{
+				log.SetTaskProgress(i, numGroups);
+
+				const auto& frame = reader.GetFrames()[i];
+				packedEntries.resize(frame.m_dataSize);
+				if (!reader.ReadFrame(file, i, packedEntries.data()))
+				{
+					log.Error("Trace: Failed to load entry table");
+					return false;
+				}
+
+				const auto firstEntry = (uint64)i * ENTRIES_PER_FRAME;
+				if (m_entries.size() != firstEntry || !UnpackEntries(packedEntries.data(), frame.m_dataSize, firstEntry, m_entries))
+				{
+					log.Error("Trace: Entry table is corrupted");
+					return false;
+				}
+			}
+		}
+		{
+			// the data blob is only indexed here, it's decompressed on demand
+			log.SetTaskName("Loading data blob...");
+			auto& info = header.m_chunks[CHUNK_DATA_BLOB];
+			if (!m_dataBlob.Open(log, filePath, info.m_dataOffset, info.m_dataSize))
+				return false;
+		}
+		{
+			log.SetTaskName("Loading call frames...");
+			auto& info = header.m_chunks[CHUNK_CALL_FRAMES];
+			if (!ReadCompressedChunk(log, file, m_callFrames, info.m_dataOffset, info.m_dataSize))
+				return false;
+		}
+		{
+			log.SetTaskName("Loading code trace...");
+			auto& info = header.m_chunks[CHUNK_CODE_TRACE];
+			if (!ReadCompressedChunk(log, file, m_codeTracePages, info.m_dataOffset, info.m_dataSize))
+				return false;
+		}
+		{
+			log.SetTaskName("Loading memory trace...");
+			auto& info = header.m_chunks[CHUNK_MEMORY_TRACE];
+			if (!ReadCompressedChunk(log, file, m_memoryTracePages, info.m_dataOffset, info.m_dataSize))
+				return false;
+		}
+		{
+			log.SetTaskName("Loading page data offsets...");
+			auto& info = header.m_chunks[CHUNK_PAGE_DATA_OFFSETS];
+			if (!ReadCompressedChunk(log, file, m_pageDataOffsets, info.m_dataOffset, info.m_dataSize))
+				return false;
+		}
+
+		return true;
+	}
+
 	std::unique_ptr<DataFile> DataFile::Load(ILogOutput& log, const platform::CPU& cpuInfo, const std::wstring& filePath)
 	{
 		std::ifstream file(filePath, std::ios::in | std::ios::binary);
@@ -731,12 +1007,20 @@ namespace trace
 		file.read((char*)&header, sizeof(header));
 
 		// check that the file is valid
-		if (header.m_magic != MAGIC)
+		if (header.m_magic != MAGIC && header.m_magic != MAGIC_COMPRESSED)
 		{
 			log.Error("Trace: File '%ls' does not have a valid header", filePath.c_str());
 			return nullptr;
 		}
 
+		// legacy files have less chunks in the header
+		if (header.m_magic == MAGIC)
+		{
+			header.m_chunks[CHUNK_PAGE_DATA_OFFSETS].m_dataOffset = 0;
+			header.m_chunks[CHUNK_PAGE_DATA_OFFSETS].m_dataSize = 0;
+			file.seekg(sizeof(FileHeader) - (NUM_CHUNKS - NUM_LEGACY_CHUNKS) * sizeof(FileChunk));
+		}
+
 		// load the registers
 		uint32_t traceDataOffsetPos = 0;
 		std::unique_ptr<DataFile> ret(new DataFile(&cpuInfo));
@@ -779,42 +1063,14 @@ namespace trace
 		ret->m_lastFrameSeq = header.m_lastSeq;
 
 		// load the chunks
-		{
-			log.SetTaskName("Loading context table...");
-			auto& info = header.m_chunks[CHUNK_CONTEXTS];
-			if (!ReadDataChunk(log, file, ret->m_contexts, info.m_dataOffset, info.m_dataSize))
-				return false;
-		}
-		{
-			log.SetTaskName("Loading entry offset table...");
-			auto& info = header.m_chunks[CHUNK_ENTRIES];
-			if (!ReadDataChunk(log, file, ret->m_entries, info.m_dataOffset, info.m_dataSize))
-				return false;
-		}
-		{
-			log.SetTaskName("Loading data blob...");
-			auto& info = header.m_chunks[CHUNK_DATA_BLOB];
-			if (!ReadDataChunk(log, file, ret->m_dataBlob, info.m_dataOffset, info.m_dataSize))
-				return false;
-		}
-		{
-			log.SetTaskName("Loading call frames...");
-			auto& info = header.m_chunks[CHUNK_CALL_FRAMES];
-			if (!ReadDataChunk(log, file, ret->m_callFrames, info.m_dataOffset, info.m_dataSize))
-				return false;
-		}
-		{
-			log.SetTaskName("Loading code trace...");
-			auto& info = header.m_chunks[CHUNK_CODE_TRACE];
-			if (!ReadDataChunk(log, file, ret->m_codeTracePages, info.m_dataOffset, info.m_dataSize))
-				return false;
-		}
-		{
-			log.SetTaskName("Loading memory trace...");
-			auto& info = header.m_chunks[CHUNK_MEMORY_TRACE];
-			if (!ReadDataChunk(log, file, ret->m_memoryTracePages, info.m_dataOffset, info.m_dataSize))
-				return false;
-		}
+		const auto loaded = (header.m_magic == MAGIC_COMPRESSED)
+			? ret->LoadCompressedChunks(log, file, header, filePath)
+			: ret->LoadRawChunks(log, file, header);
+		if (!loaded)
+			return nullptr;
+
+		// stats
+		ret->ReportPageMemoryUsage(log);
 
 		// set file path
 		ret->m_filePath = filePath;
@@ -875,12 +1131,16 @@ namespace trace
 		ret->m_lastFrameSeq = builder.m_lastSeq;
 
 		// extract data
-		builder.m_blob.exportToVector(ret->m_dataBlob);
+		std::vector<uint8> blobData;
+		builder.m_blob.exportToVector(blobData);
+		ret->m_dataBlob.Bind(std::move(blobData));
 		builder.m_entries.exportToVector(ret->m_entries);
 		builder.m_contexts.exportToVector(ret->m_contexts);
 		builder.m_callFrames.exportToVector(ret->m_callFrames);
 		builder.m_codeTracePages.exportToVector(ret->m_codeTracePages);
 		builder.m_memoryTracePages.exportToVector(ret->m_memoryTracePages);
+		builder.m_pageDataOffsets.exportToVector(ret->m_pageDataOffsets);
+		ret->ReportPageMemoryUsage(log);
 
 		// done
 		return ret;
@@ -1,5 +1,7 @@
 #pragma once
 #include "traceMemorySlice.h"
+#include <intrin.h>
+#include "traceCompressedChunk.h"
 
 namespace trace
 {
@@ -106,20 +108,63 @@ namespace trace
 		{}
 	};
 
-	// code trace page
-	struct CodeTracePage
+	// sparse page of offsets to entry lists in data blob
+	// only the addresses that were touched have the offset stored, offsets are kept in a shared table
+	// the bitmap with per-word prefix counts gives O(1) lookup of the offset for given address
+	struct SparseTracePage
 	{
 		static const uint32_t NUM_ADDRESSES_PER_PAGE = 4096; // normal page
+		static const uint32_t NUM_MASK_WORDS = NUM_ADDRESSES_PER_PAGE / 64;
+
 		uint64_t m_baseAddress; // base address of data
-		uint64_t m_dataOffsets[NUM_ADDRESSES_PER_PAGE]; // offsets to entry lists in data blob
+		uint64_t m_firstDataOffset; // index of the first offset in the shared offset table
+		uint64_t m_usedMask[NUM_MASK_WORDS]; // bit is set for every address that has data
+		uint16_t m_usedBefore[NUM_MASK_WORDS]; // number of addresses with data in the preceding mask words
+
+		// get index (in the shared offset table) of the offset for given address in the page, returns false if address has no data
+		inline const bool GetDataOffsetIndex(const uint32_t localAddress, uint64_t& outIndex) const
+		{
+			const auto word = m_usedMask[localAddress / 64];
+			const auto bit = 1ULL << (localAddress % 64);
+			if (!(word & bit))
+				return false;
+
+			outIndex = m_firstDataOffset + m_usedBefore[localAddress / 64] + __popcnt64(word & (bit - 1));
+			return true;
+		}
+
+		// pack dense offset table into the page, offsets are appended to the shared offset table
+		template< typename TOffsetTable >
+		inline void Pack(const uint64_t baseAddress, const uint64_t* denseOffsets, TOffsetTable& outOffsetTable)
+		{
+			memset(this, 0, sizeof(SparseTracePage));
+			m_baseAddress = baseAddress;
+			m_firstDataOffset = outOffsetTable.size();
+
+			uint16_t count = 0;
+			for (uint32_t i = 0; i < NUM_ADDRESSES_PER_PAGE; ++i)
+			{
+				if ((i % 64) == 0)
+					m_usedBefore[i / 64] = count;
+
+				if (denseOffsets[i])
+				{
+					m_usedMask[i / 64] |= 1ULL << (i % 64);
+					outOffsetTable.push_back(denseOffsets[i]);
+					count += 1;
+				}
+			}
+		}
+	};
+
+	// code trace page
+	struct CodeTracePage : public SparseTracePage
+	{
 	};
 
 	// memory trace page
-	struct MemoryTracePage
+	struct MemoryTracePage : public SparseTracePage
 	{
-		static const uint32_t NUM_ADDRESSES_PER_PAGE = 4096; // normal page
-		uint64_t m_baseAddress; // base address of data
-		uint64_t m_dataOffsets[NUM_ADDRESSES_PER_PAGE]; // offsets to entry lists in data blob
 	};
 
 	// memory access type
@@ -247,6 +292,13 @@ namespace trace
 		// decode frame
 		const DataFrame& GetFrame(const TraceFrameID seq);
 		
+		// decode frame without using the frame cache, safe to call from multiple threads
+		// NOTE: the base frame (see GetBaseFrame) must be provided for the delta compressed frames, caller owns the returned frame
+		DataFrame* DecodeFrame(const TraceFrameID seq, const DataFrame* baseFrame) const;
+
+		// get the reference frame given frame is delta compressed against, returns INVALID_TRACE_FRAME_ID if frame is not delta compressed
+		const TraceFrameID GetBaseFrame(const TraceFrameID seq) const;
+
 		// get index of next frame for given frame ID
 		const TraceFrameID GetNextInContextFrame(const TraceFrameID seq) const;
 
@@ -313,8 +365,12 @@ namespace trace
 	private:
 		DataFile(const platform::CPU* cpuInfo);
 
-		static const uint32_t MAGIC = 'XTRC';
-		static const uint32_t NUM_CHUNKS = 6;
+		static const uint32_t MAGIC = 'XTRC'; // raw chunks, legacy
+		static const uint32_t MAGIC_COMPRESSED = 'XTRZ'; // compressed chunks with frame index
+		static const uint32_t NUM_CHUNKS = 7;
+		static const uint32_t NUM_LEGACY_CHUNKS = 6;
+
+		static const uint32_t ENTRIES_PER_FRAME = 65536; // entries are stored in independent column-wise packed groups
 
 		static const uint32_t CHUNK_CONTEXTS = 0;
 		static const uint32_t CHUNK_ENTRIES = 1;
@@ -322,6 +378,7 @@ namespace trace
 		static const uint32_t CHUNK_CALL_FRAMES = 3;
 		static const uint32_t CHUNK_CODE_TRACE = 4;
 		static const uint32_t CHUNK_MEMORY_TRACE = 5;
+		static const uint32_t CHUNK_PAGE_DATA_OFFSETS = 6;
 
 		struct FileChunk
 		{
@@ -382,8 +439,8 @@ namespace trace
 		// for each trace sequence number this points to the data in the trace buffer
 		std::vector<Entry> m_entries;
 
-		// packed trace data
-		std::vector<uint8_t> m_dataBlob;
+		// packed trace data, loaded on demand
+		DataBlob m_dataBlob;
 
 		// trace context table (threads and IRQs/APC/etc)
 		std::vector<Context> m_contexts;
@@ -397,6 +454,9 @@ namespace trace
 		// memory pages
 		std::vector<MemoryTracePage> m_memoryTracePages;
 
+		// offsets to data in blob for addresses used in code and memory pages
+		std::vector<uint64_t> m_pageDataOffsets;
+
 		// sequence range
 		TraceFrameID m_firstFrameSeq;
 		TraceFrameID m_lastFrameSeq;
@@ -430,6 +490,27 @@ namespace trace
 
 		DataFrame* CompileFrame(const TraceFrameID id);
 
+		// get blob info for given entry
+		const BlobInfo& GetBlobInfo(const Entry& entry) const;
+
+		// get offset to data in blob for given address in code or memory page, returns 0 if there's no data
+		const uint64_t GetPageDataOffset(const SparseTracePage& page, const uint64_t address) const;
+
+		// print the memory used by the page tables
+		void ReportPageMemoryUsage(ILogOutput& log) const;
+
+		// pack group of entries column-wise using delta/varint coding
+		static void PackEntries(const Entry* entries, const uint32 numEntries, const TraceFrameID firstSeq, std::vector<uint8>& outData);
+
+		// unpack group of entries packed with PackEntries, entries are appended to the table
+		static const bool UnpackEntries(const uint8* data, const uint32 dataSize, const TraceFrameID firstSeq, std::vector<Entry>& outEntries);
+
+		// load chunks from legacy file with raw chunks
+		const bool LoadRawChunks(ILogOutput& log, std::ifstream& file, const FileHeader& header);
+
+		// load chunks from file with compressed chunks
+		const bool LoadCompressedChunks(ILogOutput& log, std::ifstream& file, const FileHeader& header, const std::wstring& filePath);
+
 		void PostLoad();
 
 		friend class DataBuilder;
@@ -1,119 +1,98 @@
 #include "build.h"
-
-#if 0
-
 #include "traceMemoryHistory.h"
 
 namespace trace 
 {
 	MemoryHistory::MemoryHistory()
-		: m_pageRanges(NULL)
-		, m_entryFile(NULL)
-		, m_numPageRanges(0)
-		, m_pages(NULL)
-		, m_numPages(0)
+		: m_entriesOffset(0)
+		, m_numEntries(0)
 	{
+		memset(&m_addressSpaceMap[0], 0, sizeof(m_addressSpaceMap));
 	}
 
 	MemoryHistory::~MemoryHistory()
 	{
-		if (m_pages)
-		{
-			free((void*)m_pages);
-			m_pages = NULL;
-		}
-
-		if (m_pageRanges)
-		{
-			free((void*)m_pageRanges);
-			m_pageRanges = NULL;
-		}
-
-		if (m_entryFile)
-		{
-			delete m_entryFile;
-			m_entryFile = NULL;
-		}
 	}
 
 	class MemoryHistoryReader* MemoryHistory::CreateReader() const
 	{
-		return new MemoryHistoryReader(this, m_entryFile->CreateReader());
+		// each reader has its own file handle so they can be used from different threads
+		auto file = std::make_unique<std::ifstream>(m_filePath, std::ios::in | std::ios::binary);
+		if (file->fail())
+			return nullptr;
+
+		return new MemoryHistoryReader(this, file);
 	}
 
 	MemoryHistory* MemoryHistory::OpenFile(class ILogOutput& log, const wchar_t* filePath)
 	{
 		// open file
-		std::auto_ptr<PagedFile> file(PagedFile::OpenFile(filePath));
-		if (!file.get())
+		std::ifstream file(filePath, std::ios::in | std::ios::binary);
+		if (file.fail())
 		{
 			log.Error( "MemoryTrace: Failed to open file '%ls'", filePath);
-			return NULL;
+			return nullptr;
 		}
 
-		// create data reader
-		std::auto_ptr<PagedFileReader> reader(file->CreateReader());
-
 		// read the header
 		Header header;
 		memset(&header,0,sizeof(header));
-		if (!reader->Read(&header, sizeof(header)))
+		file.read((char*)&header, sizeof(header));
+		if (file.fail())
 		{
 			log.Error( "MemoryTrace: Error reading from '%ls'", filePath );
-			return NULL;
+			return nullptr;
 		}
 
 		// valid file ?
 		if (header.m_magic != MAGIC)
 		{
 			log.Error( "MemoryTrace: Invalid format of '%ls' (%08X!=%08X)", filePath, header.m_magic, MAGIC );
-			return NULL;
+			return nullptr;
 		}
 
 		// create output object
-		std::auto_ptr<MemoryHistory> ret(new MemoryHistory());
-		ret->m_numPageRanges = header.m_numPageRanges;
-		ret->m_numPages = header.m_numPages;
+		std::unique_ptr<MemoryHistory> ret(new MemoryHistory());
 		ret->m_numEntries = header.m_numEntries;
 
 		// Load pages
-		ret->m_pages = (const Page*) malloc(header.m_numPages*sizeof(Page));
-		reader->Seek( header.m_pagesOffset );
-		if (!ret->m_pages || !reader->Read((void*)ret->m_pages, header.m_numPages*sizeof(Page)))
+		ret->m_pages.resize(header.m_numPages);
+		file.seekg(header.m_pagesOffset);
+		file.read((char*)ret->m_pages.data(), header.m_numPages*sizeof(Page));
+		if (file.fail())
 		{
 			log.Error( "MemoryTrace: Error loading pages from '%ls'", filePath);
-			return NULL;
+			return nullptr;
 		}
 
-		// Create page ranges
-		ret->m_pageRanges = (const PageRange*) malloc(header.m_numPageRanges*sizeof(PageRange));
-		reader->Seek(header.m_pageRangesOffset);
-		if (!ret->m_pageRanges || !reader->Read((void*)ret->m_pageRanges, header.m_numPageRanges*sizeof(PageRange)))
+		// Load page ranges
+		ret->m_pageRanges.resize(header.m_numPageRanges);
+		file.seekg(header.m_pageRangesOffset);
+		file.read((char*)ret->m_pageRanges.data(), header.m_numPageRanges*sizeof(PageRange));
+		if (file.fail())
 		{
-			log.Error( "MemoryTrace: Error loading pages from '%ls'", filePath);
-			return NULL;
+			log.Error( "MemoryTrace: Error loading page ranges from '%ls'", filePath);
+			return nullptr;
 		}
 
 		// Setup page mapping
-		memset(&ret->m_addressSpaceMap[0], 0, sizeof(ret->m_addressSpaceMap));
-		for (uint32 i=0; i<header.m_numPageRanges; ++i)
+		for (const auto& pr : ret->m_pageRanges)
 		{
-			const PageRange* pr = &ret->m_pageRanges[i];
-			const uint32 prIndex = pr->m_address >> (RANGE_SHIFT);
+			const uint32 prIndex = pr.m_address >> (RANGE_SHIFT);
 			if (ret->m_addressSpaceMap[prIndex])
 			{
-				log.Log( "MemoryTrace: PageRange collision at entry %u", prIndex);
-				return NULL;
+				log.Error( "MemoryTrace: PageRange collision at entry %u", prIndex);
+				return nullptr;
 			}
 
-			ret->m_addressSpaceMap[prIndex] = pr;
+			ret->m_addressSpaceMap[prIndex] = &pr;
 		}
 
 		// stats
 		log.Log( "MemoryTrace: Loaded memory trace, %u entries in %u pages, %u page ranges", header.m_numEntries, header.m_numPages, header.m_numPageRanges );
 
-		// set file
-		ret->m_entryFile = file.release();
+		// entries are read on demand
+		ret->m_filePath = filePath;
 		ret->m_entriesOffset = header.m_entriesOffset;
 
 		// done
@@ -131,30 +110,25 @@ namespace trace
 		// get page in page range
 		const uint32 pageNr = (memoryAddress >> PAGE_SHIFT) & PAGE_MASK;
 		const uint32 pageIndex = pr->m_pages[ pageNr ];
-		if ( !pageIndex )
+		if ( !pageIndex || pageIndex > m_pages.size() )
 			return 0;
 
 		// get entry index
-		const Page* page = m_pages + (pageIndex-1);
-		const uint32 entryList = page->m_entries[ memoryAddress & PAGE_MASK ];
+		const Page& page = m_pages[pageIndex-1];
+		const uint32 entryList = page.m_entries[ memoryAddress & PAGE_MASK ];
 		return entryList;
 	}
 
 	//---------------------------------------------------------------------------
 
-	MemoryHistoryReader::MemoryHistoryReader(const MemoryHistory* data, PagedFileReader* fileReader)
+	MemoryHistoryReader::MemoryHistoryReader(const MemoryHistory* data, std::unique_ptr<std::ifstream>& file)
 		: m_data(data)
-		, m_reader(fileReader)
+		, m_file(std::move(file))
 	{
 	}
 
 	MemoryHistoryReader::~MemoryHistoryReader()
 	{
-		if (m_reader)
-		{
-			delete m_reader;
-			m_reader = NULL;
-		}
 	}
 
 	const bool MemoryHistoryReader::GetHistory(const uint32 address, const uint32 minTraceEntry, const uint32 maxTraceEntry, std::vector<History>& outHistory) const
@@ -166,17 +140,26 @@ namespace trace
 
 		// build the list
 		uint32 entryIndex = entryList;
+		uint32 filePosIndex = 0;
 		while (entryIndex)
 		{
 			// invalid entry ?
-			if (entryIndex >= m_data->m_numEntries)
+			if (entryIndex > m_data->m_numEntries)
 				break;
 
-			// read entry		
+			// entries for the same address are usually stored one after another, seek only when needed
+			if (entryIndex != filePosIndex)
+				m_file->seekg(m_data->m_entriesOffset + (uint64)(entryIndex-1)*sizeof(MemoryHistory::Entry));
+
+			// read entry
 			MemoryHistory::Entry entry;
-			m_reader->Seek(m_data->m_entriesOffset + (entryIndex-1)*sizeof(entry));
-			if (!m_reader->Read(&entry, sizeof(entry)))
+			m_file->read((char*)&entry, sizeof(entry));
+			if (m_file->fail())
+			{
+				m_file->clear();
 				break;
+			}
+			filePosIndex = entryIndex + 1;
 
 			// out of range
 			if (entry.m_entry > maxTraceEntry)
@@ -202,5 +185,3 @@ namespace trace
 	}
 
 } // trace
-
-#endif // _DEBUG
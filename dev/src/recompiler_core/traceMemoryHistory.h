@@ -5,8 +5,6 @@ namespace trace
 
 	//---------------------------------------------------------------------------
 
-	class PagedFile;
-	class PagedFileReader;
 	class MemoryHistoryReader;
 	class MemoryHistoryBuilder;
 
@@ -55,10 +53,11 @@ namespace trace
 
 		struct Entry
 		{
-			uint32		m_next:24;		// next entry
-			uint32		m_data:8;		// memory data
+			uint32		m_next;			// next entry (1-based, 0 ends the list)
 			uint32		m_entry:31;		// index of entry affecting this location
 			uint32		m_op:1;			// read:0 write:1
+			uint8		m_data;			// memory data
+			uint8		m_padding[3];
 		};
 
 		// ~1KB access page
@@ -76,16 +75,13 @@ namespace trace
 		};
 
 		// address space mapping for higher (32-20 = 12 bits = 4096 entries)
-		const PageRange*		m_pageRanges;
-		uint32					m_numPageRanges;
-		uint32					m_numPageIds;
+		std::vector<PageRange>	m_pageRanges;
 
 		// page ranges (valid ones)
-		const Page*				m_pages;
-		uint32					m_numPages;
+		std::vector<Page>		m_pages;
 
 		// file with memory access entries
-		PagedFile*				m_entryFile;
+		std::wstring			m_filePath;
 		uint64					m_entriesOffset;
 		uint32					m_numEntries;
 
@@ -112,7 +108,7 @@ namespace trace
 			uint8	m_op;  //1-write, 0-read
 		};
 
-		MemoryHistoryReader( const MemoryHistory* data, PagedFileReader* fileReader);
+		MemoryHistoryReader( const MemoryHistory* data, std::unique_ptr<std::ifstream>& file );
 		~MemoryHistoryReader();
 
 		// get memory history for given byte
@@ -123,7 +119,7 @@ namespace trace
 		const MemoryHistory*		m_data;
 
 		// file reader
-		PagedFileReader*		m_reader;
+		std::unique_ptr<std::ifstream>	m_file;
 	};
 	
 	//---------------------------------------------------------------------------
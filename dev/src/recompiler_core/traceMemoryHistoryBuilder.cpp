@@ -1,137 +1,281 @@
 #include "build.h"
 
-#if 0
-
 #include "decodingContext.h"
 #include "decodingInstruction.h"
 #include "decodingInstructionInfo.h"
 
-#include "tracePagedFile.h"
-#include "traceData.h"
+#include "traceDataFile.h"
 #include "traceMemoryHistory.h"
 #include "traceMemoryHistoryBuilder.h"
 #include "platformCPU.h"
 #include "traceUtils.h"
 
+#include <thread>
+#include <future>
+#include <queue>
+
 namespace trace
 {
 
 	MemoryHistoryBuilder::MemoryHistoryBuilder()
-		: m_nextEntryId(1)
-		, m_outputFile(NULL)
+		: m_traceData(nullptr)
+		, m_decodingContext(nullptr)
+		, m_nextJob(0)
+		, m_numFramesProcessed(0)
+		, m_canceled(false)
 	{
-		memset( &m_ranges[0], 0, sizeof(m_ranges));
 	}
 
 	MemoryHistoryBuilder::~MemoryHistoryBuilder()
 	{
-		// close file
-		if ( m_outputFile )
-		{
-			fclose(m_outputFile);
-			m_outputFile = NULL;
-		}
+		// remove any left over temporary files
+		DeleteRuns();
 
 		// cleanup
-		for (uint32 i=0; i<MemoryHistory::MAX_RANGES; ++i)
-		{
-			delete m_ranges[i];
-		}
+		for (auto& it : m_instructions)
+			delete it.second;
 	}
 
-	bool MemoryHistoryBuilder::BuildFile(class ILogOutput& log, decoding::Context& decodingContext, const Data& data, const wchar_t* outputFile)
+	bool MemoryHistoryBuilder::BuildFile(class ILogOutput& log, decoding::Context& decodingContext, const DataFile& data, const wchar_t* outputFile, const uint64 memoryBudget)
 	{
 		// get the target CPU
 		const platform::CPU* dataCpu = data.GetCPU();
 		if (!dataCpu)
 			return false;
 
-		// open output file
-		_wfopen_s(&m_outputFile, outputFile, L"wb+");
-		if (!m_outputFile)
+		// the trace entry index is stored on 31 bits
+		const uint64 numFrames = data.GetNumDataFrames();
+		if (numFrames >= (1ULL << 31))
+		{
+			log.Error("MemTrace: Trace is to big (%llu frames) to build memory history", numFrames);
 			return false;
+		}
 
-		// prepare header
-		MemoryHistory::Header header;
-		memset(&header, 0, sizeof(header));
-		header.m_magic = MemoryHistory::MAGIC;
+		// setup
+		m_traceData = &data;
+		m_decodingContext = &decodingContext;
+		m_outputPath = outputFile;
+		m_nextJob = 0;
+		m_numFramesProcessed = 0;
+		m_canceled = false;
+
+		// prepare workers, each one gets the equal share of the sort memory
+		const uint32 numWorkers = std::max<uint32>(1, std::thread::hardware_concurrency());
+		const uint64 maxOpsPerWorker = std::max<uint64>(65536, (memoryBudget / numWorkers) / sizeof(MemoryOp));
+		std::vector<Worker> workers(numWorkers);
+		for (auto& worker : workers)
+		{
+			worker.m_maxOps = maxOpsPerWorker;
+			worker.m_ops.reserve((size_t)maxOpsPerWorker);
+			worker.m_numReadBytes = 0;
+			worker.m_numReadInstructions = 0;
+			worker.m_numWriteBytes = 0;
+			worker.m_numWriteInstructions = 0;
+			worker.m_numUnsupported = 0;
+			worker.m_numUnknownInstructions = 0;
+			worker.m_failed = false;
+		}
 
-		// write header
-		SetFilePos(0);
-		WriteToFile(&header, sizeof(header));
+		// extract memory operations in parallel
+		log.SetTaskName("Building memory trace...");
+		{
+			const uint32 numJobs = (uint32)((numFrames + FRAMES_PER_JOB - 1) / FRAMES_PER_JOB);
 
-		// entry data start
-		header.m_entriesOffset = GetFilePos();
-		m_entryDataStart = GetFilePos();
+			std::vector<std::future<void>> jobs;
+			for (auto& worker : workers)
+			{
+				auto* workerPtr = &worker;
+				jobs.push_back(std::async(std::launch::async, [this, workerPtr, numJobs, numFrames]()
+				{
+					for (;;)
+					{
+						const auto jobIndex = m_nextJob++;
+						if (jobIndex >= numJobs || m_canceled || workerPtr->m_failed)
+							break;
+
+						const auto firstFrame = jobIndex * FRAMES_PER_JOB;
+						const auto lastFrame = (uint32)std::min<uint64>(numFrames, (uint64)firstFrame + FRAMES_PER_JOB);
+						ProcessFrames(*workerPtr, firstFrame, lastFrame);
+					}
+
+					// spill whatever is left
+					if (!workerPtr->m_ops.empty() && !m_canceled && !workerPtr->m_failed)
+						FlushRun(*workerPtr);
+				}));
+			}
 
-		// reset counters
-		m_nextEntryId = 1;
+			// wait for the workers, only this thread talks to the log
+			for (auto& job : jobs)
+			{
+				while (job.wait_for(std::chrono::milliseconds(100)) != std::future_status::ready)
+				{
+					log.SetTaskProgress(m_numFramesProcessed, numFrames);
+					if (log.IsTaskCanceled())
+						m_canceled = true;
+				}
+			}
+		}
 
-		// create trace data reader
-		std::auto_ptr<DataReader> reader(data.CreateReader());
+		// canceled
+		if (m_canceled)
+		{
+			DeleteRuns();
+			return false;
+		}
 
-		// stats
-		log.SetTaskName("Building memory trace...");
+		// final stats
+		uint64 numReadBytes = 0, numReadInstructions = 0, numWriteBytes = 0, numWriteInstructions = 0, numUnsupported = 0, numUnknown = 0;
+		bool failed = false;
+		for (const auto& worker : workers)
+		{
+			numReadBytes += worker.m_numReadBytes;
+			numReadInstructions += worker.m_numReadInstructions;
+			numWriteBytes += worker.m_numWriteBytes;
+			numWriteInstructions += worker.m_numWriteInstructions;
+			numUnsupported += worker.m_numUnsupported;
+			numUnknown += worker.m_numUnknownInstructions;
+			failed |= worker.m_failed;
+		}
 
-		// process the entries
-		uint32 numWriteInstructions = 0;
-		uint32 numWriteBytes = 0;
-		uint32 numReadInstructions = 0;
-		uint32 numReadBytes = 0;
-		const uint32 numFrames = data.GetNumDataFrames();
-		for (uint32 i=0; i<numFrames; ++i)
+		// failed to write the temporary data
+		if (failed)
 		{
-			// stats
-			log.SetTaskProgress(i,numFrames);
+			log.Error("MemTrace: Failed to write temporary sort data. Check for disk space.");
+			DeleteRuns();
+			return false;
+		}
+
+		if (numUnknown)
+			log.Warn("MemTrace: %llu unknown instructions were found, the trace may be incomplete", numUnknown);
+		if (numUnsupported)
+			log.Warn("MemTrace: %llu memory accesses were not saved because of unsupported size or address", numUnsupported);
+		log.Log("MemTrace: Read %llu bytes in %llu instructions", numReadBytes, numReadInstructions);
+		log.Log("MemTrace: Written %llu bytes in %llu instructions", numWriteBytes, numWriteInstructions);
+		log.Log("MemTrace: %u sorted runs created", (uint32)m_runs.size());
+
+		// merge sorted data into the final file
+		const bool ret = MergeRuns(log, memoryBudget);
+		DeleteRuns();
+		return ret;
+	}
+
+	const MemoryHistoryBuilder::DecodedInstruction* MemoryHistoryBuilder::GetInstruction(Worker& worker, const uint64 codeAddress)
+	{
+		// local lookup, no locking
+		const auto localIt = worker.m_localInstructions.find(codeAddress);
+		if (localIt != worker.m_localInstructions.end())
+			return localIt->second;
+
+		// shared lookup, decode if not there yet
+		std::lock_guard<std::mutex> lock(m_decodeLock);
+		auto*& entry = m_instructions[codeAddress];
+		if (!entry)
+		{
+			entry = new DecodedInstruction();
+			entry->m_valid = false;
+
+			if (m_decodingContext->DecodeInstruction(ILogOutput::DevNull(), codeAddress, entry->m_op))
+				entry->m_valid = entry->m_op.GetExtendedInfo(codeAddress, *m_decodingContext, entry->m_info);
+		}
+
+		worker.m_localInstructions[codeAddress] = entry;
+		return entry;
+	}
+
+	void MemoryHistoryBuilder::ProcessFrames(Worker& worker, const uint32 firstFrame, const uint32 lastFrame)
+	{
+		// frames are delta compressed, keep the reference frames around as they are shared by many frames
+		std::unique_ptr<DataFrame> baseFrames[2];
+		TraceFrameID baseFrameIds[2] = { INVALID_TRACE_FRAME_ID, INVALID_TRACE_FRAME_ID };
+		auto decodeFrame = [&](const TraceFrameID seq) -> DataFrame*
+		{
+			const auto baseId = m_traceData->GetBaseFrame(seq);
+			const DataFrame* baseFrame = nullptr;
+			if (baseId != INVALID_TRACE_FRAME_ID)
+			{
+				uint32 slot = 0;
+				if (baseFrameIds[0] != baseId)
+				{
+					if (baseFrameIds[1] != baseId)
+					{
+						baseFrames[1] = std::move(baseFrames[0]);
+						baseFrameIds[1] = baseFrameIds[0];
+						baseFrames[0].reset(m_traceData->DecodeFrame(baseId, nullptr));
+						baseFrameIds[0] = baseId;
+					}
+					else
+					{
+						slot = 1;
+					}
+				}
+
+				baseFrame = baseFrames[slot].get();
+			}
+
+			return m_traceData->DecodeFrame(seq, baseFrame);
+		};
+
+		for (uint32 i = firstFrame; i < lastFrame; ++i)
+		{
+			if (m_canceled || worker.m_failed)
+				return;
+
+			++m_numFramesProcessed;
 
 			// read trace data
-			const DataFrame& frame = reader->GetFrame(i);
-			const DataFrame& nextFrame = reader->GetFrame(i+1); // so we know what has been read
-			const uint32 codeAddress = frame.GetAddress();
-			if ( !codeAddress )
+			std::unique_ptr<DataFrame> frame(decodeFrame(i));
+			if (!frame || frame->GetType() != FrameType::CpuInstruction)
+				continue;
+
+			const uint64 codeAddress = frame->GetAddress();
+			if (!codeAddress)
 				continue;
 
 			// decode instruction
-			decoding::Instruction op;
-			if ( !decodingContext.DecodeInstruction( log, codeAddress, op ) )
+			const auto* decoded = GetInstruction(worker, codeAddress);
+			if (!decoded->m_valid)
 			{
-				log.Error( "MemTrace: Unknown instruction used at address %08Xh, the trace may be incomplete", codeAddress );
+				worker.m_numUnknownInstructions += 1;
 				continue;
 			}
 
-			// get extra instruction info
-			decoding::InstructionExtendedInfo info;
-			if (!op.GetExtendedInfo(codeAddress, decodingContext, info))
-				continue;
-
 			// not a memory access instruction ?
+			const auto& info = decoded->m_info;
 			if (0 == (info.m_memoryFlags & (decoding::InstructionExtendedInfo::eMemoryFlags_Write | decoding::InstructionExtendedInfo::eMemoryFlags_Read)))
 				continue;
 
 			// calculate target address (using trace data)
 			uint64 memoryAdddress;
-			if (!info.ComputeMemoryAddress(frame, memoryAdddress))
+			if (!info.ComputeMemoryAddress(*frame, memoryAdddress))
 				continue;
 
 			// get the register
-			const platform::CPURegister* reg0 = op.GetArg0().m_reg;
+			const platform::CPURegister* reg0 = decoded->m_op.GetArg0().m_reg;
 
 			// write memory operation
 			uint8 opType = 1; // write
 			uint64 value = 0;
 			if (info.m_memoryFlags & decoding::InstructionExtendedInfo::eMemoryFlags_Write)
 			{
-				numWriteBytes += info.m_memorySize;
-				numWriteInstructions += 1;
-				value = trace::GetRegisterValueInteger(reg0, frame, false);
+				worker.m_numWriteBytes += info.m_memorySize;
+				worker.m_numWriteInstructions += 1;
+				value = trace::GetRegisterValueInteger(reg0, *frame, false);
 				opType = 1;
 			}
-			else if (info.m_memoryFlags & decoding::InstructionExtendedInfo::eMemoryFlags_Read)
+			else
 			{
-				numReadBytes += info.m_memorySize;
-				numReadInstructions += 1;
+				// what was the value that was read ? we need the next frame in the same thread
+				const auto nextSeq = m_traceData->GetNextInContextFrame(i);
+				if (nextSeq == INVALID_TRACE_FRAME_ID)
+					continue;
+
+				std::unique_ptr<DataFrame> nextFrame(decodeFrame(nextSeq));
+				if (!nextFrame)
+					continue;
 
-				value = trace::GetRegisterValueInteger(reg0, nextFrame, false); // what was the value that was read ?
+				worker.m_numReadBytes += info.m_memorySize;
+				worker.m_numReadInstructions += 1;
+				value = trace::GetRegisterValueInteger(reg0, *nextFrame, false);
 				opType = 0;
 			}
 
@@ -139,239 +283,302 @@ namespace trace
 			if (info.m_memorySize == 1)
 			{
 				const uint8 valueToSave = (uint8)value;
-				AddMemoryOperation(i, memoryAdddress, opType, info.m_memorySize, &valueToSave);
+				AddMemoryOperation(worker, i, memoryAdddress, opType, info.m_memorySize, &valueToSave);
 			}
 			else if (info.m_memorySize == 2)
 			{
-				const uint16 valueToSave = _byteswap_ushort( (uint16)value);
-				AddMemoryOperation(i, memoryAdddress, opType, info.m_memorySize, &valueToSave);
+				const uint16 valueToSave = _byteswap_ushort((uint16)value);
+				AddMemoryOperation(worker, i, memoryAdddress, opType, info.m_memorySize, &valueToSave);
 			}
 			else if (info.m_memorySize == 4)
 			{
-				const uint32 valueToSave = _byteswap_ulong( (uint32)value );
-				AddMemoryOperation(i, memoryAdddress, opType, info.m_memorySize, &valueToSave);
+				const uint32 valueToSave = _byteswap_ulong((uint32)value);
+				AddMemoryOperation(worker, i, memoryAdddress, opType, info.m_memorySize, &valueToSave);
 			}
 			else if (info.m_memorySize == 8)
 			{
 				const uint64 valueToSave = _byteswap_uint64(value);
-				AddMemoryOperation(i, memoryAdddress, opType, info.m_memorySize, &valueToSave);
+				AddMemoryOperation(worker, i, memoryAdddress, opType, info.m_memorySize, &valueToSave);
 			}
 			else
 			{
-				log.Error( "MemTrace: Unsupported memory access of size %u used for accessing the memory at %06Xh at entry %u, IP=%06Xh. Entry will not be saved!", 
-					info.m_memorySize, memoryAdddress, i, codeAddress);
-				continue;
+				worker.m_numUnsupported += 1;
 			}
 		}
+	}
 
-		// final stats
-		log.Log( "MemTrace: Read %u bytes in %u instructions", numReadBytes, numReadInstructions );
-		log.Log( "MemTrace: Written %u bytes in %u instructions", numWriteBytes, numWriteInstructions );
-
-		// update header
-		header.m_numEntries = m_nextEntryId-1;
-
-		// store the entries IDs from the valid pages, enumerate pages
+	void MemoryHistoryBuilder::AddMemoryOperation(Worker& worker, const uint32 seq, const uint64 memoryAddress, const uint8 type, const uint32 size, const void* data)
+	{
+		// the memory history file can only address 32-bit memory space
+		if (memoryAddress + size > (1ULL << 32))
 		{
-			header.m_pagesOffset = GetFilePos();
-			header.m_numPages = 0;
-
-			for (uint32 i=0; i<MemoryHistory::MAX_RANGES; ++i)
-			{
-				const PageRange* pr = m_ranges[i];
-				if (!pr)
-					continue;
-
-				for (uint32 j=0; j<MemoryHistory::PAGES_PER_RANGE; ++j)
-				{
-					Page* page = pr->m_pages[j];
-					if (!page)
-						continue;
-
-					// set page id
-					page->m_id = header.m_numPages+1;
-					header.m_numPages += 1;
-
-					// write the top list IDs to the file
-					WriteToFile(&page->m_address, sizeof(page->m_address));
-					WriteToFile(&page->m_entriesHead,sizeof(page->m_entriesHead));
-				}
-			}
-
-			log.Log( "MemTrace: %u pages written", header.m_numPages );
+			worker.m_numUnsupported += 1;
+			return;
 		}
 
-		// store the page ranges
+		// add memory operations to the whole range
+		const uint8* dataPtr = (const uint8*)data;
+		for (uint32 i = 0; i < size; ++i)
 		{
-			header.m_pageRangesOffset = GetFilePos();
-			header.m_numPageRanges = 0;
-
-			for (uint32 i=0; i<MemoryHistory::MAX_RANGES; ++i)
-			{
-				const PageRange* pr = m_ranges[i];
-				if (!pr)
-					continue;
+			MemoryOp op;
+			op.m_address = memoryAddress + i;
+			op.m_seq = seq;
+			op.m_op = type;
+			op.m_data = dataPtr[i];
+			op.m_padding = 0;
+			worker.m_ops.push_back(op);
+		}
 
-				// count non zero pages
-				uint16 numNonZeroPages = 0;
-				for (uint32 j=0; j<MemoryHistory::PAGES_PER_RANGE; ++j)
-				{
-					Page* page = pr->m_pages[j];
-					if (page)
-						numNonZeroPages += 1;
-				}
+		// out of sort memory, spill to disk
+		if (worker.m_ops.size() >= worker.m_maxOps)
+			FlushRun(worker);
+	}
 
-				// save the page rande address
-				if (!numNonZeroPages) 
-					continue;
+	const bool MemoryHistoryBuilder::FlushRun(Worker& worker)
+	{
+		// sort by address, keep the trace order for the same address
+		std::sort(worker.m_ops.begin(), worker.m_ops.end());
 
-				// store the page range data
-				WriteToFile(&pr->m_address, sizeof(pr->m_address));
-				for (uint32 j=0; j<MemoryHistory::PAGES_PER_RANGE; ++j)
-				{
-					Page* page = pr->m_pages[j];
-					uint32 pageId = page ? page->m_id : 0;
-					WriteToFile(&pageId,sizeof(page->m_id));
-				}
+		// allocate run
+		SortedRun run;
+		run.m_numOps = worker.m_ops.size();
+		{
+			std::lock_guard<std::mutex> lock(m_runsLock);
+			wchar_t ext[32];
+			swprintf_s(ext, L".run%u.tmp", (uint32)m_runs.size());
+			run.m_path = m_outputPath + ext;
+			m_runs.push_back(run);
+		}
 
-				// count the saved page ranges
-				header.m_numPageRanges += 1;
-			}
+		// write the data
+		std::ofstream file(run.m_path, std::ios::out | std::ios::binary | std::ios::trunc);
+		file.write((const char*)worker.m_ops.data(), worker.m_ops.size() * sizeof(MemoryOp));
+		file.close();
+		worker.m_ops.clear();
 
-			log.Log( "MemTrace: %u page ranges", header.m_numPageRanges );
+		// error ?
+		if (file.fail())
+		{
+			worker.m_failed = true;
+			return false;
 		}
 
-		// update the file header
-		SetFilePos(0);
-		WriteToFile(&header, sizeof(header));
-
-		// saved
-		fclose(m_outputFile);
 		return true;
 	}
 
-	MemoryHistoryBuilder::PageRange* MemoryHistoryBuilder::GetPageRange(const uint64 address)
+	const bool MemoryHistoryBuilder::MergeRuns(ILogOutput& log, const uint64 memoryBudget)
 	{
-		// get page index
-		const uint64 rangeIndex = (address >> MemoryHistory::RANGE_SHIFT);
-		if (!m_ranges[rangeIndex])
+		// open output file
+		std::ofstream file(m_outputPath, std::ios::out | std::ios::binary | std::ios::trunc);
+		if (file.fail())
 		{
-			const uint64 baseAddress = rangeIndex << MemoryHistory::RANGE_SHIFT;
-			m_ranges[rangeIndex] = new PageRange(baseAddress);
+			log.Error("MemTrace: Unable to create file '%ls'", m_outputPath.c_str());
+			return false;
 		}
 
-		// get the page
-		return m_ranges[rangeIndex];
-	}
+		// prepare header, the final version is written at the end
+		MemoryHistory::Header header;
+		memset(&header, 0, sizeof(header));
+		header.m_magic = MemoryHistory::MAGIC;
+		file.write((const char*)&header, sizeof(header));
+		header.m_entriesOffset = sizeof(header);
 
-	MemoryHistoryBuilder::Page* MemoryHistoryBuilder::GetPage(const uint64 address)
-	{
-		// get matching page range
-		PageRange* range = GetPageRange(address);
-		if (!range)
-			return NULL;
-
-		// no page entry, create it
-		const uint64 pageIndex = (address >> MemoryHistory::PAGE_SHIFT) & MemoryHistory::PAGE_MASK;
-		if (!range->m_pages[pageIndex])
+		// buffered input from each run
+		struct RunReader
 		{
-			const uint64 baseAddress = (address >> MemoryHistory::PAGE_SHIFT) << MemoryHistory::PAGE_SHIFT;
-			range->m_pages[pageIndex] = new Page(baseAddress);
-		}
+			std::ifstream			m_file;
+			std::vector<MemoryOp>	m_buffer;
+			uint64					m_numLeft;
+			uint32					m_pos;
 
-		// get the page
-		return range->m_pages[pageIndex];
-	}
+			const bool Refill(const uint32 maxOps)
+			{
+				const auto count = (uint32)std::min<uint64>(m_numLeft, maxOps);
+				m_buffer.resize(count);
+				m_file.read((char*)m_buffer.data(), count * sizeof(MemoryOp));
+				m_numLeft -= count;
+				m_pos = 0;
+				return !m_file.fail();
+			}
+		};
 
-	const bool MemoryHistoryBuilder::AddMemoryOperation(const uint32 traceEntryIndex, const uint64 memoryAddress, const uint8 type, const uint32 size, const void* data)
-	{
-		// add memory operations to the whole range
-		const uint8* dataPtr = (const uint8*)data;
-		for (uint32 i=0; i<size; ++i)
+		const auto numRuns = (uint32)m_runs.size();
+		const auto maxOpsPerRead = (uint32)std::max<uint64>(4096, std::min<uint64>(1 << 20, (memoryBudget / std::max<uint32>(1, numRuns)) / sizeof(MemoryOp)));
+		std::vector<std::unique_ptr<RunReader>> readers;
+		uint64 totalOps = 0;
+		for (const auto& run : m_runs)
 		{
-			if (!AddMemoryOperationAt(traceEntryIndex, memoryAddress+i, type, dataPtr[i]))
+			std::unique_ptr<RunReader> reader(new RunReader());
+			reader->m_file.open(run.m_path, std::ios::in | std::ios::binary);
+			reader->m_numLeft = run.m_numOps;
+			if (reader->m_file.fail() || !reader->Refill(maxOpsPerRead))
+			{
+				log.Error("MemTrace: Failed to read temporary file '%ls'", run.m_path.c_str());
 				return false;
-		}
+			}
 
-		return true;
-	}
+			totalOps += run.m_numOps;
+			readers.push_back(std::move(reader));
+		}
 
-	const bool MemoryHistoryBuilder::AddMemoryOperationAt(const uint32 traceEntryIndex, const uint64 memoryAddress, const uint8 type, const uint8 data)
-	{
-		// get target page
-		MemoryHistoryBuilder::Page* page = GetPage(memoryAddress);
-		if (!page)
+		// entries are linked with 32 bit indices, 0 is reserved for the end of the list
+		if (totalOps >= (1ULL << 32))
+		{
+			log.Error("MemTrace: Too many memory operations (%llu) to store in memory history file", totalOps);
 			return false;
+		}
 
-		// allocate new entry id
-		const uint32 writtenEntryId = m_nextEntryId++;
-
-		// get entry linked list for this address
-		uint32& entryListHead = page->m_entriesHead[memoryAddress & MemoryHistory::PAGE_MASK];
-		uint32& entryListTail = page->m_entriesTail[memoryAddress & MemoryHistory::PAGE_MASK];
-		if (!entryListHead)
+		// k-way merge, smallest element at the top
+		typedef std::pair<MemoryOp, uint32> THeapEntry;
+		auto compare = [](const THeapEntry& a, const THeapEntry& b) { return b.first < a.first; };
+		std::priority_queue<THeapEntry, std::vector<THeapEntry>, decltype(compare)> heap(compare);
+		for (uint32 i = 0; i < numRuns; ++i)
 		{
-			entryListHead = writtenEntryId;
-			entryListTail = writtenEntryId;
+			auto& reader = *readers[i];
+			if (!reader.m_buffer.empty())
+				heap.push(THeapEntry(reader.m_buffer[reader.m_pos++], i));
 		}
-		else
+
+		// pages and ranges are created as the addresses come in sorted order
+		std::vector<MemoryHistory::Page> pages;
+		std::vector<MemoryHistory::PageRange> pageRanges;
+		uint64 currentPage = ~0ULL;
+		uint64 currentRange = ~0ULL;
+
+		// entries are written in address order so the "next" link is always the following entry
+		std::vector<MemoryHistory::Entry> entries;
+		entries.reserve(65536);
+		uint32 numEntries = 0;
+		bool hasPrevEntry = false;
+		uint64 prevAddress = 0;
+		MemoryHistory::Entry prevEntry;
+		memset(&prevEntry, 0, sizeof(prevEntry));
+
+		log.SetTaskName("Sorting memory trace...");
+		while (!heap.empty())
 		{
-			const uint64 currentEndPos = GetFilePos();
+			if ((numEntries & 0xFFFF) == 0)
+				log.SetTaskProgress(numEntries, totalOps);
+
+			const auto top = heap.top();
+			heap.pop();
+
+			// get next element from the same run
+			{
+				auto& reader = *readers[top.second];
+				if (reader.m_pos == reader.m_buffer.size() && reader.m_numLeft > 0)
+				{
+					if (!reader.Refill(maxOpsPerRead))
+					{
+						log.Error("MemTrace: Failed to read temporary file '%ls'", m_runs[top.second].m_path.c_str());
+						return false;
+					}
+				}
+
+				if (reader.m_pos < reader.m_buffer.size())
+					heap.push(THeapEntry(reader.m_buffer[reader.m_pos++], top.second));
+			}
+
+			// allocate entry id (1-based)
+			const auto& op = top.first;
+			const uint32 entryId = ++numEntries;
+
+			// link previous entry
+			if (hasPrevEntry)
+			{
+				prevEntry.m_next = (prevAddress == op.m_address) ? entryId : 0;
+				entries.push_back(prevEntry);
+			}
+
+			// new address, register list head in the page
+			if (!hasPrevEntry || prevAddress != op.m_address)
+			{
+				const uint64 rangeIndex = op.m_address >> MemoryHistory::RANGE_SHIFT;
+				if (rangeIndex != currentRange)
+				{
+					MemoryHistory::PageRange range;
+					memset(&range, 0, sizeof(range));
+					range.m_address = (uint32)(rangeIndex << MemoryHistory::RANGE_SHIFT);
+					pageRanges.push_back(range);
+					currentRange = rangeIndex;
+				}
+
+				const uint64 pageIndex = op.m_address >> MemoryHistory::PAGE_SHIFT;
+				if (pageIndex != currentPage)
+				{
+					MemoryHistory::Page page;
+					memset(&page, 0, sizeof(page));
+					page.m_address = (uint32)(pageIndex << MemoryHistory::PAGE_SHIFT);
+					pages.push_back(page);
+					currentPage = pageIndex;
+
+					pageRanges.back().m_pages[pageIndex & MemoryHistory::PAGE_MASK] = (uint32)pages.size();
+				}
 
-			// update tail entry
-			const uint64 tailEntryPos = m_entryDataStart + (entryListTail-1)*sizeof(MemoryHistory::Entry);
-			SetFilePos(tailEntryPos);
+				pages.back().m_entries[op.m_address & MemoryHistory::PAGE_MASK] = entryId;
+			}
 
-			// read the entry data
-			MemoryHistory::Entry entryInfo;
-			ReadFromFile( &entryInfo, sizeof(entryInfo));
-			entryInfo.m_next = writtenEntryId;
-			WriteToFile( &entryInfo, sizeof(entryInfo));
+			// prepare entry
+			prevEntry.m_next = 0;
+			prevEntry.m_data = op.m_data;
+			prevEntry.m_entry = op.m_seq;
+			prevEntry.m_op = op.m_op;
+			prevAddress = op.m_address;
+			hasPrevEntry = true;
 
-			// restore file pos
-			SetFilePos(currentEndPos);
+			// flush entries
+			if (entries.size() >= 65536)
+			{
+				file.write((const char*)entries.data(), entries.size() * sizeof(MemoryHistory::Entry));
+				entries.clear();
+			}
+		}
 
-			// link
-			entryListTail = writtenEntryId;
+		// last entry ends the list
+		if (hasPrevEntry)
+		{
+			prevEntry.m_next = 0;
+			entries.push_back(prevEntry);
 		}
 
-		// write entry on disk
-		MemoryHistory::Entry entryInfo;
-		entryInfo.m_data = data;
-		entryInfo.m_entry = traceEntryIndex;
-		entryInfo.m_next = 0; // nothing yet
-		entryInfo.m_op = type;
+		file.write((const char*)entries.data(), entries.size() * sizeof(MemoryHistory::Entry));
+		header.m_numEntries = numEntries;
 
-		// save the entry
-		WriteToFile( &entryInfo, sizeof(entryInfo) );
-		return true;
-	}
+		// store pages
+		header.m_pagesOffset = (uint64)file.tellp();
+		header.m_numPages = (uint32)pages.size();
+		file.write((const char*)pages.data(), pages.size() * sizeof(MemoryHistory::Page));
+		log.Log("MemTrace: %u pages written", header.m_numPages);
 
-	const uint64 MemoryHistoryBuilder::GetFilePos() const
-	{
-		fpos_t pos = 0;
-		fgetpos(m_outputFile, &pos);
-		return pos;
-	}
+		// store page ranges
+		header.m_pageRangesOffset = (uint64)file.tellp();
+		header.m_numPageRanges = (uint32)pageRanges.size();
+		file.write((const char*)pageRanges.data(), pageRanges.size() * sizeof(MemoryHistory::PageRange));
+		log.Log("MemTrace: %u page ranges", header.m_numPageRanges);
 
-	void MemoryHistoryBuilder::SetFilePos(const uint64 pos_)
-	{
-		fpos_t pos = (fpos_t)pos_;
-		fsetpos(m_outputFile, &pos);
-	}
+		// update the file header
+		file.seekp(0);
+		file.write((const char*)&header, sizeof(header));
+		file.close();
 
-	void MemoryHistoryBuilder::WriteToFile(const void* data, const uint32 size)
-	{
-		fwrite(data,1,size,m_outputFile);
+		// error ?
+		if (file.fail())
+		{
+			log.Error("MemTrace: Failed to save data to file. Check for disk space.");
+			return false;
+		}
+
+		return true;
 	}
 
-	void MemoryHistoryBuilder::ReadFromFile(void* data, const uint32 size)
+	void MemoryHistoryBuilder::DeleteRuns()
 	{
-		fread(data,1,size,m_outputFile);
+		for (const auto& run : m_runs)
+			_wremove(run.m_path.c_str());
+
+		m_runs.clear();
 	}
 
 	//---------------------------------------------------------------------------
 
 } // trace
-
-#endif
\ No newline at end of file
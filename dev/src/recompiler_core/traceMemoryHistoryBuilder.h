@@ -1,93 +1,115 @@
 #pragma once
 
 #include "traceMemoryHistory.h"
+#include "decodingInstruction.h"
+#include "decodingInstructionInfo.h"
 
-namespace image
-{
-	class Binary;
-}
+#include <mutex>
+#include <atomic>
 
 namespace trace
 {
-	class Data;
+	class DataFile;
 
 	/// build of the memory trace file
+	/// memory operations are extracted from the trace in parallel, sorted by address in bounded memory (sorted runs are spilled to disk) and merged into the output file sequentially
 	class RECOMPILER_API MemoryHistoryBuilder
 	{
 	public:
-		struct Page
-		{
-			uint32		m_id;
-			uint64		m_address;
-			uint32		m_entriesHead[MemoryHistory::ENTRIES_PER_PAGE];
-			uint32		m_entriesTail[MemoryHistory::ENTRIES_PER_PAGE];
+		static const uint64 DEFAULT_MEMORY_BUDGET = 256ULL << 20; // total memory used for sorting across all worker threads
+		static const uint32 FRAMES_PER_JOB = 65536; // number of trace frames processed by single job
 
-			Page(const uint64 adddres)
-				: m_id(0)
-				, m_address(adddres)
-			{
-				memset(&m_entriesHead[0],0,sizeof(m_entriesHead));
-				memset(&m_entriesTail[0],0,sizeof(m_entriesTail));
-			}
-		};
+		MemoryHistoryBuilder();
+		~MemoryHistoryBuilder();
+
+		// build a memory trace file from normal data trace
+		bool BuildFile(class ILogOutput& log, decoding::Context& decodingContext, const DataFile& traceData, const wchar_t* outputFile, const uint64 memoryBudget = DEFAULT_MEMORY_BUDGET);
 
-		struct PageRange
+	private:
+		// single byte memory operation extracted from trace
+		struct MemoryOp
 		{
 			uint64		m_address;
-			Page*		m_pages[MemoryHistory::PAGES_PER_RANGE];
+			uint32		m_seq;
+			uint8		m_op; // read:0 write:1
+			uint8		m_data;
+			uint16		m_padding;
 
-			PageRange(const uint64 address)
-				: m_address(address)
+			inline const bool operator<(const MemoryOp& other) const
 			{
-				memset(&m_pages[0], 0, sizeof(m_pages));
+				if (m_address != other.m_address)
+					return m_address < other.m_address;
+				return m_seq < other.m_seq;
 			}
+		};
 
-			~PageRange()
-			{
-				for (uint32 i=0; i<MemoryHistory::PAGES_PER_RANGE; ++i)
-				{
-					delete m_pages[i];
-				}
-			}
+		// decoded instruction, shared between the worker threads
+		struct DecodedInstruction
+		{
+			bool								m_valid;
+			decoding::Instruction				m_op;
+			decoding::InstructionExtendedInfo	m_info;
 		};
 
-		uint32	m_nextEntryId;
-		uint64	m_entryDataStart;
-		FILE*	m_outputFile;
+		// sorted run of memory operations stored in temporary file
+		struct SortedRun
+		{
+			std::wstring	m_path;
+			uint64			m_numOps;
+		};
 
-		PageRange* m_ranges[ MemoryHistory::MAX_RANGES ];
+		// per thread state
+		struct Worker
+		{
+			std::vector<MemoryOp>	m_ops;
+			uint64					m_maxOps;
+
+			std::unordered_map<uint64, const DecodedInstruction*> m_localInstructions;
+
+			uint64					m_numReadBytes;
+			uint64					m_numReadInstructions;
+			uint64					m_numWriteBytes;
+			uint64					m_numWriteInstructions;
+			uint64					m_numUnsupported;
+			uint64					m_numUnknownInstructions;
+			bool					m_failed;
+		};
 
-	public:
-		MemoryHistoryBuilder();
-		~MemoryHistoryBuilder();
+		// input
+		const DataFile*				m_traceData;
+		decoding::Context*			m_decodingContext;
+		std::wstring				m_outputPath;
 
-		// build a memory trace file from normal data trace
-		bool BuildFile( class ILogOutput& log, decoding::Context& decodingContext, const Data& traceData, const wchar_t* outputFile);
+		// instruction cache, the decoding context is not thread safe
+		std::mutex					m_decodeLock;
+		std::unordered_map<uint64, DecodedInstruction*> m_instructions;
 
-	private:
-		// add memory operation to range of addresses
-		const bool AddMemoryOperation(const uint32 traceEntryIndex, const uint64 memoryAddress, const uint8 type, const uint32 size, const void* data);
+		// job distribution
+		std::atomic<uint32>			m_nextJob;
+		std::atomic<uint32>			m_numFramesProcessed;
+		std::atomic<bool>			m_canceled;
 
-		// add memory operation to given address
-		const bool AddMemoryOperationAt(const uint32 traceEntryIndex, const uint64 memoryAddress, const uint8 type, const uint8 data);
+		// sorted runs on disk
+		std::mutex					m_runsLock;
+		std::vector<SortedRun>		m_runs;
 
-		// get page range at given address base
-		PageRange* GetPageRange(const uint64 address);
+		// decode instruction at given address (cached)
+		const DecodedInstruction* GetInstruction(Worker& worker, const uint64 codeAddress);
 
-		// get page at given address base
-		Page* GetPage(const uint64 address);
+		// process range of trace frames
+		void ProcessFrames(Worker& worker, const uint32 firstFrame, const uint32 lastFrame);
 
-		// get file position
-		const uint64 GetFilePos() const;
+		// add memory operation to range of addresses
+		void AddMemoryOperation(Worker& worker, const uint32 seq, const uint64 memoryAddress, const uint8 type, const uint32 size, const void* data);
 
-		// seek to file position
-		void SetFilePos(const uint64 pos);
+		// sort collected operations and spill them to disk as sorted run
+		const bool FlushRun(Worker& worker);
 
-		// write to file
-		void WriteToFile(const void* data, const uint32 size);
+		// merge sorted runs into the final file
+		const bool MergeRuns(ILogOutput& log, const uint64 memoryBudget);
 
-		// read from file
-		void ReadFromFile(void* data, const uint32 size);
+		// delete temporary files
+		void DeleteRuns();
 	};
 
-} // trace
\ No newline at end of file
+} // trace
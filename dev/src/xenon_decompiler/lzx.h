@@ -68,6 +68,7 @@ struct lzxd_stream {
   unsigned char  header_read;     /* have we started decoding at all yet?    */
   unsigned char  posn_slots;      /* how many posn slots in stream?          */
   unsigned char  input_end;       /* have we reached the end of input?       */
+  unsigned char  input_memory;    /* is the input read directly from memory? */
 
   int error;
 
@@ -132,6 +133,18 @@ extern struct lzxd_stream *lzxd_init(struct mspack_system *system,
 extern void lzxd_set_output_length(struct lzxd_stream *lzx,
 				   off_t output_length);
 
+/* makes the decompressor read the compressed bitstream directly from memory
+ * instead of copying it into the input buffer with system->read().
+ *
+ * - must be called before the first lzxd_decompress(), the input file
+ *   handle given in lzxd_init() is not used after that.
+ *
+ * - the buffer is not modified and must stay valid until the stream is freed.
+ */
+extern void lzxd_set_input_buffer(struct lzxd_stream *lzx,
+				  const unsigned char *buffer,
+				  off_t size);
+
 /* decompresses, or decompresses more of, an LZX stream.
  *
  * - out_bytes of data will be decompressed and the function will return
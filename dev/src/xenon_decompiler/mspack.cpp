@@ -132,7 +132,8 @@
 } while (0)
 
 static int lzxd_read_input(struct lzxd_stream *lzx) {
-  int read = lzx->sys->read(lzx->input, &lzx->inbuf[0], (int)lzx->inbuf_size);
+  /* memory input is consumed in one go, only the end of stream is left */
+  int read = lzx->input_memory ? 0 : lzx->sys->read(lzx->input, &lzx->inbuf[0], (int)lzx->inbuf_size);
   if (read < 0) return lzx->error = MSPACK_ERR_READ;
 
   /* huff decode's ENSURE_BYTES(16) might overrun the input stream, even
@@ -446,6 +447,7 @@ struct lzxd_stream *lzxd_init(struct mspack_system *system,
 			  ((window_bits == 20) ? 42 : (window_bits << 1)));
   lzx->intel_started   = 0;
   lzx->input_end       = 0;
+  lzx->input_memory    = 0;
 
   lzx->error = MSPACK_ERR_OK;
 
@@ -461,6 +463,14 @@ void lzxd_set_output_length(struct lzxd_stream *lzx, off_t out_bytes) {
   if (lzx) lzx->length = out_bytes;
 }
 
+void lzxd_set_input_buffer(struct lzxd_stream *lzx, const unsigned char *buffer, off_t size) {
+  if (!lzx) return;
+  /* the bitstream is only read through i_ptr, it's never written to */
+  lzx->i_ptr = (unsigned char *) buffer;
+  lzx->i_end = (unsigned char *) buffer + size;
+  lzx->input_memory = 1;
+}
+
 int lzxd_decompress(struct lzxd_stream *lzx, off_t out_bytes) {
   /* bitstream reading and huffman variables */
   register unsigned int bit_buffer;
@@ -0,0 +1,129 @@
+#include "xenonAES.h"
+
+#include <intrin.h>
+#include <wmmintrin.h>
+
+//---------------------------------------------------------------------------
+
+XenonAESDecryptor::XenonAESDecryptor( const uint8* key )
+	: m_useHardware( HasHardwareSupport() )
+{
+	// the reference key schedule is already in the order and form (inverse mix columns applied) expected by the AES-NI decryption rounds
+	m_numRounds = rijndaelKeySetupDec( m_roundKeys, key, 128 );
+}
+
+const bool XenonAESDecryptor::HasHardwareSupport()
+{
+	static const bool hasAES = []()
+	{
+		int info[4] = { 0, 0, 0, 0 };
+		__cpuid( info, 1 );
+		return (info[2] & (1 << 25)) != 0;
+	}();
+
+	return hasAES;
+}
+
+void XenonAESDecryptor::DecryptCBC( const uint8* iv, const uint8* inputData, uint8* outputData, const uint32 size ) const
+{
+	if ( m_useHardware )
+		DecryptHardware( iv, inputData, outputData, size );
+	else
+		DecryptSoftware( iv, inputData, outputData, size );
+}
+
+void XenonAESDecryptor::DecryptSoftware( const uint8* iv, const uint8* inputData, uint8* outputData, const uint32 size ) const
+{
+	uint8 prev[ BLOCK_SIZE ];
+	memcpy( prev, iv, BLOCK_SIZE );
+
+	for ( uint32 n=0; n<size; n += BLOCK_SIZE )
+	{
+		// keep the cipher block, the output may overwrite it
+		uint8 cipher[ BLOCK_SIZE ];
+		memcpy( cipher, inputData + n, BLOCK_SIZE );
+
+		uint8* pt = outputData + n;
+		rijndaelDecrypt( m_roundKeys, m_numRounds, cipher, pt );
+
+		for ( uint32 i=0; i<BLOCK_SIZE; ++i )
+			pt[i] ^= prev[i];
+
+		memcpy( prev, cipher, BLOCK_SIZE );
+	}
+}
+
+void XenonAESDecryptor::DecryptHardware( const uint8* iv, const uint8* inputData, uint8* outputData, const uint32 size ) const
+{
+	// round keys are stored as big endian words
+	__m128i keys[ MAXNR + 1 ];
+	for ( int32 r=0; r<=m_numRounds; ++r )
+	{
+		uint8 bytes[ BLOCK_SIZE ];
+		for ( uint32 i=0; i<4; ++i )
+		{
+			const uint32 word = m_roundKeys[ r*4 + i ];
+			bytes[ i*4 + 0 ] = (uint8)( word >> 24 );
+			bytes[ i*4 + 1 ] = (uint8)( word >> 16 );
+			bytes[ i*4 + 2 ] = (uint8)( word >> 8 );
+			bytes[ i*4 + 3 ] = (uint8)( word );
+		}
+
+		keys[r] = _mm_loadu_si128( (const __m128i*) bytes );
+	}
+
+	const __m128i* src = (const __m128i*) inputData;
+	__m128i* dest = (__m128i*) outputData;
+	const uint32 numBlocks = size / BLOCK_SIZE;
+	const int32 lastRound = m_numRounds;
+
+	__m128i prev = _mm_loadu_si128( (const __m128i*) iv );
+
+	// CBC decryption does not depend on the previous output, interleave 4 blocks to hide the latency of the rounds
+	uint32 n = 0;
+	for ( ; n + 4 <= numBlocks; n += 4 )
+	{
+		const __m128i c0 = _mm_loadu_si128( src + n + 0 );
+		const __m128i c1 = _mm_loadu_si128( src + n + 1 );
+		const __m128i c2 = _mm_loadu_si128( src + n + 2 );
+		const __m128i c3 = _mm_loadu_si128( src + n + 3 );
+
+		__m128i b0 = _mm_xor_si128( c0, keys[0] );
+		__m128i b1 = _mm_xor_si128( c1, keys[0] );
+		__m128i b2 = _mm_xor_si128( c2, keys[0] );
+		__m128i b3 = _mm_xor_si128( c3, keys[0] );
+
+		for ( int32 r=1; r<lastRound; ++r )
+		{
+			b0 = _mm_aesdec_si128( b0, keys[r] );
+			b1 = _mm_aesdec_si128( b1, keys[r] );
+			b2 = _mm_aesdec_si128( b2, keys[r] );
+			b3 = _mm_aesdec_si128( b3, keys[r] );
+		}
+
+		b0 = _mm_aesdeclast_si128( b0, keys[lastRound] );
+		b1 = _mm_aesdeclast_si128( b1, keys[lastRound] );
+		b2 = _mm_aesdeclast_si128( b2, keys[lastRound] );
+		b3 = _mm_aesdeclast_si128( b3, keys[lastRound] );
+
+		_mm_storeu_si128( dest + n + 0, _mm_xor_si128( b0, prev ) );
+		_mm_storeu_si128( dest + n + 1, _mm_xor_si128( b1, c0 ) );
+		_mm_storeu_si128( dest + n + 2, _mm_xor_si128( b2, c1 ) );
+		_mm_storeu_si128( dest + n + 3, _mm_xor_si128( b3, c2 ) );
+		prev = c3;
+	}
+
+	// tail
+	for ( ; n < numBlocks; ++n )
+	{
+		const __m128i c = _mm_loadu_si128( src + n );
+
+		__m128i b = _mm_xor_si128( c, keys[0] );
+		for ( int32 r=1; r<lastRound; ++r )
+			b = _mm_aesdec_si128( b, keys[r] );
+		b = _mm_aesdeclast_si128( b, keys[lastRound] );
+
+		_mm_storeu_si128( dest + n, _mm_xor_si128( b, prev ) );
+		prev = c;
+	}
+}
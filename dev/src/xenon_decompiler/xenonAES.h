@@ -0,0 +1,33 @@
+#pragma once
+
+#include "../recompiler_core/build.h"
+#include "rijndael-alg-fst.h"
+
+/// AES-128 decryption in CBC mode as used by the XEX images
+/// Uses the AES-NI instructions when the CPU supports them, the reference implementation otherwise
+class XenonAESDecryptor
+{
+public:
+	XenonAESDecryptor( const uint8* key );
+
+	/// Decrypt data, size must be a multiple of 16 bytes
+	/// The iv is the cipher block preceding the input in the stream (zeros at the start of the stream), input and output may be the same buffer
+	void DecryptCBC( const uint8* iv, const uint8* inputData, uint8* outputData, const uint32 size ) const;
+
+	/// Is the hardware path used
+	inline const bool IsHardwareAccelerated() const { return m_useHardware; }
+
+	/// Does the CPU support the AES-NI instructions
+	static const bool HasHardwareSupport();
+
+private:
+	static const uint32 BLOCK_SIZE = 16;
+
+	// decryption key schedule, shared by both paths
+	uint32		m_roundKeys[ 4 * (MAXNR + 1) ];
+	int32		m_numRounds;
+	bool		m_useHardware;
+
+	void DecryptSoftware( const uint8* iv, const uint8* inputData, uint8* outputData, const uint32 size ) const;
+	void DecryptHardware( const uint8* iv, const uint8* inputData, uint8* outputData, const uint32 size ) const;
+};
@@ -3007,6 +3007,9 @@ CPU_XenonPPC::CPU_XenonPPC()
 			OutputDebugStringA(s);
 		}
 	}*/
+
+	// instruction decoding
+	BuildDecodingTables();
 }
 
 CPU_XenonPPC::~CPU_XenonPPC()
@@ -1006,15 +1006,47 @@ public:
 	virtual uint32 ValidateInstruction(const uint8* inputStream) const override final;
 	virtual uint32 DecodeInstruction(const uint8* inputStream, class decoding::Instruction& outDecodedInstruction) const override final;
 
+	// decode instruction, errors are not reported if requested (when lots of data that is not code is decoded on purpose)
+	uint32 DecodeInstruction(const uint8* inputStream, class decoding::Instruction& outDecodedInstruction, const bool reportErrors) const;
+
 	static CPU_XenonPPC& GetInstance();
 
 private:
+	// the decoding test (dev/tools/xdecode) compares the decoding tables with the reference decoder
+	friend class CPU_XenonPPCDecodingTest;
+
 	// internal registers map
 	const class platform::CPURegister* m_regMap[ eRegister_MAX + (128 * (16 + 8 + 4 + 2))];
 
 	// internal instruction map
 	const class platform::CPUInstruction* m_opMap[ eInstruction_MAX ];
 
+	// decoding function for a group of instructions, returns size of the decoded instruction or 0 if the instruction is not valid
+	typedef uint32 (*TDecodingFunction)(const CPU_XenonPPC* self, const uint32 instrWord, class decoding::Instruction& outDecodedInstruction, const bool reportErrors);
+
+	// decoding functions indexed by the value of an extended opcode field
+	struct DecodingTable
+	{
+		uint32								m_shift;
+		uint32								m_mask;
+		std::vector< TDecodingFunction >	m_functions;
+	};
+
+	// decoding of a primary opcode, tables are matched in order, default function handles everything that was not matched
+	struct PrimaryDecoding
+	{
+		std::vector< DecodingTable >	m_tables;
+		TDecodingFunction				m_default;
+	};
+
+	// decoding tables, indexed by the primary opcode
+	PrimaryDecoding m_decoding[64];
+
+	// build the decoding tables from the instruction descriptions
+	void BuildDecodingTables();
+	void AddDecoder(const uint32 primary, const uint32 xoStart, const uint32 xoLength, const uint32 xo, TDecodingFunction func);
+	void SetDefaultDecoder(const uint32 primary, TDecodingFunction func);
+
 	// get fixed point register
 	inline const platform::CPURegister* REG(const uint32 val) const
 	{
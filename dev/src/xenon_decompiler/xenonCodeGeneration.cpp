@@ -5,6 +5,7 @@
 #include "../recompiler_core/decodingContext.h"
 #include "../recompiler_core/image.h"
 #include "../recompiler_core/decodingMemoryMap.h"
+#include "../recompiler_core/decodingAddressMap.h"
 #include "../recompiler_core/decodingNameMap.h"
 #include "../recompiler_core/codeGenerator.h"
 #include "../recompiler_core/internalUtils.h"
@@ -15,6 +16,9 @@ CodeGeneratorOptionsXenon::CodeGeneratorOptionsXenon(const bool allowDebugging)
 	: m_allowBlockMerging(!allowDebugging)
 	, m_allowLocalLabels(!allowDebugging)
 	, m_allowCallInlinling(!allowDebugging)
+	, m_allowRegisterPromotion(!allowDebugging)
+	, m_allowCodeSharing(!allowDebugging)
+	, m_emitComments(true)
 {
 	m_forceMultiAddressBlocks = allowDebugging;
 	m_debugTrace = allowDebugging;
@@ -164,6 +168,7 @@ void CodeGeneratorXenon::Instruction::LinkTo(Instruction* target)
 CodeGeneratorXenon::Block::Block()
 	: m_multiAddress(0)
 	, m_functionStart(0)
+	, m_unknownEntries(0)
 {
 }
 
@@ -176,7 +181,17 @@ CodeGeneratorXenon::Block::~Block()
 }
 
 CodeGeneratorXenon::CodeGeneratorXenon(const decoding::Context& context, const CodeGeneratorOptionsXenon& options)
-	: m_options(&options)
+	: m_isInSwitch(false)
+	, m_blockEndAddress(0)
+	, m_numRemovedCRUpdates(0)
+	, m_numRemovedXERUpdates(0)
+	, m_numFoldedConstants(0)
+	, m_numFoldedAddresses(0)
+	, m_numConstantLoads(0)
+	, m_numNativeSwitches(0)
+	, m_numLocalJumps(0)
+	, m_numInstructions(0)
+	, m_options(&options)
 	, m_image(context.GetImage().get())
 	, m_context(&context)
 {
@@ -212,7 +227,10 @@ const bool CodeGeneratorXenon::AddBlock(class ILogOutput& log, const uint32 star
 
 	// we are inside the switch :(
 	if (m_isInSwitch)
+	{
 		block->m_multiAddress = true;
+		block->m_unknownEntries = true;
+	}
 
 	// add instructions
 	uint32 codeAddress = start;
@@ -248,7 +266,10 @@ const bool CodeGeneratorXenon::AddBlock(class ILogOutput& log, const uint32 star
 			if (info.m_branchTargetReg)
 			{
 				block->m_multiAddress = true; // reeanble
-				m_isInSwitch = true;
+
+				// recovered jump table, all the targets are known
+				if (!m_context->GetAddressMap().GetJumpTable(codeAddress))
+					m_isInSwitch = true;
 			}
 		}
 
@@ -271,29 +292,754 @@ const bool CodeGeneratorXenon::AddBlock(class ILogOutput& log, const uint32 star
 		// advance
 		block->m_instructions.push_back(instr);
 		codeAddress += size;
+		m_numInstructions += 1;
 	}
 
 	// block decoded
+	m_blockEndAddress = end;
 	return true;
 }
 
 ////#pragma optimize("",on)
 
-const bool CodeGeneratorXenon::CanGlue() const
+const bool CodeGeneratorXenon::CanGlue(const uint32 nextBlockStart) const
 {
 	// code gluing not allowed in options
 	if (!m_options->m_allowBlockMerging)
 		return false;
 
-	// not allowed yet
-	return false;
+	// jumps between the blocks are emitted as gotos, without them there's no point in merging
+	if (!m_options->m_allowLocalLabels)
+		return false;
+
+	// only the following code
+	if (nextBlockStart != m_blockEndAddress)
+		return false;
+
+	// never glue into other function or into something that is called
+	const decoding::InstructionFlags flags = m_context->GetMemoryMap().GetMemoryInfo(nextBlockStart).GetInstructionFlags();
+	if (flags.IsFunctionStart() || flags.IsStaticCallTarget() || flags.IsDynamicCallTarget())
+		return false;
+
+	// very big functions are split, the compilation time grows faster than the size
+	if (m_numInstructions >= MAX_MERGED_INSTRUCTIONS)
+		return false;
+
+	// the whole function is emitted together, the switch cases are in the same function as the jump so the switch can jump there directly
+	return true;
+}
+
+namespace Helper
+{
+	// tracked flags: CR fields and the XER carry
+	static const uint32 FLAGS_CR = 0xFF;
+	static const uint32 FLAG_XER_CA = 0x100;
+	static const uint32 FLAGS_ALL = FLAGS_CR | FLAG_XER_CA;
+
+	// how far we look into the following code
+	static const uint32 MAX_SCAN_INSTRUCTIONS = 64;
+	static const uint32 MAX_SCAN_DEPTH = 2;
+
+	// get flags referenced by register
+	static inline uint32 GetRegisterFlags(const platform::CPURegister* reg)
+	{
+		const int index = reg->GetNativeIndex();
+		if (index == CPU_XenonPPC::eRegister_CR)
+			return FLAGS_CR;
+		if (index >= CPU_XenonPPC::eRegister_CR0 && index <= CPU_XenonPPC::eRegister_CR7)
+			return 1 << (index - CPU_XenonPPC::eRegister_CR0);
+		if (index >= CPU_XenonPPC::eRegister_CR0_LT && index <= CPU_XenonPPC::eRegister_CR7_SO)
+			return 1 << ((index - CPU_XenonPPC::eRegister_CR0_LT) / 4);
+		if (index == CPU_XenonPPC::eRegister_XER || index == CPU_XenonPPC::eRegister_XER_CA)
+			return FLAG_XER_CA;
+		return 0;
+	}
+
+	// get flags read by instruction
+	static inline uint32 GetUsedFlags(const decoding::Instruction& op, const decoding::InstructionExtendedInfo& info)
+	{
+		uint32 flags = 0;
+		for (uint32 i = 0; i < info.m_registersDependenciesCount; ++i)
+			flags |= GetRegisterFlags(info.m_registersDependencies[i]);
+
+		// the whole CR is read without being listed as dependency
+		const char* name = op.GetOpcode()->GetName();
+		if (0 == strcmp(name, "mfcr") || 0 == strcmp(name, "mfocrf"))
+			flags |= FLAGS_CR;
+
+		return flags;
+	}
+
+	// get flags fully overwritten by instruction, single CR bits are not counted
+	static inline uint32 GetDefinedFlags(const decoding::InstructionExtendedInfo& info)
+	{
+		uint32 flags = 0;
+		for (uint32 i = 0; i < info.m_registersModifiedCount; ++i)
+		{
+			const int index = info.m_registersModified[i]->GetNativeIndex();
+			if (index >= CPU_XenonPPC::eRegister_CR0 && index <= CPU_XenonPPC::eRegister_CR7)
+				flags |= 1 << (index - CPU_XenonPPC::eRegister_CR0);
+			else if (index == CPU_XenonPPC::eRegister_XER || index == CPU_XenonPPC::eRegister_XER_CA)
+				flags |= FLAG_XER_CA;
+		}
+		return flags;
+	}
+
+	// does the instruction leave the code block
+	static inline bool IsExit(const decoding::InstructionExtendedInfo& info)
+	{
+		return 0 != (info.m_codeFlags & (decoding::InstructionExtendedInfo::eInstructionFlag_Jump |
+			decoding::InstructionExtendedInfo::eInstructionFlag_Call |
+			decoding::InstructionExtendedInfo::eInstructionFlag_Return |
+			decoding::InstructionExtendedInfo::eInstructionFlag_Diverge));
+	}
+
+	// is this a jump to a known address
+	static inline bool IsStaticJump(const decoding::InstructionExtendedInfo& info)
+	{
+		if (info.m_codeFlags & (decoding::InstructionExtendedInfo::eInstructionFlag_Call | decoding::InstructionExtendedInfo::eInstructionFlag_Return))
+			return false;
+		return (info.m_codeFlags & decoding::InstructionExtendedInfo::eInstructionFlag_Jump) && !info.m_branchTargetReg && info.m_branchTargetAddress;
+	}
+
+	// replace the prefix of the generated code
+	static inline bool ReplacePrefix(std::string& code, const std::string& prefix, const std::string& newPrefix)
+	{
+		if (0 != code.compare(0, prefix.length(), prefix))
+			return false;
+
+		code.replace(0, prefix.length(), newPrefix);
+		return true;
+	}
+
+	static inline bool IsIdentifierChar(const char ch)
+	{
+		return (ch >= 'a' && ch <= 'z') || (ch >= 'A' && ch <= 'Z') || (ch >= '0' && ch <= '9') || (ch == '_');
+	}
+
+	// visit all register references ("regs.R3", "&regs.FR1") in the generated code
+	template< typename F >
+	static inline void VisitRegisterReferences(const std::string& code, const F& func)
+	{
+		size_t pos = 0;
+		while ((pos = code.find("regs.", pos)) != std::string::npos)
+		{
+			const size_t nameStart = pos + 5;
+			size_t nameEnd = nameStart;
+			while (nameEnd < code.length() && IsIdentifierChar(code[nameEnd]))
+				++nameEnd;
+
+			// not a part of other identifier
+			if (pos == 0 || !IsIdentifierChar(code[pos - 1]))
+				func(pos, nameEnd, code.substr(nameStart, nameEnd - nameStart));
+
+			pos = nameEnd;
+		}
+	}
+
+	// get type of the local variable for the register, NULL if the register cannot be promoted
+	// NOTE: R0 is never promoted, some ops check if the argument is the R0 register by address
+	static inline const char* GetPromotedRegisterType(const std::string& name)
+	{
+		const char* digits = NULL;
+		const char* type = NULL;
+		if (name.length() >= 2 && name[0] == 'R' && name != "R0")
+		{
+			digits = name.c_str() + 1;
+			type = "cpu::TReg";
+		}
+		else if (name.length() >= 3 && name[0] == 'F' && name[1] == 'R')
+		{
+			digits = name.c_str() + 2;
+			type = "cpu::TFReg";
+		}
+		else
+		{
+			return NULL;
+		}
+
+		for (const char* ch = digits; *ch; ++ch)
+			if (*ch < '0' || *ch > '9')
+				return NULL;
+
+		return type;
+	}
+
+	// registers must be in the register file when leaving the block or when calling the interrupt handler (traps and system calls)
+	// NOTE: jumps emitted as local goto do not leave the block
+	static inline bool IsRegisterBarrier(const decoding::Instruction& op, const decoding::InstructionExtendedInfo& info, const std::string& code)
+	{
+		if (code.find("return") != std::string::npos)
+			return true;
+
+		const char* name = op.GetOpcode()->GetName();
+		return 0 == strcmp(name, "sc") || 0 == strcmp(name, "tw") || 0 == strcmp(name, "twi") || 0 == strcmp(name, "td") || 0 == strcmp(name, "tdi");
+	}
+
+	// replace references to promoted registers with the local variables
+	static inline std::string PromoteRegisters(const std::string& code, const std::set<std::string>& promotedRegisters)
+	{
+		std::string ret;
+		size_t lastPos = 0;
+		VisitRegisterReferences(code, [&](const size_t start, const size_t end, const std::string& name)
+		{
+			if (promotedRegisters.find(name) != promotedRegisters.end())
+			{
+				ret.append(code, lastPos, start - lastPos);
+				ret += "local_";
+				ret += name;
+				lastPos = end;
+			}
+		});
+
+		ret.append(code, lastPos, std::string::npos);
+		return ret;
+	}
+
+	// get index of the general purpose register, -1 for other registers
+	static inline int GetGPRIndex(const platform::CPURegister* reg)
+	{
+		if (!reg)
+			return -1;
+
+		const int index = reg->GetNativeIndex();
+		if (index >= CPU_XenonPPC::eRegister_R0 && index <= CPU_XenonPPC::eRegister_R31)
+			return index - CPU_XenonPPC::eRegister_R0;
+		return -1;
+	}
+
+	// values of the general purpose registers known at given point in the code
+	struct KnownRegisters
+	{
+		uint64		m_values[32];
+		uint32		m_mask;
+
+		inline KnownRegisters() : m_mask(0) {}
+
+		inline void Reset() { m_mask = 0; }
+		inline bool IsKnown(const int index) const { return (index >= 0) && (0 != (m_mask & (1U << index))); }
+		inline void Set(const int index, const uint64 value) { m_values[index] = value; m_mask |= (1U << index); }
+		inline void Clear(const int index) { if (index >= 0) m_mask &= ~(1U << index); }
+	};
+
+	// can the code be entered at this instruction from some other place
+	static inline bool IsEntryPoint(const decoding::InstructionFlags& flags)
+	{
+		return flags.IsBlockStart() || flags.IsFunctionStart() || flags.IsEntryPoint() ||
+			flags.IsStaticJumpTarget() || flags.IsDynamicJumpTarget() ||
+			flags.IsStaticCallTarget() || flags.IsDynamicCallTarget() ||
+			flags.IsReferencedInData();
+	}
+
+	// sign extension, same as in the runtime
+	static inline uint64 EXTS(const uint32 value)
+	{
+		return (uint64)(int64)(int32)value;
+	}
+
+	// get type of the load that can be replaced with a constant, returns false for other instructions
+	static inline bool GetConstantLoadType(const char* name, bool& outAlgebraic)
+	{
+		static const char* logicalLoads[] = { "lbz", "lhz", "lwz", "ld", "lbzx", "lhzx", "lwzx", "ldx" };
+		static const char* algebraicLoads[] = { "lba", "lha", "lwa", "lbax", "lhax", "lwax" };
+
+		for (const char* load : logicalLoads)
+		{
+			if (0 == strcmp(name, load))
+			{
+				outAlgebraic = false;
+				return true;
+			}
+		}
+
+		for (const char* load : algebraicLoads)
+		{
+			if (0 == strcmp(name, load))
+			{
+				outAlgebraic = true;
+				return true;
+			}
+		}
+
+		return false;
+	}
+
+	// format address calculation code the same way the memory instructions do
+	static inline std::string GetAddressCode(const decoding::Instruction::Operand& arg)
+	{
+		char addressCode[128];
+		if (arg.m_index && arg.m_scale != 1)
+			sprintf_s(addressCode, "(uint32)(regs.%s + %d*regs.%s + 0x%08X)", arg.m_reg->GetName(), arg.m_scale, arg.m_index->GetName(), arg.m_imm);
+		else if (arg.m_index)
+			sprintf_s(addressCode, "(uint32)(regs.%s + regs.%s + 0x%08X)", arg.m_reg->GetName(), arg.m_index->GetName(), arg.m_imm);
+		else
+			sprintf_s(addressCode, "(uint32)(regs.%s + 0x%08X)", arg.m_reg->GetName(), arg.m_imm);
+		return addressCode;
+	}
+
+	// replace all occurrences of the text in the generated code, returns number of replacements
+	static inline uint32 ReplaceAll(std::string& code, const std::string& text, const std::string& newText)
+	{
+		uint32 count = 0;
+		size_t pos = 0;
+		while ((pos = code.find(text, pos)) != std::string::npos)
+		{
+			code.replace(pos, text.length(), newText);
+			pos += newText.length();
+			count += 1;
+		}
+		return count;
+	}
+}
+
+const uint32 CodeGeneratorXenon::GetLiveFlags(class ILogOutput& log, const uint32 address, const uint32 depth) const
+{
+	uint32 liveFlags = 0;
+	uint32 definedFlags = 0;
+
+	uint32 codeAddress = address;
+	for (uint32 i = 0; i < Helper::MAX_SCAN_INSTRUCTIONS; ++i)
+	{
+		// leaving the code, assume everything is used
+		const decoding::MemoryFlags flags = m_context->GetMemoryMap().GetMemoryInfo(codeAddress);
+		if (!flags.IsExecutable() || flags.GetInstructionFlags().IsImportFunction())
+			break;
+
+		decoding::Instruction op;
+		const uint32 size = const_cast<decoding::Context*>(m_context)->DecodeInstruction(log, codeAddress, op);
+		if (!size)
+			break;
+
+		decoding::InstructionExtendedInfo info;
+		if (!op.GetExtendedInfo(codeAddress, *const_cast<decoding::Context*>(m_context), info))
+			break;
+
+		// flags read before being overwritten are live
+		liveFlags |= Helper::GetUsedFlags(op, info) & ~definedFlags;
+		definedFlags |= Helper::GetDefinedFlags(info);
+		if (definedFlags == Helper::FLAGS_ALL)
+			return liveFlags;
+
+		// follow the local jumps, everything else (calls, returns, indirect jumps) may use all the flags
+		if (Helper::IsExit(info))
+		{
+			uint32 exitFlags = Helper::FLAGS_ALL;
+			if (depth && Helper::IsStaticJump(info))
+			{
+				exitFlags = GetLiveFlags(log, (uint32)info.m_branchTargetAddress, depth - 1);
+				if (info.m_codeFlags & decoding::InstructionExtendedInfo::eInstructionFlag_Conditional)
+					exitFlags |= GetLiveFlags(log, codeAddress + size, depth - 1);
+			}
+
+			return liveFlags | (exitFlags & ~definedFlags);
+		}
+
+		codeAddress += size;
+	}
+
+	// we don't know what happens next
+	return liveFlags | (Helper::FLAGS_ALL & ~definedFlags);
+}
+
+void CodeGeneratorXenon::RemoveDeadFlagUpdates(Instruction* instr, const uint32 liveFlags)
+{
+	const uint32 definedFlags = Helper::GetDefinedFlags(instr->m_info);
+	const uint32 deadFlags = definedFlags & ~liveFlags;
+	if (!deadFlags)
+		return;
+
+	// opcode name without the record bit
+	std::string name = instr->m_op.GetOpcode()->GetName();
+	const bool recordForm = !name.empty() && name.back() == '.';
+	if (recordForm)
+		name.pop_back();
+
+	std::string code = instr->m_finalCode.empty() ? instr->m_rawCode : instr->m_finalCode;
+
+	// CR field update is not used
+	if ((definedFlags & Helper::FLAGS_CR) && !(definedFlags & Helper::FLAGS_CR & liveFlags))
+	{
+		if (0 == name.compare(0, 3, "cmp"))
+		{
+			// compare has no other side effects
+			instr->m_flagMerged = 1;
+			m_numRemovedCRUpdates += 1;
+			return;
+		}
+		else if (recordForm && Helper::ReplacePrefix(code, "cpu::op::" + name + "<1", "cpu::op::" + name + "<0"))
+		{
+			// record form, generate the normal version
+			instr->m_finalCode = code;
+			m_numRemovedCRUpdates += 1;
+		}
+	}
+
+	// carry is not used, use the version that does not compute it
+	if (deadFlags & Helper::FLAG_XER_CA)
+	{
+		static const char* carryOps[][2] = { { "addic", "addi" }, { "addc", "add" }, { "subfc", "subf" } };
+		for (const auto& carryOp : carryOps)
+		{
+			if (name == carryOp[0] && Helper::ReplacePrefix(code, std::string("cpu::op::") + carryOp[0] + "<", std::string("cpu::op::") + carryOp[1] + "<"))
+			{
+				instr->m_finalCode = code;
+				m_numRemovedXERUpdates += 1;
+				break;
+			}
+		}
+	}
+}
+
+const bool CodeGeneratorXenon::ReadConstantMemory(const uint32 address, const uint32 size, uint64& outValue) const
+{
+	// must be inside the image
+	const uint64 baseAddress = m_image->GetBaseAddress();
+	if (address < baseAddress || (address - baseAddress) + size > m_image->GetMemorySize())
+		return false;
+
+	// section must not be writable
+	const uint32 offset = (uint32)(address - baseAddress);
+	const image::Section* section = m_image->FindSectionForOffset(offset);
+	if (!section || !section->CanRead() || section->CanWrite() || !section->IsValidOffset(offset + size - 1))
+		return false;
+
+	// import tables are filled by the loader even in the read only sections
+	const uint32 numImports = m_image->GetNumImports();
+	for (uint32 i = 0; i<numImports; ++i)
+	{
+		const uint64 tableAddress = m_image->GetImport(i)->GetTableAddress();
+		if (address < tableAddress + 8 && tableAddress < (uint64)address + size)
+			return false;
+	}
+
+	// big endian data
+	const uint8* data = m_image->GetMemory() + offset;
+	uint64 value = 0;
+	for (uint32 i = 0; i<size; ++i)
+		value = (value << 8) | data[i];
+
+	outValue = value;
+	return true;
+}
+
+void CodeGeneratorXenon::PropagateConstants(Block* block)
+{
+	Helper::KnownRegisters known;
+	bool unknownEntries = block->m_unknownEntries;
+
+	for (uint32 j = 0; j<block->m_instructions.size(); ++j)
+	{
+		Instruction* instr = block->m_instructions[j];
+
+		// nothing is known when the code is entered from other place
+		const decoding::MemoryFlags flags = m_context->GetMemoryMap().GetMemoryInfo(instr->m_address);
+		if (j == 0 || unknownEntries || Helper::IsEntryPoint(flags.GetInstructionFlags()))
+			known.Reset();
+
+		if (instr->m_flagMerged)
+			continue;
+
+		std::string code = instr->m_finalCode.empty() ? instr->m_rawCode : instr->m_finalCode;
+		const char* name = instr->m_op.GetOpcode()->GetName();
+		const auto& arg0 = instr->m_op.GetArg0();
+		const auto& arg1 = instr->m_op.GetArg1();
+		const auto& arg2 = instr->m_op.GetArg2();
+
+		// value of the output register if known after the instruction
+		const int outputIndex = Helper::GetGPRIndex(arg0.m_reg);
+		bool hasOutputValue = false;
+		uint64 outputValue = 0;
+
+		// constants built from immediates
+		if (0 == strcmp(name, "li"))
+		{
+			outputValue = Helper::EXTS(arg1.m_imm);
+			hasOutputValue = true;
+		}
+		else if (0 == strcmp(name, "lis"))
+		{
+			outputValue = Helper::EXTS(arg1.m_imm << 16);
+			hasOutputValue = true;
+		}
+		else if (known.IsKnown(Helper::GetGPRIndex(arg1.m_reg)) && arg2.m_type == decoding::Instruction::eType_Imm &&
+			(0 == strcmp(name, "addi") || 0 == strcmp(name, "addis") || 0 == strcmp(name, "ori") || 0 == strcmp(name, "oris")))
+		{
+			const uint64 value = known.m_values[Helper::GetGPRIndex(arg1.m_reg)];
+			if (0 == strcmp(name, "addi"))
+				outputValue = value + Helper::EXTS(arg2.m_imm);
+			else if (0 == strcmp(name, "addis"))
+				outputValue = value + Helper::EXTS(arg2.m_imm << 16);
+			else if (0 == strcmp(name, "ori"))
+				outputValue = value | (uint64)arg2.m_imm;
+			else
+				outputValue = value | (uint64)(arg2.m_imm << 16);
+
+			char newCode[128];
+			sprintf_s(newCode, "regs.%s = 0x%016llXULL;", arg0.m_reg->GetName(), outputValue);
+			code = newCode;
+			hasOutputValue = true;
+			m_numFoldedConstants += 1;
+		}
+
+		// memory access with the address computed from the known registers
+		if ((instr->m_info.m_memoryFlags & (decoding::InstructionExtendedInfo::eMemoryFlags_Read | decoding::InstructionExtendedInfo::eMemoryFlags_Write)) &&
+			arg1.m_type == decoding::Instruction::eType_Mem)
+		{
+			const int baseIndex = Helper::GetGPRIndex(arg1.m_reg);
+			const int indexIndex = Helper::GetGPRIndex(arg1.m_index);
+
+			bool addressKnown = false;
+			uint32 address = 0;
+			if (!arg1.m_reg && !arg1.m_index)
+			{
+				address = arg1.m_imm;
+				addressKnown = true;
+			}
+			else if (arg1.m_reg && known.IsKnown(baseIndex) && (!arg1.m_index || known.IsKnown(indexIndex)))
+			{
+				uint64 fullAddress = known.m_values[baseIndex] + arg1.m_imm;
+				if (arg1.m_index)
+					fullAddress += arg1.m_scale * known.m_values[indexIndex];
+				address = (uint32)fullAddress;
+				addressKnown = true;
+
+				// use the immediate address instead of the registers
+				char addressCode[32];
+				sprintf_s(addressCode, "0x%08X", address);
+				if (Helper::ReplaceAll(code, Helper::GetAddressCode(arg1), addressCode))
+					m_numFoldedAddresses += 1;
+			}
+
+			// load from the read only memory (mapped memory is never constant)
+			bool algebraic = false;
+			uint64 value = 0;
+			if (addressKnown && Helper::GetConstantLoadType(name, algebraic) &&
+				!(instr->m_info.m_memoryFlags & decoding::InstructionExtendedInfo::eMemoryFlags_DirectMap) &&
+				ReadConstantMemory(address, instr->m_info.m_memorySize, value))
+			{
+				if (algebraic && instr->m_info.m_memorySize == 1)
+					value = (uint64)(int64)(int8)value;
+				else if (algebraic && instr->m_info.m_memorySize == 2)
+					value = (uint64)(int64)(int16)value;
+				else if (algebraic && instr->m_info.m_memorySize == 4)
+					value = (uint64)(int64)(int32)value;
+
+				char newCode[128];
+				sprintf_s(newCode, "regs.%s = 0x%016llXULL;", arg0.m_reg->GetName(), value);
+				code = newCode;
+				outputValue = value;
+				hasOutputValue = true;
+				m_numConstantLoads += 1;
+			}
+		}
+
+		// update the code
+		const std::string& oldCode = instr->m_finalCode.empty() ? instr->m_rawCode : instr->m_finalCode;
+		if (code != oldCode)
+			instr->m_finalCode = code;
+
+		// registers modified by the instruction are no longer known
+		for (uint32 k = 0; k < instr->m_info.m_registersModifiedCount; ++k)
+			known.Clear(Helper::GetGPRIndex(instr->m_info.m_registersModified[k]));
+
+		// registers written through the pointer or assigned in the code
+		Helper::VisitRegisterReferences(code, [&known, &code](const size_t start, const size_t end, const std::string& regName)
+		{
+			const bool isPointer = (start > 0 && code[start - 1] == '&');
+			const bool isAssigned = (0 == code.compare(end, 3, " = "));
+			if (isPointer || isAssigned)
+			{
+				if (regName.length() >= 2 && regName[0] == 'R' && regName[1] >= '0' && regName[1] <= '9')
+					known.Clear(atoi(regName.c_str() + 1));
+			}
+		});
+
+		if (hasOutputValue && outputIndex >= 0)
+			known.Set(outputIndex, outputValue);
+
+		// the called code and the interrupt handlers may change any register, register jumps can land anywhere
+		if (Helper::IsExit(instr->m_info) || Helper::IsRegisterBarrier(instr->m_op, instr->m_info, code))
+		{
+			const bool conditionalJump = (instr->m_info.m_codeFlags & decoding::InstructionExtendedInfo::eInstructionFlag_Conditional) && Helper::IsStaticJump(instr->m_info);
+			if (!conditionalJump)
+				known.Reset();
+
+			if ((instr->m_info.m_codeFlags & decoding::InstructionExtendedInfo::eInstructionFlag_Jump) && instr->m_info.m_branchTargetReg)
+				unknownEntries = true;
+		}
+	}
 }
 
 const bool CodeGeneratorXenon::Optimize(class ILogOutput& log)
 {
+	// every instruction is a separate exit when tracing
+	if (m_options->m_debugTrace)
+		return true;
+
+	for (uint32 i = 0; i<m_blocks.size(); ++i)
+	{
+		Block* block = m_blocks[i];
+		if (block->m_instructions.empty())
+			continue;
+
+		// flags used by the code following the block
+		const Instruction* lastInstr = block->m_instructions.back();
+		uint32 liveFlags = GetLiveFlags(log, lastInstr->m_address + 4, Helper::MAX_SCAN_DEPTH);
+
+		// backward liveness pass
+		for (int j = (int)block->m_instructions.size() - 1; j >= 0; --j)
+		{
+			Instruction* instr = block->m_instructions[j];
+
+			// flags used after the jump
+			if (Helper::IsExit(instr->m_info))
+			{
+				uint32 exitFlags = Helper::FLAGS_ALL;
+				if (Helper::IsStaticJump(instr->m_info))
+					exitFlags = GetLiveFlags(log, (uint32)instr->m_info.m_branchTargetAddress, Helper::MAX_SCAN_DEPTH);
+
+				// unconditional jump does not continue
+				if (!(instr->m_info.m_codeFlags & decoding::InstructionExtendedInfo::eInstructionFlag_Conditional) && Helper::IsStaticJump(instr->m_info))
+					liveFlags = exitFlags;
+				else
+					liveFlags |= exitFlags;
+			}
+
+			RemoveDeadFlagUpdates(instr, liveFlags);
+
+			liveFlags &= ~Helper::GetDefinedFlags(instr->m_info);
+			liveFlags |= Helper::GetUsedFlags(instr->m_op, instr->m_info);
+		}
+
+		// fold the constants (after the flags, the folded code does not update them)
+		PropagateConstants(block);
+	}
+
+	// jumps with the targets inside this code
+	if (m_options->m_allowLocalLabels)
+	{
+		std::unordered_map<uint32, Instruction*> instructions;
+		for (const Block* block : m_blocks)
+			for (Instruction* instr : block->m_instructions)
+				instructions[instr->m_address] = instr;
+
+		for (uint32 i = 0; i<m_blocks.size(); ++i)
+		{
+			Block* block = m_blocks[i];
+			for (uint32 j = 0; j<block->m_instructions.size(); ++j)
+			{
+				Instruction* instr = block->m_instructions[j];
+				if (instr->m_flagMerged || !Helper::IsExit(instr->m_info))
+					continue;
+
+				// static jump
+				if (Helper::IsStaticJump(instr->m_info))
+				{
+					CreateLocalJump(instr, instructions);
+					continue;
+				}
+
+				// switch
+				if (instr->m_info.m_branchTargetReg)
+				{
+					const decoding::AddressMap::JumpTable* jumpTable = m_context->GetAddressMap().GetJumpTable(instr->m_address);
+					if (jumpTable)
+						CreateNativeSwitch(instr, *jumpTable, instructions);
+				}
+			}
+		}
+	}
+
 	return true;
 }
 
+void CodeGeneratorXenon::CreateLocalJump(Instruction* instr, const std::unordered_map<uint32, Instruction*>& instructions)
+{
+	const uint32 targetAddress = (uint32)instr->m_info.m_branchTargetAddress;
+	const auto it = instructions.find(targetAddress);
+	if (it == instructions.end() || it->second->m_flagMerged)
+		return;
+
+	// replace the return to the executor with the jump
+	char returnCode[32], gotoCode[32];
+	sprintf_s(returnCode, "return 0x%08X;", targetAddress);
+	sprintf_s(gotoCode, "goto label_%08X;", targetAddress);
+
+	std::string code = instr->m_finalCode.empty() ? instr->m_rawCode : instr->m_finalCode;
+	if (!Helper::ReplaceAll(code, returnCode, gotoCode))
+		return;
+
+	instr->m_finalCode = code;
+	instr->m_targetAddress = targetAddress;
+	instr->LinkTo(it->second);
+	it->second->m_flagLocalLabel = 1;
+	m_numLocalJumps += 1;
+}
+
+void CodeGeneratorXenon::CreateNativeSwitch(Instruction* instr, const decoding::AddressMap::JumpTable& jumpTable, const std::unordered_map<uint32, Instruction*>& instructions)
+{
+	std::string switchCode;
+	std::set<uint64> localTargets;
+	for (const auto target : jumpTable.m_targets)
+	{
+		const auto it = instructions.find((uint32)target);
+		if (it == instructions.end() || it->second->m_flagMerged)
+			continue;
+
+		// same target used by many cases
+		if (!localTargets.insert(target).second)
+			continue;
+
+		it->second->m_flagLocalLabel = 1;
+
+		char caseCode[64];
+		sprintf_s(caseCode, "case 0x%08X: goto label_%08X; ", (uint32)target, (uint32)target);
+		switchCode += caseCode;
+	}
+
+	// no targets inside this code
+	if (switchCode.empty())
+		return;
+
+	// targets outside this code are still handled by the original jump
+	const std::string& code = instr->m_finalCode.empty() ? instr->m_rawCode : instr->m_finalCode;
+	instr->m_finalCode = "switch ( (uint32)regs.CTR ) { " + switchCode + "} " + code;
+	m_numNativeSwitches += 1;
+}
+
+void CodeGeneratorXenon::CollectPromotedRegisters(std::set<std::string>& outRegisters) const
+{
+	// count register references outside the barriers
+	std::map<std::string, uint32> numReferences;
+	for (uint32 i = 0; i<m_blocks.size(); ++i)
+	{
+		const Block* block = m_blocks[i];
+		for (uint32 j = 0; j<block->m_instructions.size(); ++j)
+		{
+			const Instruction* instr = block->m_instructions[j];
+			if (instr->m_flagMerged)
+				continue;
+
+			const std::string& code = instr->m_finalCode.empty() ? instr->m_rawCode : instr->m_finalCode;
+			if (Helper::IsRegisterBarrier(instr->m_op, instr->m_info, code))
+				continue;
+
+			Helper::VisitRegisterReferences(code, [&numReferences](const size_t, const size_t, const std::string& name)
+			{
+				if (Helper::GetPromotedRegisterType(name))
+					numReferences[name] += 1;
+			});
+		}
+	}
+
+	// single reference is not worth the load and the store
+	for (const auto& it : numReferences)
+	{
+		if (it.second >= 2)
+			outRegisters.insert(it.first);
+	}
+}
+
 const bool CodeGeneratorXenon::Emit(class ILogOutput& log, class code::IGenerator& codeGen) const
 {
 	// empty block
@@ -328,8 +1074,32 @@ const bool CodeGeneratorXenon::Emit(class ILogOutput& log, class code::IGenerato
 		}
 	}
 
-	// emit the final code
-	codeGen.StartBlock(startAddress, true/*multiAddress*/, functionName);
+	// registers kept in local variables, loaded on every block entry and stored back before leaving the block
+	std::set<std::string> promotedRegisters;
+	std::string prologueCode, spillCode, reloadCode;
+	if (m_options->m_allowRegisterPromotion && !m_options->m_debugTrace)
+	{
+		CollectPromotedRegisters(promotedRegisters);
+		for (const auto& name : promotedRegisters)
+		{
+			prologueCode += Helper::GetPromotedRegisterType(name);
+			prologueCode += " local_" + name + " = regs." + name + ";\n";
+			spillCode += "regs." + name + " = local_" + name + "; ";
+			reloadCode += "local_" + name + " = regs." + name + "; ";
+		}
+	}
+
+	// emit the final code, lines are assembled in a reused buffer instead of going through the printf formatting
+	std::string line;
+	line.reserve(1024);
+	const auto emitLine = [&codeGen, &line](const uint64 address, const std::string& code)
+	{
+		line = code;
+		line += '\n';
+		codeGen.AddCode(address, line.c_str());
+	};
+
+	codeGen.StartBlock(startAddress, true/*multiAddress*/, functionName, prologueCode.c_str());
 	for (uint32 i = 0; i<m_blocks.size(); ++i)
 	{
 		const Block* block = m_blocks[i];
@@ -339,6 +1109,7 @@ const bool CodeGeneratorXenon::Emit(class ILogOutput& log, class code::IGenerato
 			const uint64 codeAddress = instr->m_address;
 
 			// emit original code
+			if (m_options->m_emitComments)
 			{
 				char originalCode[256];
 				char* stream = originalCode;
@@ -346,25 +1117,40 @@ const bool CodeGeneratorXenon::Emit(class ILogOutput& log, class code::IGenerato
 				codeGen.AddCodef(codeAddress, "/* %s */\n", originalCode);
 			}
 
-			// optimized away
+			// local jump target
+			if (instr->m_flagLocalLabel)
+			{
+				codeGen.AddCodef(codeAddress, "label_%08X: ;\n", codeAddress);
+			}
+
+			// optimized away, the (empty) code is still added so the multi address block gets the case label for this address
 			if (instr->m_flagMerged)
 			{
-				codeGen.AddCodef(codeAddress, "/* OPTIMIZED AWAY */\n");
+				codeGen.AddCode(codeAddress, m_options->m_emitComments ? "/* OPTIMIZED AWAY */\n" : "");
 				continue;
 			}
 
 			// emit code (prefer final code)
-			if (!instr->m_finalCode.empty())
+			const std::string& code = !instr->m_finalCode.empty() ? instr->m_finalCode : instr->m_rawCode;
+			if (code.empty())
 			{
-				codeGen.AddCodef(codeAddress, "%s\n", instr->m_finalCode.c_str());
+				codeGen.AddCode(codeAddress, m_options->m_emitComments ? "/* NO CODE */\n" : "");
 			}
-			else if (!instr->m_rawCode.empty())
+			else if (promotedRegisters.empty())
 			{
-				codeGen.AddCodef(codeAddress, "%s\n", instr->m_rawCode.c_str());
+				emitLine(codeAddress, code);
 			}
-			else if (!instr->m_rawCode.empty())
+			else if (Helper::IsRegisterBarrier(instr->m_op, instr->m_info, code))
 			{
-				codeGen.AddCodef(codeAddress, "/* NO CODE */\n");
+				// interrupt handler may change the registers
+				emitLine(codeAddress, spillCode);
+				emitLine(codeAddress, code);
+				if (!Helper::IsExit(instr->m_info))
+					emitLine(codeAddress, reloadCode);
+			}
+			else
+			{
+				emitLine(codeAddress, Helper::PromoteRegisters(code, promotedRegisters));
 			}
 
 			// trace support
@@ -375,6 +1161,13 @@ const bool CodeGeneratorXenon::Emit(class ILogOutput& log, class code::IGenerato
 		}
 	}
 
+	// falling through to the next block
+	if (!promotedRegisters.empty())
+	{
+		const uint32 endAddress = m_blocks.back()->m_instructions.back()->m_address;
+		emitLine(endAddress, spillCode);
+	}
+
 	// end block
 	codeGen.CloseBlock();
 
@@ -382,6 +1175,55 @@ const bool CodeGeneratorXenon::Emit(class ILogOutput& log, class code::IGenerato
 	return true;
 }
 
+const uint32 CodeGeneratorXenon::GetStartAddress() const
+{
+	if (m_blocks.empty() || m_blocks[0]->m_instructions.empty())
+		return 0;
+
+	return m_blocks[0]->m_instructions[0]->m_address;
+}
+
+const bool CodeGeneratorXenon::GetSharedCodeKey(std::string& outKey) const
+{
+	// small code only, big functions are rarely identical
+	if (m_numInstructions == 0 || m_numInstructions > MAX_SHARED_INSTRUCTIONS || m_options->m_debugTrace)
+		return false;
+
+	outKey.clear();
+	for (const Block* block : m_blocks)
+	{
+		for (const Instruction* instr : block->m_instructions)
+		{
+			// code referencing its own addresses (calls, local jumps) is never identical so only the code itself is compared
+			if (instr->m_flagMerged)
+				outKey += "~";
+			else
+				outKey += !instr->m_finalCode.empty() ? instr->m_finalCode : instr->m_rawCode;
+			outKey += "\n";
+		}
+	}
+
+	// the code must not fall through to the end of the block (the block return address is not shared)
+	const Instruction* lastInstr = m_blocks.back()->m_instructions.back();
+	const std::string& lastCode = !lastInstr->m_finalCode.empty() ? lastInstr->m_finalCode : lastInstr->m_rawCode;
+	return !lastInstr->m_flagMerged && (0 == lastCode.compare(0, 7, "return "));
+}
+
+const bool CodeGeneratorXenon::EmitAlias(class ILogOutput& log, class code::IGenerator& codeGen, const uint32 sourceAddress) const
+{
+	const uint32 startAddress = GetStartAddress();
+	const uint32 endAddress = m_blocks.back()->m_instructions.back()->m_address + 4;
+
+	// function?
+	const decoding::MemoryFlags startFlags = m_context->GetMemoryMap().GetMemoryInfo(startAddress);
+	const char* functionName = NULL;
+	if (startFlags.IsExecutable() && startFlags.GetInstructionFlags().IsFunctionStart())
+		functionName = m_context->GetNameMap().GetName(startAddress);
+
+	codeGen.AddBlockAlias(startAddress, endAddress, sourceAddress, functionName);
+	return true;
+}
+
 //---------------------------------------------------------------------------
 
 bool DecompilationXenon::ExportCode(ILogOutput& log, decoding::Context& decodingContext, const Commandline& settings, class code::IGenerator& codeGen) const
@@ -389,6 +1231,14 @@ bool DecompilationXenon::ExportCode(ILogOutput& log, decoding::Context& decoding
 	// parse options
 	const bool withDebugging = settings.HasOption("O0") || settings.HasOption("debug");
 	CodeGeneratorOptionsXenon options(withDebugging);
+	if (settings.HasOption("noregpromote"))
+		options.m_allowRegisterPromotion = false;
+	if (settings.HasOption("nofuncmerge"))
+		options.m_allowBlockMerging = false;
+	if (settings.HasOption("nocodeshare"))
+		options.m_allowCodeSharing = false;
+	if (settings.HasOption("nocomments"))
+		options.m_emitComments = false;
 
 	// emit the image
 	codeGen.AddImageData(log, decodingContext.GetImage()->GetMemory(), decodingContext.GetImage()->GetMemorySize());
@@ -436,6 +1286,23 @@ bool DecompilationXenon::ExportCode(ILogOutput& log, decoding::Context& decoding
 	uint32 startBlockIndex = 0;
 	uint32 numBlockBlobs = 0;
 	uint32 numBlockInstructions = 0;
+	uint32 numRemovedCRUpdates = 0;
+	uint32 numRemovedXERUpdates = 0;
+	uint32 numFoldedConstants = 0;
+	uint32 numFoldedAddresses = 0;
+	uint32 numConstantLoads = 0;
+	uint32 numNativeSwitches = 0;
+	uint32 numLocalJumps = 0;
+	uint32 numSharedBlobs = 0;
+	uint64 numSharedBytes = 0;
+
+	// emitted shared code: start address of the first copy and the size of the code generated for it
+	struct SharedCodeInfo
+	{
+		uint32 m_address;
+		uint64 m_codeSize;
+	};
+	std::unordered_map<std::string, SharedCodeInfo> sharedCode;
 	while (currentBlockIndex < blocks.m_blocks.size())
 	{
 		CodeGeneratorXenon blob(decodingContext, options);
@@ -457,7 +1324,7 @@ bool DecompilationXenon::ExportCode(ILogOutput& log, decoding::Context& decoding
 		}
 
 		// try glue following blocks
-		while (blob.CanGlue() && currentBlockIndex < blocks.m_blocks.size())
+		while (currentBlockIndex < blocks.m_blocks.size() && blob.CanGlue((uint32)blocks.m_blocks[currentBlockIndex].m_startAddrses))
 		{
 			const CCodeSegmentsXenon::BlockInfo& block = blocks.m_blocks[currentBlockIndex];
 			currentBlockIndex += 1;
@@ -475,17 +1342,65 @@ bool DecompilationXenon::ExportCode(ILogOutput& log, decoding::Context& decoding
 			return false;
 		}
 
+		numRemovedCRUpdates += blob.GetNumRemovedCRUpdates();
+		numRemovedXERUpdates += blob.GetNumRemovedXERUpdates();
+		numFoldedConstants += blob.GetNumFoldedConstants();
+		numFoldedAddresses += blob.GetNumFoldedAddresses();
+		numConstantLoads += blob.GetNumConstantLoads();
+		numNativeSwitches += blob.GetNumNativeSwitches();
+		numLocalJumps += blob.GetNumLocalJumps();
+
+		// identical code is emitted only once, the other copies reuse it
+		std::string sharedCodeKey;
+		const bool isSharedCode = options.m_allowCodeSharing && blob.GetSharedCodeKey(sharedCodeKey);
+		if (isSharedCode)
+		{
+			const auto it = sharedCode.find(sharedCodeKey);
+			if (it != sharedCode.end())
+			{
+				const uint64 aliasStartSize = codeGen.GetCodeSize();
+				if (!blob.EmitAlias(log, codeGen, it->second.m_address))
+				{
+					log.Error("Decompile: Failed to emit code blob alias");
+					return false;
+				}
+
+				// saved = code generated for the first copy minus the code generated for the alias
+				const uint64 aliasCodeSize = codeGen.GetCodeSize() - aliasStartSize;
+				if (it->second.m_codeSize > aliasCodeSize)
+					numSharedBytes += it->second.m_codeSize - aliasCodeSize;
+
+				numSharedBlobs += 1;
+				continue;
+			}
+		}
+
 		// output the blob code to code output
+		const uint64 blobStartSize = codeGen.GetCodeSize();
 		if (!blob.Emit(log, codeGen))
 		{
 			log.Error("Decompile: Failed to emit code blob");
 			return false;
 		}
+
+		// remember where the shared code is and how big it is
+		if (isSharedCode)
+		{
+			SharedCodeInfo& info = sharedCode[sharedCodeKey];
+			info.m_address = blob.GetStartAddress();
+			info.m_codeSize = codeGen.GetCodeSize() - blobStartSize;
+		}
 	}
 
 	// done
 	log.Log("Compile: %d blocks processed, %d block groups, %d instructions",
 		blocks.m_blocks.size(), numBlockBlobs, numBlockInstructions);
+	log.Log("Compile: Removed %u unused CR updates and %u unused XER updates",
+		numRemovedCRUpdates, numRemovedXERUpdates);
+	log.Log("Compile: Folded %u constants and %u memory addresses, %u loads from read only memory replaced with constants",
+		numFoldedConstants, numFoldedAddresses, numConstantLoads);
+	log.Log("Compile: Emitted %u jump tables as native switch and %u jumps as local goto", numNativeSwitches, numLocalJumps);
+	log.Log("Compile: Shared code of %u identical block groups, %llu bytes of generated code saved", numSharedBlobs, numSharedBytes);
 
 	// done
 	return true;
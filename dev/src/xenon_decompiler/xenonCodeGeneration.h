@@ -5,6 +5,7 @@
 #include "../recompiler_core/build.h"
 #include "../recompiler_core/decodingInstruction.h"
 #include "../recompiler_core/decodingInstructionInfo.h"
+#include "../recompiler_core/decodingAddressMap.h"
 
 //---------------------------------------------------------------------------
 
@@ -14,6 +15,9 @@ public:
 	bool		m_allowBlockMerging;
 	bool		m_allowLocalLabels;
 	bool		m_allowCallInlinling;
+	bool		m_allowRegisterPromotion;
+	bool		m_allowCodeSharing;
+	bool		m_emitComments;
 
 	bool		m_forceMultiAddressBlocks;
 
@@ -56,15 +60,45 @@ public:
 	const bool AddBlock(class ILogOutput& log, const uint32 start, const uint32 end, class code::IGenerator& codeGen);
 
 	// should we try to merge the following block ?
-	const bool CanGlue() const;
+	const bool CanGlue(const uint32 nextBlockStart) const;
 
 	// optimize code
 	const bool Optimize(class ILogOutput& log);
 
+	// get number of the flag updates removed by the optimizer
+	inline const uint32 GetNumRemovedCRUpdates() const { return m_numRemovedCRUpdates; }
+	inline const uint32 GetNumRemovedXERUpdates() const { return m_numRemovedXERUpdates; }
+
+	// get number of the constants and addresses folded by the optimizer
+	inline const uint32 GetNumFoldedConstants() const { return m_numFoldedConstants; }
+	inline const uint32 GetNumFoldedAddresses() const { return m_numFoldedAddresses; }
+	inline const uint32 GetNumConstantLoads() const { return m_numConstantLoads; }
+
+	// get number of the jump tables emitted as native switch
+	inline const uint32 GetNumNativeSwitches() const { return m_numNativeSwitches; }
+
+	// get number of the jumps emitted as local goto
+	inline const uint32 GetNumLocalJumps() const { return m_numLocalJumps; }
+
 	// emit code
 	const bool Emit(class ILogOutput& log, class code::IGenerator& codeGen) const;
 
+	// get address of the first instruction
+	const uint32 GetStartAddress() const;
+
+	// get key of the final code, code with the same key is identical regardless of its address, returns false if the code can't be shared
+	const bool GetSharedCodeKey(std::string& outKey) const;
+
+	// emit code as an alias of already emitted identical code
+	const bool EmitAlias(class ILogOutput& log, class code::IGenerator& codeGen, const uint32 sourceAddress) const;
+
 private:
+	// maximum size of the function emitted as one piece of code
+	static const uint32 MAX_MERGED_INSTRUCTIONS = 16384;
+
+	// maximum size of the code considered for sharing
+	static const uint32 MAX_SHARED_INSTRUCTIONS = 64;
+
 	struct Instruction
 	{
 		uint32						m_address;
@@ -96,6 +130,7 @@ private:
 		TInstructions		m_instructions;
 		uint32				m_multiAddress : 1;
 		uint32				m_functionStart : 1;
+		uint32				m_unknownEntries : 1;	// code after the register jump, any instruction can be entered
 
 		Block();
 		~Block();
@@ -106,6 +141,38 @@ private:
 
 	bool			m_isInSwitch;
 
+	uint32			m_blockEndAddress;		// end of the last added block
+
+	uint32			m_numRemovedCRUpdates;
+	uint32			m_numRemovedXERUpdates;
+	uint32			m_numFoldedConstants;
+	uint32			m_numFoldedAddresses;
+	uint32			m_numConstantLoads;
+	uint32			m_numNativeSwitches;
+	uint32			m_numLocalJumps;
+	uint32			m_numInstructions;
+
+	// get flags that are read before being overwritten by the code starting at given address, follows local jumps up to given depth
+	const uint32 GetLiveFlags(class ILogOutput& log, const uint32 address, const uint32 depth) const;
+
+	// remove updates of the flags that are not live after the instruction
+	void RemoveDeadFlagUpdates(Instruction* instr, const uint32 liveFlags);
+
+	// track the register values built from immediates and fold them into the following code
+	void PropagateConstants(Block* block);
+
+	// read value from the image memory that cannot be modified at runtime, returns false if the memory may change
+	const bool ReadConstantMemory(const uint32 address, const uint32 size, uint64& outValue) const;
+
+	// jump directly to the target if it's inside this code
+	void CreateLocalJump(Instruction* instr, const std::unordered_map<uint32, Instruction*>& instructions);
+
+	// jump directly to the jump table targets that are inside this code
+	void CreateNativeSwitch(Instruction* instr, const decoding::AddressMap::JumpTable& jumpTable, const std::unordered_map<uint32, Instruction*>& instructions);
+
+	// collect registers that are worth keeping in local variables
+	void CollectPromotedRegisters(std::set<std::string>& outRegisters) const;
+
 	const CodeGeneratorOptionsXenon*	m_options;
 	const image::Binary*				m_image;
 	const decoding::Context*			m_context;
@@ -411,6 +411,404 @@ public:
 
 //---------------------------------------------------------------------------
 
+class CJumpTableDetectorXenon
+{
+private:
+	decoding::Context*					m_context;
+
+	const platform::CPUInstruction*		m_opLi;
+	const platform::CPUInstruction*		m_opLis;
+	const platform::CPUInstruction*		m_opAddi;
+	const platform::CPUInstruction*		m_opAddis;
+	const platform::CPUInstruction*		m_opOri;
+	const platform::CPUInstruction*		m_opAdd;
+	const platform::CPUInstruction*		m_opRlwinm;
+	const platform::CPUInstruction*		m_opLbzx;
+	const platform::CPUInstruction*		m_opLhzx;
+	const platform::CPUInstruction*		m_opLwzx;
+	const platform::CPUInstruction*		m_opCmplwi;
+	const platform::CPUInstruction*		m_opBc;
+	const platform::CPUInstruction*		m_opMtspr;
+
+	const static uint32 MAX_SCAN_INSTRUCTIONS = 32;
+	const static uint32 MAX_TABLE_ENTRIES = 4096;
+
+	struct Code
+	{
+		uint32								m_address;
+		decoding::Instruction				m_op;
+		decoding::InstructionExtendedInfo	m_info;
+	};
+
+	// linear code preceding the indirect jump, the jump is the last one
+	std::vector<Code>					m_code;
+
+public:
+	uint32								m_numJumpTables;
+	uint32								m_numJumpTargets;
+
+public:
+	CJumpTableDetectorXenon(decoding::Context& context)
+		: m_context(&context)
+		, m_numJumpTables(0)
+		, m_numJumpTargets(0)
+	{
+		// cache important instructions
+		m_opLi = CPU_XenonPPC::GetInstance().FindInstruction("li");
+		m_opLis = CPU_XenonPPC::GetInstance().FindInstruction("lis");
+		m_opAddi = CPU_XenonPPC::GetInstance().FindInstruction("addi");
+		m_opAddis = CPU_XenonPPC::GetInstance().FindInstruction("addis");
+		m_opOri = CPU_XenonPPC::GetInstance().FindInstruction("ori");
+		m_opAdd = CPU_XenonPPC::GetInstance().FindInstruction("add");
+		m_opRlwinm = CPU_XenonPPC::GetInstance().FindInstruction("rlwinm");
+		m_opLbzx = CPU_XenonPPC::GetInstance().FindInstruction("lbzx");
+		m_opLhzx = CPU_XenonPPC::GetInstance().FindInstruction("lhzx");
+		m_opLwzx = CPU_XenonPPC::GetInstance().FindInstruction("lwzx");
+		m_opCmplwi = CPU_XenonPPC::GetInstance().FindInstruction("cmplwi");
+		m_opBc = CPU_XenonPPC::GetInstance().FindInstruction("bc");
+		m_opMtspr = CPU_XenonPPC::GetInstance().FindInstruction("mtspr");
+	}
+
+	void Process(ILogOutput& log, const decoding::Instruction& instr, const uint64 codeAddress, const decoding::InstructionExtendedInfo& info)
+	{
+		// only the unconditional jumps via register (bctr)
+		if (!(info.m_codeFlags & decoding::InstructionExtendedInfo::eInstructionFlag_Jump) || !info.m_branchTargetReg)
+			return;
+		if (info.m_codeFlags & (decoding::InstructionExtendedInfo::eInstructionFlag_Call | decoding::InstructionExtendedInfo::eInstructionFlag_Return | decoding::InstructionExtendedInfo::eInstructionFlag_Conditional))
+			return;
+
+		// get the code leading to the jump
+		if (!CollectCode(log, (uint32)codeAddress, instr, info))
+			return;
+
+		uint64 tableAddress = 0;
+		uint32 entrySize = 0;
+		uint32 numEntries = 0;
+		uint64 baseAddress = 0;
+		if (!MatchPattern(tableAddress, entrySize, numEntries, baseAddress))
+			return;
+
+		// read the table
+		std::vector<uint64> targets;
+		if (!ReadTable(log, (uint32)codeAddress, tableAddress, entrySize, numEntries, baseAddress, targets))
+			return;
+
+		// mark the jump targets
+		for (const auto target : targets)
+		{
+			m_context->GetMemoryMap().SetMemoryBlockSubType(log, target, (uint32)decoding::InstructionFlag::BlockStart, 0);
+			m_context->GetMemoryMap().SetMemoryBlockSubType(log, target, (uint32)decoding::InstructionFlag::DynamicJumpTarget, 0);
+		}
+
+		// mark the table data
+		const image::Section* tableSection = m_context->GetImage()->FindSectionForOffset((uint32)(tableAddress - m_context->GetImage()->GetBaseAddress()));
+		if (tableSection && !tableSection->CanExecute())
+		{
+			for (uint32 i = 0; i < numEntries; ++i)
+			{
+				const uint64 entryAddress = tableAddress + i*entrySize;
+				m_context->GetMemoryMap().SetMemoryBlockLength(log, entryAddress, entrySize);
+				m_context->GetMemoryMap().SetMemoryBlockType(log, entryAddress, (uint32)decoding::MemoryFlag::ReferencedData, 0);
+				m_context->GetMemoryMap().SetMemoryBlockType(log, entryAddress, (uint32)decoding::MemoryFlag::GenericData, 0);
+				m_context->GetMemoryMap().SetMemoryBlockSubType(log, entryAddress, (uint32)decoding::DataFlag::HasCodeRef, 0);
+			}
+		}
+
+		m_context->GetAddressMap().SetJumpTable(codeAddress, tableAddress, numEntries * entrySize, targets);
+		m_numJumpTables += 1;
+		m_numJumpTargets += (uint32)targets.size();
+	}
+
+private:
+	const bool CollectCode(ILogOutput& log, const uint32 jumpAddress, const decoding::Instruction& jumpInstr, const decoding::InstructionExtendedInfo& jumpInfo)
+	{
+		m_code.clear();
+
+		// walk back until the linear code flow is broken
+		uint32 address = jumpAddress;
+		for (uint32 i = 0; i < MAX_SCAN_INSTRUCTIONS; ++i)
+		{
+			address -= 4;
+
+			const decoding::MemoryFlags flags = m_context->GetMemoryMap().GetMemoryInfo(address);
+			if (!flags.IsExecutable() || flags.GetInstructionFlags().IsThunk())
+				break;
+
+			Code code;
+			code.m_address = address;
+			if (!m_context->DecodeInstruction(log, address, code.m_op, false))
+				break;
+			if (!code.m_op.GetExtendedInfo(address, *m_context, code.m_info))
+				break;
+
+			// conditional jumps are allowed (range check)
+			const uint32 exitFlags = decoding::InstructionExtendedInfo::eInstructionFlag_Jump |
+				decoding::InstructionExtendedInfo::eInstructionFlag_Call |
+				decoding::InstructionExtendedInfo::eInstructionFlag_Return;
+			if ((code.m_info.m_codeFlags & exitFlags) && !(code.m_info.m_codeFlags & decoding::InstructionExtendedInfo::eInstructionFlag_Conditional))
+				break;
+			if (code.m_info.m_codeFlags & (decoding::InstructionExtendedInfo::eInstructionFlag_Call | decoding::InstructionExtendedInfo::eInstructionFlag_Return))
+				break;
+
+			m_code.push_back(code);
+		}
+
+		// keep the code order
+		std::reverse(m_code.begin(), m_code.end());
+
+		Code jump;
+		jump.m_address = jumpAddress;
+		jump.m_op = jumpInstr;
+		jump.m_info = jumpInfo;
+		m_code.push_back(jump);
+		return m_code.size() > 1;
+	}
+
+	static const bool IsSameReg(const platform::CPURegister* a, const platform::CPURegister* b)
+	{
+		return a && b && (a->GetNativeIndex() == b->GetNativeIndex());
+	}
+
+	// find the last instruction that modifies given register before given instruction, returns -1 if not found
+	const int FindDefinition(const platform::CPURegister* reg, const int before) const
+	{
+		for (int i = before - 1; i >= 0; --i)
+		{
+			const auto& info = m_code[i].m_info;
+			for (uint32 j = 0; j < info.m_registersModifiedCount; ++j)
+				if (IsSameReg(info.m_registersModified[j], reg))
+					return i;
+		}
+
+		return -1;
+	}
+
+	// compute the value of the register built from immediates
+	const bool ResolveConstant(const platform::CPURegister* reg, const int before, uint64& outValue) const
+	{
+		const int def = FindDefinition(reg, before);
+		if (def < 0)
+			return false;
+
+		const auto& op = m_code[def].m_op;
+		if (op.GetOpcode() == m_opLi)
+		{
+			outValue = CAddressCalculatorXenon::EXTS(op.GetArg1().m_imm);
+			return true;
+		}
+		else if (op.GetOpcode() == m_opLis)
+		{
+			outValue = CAddressCalculatorXenon::EXTS(op.GetArg1().m_imm << 16);
+			return true;
+		}
+
+		uint64 value = 0;
+		if (op.GetOpcode() == m_opAddi && ResolveConstant(op.GetArg1().m_reg, def, value))
+		{
+			outValue = value + CAddressCalculatorXenon::EXTS(op.GetArg2().m_imm);
+			return true;
+		}
+		else if (op.GetOpcode() == m_opAddis && ResolveConstant(op.GetArg1().m_reg, def, value))
+		{
+			outValue = value + CAddressCalculatorXenon::EXTS(op.GetArg2().m_imm << 16);
+			return true;
+		}
+		else if (op.GetOpcode() == m_opOri && ResolveConstant(op.GetArg1().m_reg, def, value))
+		{
+			outValue = value | op.GetArg2().m_imm;
+			return true;
+		}
+
+		return false;
+	}
+
+	// match "rlwinm reg, index, shift, 0, 31-shift" (index shifted to the table entry size)
+	const int MatchScaledIndex(const platform::CPURegister* reg, const int before, const uint32 shift, const platform::CPURegister*& outIndexReg) const
+	{
+		const int def = FindDefinition(reg, before);
+		if (def < 0)
+			return -1;
+
+		const auto& op = m_code[def].m_op;
+		if (op.GetOpcode() != m_opRlwinm)
+			return -1;
+		if (op.GetArg2().m_imm != shift || op.GetArg3().m_imm != 0 || op.GetArg4().m_imm != 31 - shift)
+			return -1;
+
+		outIndexReg = op.GetArg1().m_reg;
+		return def;
+	}
+
+	// match the table load, returns index of the load instruction or -1
+	const int MatchTableLoad(const int def, const uint32 entrySize, uint64& outTableAddress, const platform::CPURegister*& outIndexReg) const
+	{
+		const auto& op = m_code[def].m_op;
+		const auto& mem = op.GetArg1();
+		if (mem.m_type != decoding::Instruction::eType_Mem || !mem.m_reg || !mem.m_index)
+			return -1;
+
+		// table address may be in any of the registers
+		for (uint32 i = 0; i < 2; ++i)
+		{
+			const platform::CPURegister* tableReg = i ? mem.m_index : mem.m_reg;
+			const platform::CPURegister* offsetReg = i ? mem.m_reg : mem.m_index;
+			if (!ResolveConstant(tableReg, def, outTableAddress))
+				continue;
+
+			// byte tables use the index directly
+			if (entrySize == 1)
+			{
+				outIndexReg = offsetReg;
+				return def;
+			}
+
+			const uint32 shift = (entrySize == 4) ? 2 : 1;
+			if (MatchScaledIndex(offsetReg, def, shift, outIndexReg) >= 0)
+				return def;
+		}
+
+		return -1;
+	}
+
+	// match the range check of the index ("cmplwi crN, index, imm" + "bgt crN" or "bge crN"), returns number of the table entries
+	const uint32 MatchRangeCheck(const platform::CPURegister* indexReg, const int before) const
+	{
+		for (int i = before - 1; i >= 0; --i)
+		{
+			const auto& op = m_code[i].m_op;
+			if (op.GetOpcode() == m_opCmplwi && IsSameReg(op.GetArg1().m_reg, indexReg))
+			{
+				const int crIndex = op.GetArg0().m_reg->GetNativeIndex() - CPU_XenonPPC::eRegister_CR0;
+				const int ltIndex = CPU_XenonPPC::eRegister_CR0_LT + (crIndex * 4);
+
+				// the conditional jump to the default case
+				for (int j = i + 1; j < (int)m_code.size() - 1; ++j)
+				{
+					const auto& branch = m_code[j].m_op;
+					if (branch.GetOpcode() != m_opBc || !branch.GetArg1().m_reg)
+						continue;
+
+					const uint32 bo = branch.GetArg0().m_imm & 0x1C;
+					const int bit = branch.GetArg1().m_reg->GetNativeIndex();
+					if (bo == 0x0C && bit == ltIndex + 1) // bgt
+						return op.GetArg2().m_imm + 1;
+					if (bo == 0x04 && bit == ltIndex) // bge
+						return op.GetArg2().m_imm;
+				}
+
+				return 0;
+			}
+
+			// index changed after the check
+			const auto& info = m_code[i].m_info;
+			for (uint32 j = 0; j < info.m_registersModifiedCount; ++j)
+				if (IsSameReg(info.m_registersModified[j], indexReg))
+					return 0;
+		}
+
+		return 0;
+	}
+
+	const bool MatchPattern(uint64& outTableAddress, uint32& outEntrySize, uint32& outNumEntries, uint64& outBaseAddress) const
+	{
+		// mtctr rT
+		const int jumpIndex = (int)m_code.size() - 1;
+		const int mtctr = FindDefinition(m_code[jumpIndex].m_info.m_branchTargetReg, jumpIndex);
+		if (mtctr < 0 || m_code[mtctr].m_op.GetOpcode() != m_opMtspr)
+			return false;
+
+		const platform::CPURegister* targetReg = m_code[mtctr].m_op.GetArg1().m_reg;
+		const int targetDef = FindDefinition(targetReg, mtctr);
+		if (targetDef < 0)
+			return false;
+
+		const platform::CPURegister* indexReg = NULL;
+		int loadDef = -1;
+
+		const auto& op = m_code[targetDef].m_op;
+		if (op.GetOpcode() == m_opLwzx)
+		{
+			// absolute addresses: rlwinm r0, index, 2, 0, 29; lwzx rT, table, r0
+			loadDef = MatchTableLoad(targetDef, 4, outTableAddress, indexReg);
+			outEntrySize = 4;
+			outBaseAddress = 0;
+		}
+		else if (op.GetOpcode() == m_opAdd)
+		{
+			// offsets from the base: lbzx/lhzx r0, table, index; rlwinm r0, r0, 2, 0, 29; add rT, base, r0
+			for (uint32 i = 0; i < 2 && loadDef < 0; ++i)
+			{
+				const platform::CPURegister* baseReg = i ? op.GetArg2().m_reg : op.GetArg1().m_reg;
+				const platform::CPURegister* offsetReg = i ? op.GetArg1().m_reg : op.GetArg2().m_reg;
+				if (!ResolveConstant(baseReg, targetDef, outBaseAddress))
+					continue;
+
+				const platform::CPURegister* entryReg = NULL;
+				const int scaleDef = MatchScaledIndex(offsetReg, targetDef, 2, entryReg);
+				if (scaleDef < 0)
+					continue;
+
+				const int entryDef = FindDefinition(entryReg, scaleDef);
+				if (entryDef < 0)
+					continue;
+
+				if (m_code[entryDef].m_op.GetOpcode() == m_opLbzx)
+				{
+					loadDef = MatchTableLoad(entryDef, 1, outTableAddress, indexReg);
+					outEntrySize = 1;
+				}
+				else if (m_code[entryDef].m_op.GetOpcode() == m_opLhzx)
+				{
+					loadDef = MatchTableLoad(entryDef, 2, outTableAddress, indexReg);
+					outEntrySize = 2;
+				}
+			}
+		}
+
+		if (loadDef < 0 || !indexReg)
+			return false;
+
+		// table size
+		outNumEntries = MatchRangeCheck(indexReg, loadDef);
+		return (outNumEntries > 0) && (outNumEntries <= MAX_TABLE_ENTRIES);
+	}
+
+	const bool ReadTable(ILogOutput& log, const uint32 jumpAddress, const uint64 tableAddress, const uint32 entrySize, const uint32 numEntries, const uint64 baseAddress, std::vector<uint64>& outTargets) const
+	{
+		const auto image = m_context->GetImage();
+		const uint64 imageBase = image->GetBaseAddress();
+		if (tableAddress < imageBase || (tableAddress - imageBase) + (numEntries * entrySize) > image->GetMemorySize())
+		{
+			log.Warn("Decode: Jump table at %08llXh used by jump at %08Xh is outside image", tableAddress, jumpAddress);
+			return false;
+		}
+
+		const uint8* data = image->GetMemory() + (tableAddress - imageBase);
+		for (uint32 i = 0; i < numEntries; ++i, data += entrySize)
+		{
+			uint64 value = 0;
+			for (uint32 j = 0; j < entrySize; ++j)
+				value = (value << 8) | data[j];
+
+			// relative tables store offsets in instructions
+			const uint32 target = baseAddress ? (uint32)(baseAddress + (value << 2)) : (uint32)value;
+
+			const image::Section* section = image->FindSectionForOffset((uint32)(target - imageBase));
+			if ((target & 3) || target < imageBase || !section || !section->CanExecute())
+			{
+				log.Warn("Decode: Jump table at %08llXh used by jump at %08Xh has invalid target %08Xh", tableAddress, jumpAddress, target);
+				return false;
+			}
+
+			outTargets.push_back(target);
+		}
+
+		return true;
+	}
+};
+
+//---------------------------------------------------------------------------
+
 bool DecompilationXenon::DecodeImage(ILogOutput& log, class decoding::Context& context) const
 {
 	const auto image = context.GetImage();
@@ -831,6 +1229,59 @@ bool DecompilationXenon::DecodeImage(ILogOutput& log, class decoding::Context& c
 		}
 	}
 
+	// recover the jump tables used by the switch statements
+	if (returnStatus)
+	{
+		log.SetTaskName("Recovering jump tables...");
+
+		CJumpTableDetectorXenon detector(context);
+
+		// decode all executable sections
+		const uint32 numSections = image->GetNumSections();
+		for (uint32 i = 0; i < numSections; ++i)
+		{
+			const image::Section* section = image->GetSection(i);
+			if (!section->CanExecute())
+				continue;
+
+			// start decoding phase
+			log.SetTaskName("Recovering jump tables in section '%s'...", section->GetName().c_str());
+
+			// compute code range
+			const uint32 baseAddress = image->GetBaseAddress();
+			const uint32 sectionBaseAddress = baseAddress + section->GetVirtualOffset();
+			const uint32 endAddress = baseAddress + section->GetVirtualOffset() + section->GetVirtualSize();
+
+			// process all instructions in the code range
+			uint32 address = sectionBaseAddress;
+			while (address < endAddress)
+			{
+				// update progress
+				log.SetTaskProgress(address - sectionBaseAddress, endAddress - sectionBaseAddress);
+
+				// parse till the first invalid instruction is encountered
+				decoding::Instruction instr;
+				const uint32 instructionSize = context.DecodeInstruction(log, address, instr, false);
+				if (!instructionSize)
+					break;
+
+				// get extended instruction information (for branch target)
+				decoding::InstructionExtendedInfo info;
+				if (!instr.GetExtendedInfo(address, context, info))
+					break;
+
+				// look for the jump table
+				detector.Process(log, instr, address, info);
+
+				// advance
+				address += instructionSize;
+			}
+		}
+
+		// stats
+		log.Log("Decode: Recovered %d jump tables with %d targets", detector.m_numJumpTables, detector.m_numJumpTargets);
+	}
+
 	// scanning for mapped memory access
 	if (returnStatus)
 	{
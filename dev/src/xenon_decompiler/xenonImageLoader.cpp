@@ -1,8 +1,12 @@
 #include "xenonImageLoader.h"
+#include "xenonAES.h"
 #include "rijndael-alg-fst.h"
 #include "mspack.h"
 #include "lzx.h"
 #include <assert.h>
+#include <thread>
+#include <future>
+#include <atomic>
 
 #include "../recompiler_core/internalUtils.h"
 #include "../recompiler_core/platformDefinition.h"
@@ -540,28 +544,11 @@ namespace MSPack
 {
 	struct mspack_memory_file
 	{
-		mspack_system sys;
 		void *buffer;
 		uint32 buffer_size;
 		uint32 offset;
 	};
 
-	mspack_memory_file* mspack_memory_open(mspack_system *sys, void *buffer, const uint32 buffer_size )
-	{
-		mspack_memory_file *memfile = (mspack_memory_file *)calloc(1, sizeof(mspack_memory_file));
-		if (!memfile) return NULL;
-		memfile->buffer = buffer;
-		memfile->buffer_size = (off_t)buffer_size;
-		memfile->offset = 0;
-		return memfile;
-	}
-
-	void mspack_memory_close( mspack_memory_file *file )
-	{
-		mspack_memory_file *memfile = (mspack_memory_file *)file;
-		free(memfile);
-	}
-
 	int mspack_memory_read(struct mspack_file *file, void *buffer, int chars)
 	{
 		mspack_memory_file *memfile = (mspack_memory_file *)file;
@@ -597,71 +584,139 @@ namespace MSPack
 		memcpy(dest, src, chars);
 	}
 
-	mspack_system *mspack_memory_sys_create()
+	void mspack_memory_sys_init(mspack_system& sys)
 	{
-		mspack_system *sys = (mspack_system *)calloc(1, sizeof(mspack_system));
-		if (!sys) return NULL;
-		sys->read = mspack_memory_read;
-		sys->write = mspack_memory_write;
-		sys->alloc = mspack_memory_alloc;
-		sys->free = mspack_memory_free;
-		sys->copy = mspack_memory_copy;
-		return sys;
+		memset(&sys, 0, sizeof(sys));
+		sys.read = mspack_memory_read;
+		sys.write = mspack_memory_write;
+		sys.alloc = mspack_memory_alloc;
+		sys.free = mspack_memory_free;
+		sys.copy = mspack_memory_copy;
 	}
+} // MSPack
+
+namespace
+{
+	// part of the CBC stream decrypted by a single job
+	struct DecryptionJob
+	{
+		const uint8*	m_input;
+		uint8*			m_output;
+		const uint8*	m_iv;
+		uint32			m_size;
+	};
+
+	// CBC stream is split into jobs of this size
+	static const uint32 DECRYPTION_JOB_SIZE = 1 << 20;
 
-	void mspack_memory_sys_destroy(mspack_system *sys)
+	// IV at the start of the stream
+	static const uint8 DECRYPTION_ZERO_IV[16] = { 0 };
+
+	// add jobs for decrypting a range of the CBC stream, each job gets the preceding cipher block as the IV so they are independent
+	// input and output must not overlap, size must be a multiple of 16 bytes
+	static void AddDecryptionJobs( std::vector< DecryptionJob >& outJobs, const uint8* streamStart, const uint8* input, uint8* output, const uint32 size )
 	{
-		free(sys);
+		for ( uint32 offset=0; offset<size; offset += DECRYPTION_JOB_SIZE )
+		{
+			DecryptionJob job;
+			job.m_input = input + offset;
+			job.m_output = output + offset;
+			job.m_iv = (job.m_input > streamStart) ? (job.m_input - 16) : DECRYPTION_ZERO_IV;
+			job.m_size = std::min<uint32>( DECRYPTION_JOB_SIZE, size - offset );
+			outJobs.push_back( job );
+		}
 	}
-} // MSPack
 
+	// run the decryption jobs on all cores
+	static void RunDecryptionJobs( const XenonAESDecryptor& decryptor, const std::vector< DecryptionJob >& jobs )
+	{
+		const uint32 numJobs = (uint32) jobs.size();
+		const uint32 numWorkers = std::min<uint32>( numJobs, std::max<uint32>( 1, std::thread::hardware_concurrency() ) );
+
+		std::atomic<uint32> nextJob( 0 );
+		const auto workerFunc = [&]()
+		{
+			for (;;)
+			{
+				const uint32 jobIndex = nextJob++;
+				if ( jobIndex >= numJobs )
+					break;
+
+				const DecryptionJob& job = jobs[ jobIndex ];
+				decryptor.DecryptCBC( job.m_iv, job.m_input, job.m_output, job.m_size );
+			}
+		};
+
+		// not worth starting threads
+		if ( numWorkers <= 1 )
+		{
+			workerFunc();
+			return;
+		}
+
+		std::vector< std::future<void> > workers;
+		for ( uint32 i=0; i<numWorkers; ++i )
+			workers.push_back( std::async( std::launch::async, workerFunc ) );
+
+		for ( auto& worker : workers )
+			worker.wait();
+	}
+} // namespace
 
 bool ImageBinaryXEX::LoadImageDataNormal( ILogOutput& log, ImageByteReaderXEX& data )
 {
-	bool sucesss = false;
-
 	// Image source
 	const uint32 sourceSize = (uint32)(data.GetSize() - m_xexData.header.exe_offset);
 	const uint8* sourceBuffer = data.GetData() + m_xexData.header.exe_offset;
 
+	// Allocate the working buffer, the data is decrypted into it and then deblocked in place
+	uint8* compressData = (uint8*) malloc( sourceSize );
+	if ( !compressData )
+	{
+		log.Error( "Unable to allocate memory for compressed image" );
+		return false;
+	}
+
 	// Get data
-	uint32 imageSize = sourceSize;
 	const uint8* imageData = sourceBuffer;
 	if ( m_xexData.file_format_info.encryption_type == XEX_ENCRYPTION_NORMAL )
 	{
-		// allocate new buffer and decode it
-		imageData = (const uint8*) malloc( sourceSize );
-		memset( (void*)imageData, 0, sourceSize );
-		DecryptBuffer( m_xexData.session_key, sourceBuffer, sourceSize, (uint8*) imageData, imageSize );
+		DecryptBuffer( m_xexData.session_key, sourceBuffer, sourceSize, compressData, sourceSize );
+		imageData = compressData;
 		log.Log( "Decoded the encrypted XEX image using session key" );
 	}
 
-	// Allocate deblocked data
-	uint8* compressData = (uint8*) malloc( imageSize );
-
-	// Compute buffer size
+	// Compute buffer size, the chunks are moved together (the output never overtakes the input)
 	uint32 compressedSize = 0;
 	uint32 uncompressedSize = 0;
 	{
 		const uint8* p = imageData;
+		const uint8* end = imageData + sourceSize;
 		uint8* d = compressData;
 
 		uint32 blockSize = m_xexData.file_format_info.normal.block_size;
 		while ( blockSize )
 		{
+			if ( blockSize > (uint32)(end - p) || blockSize < 24 )
+			{
+				log.Error( "XEX: Compressed block at offset %u is outside the image data", (uint32)(p - imageData) );
+				free( compressData );
+				return false;
+			}
+
 			const uint8 *pnext = p + blockSize;
 			const uint32 nextSize = _byteswap_ulong( *(uint32*)p );
 			p += 4;
 			p += 20;  // skip 20b hash
 
-			while (true)
+			while ( p + 2 <= pnext )
 			{
 				const uint32 chunkSize = (p[0] << 8) | p[1];
 				p += 2;
-				if ( !chunkSize)
+				if ( !chunkSize || chunkSize > (uint32)(pnext - p) )
 					break;	
 
-				memcpy(d, p, chunkSize);
+				memmove(d, p, chunkSize);
 				p += chunkSize;
 				d += chunkSize;
 
@@ -684,102 +739,66 @@ bool ImageBinaryXEX::LoadImageDataNormal( ILogOutput& log, ImageByteReaderXEX& d
 	if ( !uncompressedImage)
 	{
 		log.Error( "Unable to allocate memory for uncompressed image" );
-		goto Cleanup;
-	}
-
-	// Setup decompressor and decompress.
-	mspack_system* sys = MSPack::mspack_memory_sys_create();
-	if ( !sys )
-	{
-		log.Error( "Unable to allocate decompression helper" );
-		goto Cleanup;
+		free( compressData );
+		return false;
 	}
 
-	// create source file
-	MSPack::mspack_memory_file* lzxsrc = MSPack::mspack_memory_open( sys, compressData, compressedSize);
-	if ( !lzxsrc )
-	{
-		log.Error( "Unable to allocate input decompression file" );
-		goto Cleanup;
-	}
+	// Setup decompressor, the compressed data is read directly from memory and the output goes straight to the image
+	mspack_system sys;
+	MSPack::mspack_memory_sys_init( sys );
 
-	// create destination file
-	MSPack::mspack_memory_file* lzxdst = MSPack::mspack_memory_open( sys, uncompressedImage, uncompressedSize);
-	if ( !lzxdst )
-	{
-		log.Error( "Unable to allocate output decompression file" );
-		goto Cleanup;
-	}
+	MSPack::mspack_memory_file lzxdst;
+	lzxdst.buffer = uncompressedImage;
+	lzxdst.buffer_size = uncompressedSize;
+	lzxdst.offset = 0;
 
 	// initialize decompression
-	lzxd_stream* lzxd = lzxd_init( sys, (mspack_file*) lzxsrc, (mspack_file *)lzxdst, m_xexData.file_format_info.normal.window_bits, 0, 32768, m_xexData.loader_info.image_size );
+	bool sucesss = false;
+	lzxd_stream* lzxd = lzxd_init( &sys, nullptr, (mspack_file *)&lzxdst, m_xexData.file_format_info.normal.window_bits, 0, 32768, m_xexData.loader_info.image_size );
 	if ( !lzxd )
 	{
 		log.Error( "Unable to initialize decompression helper" );
-		goto Cleanup;
 	}
-
-	// decompress
-	const int ret = lzxd_decompress( lzxd, (uint32) m_xexData.loader_info.image_size );
-	if ( ret != 0 )
+	else
 	{
-		log.Error( "Unable to decompression image data: %d", ret );
-		goto Cleanup;
-	}
-
-	// done
-	log.Log( "Image data decompressed" );
-	sucesss = true;
-
-	// set image data
-	m_memoryData = uncompressedImage;
-	m_memorySize = uncompressedSize;
-	uncompressedImage = nullptr;
-
-Cleanup:
-
-	if ( lzxd )
-	{
-		lzxd_free(lzxd);
-		lzxd = NULL;
-	}
-
-	if (lzxsrc)
-	{
-		MSPack::mspack_memory_close(lzxsrc);
-		lzxsrc = NULL;
-	}
-
-	if (lzxdst)
-	{
-		MSPack::mspack_memory_close(lzxdst);
-		lzxdst = NULL;
-	}
+		// decompress
+		lzxd_set_input_buffer( lzxd, compressData, compressedSize );
+		const int ret = lzxd_decompress( lzxd, (uint32) m_xexData.loader_info.image_size );
+		if ( ret != 0 )
+		{
+			log.Error( "Unable to decompression image data: %d", ret );
+		}
+		else
+		{
+			// done
+			log.Log( "Image data decompressed" );
+			sucesss = true;
+
+			// set image data
+			m_memoryData = uncompressedImage;
+			m_memorySize = uncompressedSize;
+			uncompressedImage = nullptr;
+		}
 
-	if (sys)
-	{
-		MSPack::mspack_memory_sys_destroy(sys);
-		sys = NULL;
+		lzxd_free( lzxd );
 	}
 
-	free(compressData);
-	free(uncompressedImage);
-
-	if (imageData != sourceBuffer) 
-		free((void *)imageData);
-
+	free( compressData );
+	free( uncompressedImage );
 	return sucesss;
 }
 
 bool ImageBinaryXEX::LoadImageDataBasic( ILogOutput& log, ImageByteReaderXEX& data )
 {
-	// calculate the uncompressed size
+	// calculate the uncompressed size and the size of the source data
 	uint32 memorySize = 0;
+	uint32 consumedSize = 0;
 	const uint32 blockCount = (uint32)m_xexData.file_format_info.basic_blocks.size();
 	for ( uint32 i=0; i<blockCount; ++i )
 	{
 		const XEXFileBasicCompressionBlock& block = m_xexData.file_format_info.basic_blocks[i];
 		memorySize += block.data_size + block.zero_size;
+		consumedSize += block.data_size;
 	}
 
 	// source data
@@ -796,6 +815,17 @@ bool ImageBinaryXEX::LoadImageDataBasic( ILogOutput& log, ImageByteReaderXEX& da
 		return false;
 	}
 
+	// check if all source data will be consumed
+	if ( consumedSize > sourceSize )
+	{
+		log.Error( "XEX: To much source data was consumed by block decompression (%d > %d)", consumedSize, sourceSize );
+		return false;
+	}
+	else if ( consumedSize < sourceSize )
+	{
+		log.Warn( "XEX: %d bytes of data was not consumed in block decompression (out of %d)", sourceSize - consumedSize, sourceSize );
+	}
+
 	// Allocate in-place the XEX memory.
 	uint8* memory = (uint8*) malloc( memorySize );
 	if ( nullptr == memory )
@@ -804,16 +834,13 @@ bool ImageBinaryXEX::LoadImageDataBasic( ILogOutput& log, ImageByteReaderXEX& da
 		return false;
 	}
 
-	// The decryption state is global for all blocks
-	uint32 rk[4 * (MAXNR + 1)];
-	uint8 ivec[16] = {0};
-	int Nr = rijndaelKeySetupDec(rk, m_xexData.session_key, 128);
-
 	// Destination memory pointers
 	uint8* destMemory = memory;
 	memset( memory, 0, memorySize );
 
-	// Copy/Decrypt blocks
+	// Copy blocks, encrypted blocks are a single CBC stream that is decrypted in parallel afterwards
+	const XEXEncryptionType encType = m_xexData.file_format_info.encryption_type;
+	std::vector< DecryptionJob > jobs;
 	for ( uint32 n=0; n<blockCount; n++)
 	{
 		// get the size of actual data and the zeros
@@ -822,7 +849,6 @@ bool ImageBinaryXEX::LoadImageDataBasic( ILogOutput& log, ImageByteReaderXEX& da
 		const uint32 zero_size = block.zero_size;
 
 		// decompress/copy data
-		const XEXEncryptionType encType = m_xexData.file_format_info.encryption_type;
 		switch ( encType )
 		{
 			// no encryption, copy data
@@ -835,21 +861,14 @@ bool ImageBinaryXEX::LoadImageDataBasic( ILogOutput& log, ImageByteReaderXEX& da
 			// AES
 			case XEX_ENCRYPTION_NORMAL:
 			{
-				const uint8 *ct = sourceBuffer;
-				uint8* pt = destMemory;
-				for ( uint32 n=0; n<data_size; n += 16, ct += 16, pt += 16)
+				if ( data_size & 15 )
 				{
-					// Decrypt 16 uint8_ts from input -> output.
-					rijndaelDecrypt(rk, Nr, ct, pt);
-
-					// XOR with previous
-					for ( uint32 i = 0; i < 16; i++ )
-					{
-						pt[i] ^= ivec[i];
-						ivec[i] = ct[i];
-					}
+					log.Error( "XEX: Encrypted block %u has size %u that is not a multiple of the cipher block size", n, data_size );
+					free( memory );
+					return false;
 				}
 
+				AddDecryptionJobs( jobs, data.GetData() + m_xexData.header.exe_offset, sourceBuffer, destMemory, data_size );
 				break;
 			}
         }
@@ -859,30 +878,11 @@ bool ImageBinaryXEX::LoadImageDataBasic( ILogOutput& log, ImageByteReaderXEX& da
 		destMemory += data_size + zero_size;
 	}
 
-	// check if all source data was consumed
-	const uint32 consumed = (uint32)(sourceBuffer - data.GetData());
-	if ( consumed > data.GetSize() )
+	// decrypt
+	if ( !jobs.empty() )
 	{
-		log.Error( "XEX: To much source data was consumed by block decompression (%d > %d)", consumed, data.GetSize() );
-		free( memory );
-		return false;
-	}
-	else if ( consumed < data.GetSize() )
-	{
-		log.Warn( "XEX: %d bytes of data was not consumed in block decompression (out of %d)", data.GetSize() - consumed, data.GetSize() );
-	}
-
-	// check if all data was outputed
-	const uint32 numOutputed = (uint32)(destMemory - memory);
-	if ( numOutputed > memorySize )
-	{
-		log.Error( "XEX: To much data was outputed in block decompression (%d > %d)", numOutputed, memorySize );
-		free( memory );
-		return false;
-	}
-	else if ( numOutputed < memorySize )
-	{
-		log.Warn( "XEX: %d bytes of data was not outputed in block decompression (out of %d)", memorySize - numOutputed, memorySize );
+		const XenonAESDecryptor decryptor( m_xexData.session_key );
+		RunDecryptionJobs( decryptor, jobs );
 	}
 
 	// loaded
@@ -894,6 +894,9 @@ bool ImageBinaryXEX::LoadImageDataBasic( ILogOutput& log, ImageByteReaderXEX& da
 
 bool ImageBinaryXEX::LoadImageData( ILogOutput& log, ImageByteReaderXEX& data )
 {
+	if ( m_xexData.file_format_info.encryption_type == XEX_ENCRYPTION_NORMAL )
+		log.Log( "XEX: Using %hs AES decryption", XenonAESDecryptor::HasHardwareSupport() ? "hardware (AES-NI)" : "software" );
+
 	// decompress and decrypt
 	const XEXCompressionType compType = m_xexData.file_format_info.compression_type;
 	switch ( compType )
@@ -1235,27 +1238,21 @@ bool ImageBinaryXEX::DecryptBuffer( const uint8* key, const uint8* inputData, co
 		return true;
 	}
 
-	// AES encryption
-	uint32 rk[4 * (MAXNR + 1)];
-	uint8 ivec[16] = {0};
-
-	int32 nr = rijndaelKeySetupDec(rk, key, 128);
-	const uint8* ct = inputData;
-	uint8* pt = outputData;
-
-	for ( uint32 n=0; n<inputSize; n += 16, ct += 16, pt += 16 )
+	if ( outputSize < inputSize )
 	{
-	    // Decrypt 16 uint8_ts from input -> output.
-	    rijndaelDecrypt(rk, nr, ct, pt);
-
-		// XOR with previous
-		for ( uint32 i=0; i<16; i++)
-		{
-			pt[i] ^= ivec[i];
-			ivec[i] = ct[i];
-		}
+		return false;
 	}
 
+	// AES encryption, the whole buffer is a single CBC stream
+	const uint32 alignedSize = inputSize & ~15;
+	std::vector< DecryptionJob > jobs;
+	AddDecryptionJobs( jobs, inputData, inputData, outputData, alignedSize );
+
+	const XenonAESDecryptor decryptor( key );
+	RunDecryptionJobs( decryptor, jobs );
+
+	// partial block at the end can't be decrypted, copy it as it is
+	memcpy( outputData + alignedSize, inputData + alignedSize, inputSize - alignedSize );
 	return true;
 }
 
@@ -1,1223 +1,1004 @@
-#include "xenonCPU.h"
+#include "xenonInstructionDecodingHelpers.h"
 
-#pragma optimize ("",off)
 //---------------------------------------------------------------------------
 
-#define REPORT_DECODING_ERRORS
+// instruction fields available in every decoding function, the unused ones are optimized out
+#define DECODING_FIELDS														\
+	const BitField<0,6> opcd(instrWord);										\
+	const BitField<30,1> aa(instrWord);											\
+	const BitField<31,1> lk(instrWord);											\
+	const BitField<6,5> b6(instrWord);											\
+	const BitField<6,2> b6x2(instrWord);										\
+	const BitField<11,5> b11(instrWord);										\
+	const BitField<11,1> b11x1(instrWord);										\
+	const BitField<16,5> b16(instrWord);										\
+	const BitField<21,5> b21(instrWord);										\
+	const BitField<9,2> b9x2(instrWord);										\
+	const BitField<21,10> xo21(instrWord);										\
+																				\
+	const BitField<6,24,true,2> li(instrWord); /* immediate value */			\
+	const BitField<16,14,true,2> bd(instrWord); /* branch destination */		\
+	const BitField<19,1> bh(instrWord);											\
+	const BitField<6,3> bf(instrWord);											\
+	const BitField<11,3> bfa(instrWord);										\
+	const BitField<20,7> lev(instrWord);										\
+	const BitField<16,16,true> d(instrWord);									\
+	const BitField<16,14,true> ds(instrWord);									\
+	const BitField<16,14,true,2> ds4(instrWord);								\
+	const BitField<16,16,true> si(instrWord);									\
+	const BitField<16,16> ui(instrWord);										\
+	const BitField<21,1> oe(instrWord);											\
+	const BitField<31,1> rc(instrWord);											\
+																				\
+	const BitField<16,5> sh16(instrWord);										\
+	const BitField<21,5> mb21(instrWord);										\
+	const BitField<26,1> mb26x1(instrWord);										\
+	const BitField<26,5> me26(instrWord);										\
+	const BitField<11,10> spr(instrWord);										\
+	const BitField<11,5> spr11(instrWord);										\
+	const BitField<16,5> spr16(instrWord);										\
+	const BitField<12,8> fxm(instrWord);										\
+	const BitField<16,4> u16x4(instrWord);										\
+	const BitField<7,7> flm(instrWord);											\
+	const BitField<16,4> frb(instrWord);										\
+																				\
+	/* big shift values */														\
+	const BitField<28,2,false,5> vshift28(instrWord); /* *32 */					\
+	const BitField<30,2,false,5> vshift30(instrWord); /* *32 */					\
+	const BitField<21,1,false,6> vshift26a(instrWord); /* *64 */				\
+	const BitField<26,1,false,5> vshift26b(instrWord); /* *32 */				\
+																				\
+	/* extended regs (full 128 regs) */											\
+	const platform::CPURegister* vreg6 = VREG(vshift28 + b6);					\
+	const platform::CPURegister* vreg11 = VREG(vshift26a + vshift26b + b11);	\
+	const platform::CPURegister* vreg16 = VREG(vshift30 + b16);					\
+																				\
+	/* extended opcodes */														\
+	const BitField<26,6> vxo26(instrWord);										\
+	const BitField<21,11> vxo21(instrWord);										\
+	const BitField<21,7> vxo21e(instrWord);										\
+	const BitField<30,2> vxo30(instrWord);										\
+	const BitField<27,1> vxo27b1(instrWord);									\
+	const BitField<22,4> vxo22b4(instrWord);									\
+	const BitField<22,4> vxo22(instrWord);										\
+	const BitField<27,1> vxo27(instrWord);										\
+	const BitField<11,3> b11x3(instrWord);										\
+	const BitField<10,1> l(instrWord);											\
+	const BitField<27,3> xo27(instrWord);										\
+	const BitField<27,4> xo27x4(instrWord);										\
+	const BitField<21,11> xo21ext(instrWord);									\
+	const BitField<22,9> xo22(instrWord);										\
+	const BitField<26,5> xo26(instrWord);										\
+																				\
+	const uint32 pri = opcd.Get();
 
-//---------------------------------------------------------------------------
+// decoding function, returns size of the decoded instruction or 0 if the instruction is not valid
+#define DECODER(...) [](const CPU_XenonPPC* self, const uint32 instrWord, decoding::Instruction& outOp, const bool reportErrors) -> uint32 { DECODING_FIELDS __VA_ARGS__ }
 
-template< const uint32 bestart, const uint32 length, const bool signExtend = false, const int shift = 0 >
-class BitField
+void CPU_XenonPPC::AddDecoder(const uint32 primary, const uint32 xoStart, const uint32 xoLength, const uint32 xo, TDecodingFunction func)
 {
-public:
-	static const uint32 start = (32-bestart) - length;
-
-	BitField(const uint32 input)
-	{
-		const uint32 mask = ((1<<length) - 1);
-		uint32 bitSize = length;
-		uint32 ext = (input >> start) & mask;
-
-		// additional left shift
-		if (shift > 0)
-		{
-			ext <<= shift;
-			bitSize += shift;
-		}
-
-		// if signed expand copy the sign bit
-		if (signExtend)
-		{
-			const uint32 signBitValue = ext & (1 << (bitSize-1));
-			if (signBitValue != 0)
-			{
-				const uint32 signMask = ((uint32)-1) << bitSize;
-				ext |= signMask;
-			}
-		}
-
-		// right shift (always do that after sign conversion)
-		if (shift < 0)
-		{
-			ext >>= (-shift);
-		}
-
-		// save value
-		m_val = ext;
-	}
-
-	inline const uint32 Get() const
-	{
-		return m_val;
-	}
+	const uint32 shift = (32 - xoStart) - xoLength;
+	const uint32 mask = (1 << xoLength) - 1;
 
-	inline operator uint32() const
+	// consecutive entries for the same extended opcode field go to the same table, tables are matched in the order they were created
+	auto& tables = m_decoding[primary].m_tables;
+	if (tables.empty() || tables.back().m_shift != shift || tables.back().m_mask != mask)
 	{
-		return m_val;
+		DecodingTable table;
+		table.m_shift = shift;
+		table.m_mask = mask;
+		table.m_functions.resize(mask + 1, nullptr);
+		tables.push_back(table);
 	}
 
-private:
-	uint32 m_val;
-};
-
-#ifdef REPORT_DECODING_ERRORS
-
-	extern "C" __declspec(dllimport) void __stdcall OutputDebugStringA(const char* lpOutputString);
-	extern "C" __declspec(dllimport) void __stdcall DebugBreak();
-
-	void ReportDecodingError(const char* txt, ...)
-	{
-		char buf[512];
-		va_list args;
-
-		va_start(args, txt);
-		vsprintf_s(buf, txt, args);
-		va_end(args);
-
-		strcat_s(buf, "\n");
-		OutputDebugStringA(buf);
-		//DebugBreak();
-	}
-
-	#define ERROR(x,...) ReportDecodingError(x, __VA_ARGS__); return false;
-
-#else
-
-	#define ERROR(x,...) return false;
-
-#endif
-
-template< typename T >
-static decoding::Instruction::Operand MakeOperand( T data )
-{
-	decoding::Instruction::Operand ret;
-	ret.m_type = decoding::Instruction::eType_None;
-	return ret;
+	tables.back().m_functions[xo & mask] = func;
 }
 
-template<>
-static decoding::Instruction::Operand MakeOperand( const uint32 data )
+void CPU_XenonPPC::SetDefaultDecoder(const uint32 primary, TDecodingFunction func)
 {
-	decoding::Instruction::Operand ret;
-	ret.m_type = decoding::Instruction::eType_Imm;
-	ret.m_imm = data;
-	return ret;
+	m_decoding[primary].m_default = func;
 }
 
-template< const uint32 bestart, const uint32 length, const bool signExtend, const int shift >
-static decoding::Instruction::Operand MakeOperand( const BitField<bestart, length, signExtend, shift> data )
+void CPU_XenonPPC::BuildDecodingTables()
 {
-	decoding::Instruction::Operand ret;
-	ret.m_type = decoding::Instruction::eType_Imm;
-	ret.m_imm = (uint32)data;
-	return ret;
-}
-
-template<>
-static decoding::Instruction::Operand MakeOperand( const platform::CPURegister* reg )
-{
-	decoding::Instruction::Operand ret;
-
-	if (!reg)
-	{
-		ret.m_type = decoding::Instruction::eType_Imm;
-		ret.m_imm = 0;
-	}
-	else
+	// unmatched primary opcodes
+	for (uint32 i=0; i<64; ++i)
 	{
-		ret.m_type = decoding::Instruction::eType_Reg;
-		ret.m_reg = reg;
+		SetDefaultDecoder( i, DECODER( ERROR("Decode: Unmatched primary opcode %d", pri); ) );
 	}
 
-	return ret;
-}
-
-template<>
-static decoding::Instruction::Operand MakeOperand( const MemReg memreg )
-{
-	decoding::Instruction::Operand ret;
-	ret.m_type = decoding::Instruction::eType_Mem;
-	ret.m_reg = memreg.m_reg;
-	ret.m_index = memreg.m_index;
-	ret.m_imm = memreg.m_offset;
-	ret.m_scale = 1;
-	return ret;
-}
-
-static inline void SetupInstruction(decoding::Instruction& outOp, const platform::CPUInstruction* opcode)
-{
-	outOp.Setup(4, opcode);
-}
-
-template<typename Arg0>
-static inline void SetupInstruction(decoding::Instruction& outOp, const platform::CPUInstruction* opcode, Arg0 arg0)
-{
-	outOp.Setup(4, opcode, MakeOperand(arg0));
-}
-
-template<typename Arg0, typename Arg1>
-static inline void SetupInstruction(decoding::Instruction& outOp, const platform::CPUInstruction* opcode, Arg0 arg0, Arg1 arg1)
-{
-	outOp.Setup(4, opcode, MakeOperand(arg0), MakeOperand(arg1));
-}
-
-template<typename Arg0, typename Arg1, typename Arg2>
-static inline void SetupInstruction(decoding::Instruction& outOp, const platform::CPUInstruction* opcode, Arg0 arg0, Arg1 arg1, Arg2 arg2)
-{
-	outOp.Setup(4, opcode, MakeOperand(arg0), MakeOperand(arg1), MakeOperand(arg2));
-}
-
-template<typename Arg0, typename Arg1, typename Arg2, typename Arg3>
-static inline void SetupInstruction(decoding::Instruction& outOp, const platform::CPUInstruction* opcode, Arg0 arg0, Arg1 arg1, Arg2 arg2, Arg3 arg3)
-{
-	outOp.Setup(4, opcode, MakeOperand(arg0), MakeOperand(arg1), MakeOperand(arg2), MakeOperand(arg3));
-}
-
-template<typename Arg0, typename Arg1, typename Arg2, typename Arg3, typename Arg4>
-static inline void SetupInstruction(decoding::Instruction& outOp, const platform::CPUInstruction* opcode, Arg0 arg0, Arg1 arg1, Arg2 arg2, Arg3 arg3, Arg4 arg4)
-{
-	outOp.Setup(4, opcode, MakeOperand(arg0), MakeOperand(arg1), MakeOperand(arg2), MakeOperand(arg3), MakeOperand(arg4));
-}
-
-template<typename Arg0, typename Arg1, typename Arg2, typename Arg3, typename Arg4, typename Arg5>
-static inline void SetupInstruction(decoding::Instruction& outOp, const platform::CPUInstruction* opcode, Arg0 arg0, Arg1 arg1, Arg2 arg2, Arg3 arg3, Arg4 arg4, Arg5 arg5)
-{
-	outOp.Setup(4, opcode, MakeOperand(arg0), MakeOperand(arg1), MakeOperand(arg2), MakeOperand(arg3), MakeOperand(arg4), MakeOperand(arg5));
-}
-
-#define CHECK(x) { if (!(x)) { ERROR("Decode: Usupported instruction format for opcode %d", pri); return false; } }
-#define EMIT(opname, ...) { SetupInstruction(outOp, m_opMap[ eInstruction_##opname ], __VA_ARGS__ ); return 4; }
-
-#define EMIT_RC(opname, ...)							\
-	if (!rc) EMIT(opname, __VA_ARGS__ );				\
-	EMIT(##opname##RC, __VA_ARGS__);
-
-#define EMIT_MATH(opname, ...)							\
-	if (!oe && !rc) EMIT(opname, __VA_ARGS__ );			\
-	if (!oe && rc) EMIT(##opname##RC, __VA_ARGS__);		\
-	if (oe && !rc) EMIT(##opname##o, __VA_ARGS__);		\
-	EMIT(##opname##oRC, __VA_ARGS__ );
-
-static inline uint32 EndianReverse32( const uint32 v )
-{
-	uint32 ret;
-	const uint8* p = (const uint8*)&v;
-	uint8* q = (uint8*)&ret;
-	q[0] = p[3]; 
-	q[1] = p[2]; 
-	q[2] = p[1]; 
-	q[3] = p[0];
-	return ret;
-}
-
-uint32 CPU_XenonPPC::DecodeInstruction(const uint8* inputStream, class decoding::Instruction& outOp) const	
-{
-	const uint32 instrWord = EndianReverse32( *(const uint32*)inputStream );
-
-	const BitField<0,6> opcd(instrWord);
-	const BitField<30,1> aa(instrWord);
-	const BitField<31,1> lk(instrWord);
-	const BitField<6,5> b6(instrWord);
-	const BitField<6,2> b6x2(instrWord);
-	const BitField<11,5> b11(instrWord);
-	const BitField<11,1> b11x1(instrWord);
-	const BitField<16,5> b16(instrWord);
-	const BitField<21,5> b21(instrWord);
-	const BitField<9,2> b9x2(instrWord);
-	const BitField<21,10> xo21(instrWord);
-
-	const BitField<6,24,true,2> li(instrWord); // immediate value
-	const BitField<16,14,true,2> bd(instrWord); // branch destination
-	const BitField<19,1> bh(instrWord);
-	const BitField<6,3> bf(instrWord);
-	const BitField<11,3> bfa(instrWord);
-	const BitField<20,7> lev(instrWord);
-	const BitField<16,16,true> d(instrWord);
-	const BitField<16,14,true> ds(instrWord);
-	const BitField<16,14,true,2> ds4(instrWord);
-	const BitField<16,16,true> si(instrWord);
-	const BitField<16,16> ui(instrWord);
-	const BitField<21,1> oe(instrWord);
-	const BitField<31,1> rc(instrWord);
-
-	const BitField<16,5> sh16(instrWord);
-	const BitField<21,5> mb21(instrWord);
-	const BitField<26,1> mb26x1(instrWord);
-	const BitField<26,5> me26(instrWord);
-	const BitField<11,10> spr(instrWord);
-	const BitField<11,5> spr11(instrWord);
-	const BitField<16,5> spr16(instrWord);
-	const BitField<12,8> fxm(instrWord);
-	const BitField<16,4> u16x4(instrWord);
-	const BitField<7,7> flm(instrWord);
-	const BitField<16,4> frb(instrWord);
-
-	// or nops/moves
-	if (opcd == 31 && xo21 == 444 && b11==b16 && b11==b6 && !rc)
-	{
-		EMIT(nop);
-	}
-	else if (opcd == 31 && xo21 == 444 && b6==b16 && b11!=b6 && !rc)
-	{
-		EMIT(mr, REG(b11), REG(b6));
-	}
-
-	// big shift values
-	const BitField<28,2,false,5> vshift28(instrWord); // *32
-	const BitField<30,2,false,5> vshift30(instrWord); // *32
-	const BitField<21,1,false,6> vshift26a(instrWord); // *64
-	const BitField<26,1,false,5> vshift26b(instrWord); // *32
-
-	// extended regs (full 128 regs)
-	const platform::CPURegister* vreg6 = VREG(vshift28 + b6);
-	const platform::CPURegister* vreg11 = VREG(vshift26a + vshift26b + b11);
-	const platform::CPURegister* vreg16 = VREG(vshift30 + b16);
-
-	// match by primary opcode
-	const uint32 pri = opcd.Get();
-	switch (pri)
-	{
-		default: ERROR("Decode: Unmatched primary opcode %d", pri);
-
-		// nop
-		case 0: EMIT(nop);
-
-		// tdi, twi
-		case 2: EMIT(tdi, b6, REG(b11), si);
-		case 3: EMIT(twi, b6, REG(b11), si);
-
-		// VMX
-		case 4:
+	// NOTE: instructions are matched by the first table (in order of declaration) that has an entry for them, keep the order when adding new instructions
+
+	// nop
+	SetDefaultDecoder( 0, DECODER( EMIT(nop); ) );
+
+	// tdi, twi
+	SetDefaultDecoder( 2, DECODER( EMIT(tdi, b6, REG(b11), si); ) );
+	SetDefaultDecoder( 3, DECODER( EMIT(twi, b6, REG(b11), si); ) );
+
+	// VMX, full opcode
+
+	// move to/from special reg
+	AddDecoder( 4, 21, 11, 1540, DECODER( CHECK(b11==0); CHECK(b16==0); EMIT(mfvscr, VREG(b6)); ) );
+	AddDecoder( 4, 21, 11, 1604, DECODER( CHECK(b6==0); CHECK(b11==0); EMIT(mtvscr, VREG(b16)); ) );
+
+	// vadd
+	AddDecoder( 4, 21, 11, 384, DECODER( EMIT(vaddcuw, VREG(b6), VREG(b11), VREG(b16)); ) );
+	AddDecoder( 4, 21, 11, 10, DECODER( EMIT(vaddfp, VREG(b6), VREG(b11), VREG(b16)); ) );
+	AddDecoder( 4, 21, 11, 768, DECODER( EMIT(vaddsbs, VREG(b6), VREG(b11), VREG(b16)); ) );
+	AddDecoder( 4, 21, 11, 832, DECODER( EMIT(vaddshs, VREG(b6), VREG(b11), VREG(b16)); ) );
+	AddDecoder( 4, 21, 11, 896, DECODER( EMIT(vaddsws, VREG(b6), VREG(b11), VREG(b16)); ) );
+	AddDecoder( 4, 21, 11, 0, DECODER( EMIT(vaddubm, VREG(b6), VREG(b11), VREG(b16)); ) );
+	AddDecoder( 4, 21, 11, 512, DECODER( EMIT(vaddubs, VREG(b6), VREG(b11), VREG(b16)); ) );
+	AddDecoder( 4, 21, 11, 64, DECODER( EMIT(vadduhm, VREG(b6), VREG(b11), VREG(b16)); ) );
+	AddDecoder( 4, 21, 11, 576, DECODER( EMIT(vadduhs, VREG(b6), VREG(b11), VREG(b16)); ) );
+	AddDecoder( 4, 21, 11, 128, DECODER( EMIT(vadduwm, VREG(b6), VREG(b11), VREG(b16)); ) );
+	AddDecoder( 4, 21, 11, 640, DECODER( EMIT(vadduws, VREG(b6), VREG(b11), VREG(b16)); ) );
+
+	AddDecoder( 4, 21, 11, 1408, DECODER( EMIT(vsubcuw, VREG(b6), VREG(b11), VREG(b16)); ) );
+	AddDecoder( 4, 21, 11, 1792, DECODER( EMIT(vsubsbs, VREG(b6), VREG(b11), VREG(b16)); ) );
+	AddDecoder( 4, 21, 11, 1856, DECODER( EMIT(vsubshs, VREG(b6), VREG(b11), VREG(b16)); ) );
+	AddDecoder( 4, 21, 11, 1920, DECODER( EMIT(vsubsws, VREG(b6), VREG(b11), VREG(b16)); ) );
+	AddDecoder( 4, 21, 11, 1024, DECODER( EMIT(vsububm, VREG(b6), VREG(b11), VREG(b16)); ) );
+	AddDecoder( 4, 21, 11, 1536, DECODER( EMIT(vsububs, VREG(b6), VREG(b11), VREG(b16)); ) );
+	AddDecoder( 4, 21, 11, 1088, DECODER( EMIT(vsubuhm, VREG(b6), VREG(b11), VREG(b16)); ) );
+	AddDecoder( 4, 21, 11, 1600, DECODER( EMIT(vsubuhs, VREG(b6), VREG(b11), VREG(b16)); ) );
+	AddDecoder( 4, 21, 11, 1152, DECODER( EMIT(vsubuwm, VREG(b6), VREG(b11), VREG(b16)); ) );
+	AddDecoder( 4, 21, 11, 1664, DECODER( EMIT(vsubuws, VREG(b6), VREG(b11), VREG(b16)); ) );
+
+	AddDecoder( 4, 21, 11, 1028, DECODER( EMIT(vand, VREG(b6), VREG(b11), VREG(b16)); ) );
+	AddDecoder( 4, 21, 11, 1092, DECODER( EMIT(vandc, VREG(b6), VREG(b11), VREG(b16)); ) );
+	AddDecoder( 4, 21, 11, 1282, DECODER( EMIT(vavgsb, VREG(b6), VREG(b11), VREG(b16)); ) );
+	AddDecoder( 4, 21, 11, 1346, DECODER( EMIT(vavgsh, VREG(b6), VREG(b11), VREG(b16)); ) );
+	AddDecoder( 4, 21, 11, 1410, DECODER( EMIT(vavgsw, VREG(b6), VREG(b11), VREG(b16)); ) );
+	AddDecoder( 4, 21, 11, 1026, DECODER( EMIT(vavgub, VREG(b6), VREG(b11), VREG(b16)); ) );
+	AddDecoder( 4, 21, 11, 1090, DECODER( EMIT(vavguh, VREG(b6), VREG(b11), VREG(b16)); ) );
+	AddDecoder( 4, 21, 11, 1154, DECODER( EMIT(vavguw , VREG(b6), VREG(b11), VREG(b16)); ) );
+
+	AddDecoder( 4, 21, 11, 970, DECODER( EMIT(vctsxs, VREG(b6), VREG(b16), b11); ) );
+	AddDecoder( 4, 21, 11, 906, DECODER( EMIT(vctuxs, VREG(b6), VREG(b16), b11); ) );
+	AddDecoder( 4, 21, 11, 842, DECODER( EMIT(vcfsx, VREG(b6), VREG(b16), b11); ) );
+	AddDecoder( 4, 21, 11, 778, DECODER( EMIT(vcfux, VREG(b6), VREG(b16), b11); ) );
+
+	AddDecoder( 4, 21, 11, 966, DECODER( EMIT(vcmpbfp, VREG(b6), VREG(b11), VREG(b16)); ) );
+	AddDecoder( 4, 21, 11, 1990, DECODER( EMIT(vcmpbfpRC, VREG(b6), VREG(b11), VREG(b16)); ) );
+
+	AddDecoder( 4, 21, 11, 198, DECODER( EMIT(vcmpeqfp, VREG(b6), VREG(b11), VREG(b16)); ) );
+	AddDecoder( 4, 21, 11, 1222, DECODER( EMIT(vcmpeqfpRC, VREG(b6), VREG(b11), VREG(b16)); ) );
+	AddDecoder( 4, 21, 11, 6, DECODER( EMIT(vcmpequb, VREG(b6), VREG(b11), VREG(b16)); ) );
+	AddDecoder( 4, 21, 11, 1030, DECODER( EMIT(vcmpequbRC, VREG(b6), VREG(b11), VREG(b16)); ) );
+	AddDecoder( 4, 21, 11, 70, DECODER( EMIT(vcmpequh, VREG(b6), VREG(b11), VREG(b16)); ) );
+	AddDecoder( 4, 21, 11, 1094, DECODER( EMIT(vcmpequhRC, VREG(b6), VREG(b11), VREG(b16)); ) );
+	AddDecoder( 4, 21, 11, 134, DECODER( EMIT(vcmpequw, VREG(b6), VREG(b11), VREG(b16)); ) );
+	AddDecoder( 4, 21, 11, 1158, DECODER( EMIT(vcmpequwRC, VREG(b6), VREG(b11), VREG(b16)); ) );
+	AddDecoder( 4, 21, 11, 454, DECODER( EMIT(vcmpgefp, VREG(b6), VREG(b11), VREG(b16)); ) );
+	AddDecoder( 4, 21, 11, 1478, DECODER( EMIT(vcmpgefpRC, VREG(b6), VREG(b11), VREG(b16)); ) );
+	AddDecoder( 4, 21, 11, 710, DECODER( EMIT(vcmpgtfp, VREG(b6), VREG(b11), VREG(b16)); ) );
+	AddDecoder( 4, 21, 11, 1734, DECODER( EMIT(vcmpgtfpRC, VREG(b6), VREG(b11), VREG(b16)); ) );
+	AddDecoder( 4, 21, 11, 774, DECODER( EMIT(vcmpgtsb, VREG(b6), VREG(b11), VREG(b16)); ) );
+	AddDecoder( 4, 21, 11, 1798, DECODER( EMIT(vcmpgtsbRC, VREG(b6), VREG(b11), VREG(b16)); ) );
+	AddDecoder( 4, 21, 11, 838, DECODER( EMIT(vcmpgtsh, VREG(b6), VREG(b11), VREG(b16)); ) );
+	AddDecoder( 4, 21, 11, 1862, DECODER( EMIT(vcmpgtshRC, VREG(b6), VREG(b11), VREG(b16)); ) );
+	AddDecoder( 4, 21, 11, 902, DECODER( EMIT(vcmpgtsw, VREG(b6), VREG(b11), VREG(b16)); ) );
+	AddDecoder( 4, 21, 11, 1926, DECODER( EMIT(vcmpgtswRC, VREG(b6), VREG(b11), VREG(b16)); ) );
+	AddDecoder( 4, 21, 11, 518, DECODER( EMIT(vcmpgtub, VREG(b6), VREG(b11), VREG(b16)); ) );
+	AddDecoder( 4, 21, 11, 1542, DECODER( EMIT(vcmpgtubRC, VREG(b6), VREG(b11), VREG(b16)); ) );
+	AddDecoder( 4, 21, 11, 582, DECODER( EMIT(vcmpgtuh, VREG(b6), VREG(b11), VREG(b16)); ) );
+	AddDecoder( 4, 21, 11, 1606, DECODER( EMIT(vcmpgtuhRC, VREG(b6), VREG(b11), VREG(b16)); ) );
+	AddDecoder( 4, 21, 11, 646, DECODER( EMIT(vcmpgtuw, VREG(b6), VREG(b11), VREG(b16)); ) );
+	AddDecoder( 4, 21, 11, 1670, DECODER( EMIT(vcmpgtuwRC, VREG(b6), VREG(b11), VREG(b16)); ) );
+
+	AddDecoder( 4, 21, 11, 394, DECODER( CHECK(b11==0); EMIT(vexptefp, VREG(b6), VREG(b16)); ) );
+	AddDecoder( 4, 21, 11, 458, DECODER( CHECK(b11==0); EMIT(vlogefp, VREG(b6), VREG(b16)); ) );
+
+	AddDecoder( 4, 21, 11, 1034, DECODER( EMIT(vmaxfp, VREG(b6), VREG(b11), VREG(b16)); ) );
+	AddDecoder( 4, 21, 11, 258, DECODER( EMIT(vmaxsb, VREG(b6), VREG(b11), VREG(b16)); ) );
+	AddDecoder( 4, 21, 11, 322, DECODER( EMIT(vmaxsh, VREG(b6), VREG(b11), VREG(b16)); ) );
+	AddDecoder( 4, 21, 11, 386, DECODER( EMIT(vmaxsw, VREG(b6), VREG(b11), VREG(b16)); ) );
+	AddDecoder( 4, 21, 11, 2, DECODER( EMIT(vmaxub, VREG(b6), VREG(b11), VREG(b16)); ) );
+	AddDecoder( 4, 21, 11, 66, DECODER( EMIT(vmaxuh, VREG(b6), VREG(b11), VREG(b16)); ) );
+	AddDecoder( 4, 21, 11, 130, DECODER( EMIT(vmaxuw, VREG(b6), VREG(b11), VREG(b16)); ) );
+	AddDecoder( 4, 21, 11, 1098, DECODER( EMIT(vminfp, VREG(b6), VREG(b11), VREG(b16)); ) );
+	AddDecoder( 4, 21, 11, 770, DECODER( EMIT(vminsb, VREG(b6), VREG(b11), VREG(b16)); ) );
+	AddDecoder( 4, 21, 11, 834, DECODER( EMIT(vminsh, VREG(b6), VREG(b11), VREG(b16)); ) );
+	AddDecoder( 4, 21, 11, 898, DECODER( EMIT(vminsw, VREG(b6), VREG(b11), VREG(b16)); ) );
+	AddDecoder( 4, 21, 11, 514, DECODER( EMIT(vminub, VREG(b6), VREG(b11), VREG(b16)); ) );
+	AddDecoder( 4, 21, 11, 578, DECODER( EMIT(vminuh, VREG(b6), VREG(b11), VREG(b16)); ) );
+	AddDecoder( 4, 21, 11, 642, DECODER( EMIT(vminuw, VREG(b6), VREG(b11), VREG(b16)); ) );
+
+	AddDecoder( 4, 21, 11, 524, DECODER( EMIT(vspltb, VREG(b6), VREG(b16), b11); ) );
+	AddDecoder( 4, 21, 11, 588, DECODER( EMIT(vsplth, VREG(b6), VREG(b16), b11); ) );
+	AddDecoder( 4, 21, 11, 652, DECODER( EMIT(vspltw, VREG(b6), VREG(b16), b11); ) );
+	AddDecoder( 4, 21, 11, 780, DECODER( EMIT(vspltisb, VREG(b6), b11); ) );
+	AddDecoder( 4, 21, 11, 844, DECODER( EMIT(vspltish, VREG(b6), b11); ) );
+	AddDecoder( 4, 21, 11, 908, DECODER( EMIT(vspltisw, VREG(b6), b11); ) );
+
+	AddDecoder( 4, 21, 11, 398, DECODER( EMIT(vpkshss, VREG(b6), VREG(b11), VREG(b16)); ) );
+	AddDecoder( 4, 21, 11, 270, DECODER( EMIT(vpkshus, VREG(b6), VREG(b11), VREG(b16)); ) );
+	AddDecoder( 4, 21, 11, 462, DECODER( EMIT(vpkswss, VREG(b6), VREG(b11), VREG(b16)); ) );
+	AddDecoder( 4, 21, 11, 334, DECODER( EMIT(vpkswus, VREG(b6), VREG(b11), VREG(b16)); ) );
+	AddDecoder( 4, 21, 11, 14, DECODER( EMIT(vpkuhum, VREG(b6), VREG(b11), VREG(b16)); ) );
+	AddDecoder( 4, 21, 11, 142, DECODER( EMIT(vpkuhus, VREG(b6), VREG(b11), VREG(b16)); ) );
+	AddDecoder( 4, 21, 11, 78, DECODER( EMIT(vpkuwum, VREG(b6), VREG(b11), VREG(b16)); ) );
+	AddDecoder( 4, 21, 11, 206, DECODER( EMIT(vpkuwus, VREG(b6), VREG(b11), VREG(b16)); ) );
+
+	AddDecoder( 4, 21, 11, 74, DECODER( EMIT(vsubfp, VREG(b6), VREG(b11), VREG(b16)); ) );
+	AddDecoder( 4, 21, 11, 1284, DECODER( EMIT(vnor, VREG(b6), VREG(b11), VREG(b16)); ) );
+	AddDecoder( 4, 21, 11, 1220, DECODER( EMIT(vxor, VREG(b6), VREG(b11), VREG(b16)); ) );
+	AddDecoder( 4, 21, 11, 1036, DECODER( EMIT(vslo, VREG(b6), VREG(b11), VREG(b16)); ) );
+	AddDecoder( 4, 21, 11, 1100, DECODER( EMIT(vsro, VREG(b6), VREG(b11), VREG(b16)); ) );
+
+	AddDecoder( 4, 21, 11, 452, DECODER( EMIT(vsl, VREG(b6), VREG(b11), VREG(b16)); ) );
+	AddDecoder( 4, 21, 11, 708, DECODER( EMIT(vsr, VREG(b6), VREG(b11), VREG(b16)); ) );
+	AddDecoder( 4, 21, 11, 772, DECODER( EMIT(vsrab, VREG(b6), VREG(b11), VREG(b16)); ) );
+	AddDecoder( 4, 21, 11, 836, DECODER( EMIT(vsrah, VREG(b6), VREG(b11), VREG(b16)); ) );
+	AddDecoder( 4, 21, 11, 900, DECODER( EMIT(vsraw, VREG(b6), VREG(b11), VREG(b16)); ) );
+	AddDecoder( 4, 21, 11, 516, DECODER( EMIT(vsrb, VREG(b6), VREG(b11), VREG(b16)); ) );
+	AddDecoder( 4, 21, 11, 580, DECODER( EMIT(vsrh, VREG(b6), VREG(b11), VREG(b16)); ) );
+	AddDecoder( 4, 21, 11, 644, DECODER( EMIT(vsrw, VREG(b6), VREG(b11), VREG(b16)); ) );
+	AddDecoder( 4, 21, 11, 388, DECODER( EMIT(vslw, VREG(b6), VREG(b11), VREG(b16)); ) );
+	AddDecoder( 4, 21, 11, 324, DECODER( EMIT(vslh, VREG(b6), VREG(b11), VREG(b16)); ) );
+	AddDecoder( 4, 21, 11, 260, DECODER( EMIT(vslb, VREG(b6), VREG(b11), VREG(b16)); ) );
+
+	AddDecoder( 4, 21, 11, 266, DECODER( CHECK(b11==0); EMIT(vrefp, VREG(b6), VREG(b16)); ) );
+	AddDecoder( 4, 21, 11, 714, DECODER( CHECK(b11==0); EMIT(vrfim, VREG(b6), VREG(b16)); ) );
+	AddDecoder( 4, 21, 11, 522, DECODER( CHECK(b11==0); EMIT(vrfin, VREG(b6), VREG(b16)); ) );
+	AddDecoder( 4, 21, 11, 650, DECODER( CHECK(b11==0); EMIT(vrfip, VREG(b6), VREG(b16)); ) );
+	AddDecoder( 4, 21, 11, 586, DECODER( CHECK(b11==0); EMIT(vrfiz, VREG(b6), VREG(b16)); ) );
+
+	AddDecoder( 4, 21, 11, 1156, DECODER(
+		if (b11 == b16)
 		{
-			const BitField<26,6> vxo26(instrWord);
-			const BitField<21,11> vxo21(instrWord);
-			const BitField<21,7> vxo21e(instrWord);
-			const BitField<30,2> vxo30(instrWord);
-			const BitField<27,1> vxo27b1(instrWord);
-			const BitField<22,4> vxo22b4(instrWord);
-
-			// full opcode
-			switch (vxo21)
-			{
-				// move to/from special reg
-				case 1540: CHECK(b11==0); CHECK(b16==0); EMIT(mfvscr, VREG(b6));
-				case 1604: CHECK(b6==0); CHECK(b11==0); EMIT(mtvscr, VREG(b16));
-
-				// vadd
-				case 384: EMIT(vaddcuw, VREG(b6), VREG(b11), VREG(b16));
-				case 10: EMIT(vaddfp, VREG(b6), VREG(b11), VREG(b16));
-				case 768: EMIT(vaddsbs, VREG(b6), VREG(b11), VREG(b16));
-				case 832: EMIT(vaddshs, VREG(b6), VREG(b11), VREG(b16));
-				case 896: EMIT(vaddsws, VREG(b6), VREG(b11), VREG(b16));
-				case 0: EMIT(vaddubm, VREG(b6), VREG(b11), VREG(b16));
-				case 512: EMIT(vaddubs, VREG(b6), VREG(b11), VREG(b16));
-				case 64: EMIT(vadduhm, VREG(b6), VREG(b11), VREG(b16));
-				case 576: EMIT(vadduhs, VREG(b6), VREG(b11), VREG(b16));
-				case 128: EMIT(vadduwm, VREG(b6), VREG(b11), VREG(b16));
-				case 640: EMIT(vadduws, VREG(b6), VREG(b11), VREG(b16));
-
-				case 1408: EMIT(vsubcuw, VREG(b6), VREG(b11), VREG(b16));
-				case 1792: EMIT(vsubsbs, VREG(b6), VREG(b11), VREG(b16));
-				case 1856: EMIT(vsubshs, VREG(b6), VREG(b11), VREG(b16));
-				case 1920: EMIT(vsubsws, VREG(b6), VREG(b11), VREG(b16));
-				case 1024: EMIT(vsububm, VREG(b6), VREG(b11), VREG(b16));
-				case 1536: EMIT(vsububs, VREG(b6), VREG(b11), VREG(b16));
-				case 1088: EMIT(vsubuhm, VREG(b6), VREG(b11), VREG(b16));
-				case 1600: EMIT(vsubuhs, VREG(b6), VREG(b11), VREG(b16));
-				case 1152: EMIT(vsubuwm, VREG(b6), VREG(b11), VREG(b16));
-				case 1664: EMIT(vsubuws, VREG(b6), VREG(b11), VREG(b16));
-
-				case 1028: EMIT(vand, VREG(b6), VREG(b11), VREG(b16));
-				case 1092: EMIT(vandc, VREG(b6), VREG(b11), VREG(b16));
-				case 1282: EMIT(vavgsb, VREG(b6), VREG(b11), VREG(b16));
-				case 1346: EMIT(vavgsh, VREG(b6), VREG(b11), VREG(b16));
-				case 1410: EMIT(vavgsw, VREG(b6), VREG(b11), VREG(b16));
-				case 1026: EMIT(vavgub, VREG(b6), VREG(b11), VREG(b16));
-				case 1090: EMIT(vavguh, VREG(b6), VREG(b11), VREG(b16));
-				case 1154: EMIT(vavguw , VREG(b6), VREG(b11), VREG(b16));
-
-				case 970: EMIT(vctsxs, VREG(b6), VREG(b16), b11);
-				case 906: EMIT(vctuxs, VREG(b6), VREG(b16), b11);
-				case 842: EMIT(vcfsx, VREG(b6), VREG(b16), b11);
-				case 778: EMIT(vcfux, VREG(b6), VREG(b16), b11);
-
-				case 966: EMIT(vcmpbfp, VREG(b6), VREG(b11), VREG(b16));
-				case 1990: EMIT(vcmpbfpRC, VREG(b6), VREG(b11), VREG(b16));
-				
-				case 198: EMIT(vcmpeqfp, VREG(b6), VREG(b11), VREG(b16));
-				case 1222: EMIT(vcmpeqfpRC, VREG(b6), VREG(b11), VREG(b16));
-				case 6: EMIT(vcmpequb, VREG(b6), VREG(b11), VREG(b16));
-				case 1030: EMIT(vcmpequbRC, VREG(b6), VREG(b11), VREG(b16));
-				case 70: EMIT(vcmpequh, VREG(b6), VREG(b11), VREG(b16));
-				case 1094: EMIT(vcmpequhRC, VREG(b6), VREG(b11), VREG(b16));
-				case 134: EMIT(vcmpequw, VREG(b6), VREG(b11), VREG(b16));
-				case 1158: EMIT(vcmpequwRC, VREG(b6), VREG(b11), VREG(b16));
-				case 454: EMIT(vcmpgefp, VREG(b6), VREG(b11), VREG(b16));
-				case 1478: EMIT(vcmpgefpRC, VREG(b6), VREG(b11), VREG(b16));
-				case 710: EMIT(vcmpgtfp, VREG(b6), VREG(b11), VREG(b16));
-				case 1734: EMIT(vcmpgtfpRC, VREG(b6), VREG(b11), VREG(b16));
-				case 774: EMIT(vcmpgtsb, VREG(b6), VREG(b11), VREG(b16));
-				case 1798: EMIT(vcmpgtsbRC, VREG(b6), VREG(b11), VREG(b16));
-				case 838: EMIT(vcmpgtsh, VREG(b6), VREG(b11), VREG(b16));
-				case 1862: EMIT(vcmpgtshRC, VREG(b6), VREG(b11), VREG(b16));
-				case 902: EMIT(vcmpgtsw, VREG(b6), VREG(b11), VREG(b16));
-				case 1926: EMIT(vcmpgtswRC, VREG(b6), VREG(b11), VREG(b16));
-				case 518: EMIT(vcmpgtub, VREG(b6), VREG(b11), VREG(b16));
-				case 1542: EMIT(vcmpgtubRC, VREG(b6), VREG(b11), VREG(b16));
-				case 582: EMIT(vcmpgtuh, VREG(b6), VREG(b11), VREG(b16));
-				case 1606: EMIT(vcmpgtuhRC, VREG(b6), VREG(b11), VREG(b16));
-				case 646: EMIT(vcmpgtuw, VREG(b6), VREG(b11), VREG(b16));
-				case 1670: EMIT(vcmpgtuwRC, VREG(b6), VREG(b11), VREG(b16));
-
-				case 394: CHECK(b11==0); EMIT(vexptefp, VREG(b6), VREG(b16));
-				case 458: CHECK(b11==0); EMIT(vlogefp, VREG(b6), VREG(b16));
-
-				case 1034: EMIT(vmaxfp, VREG(b6), VREG(b11), VREG(b16));
-				case 258: EMIT(vmaxsb, VREG(b6), VREG(b11), VREG(b16));
-				case 322: EMIT(vmaxsh, VREG(b6), VREG(b11), VREG(b16));
-				case 386: EMIT(vmaxsw, VREG(b6), VREG(b11), VREG(b16));
-				case 2: EMIT(vmaxub, VREG(b6), VREG(b11), VREG(b16));
-				case 66: EMIT(vmaxuh, VREG(b6), VREG(b11), VREG(b16));
-				case 130: EMIT(vmaxuw, VREG(b6), VREG(b11), VREG(b16));
-				case 1098: EMIT(vminfp, VREG(b6), VREG(b11), VREG(b16));
-				case 770: EMIT(vminsb, VREG(b6), VREG(b11), VREG(b16));
-				case 834: EMIT(vminsh, VREG(b6), VREG(b11), VREG(b16));
-				case 898: EMIT(vminsw, VREG(b6), VREG(b11), VREG(b16));
-				case 514: EMIT(vminub, VREG(b6), VREG(b11), VREG(b16));
-				case 578: EMIT(vminuh, VREG(b6), VREG(b11), VREG(b16));
-				case 642: EMIT(vminuw, VREG(b6), VREG(b11), VREG(b16));
-
-				case 524: EMIT(vspltb, VREG(b6), VREG(b16), b11);
-				case 588: EMIT(vsplth, VREG(b6), VREG(b16), b11);
-				case 652: EMIT(vspltw, VREG(b6), VREG(b16), b11);
-				case 780: EMIT(vspltisb, VREG(b6), b11);
-				case 844: EMIT(vspltish, VREG(b6), b11);
-				case 908: EMIT(vspltisw, VREG(b6), b11);
-
-				case 398: EMIT(vpkshss, VREG(b6), VREG(b11), VREG(b16));
-				case 270: EMIT(vpkshus, VREG(b6), VREG(b11), VREG(b16));
-				case 462: EMIT(vpkswss, VREG(b6), VREG(b11), VREG(b16));
-				case 334: EMIT(vpkswus, VREG(b6), VREG(b11), VREG(b16));
-				case 14: EMIT(vpkuhum, VREG(b6), VREG(b11), VREG(b16));
-				case 142: EMIT(vpkuhus, VREG(b6), VREG(b11), VREG(b16));
-				case 78: EMIT(vpkuwum, VREG(b6), VREG(b11), VREG(b16));
-				case 206: EMIT(vpkuwus, VREG(b6), VREG(b11), VREG(b16));
-
-				case 74: EMIT(vsubfp, VREG(b6), VREG(b11), VREG(b16));
-				case 1284: EMIT(vnor, VREG(b6), VREG(b11), VREG(b16));
-				case 1220: EMIT(vxor, VREG(b6), VREG(b11), VREG(b16));
-				case 1036: EMIT(vslo, VREG(b6), VREG(b11), VREG(b16));
-				case 1100: EMIT(vsro, VREG(b6), VREG(b11), VREG(b16));
-
-				case 452: EMIT(vsl, VREG(b6), VREG(b11), VREG(b16));
-				case 708: EMIT(vsr, VREG(b6), VREG(b11), VREG(b16));
-				case 772: EMIT(vsrab, VREG(b6), VREG(b11), VREG(b16)); 
-				case 836: EMIT(vsrah, VREG(b6), VREG(b11), VREG(b16)); 
-				case 900: EMIT(vsraw, VREG(b6), VREG(b11), VREG(b16)); 
-				case 516: EMIT(vsrb, VREG(b6), VREG(b11), VREG(b16));
-				case 580: EMIT(vsrh, VREG(b6), VREG(b11), VREG(b16));
-				case 644: EMIT(vsrw, VREG(b6), VREG(b11), VREG(b16));
-				case 388: EMIT(vslw, VREG(b6), VREG(b11), VREG(b16));
-				case 324: EMIT(vslh, VREG(b6), VREG(b11), VREG(b16));
-				case 260: EMIT(vslb, VREG(b6), VREG(b11), VREG(b16));
-
-				case 266: CHECK(b11==0); EMIT(vrefp, VREG(b6), VREG(b16));
-				case 714: CHECK(b11==0); EMIT(vrfim, VREG(b6), VREG(b16));
-				case 522: CHECK(b11==0); EMIT(vrfin, VREG(b6), VREG(b16));
-				case 650: CHECK(b11==0); EMIT(vrfip, VREG(b6), VREG(b16));
-				case 586: CHECK(b11==0); EMIT(vrfiz, VREG(b6), VREG(b16));
-
-				case 1156:
-				{
-					if (b11 == b16)
-					{
-						EMIT(mr, VREG(b6), VREG(b11));
-					}
-					else
-					{
-						EMIT(vor, VREG(b6), VREG(b11), VREG(b16));
-					}
-				}
-
-				case 12: EMIT(vmrghb, VREG(b6), VREG(b11), VREG(b16));
-				case 76: EMIT(vmrghh, VREG(b6), VREG(b11), VREG(b16));
-				case 140: EMIT(vmrghw, VREG(b6), VREG(b11), VREG(b16));
-				case 268: EMIT(vmrglb, VREG(b6), VREG(b11), VREG(b16));
-				case 332: EMIT(vmrglh, VREG(b6), VREG(b11), VREG(b16));
-				case 396: EMIT(vmrglw, VREG(b6), VREG(b11), VREG(b16));
-
-				case 4: EMIT(vrlb, VREG(b6), VREG(b11), VREG(b16));
-				case 68: EMIT(vrlh, VREG(b6), VREG(b11), VREG(b16));
-				case 132: EMIT(vrlw, VREG(b6), VREG(b11), VREG(b16));
-				case 782: EMIT(vpkpx, VREG(b6), VREG(b11), VREG(b16));
-
-				case 590: CHECK(b11==0); EMIT(vupkhsh, VREG(b6), VREG(b16));
-				case 526: CHECK(b11==0); EMIT(vupkhsb, VREG(b6), VREG(b16));
-				case 846: CHECK(b11==0); EMIT(vupkhpx, VREG(b6), VREG(b16));
-				case 974: CHECK(b11==0); EMIT(vupklpx, VREG(b6), VREG(b16));
-				case 654: CHECK(b11==0); EMIT(vupklsb, VREG(b6), VREG(b16));					
-				case 718: CHECK(b11 == 0); EMIT(vupklsh, VREG(b6), VREG(b16));
-					
-
-				case 330: CHECK(b11==0); EMIT(vrsqrtefp, VREG(b6), VREG(b16));
-			}
-
-			// extended op code
-			switch (vxo26)
-			{
-				case 42: EMIT(vsel, VREG(b6), VREG(b11), VREG(b16), VREG(b21));
-				case 43: EMIT(vperm, VREG(b6), VREG(b11), VREG(b16), VREG(b21));
-				case 44: EMIT(vsldoi, VREG(b6), VREG(b11), VREG(b16), vxo22b4);
-				case 46: EMIT(vmaddfp, VREG(b6), VREG(b11), VREG(b21), VREG(b16));
-				case 47: EMIT(vnmsubfp, VREG(b6), VREG(b11), VREG(b21), VREG(b16));
-			}
+			EMIT(mr, VREG(b6), VREG(b11));
+		}
+		else
+		{
+			EMIT(vor, VREG(b6), VREG(b11), VREG(b16));
+		}
+	) );
+
+	AddDecoder( 4, 21, 11, 12, DECODER( EMIT(vmrghb, VREG(b6), VREG(b11), VREG(b16)); ) );
+	AddDecoder( 4, 21, 11, 76, DECODER( EMIT(vmrghh, VREG(b6), VREG(b11), VREG(b16)); ) );
+	AddDecoder( 4, 21, 11, 140, DECODER( EMIT(vmrghw, VREG(b6), VREG(b11), VREG(b16)); ) );
+	AddDecoder( 4, 21, 11, 268, DECODER( EMIT(vmrglb, VREG(b6), VREG(b11), VREG(b16)); ) );
+	AddDecoder( 4, 21, 11, 332, DECODER( EMIT(vmrglh, VREG(b6), VREG(b11), VREG(b16)); ) );
+	AddDecoder( 4, 21, 11, 396, DECODER( EMIT(vmrglw, VREG(b6), VREG(b11), VREG(b16)); ) );
+
+	AddDecoder( 4, 21, 11, 4, DECODER( EMIT(vrlb, VREG(b6), VREG(b11), VREG(b16)); ) );
+	AddDecoder( 4, 21, 11, 68, DECODER( EMIT(vrlh, VREG(b6), VREG(b11), VREG(b16)); ) );
+	AddDecoder( 4, 21, 11, 132, DECODER( EMIT(vrlw, VREG(b6), VREG(b11), VREG(b16)); ) );
+	AddDecoder( 4, 21, 11, 782, DECODER( EMIT(vpkpx, VREG(b6), VREG(b11), VREG(b16)); ) );
+
+	AddDecoder( 4, 21, 11, 590, DECODER( CHECK(b11==0); EMIT(vupkhsh, VREG(b6), VREG(b16)); ) );
+	AddDecoder( 4, 21, 11, 526, DECODER( CHECK(b11==0); EMIT(vupkhsb, VREG(b6), VREG(b16)); ) );
+	AddDecoder( 4, 21, 11, 846, DECODER( CHECK(b11==0); EMIT(vupkhpx, VREG(b6), VREG(b16)); ) );
+	AddDecoder( 4, 21, 11, 974, DECODER( CHECK(b11==0); EMIT(vupklpx, VREG(b6), VREG(b16)); ) );
+	AddDecoder( 4, 21, 11, 654, DECODER( CHECK(b11==0); EMIT(vupklsb, VREG(b6), VREG(b16)); ) );
+	AddDecoder( 4, 21, 11, 718, DECODER( CHECK(b11 == 0); EMIT(vupklsh, VREG(b6), VREG(b16)); ) );
+
+	AddDecoder( 4, 21, 11, 330, DECODER( CHECK(b11==0); EMIT(vrsqrtefp, VREG(b6), VREG(b16)); ) );
+
+	// extended op code
+	AddDecoder( 4, 26, 6, 42, DECODER( EMIT(vsel, VREG(b6), VREG(b11), VREG(b16), VREG(b21)); ) );
+	AddDecoder( 4, 26, 6, 43, DECODER( EMIT(vperm, VREG(b6), VREG(b11), VREG(b16), VREG(b21)); ) );
+	AddDecoder( 4, 26, 6, 44, DECODER( EMIT(vsldoi, VREG(b6), VREG(b11), VREG(b16), vxo22b4); ) );
+	AddDecoder( 4, 26, 6, 46, DECODER( EMIT(vmaddfp, VREG(b6), VREG(b11), VREG(b21), VREG(b16)); ) );
+	AddDecoder( 4, 26, 6, 47, DECODER( EMIT(vnmsubfp, VREG(b6), VREG(b11), VREG(b21), VREG(b16)); ) );
+
+	// extended set
+
+	// loads
+	AddDecoder( 4, 21, 7, 64, DECODER( CHECK(vxo30==3); EMIT(lvlx, vreg6, MEMREG0(b11,b16)); ) );
+	AddDecoder( 4, 21, 7, 96, DECODER( CHECK(vxo30==3); EMIT(lvlxl, vreg6, MEMREG0(b11,b16)); ) );
+	AddDecoder( 4, 21, 7, 68, DECODER( CHECK(vxo30==3); EMIT(lvrx, vreg6, MEMREG0(b11,b16)); ) );
+	AddDecoder( 4, 21, 7, 100, DECODER( CHECK(vxo30==3); EMIT(lvrxl, vreg6, MEMREG0(b11,b16)); ) );
+	AddDecoder( 4, 21, 7, 12, DECODER( CHECK(vxo30==3); EMIT(lvx, vreg6,  MEMREG0(b11,b16)); ) );
+	AddDecoder( 4, 21, 7, 44, DECODER( CHECK(vxo30==3); EMIT(lvxl, vreg6, MEMREG0(b11,b16)); ) );
+
+	// stores
+	AddDecoder( 4, 21, 7, 24, DECODER( CHECK(vxo30==3); EMIT(stvewx, vreg6, MEMREG0(b11,b16)); ) );
+	AddDecoder( 4, 21, 7, 80, DECODER( CHECK(vxo30==3); EMIT(stvlx, vreg6, MEMREG0(b11,b16)); ) );
+	AddDecoder( 4, 21, 7, 112, DECODER( CHECK(vxo30==3); EMIT(stvlxl, vreg6, MEMREG0(b11,b16)); ) );
+	AddDecoder( 4, 21, 7, 84, DECODER( CHECK(vxo30==3); EMIT(stvrx, vreg6, MEMREG0(b11,b16)); ) );
+	AddDecoder( 4, 21, 7, 116, DECODER( CHECK(vxo30==3); EMIT(stvrxl, vreg6, MEMREG0(b11,b16)); ) );
+	AddDecoder( 4, 21, 7, 28, DECODER( CHECK(vxo30==3); EMIT(stvx, vreg6, MEMREG0(b11,b16)); ) );
+	AddDecoder( 4, 21, 7, 60, DECODER( CHECK(vxo30==3); EMIT(stvxl, vreg6, MEMREG0(b11,b16)); ) );
+
+	// vsldoi128 or unknown
+	SetDefaultDecoder( 4, DECODER(
+		if (vxo27b1)
+		{
+			EMIT(vsldoi, vreg6, vreg11, vreg16, vxo22b4 );
+		}
 
-			// extended set
-			switch (vxo21e)
-			{
-				// loads
-				case 64: CHECK(vxo30==3); EMIT(lvlx, vreg6, MEMREG0(b11,b16));
-				case 96: CHECK(vxo30==3); EMIT(lvlxl, vreg6, MEMREG0(b11,b16));
-				case 68: CHECK(vxo30==3); EMIT(lvrx, vreg6, MEMREG0(b11,b16));
-				case 100: CHECK(vxo30==3); EMIT(lvrxl, vreg6, MEMREG0(b11,b16));
-				case 12: CHECK(vxo30==3); EMIT(lvx, vreg6,  MEMREG0(b11,b16));
-				case 44: CHECK(vxo30==3); EMIT(lvxl, vreg6, MEMREG0(b11,b16));
-
-				// stores
-				case 24: CHECK(vxo30==3); EMIT(stvewx, vreg6, MEMREG0(b11,b16));
-				case 80: CHECK(vxo30==3); EMIT(stvlx, vreg6, MEMREG0(b11,b16));
-				case 112: CHECK(vxo30==3); EMIT(stvlxl, vreg6, MEMREG0(b11,b16));
-				case 84: CHECK(vxo30==3); EMIT(stvrx, vreg6, MEMREG0(b11,b16));
-				case 116: CHECK(vxo30==3); EMIT(stvrxl, vreg6, MEMREG0(b11,b16));
-				case 28: CHECK(vxo30==3); EMIT(stvx, vreg6, MEMREG0(b11,b16));
-				case 60: CHECK(vxo30==3); EMIT(stvxl, vreg6, MEMREG0(b11,b16));
-			}
+		// unknown
+		ERROR("Decode: Unmatched secondary opcode xo21=%d, xo26=%d, xo21e=%d for primary opcode %d",
+			vxo21, vxo26, vxo21e, pri);
+	) );
 
-			// vsldoi128
-			if (vxo27b1)
+	// extended VMX
+	SetDefaultDecoder( 5, DECODER(
+		// match
+		if ( vxo27 == 0 )
+		{
+			switch (vxo22)
 			{
-				EMIT(vsldoi, vreg6, vreg11, vreg16, vxo22b4 );
+				case 0: EMIT(vperm, vreg6, vreg11, vreg16, VREG(0));
+				case 1: EMIT(vperm, vreg6, vreg11, vreg16, VREG(1));
+				case 2: EMIT(vperm, vreg6, vreg11, vreg16, VREG(2));
+				case 3: EMIT(vperm, vreg6, vreg11, vreg16, VREG(3));
+				case 4: EMIT(vperm, vreg6, vreg11, vreg16, VREG(4));
+				case 5: EMIT(vperm, vreg6, vreg11, vreg16, VREG(5));
+				case 6: EMIT(vperm, vreg6, vreg11, vreg16, VREG(6));
+				case 7: EMIT(vperm, vreg6, vreg11, vreg16, VREG(7));
+
+				case 8: EMIT(vpkshss, vreg6, vreg11, vreg16);
+				case 9: EMIT(vpkshus, vreg6, vreg11, vreg16);
+				case 10: EMIT(vpkswss, vreg6, vreg11, vreg16);
+				case 11: EMIT(vpkswus, vreg6, vreg11, vreg16);
+				case 12: EMIT(vpkuhum, vreg6, vreg11, vreg16);
+				case 13: EMIT(vpkuhus, vreg6, vreg11, vreg16);
+				case 14: EMIT(vpkuwum, vreg6, vreg11, vreg16);
+				case 15: EMIT(vpkuwus, vreg6, vreg11, vreg16);
 			}
-
-			// unknown
-			ERROR("Decode: Unmatched secondary opcode xo21=%d, xo26=%d, xo21e=%d for primary opcode %d", 
-				vxo21, vxo26, vxo21e, pri);
 		}
-
-		// extended VMX
-		case 5:
+		else
 		{
-			const BitField<22,4> vxo22(instrWord);
-			const BitField<27,1> vxo27(instrWord);
-
-			// match
-			if ( vxo27 == 0 )
-			{
-				switch (vxo22)
-				{
-					case 0: EMIT(vperm, vreg6, vreg11, vreg16, VREG(0));
-					case 1: EMIT(vperm, vreg6, vreg11, vreg16, VREG(1));
-					case 2: EMIT(vperm, vreg6, vreg11, vreg16, VREG(2));
-					case 3: EMIT(vperm, vreg6, vreg11, vreg16, VREG(3));
-					case 4: EMIT(vperm, vreg6, vreg11, vreg16, VREG(4));
-					case 5: EMIT(vperm, vreg6, vreg11, vreg16, VREG(5));
-					case 6: EMIT(vperm, vreg6, vreg11, vreg16, VREG(6));
-					case 7: EMIT(vperm, vreg6, vreg11, vreg16, VREG(7));
-
-					case 8: EMIT(vpkshss, vreg6, vreg11, vreg16);
-					case 9: EMIT(vpkshus, vreg6, vreg11, vreg16);
-					case 10: EMIT(vpkswss, vreg6, vreg11, vreg16);
-					case 11: EMIT(vpkswus, vreg6, vreg11, vreg16);
-					case 12: EMIT(vpkuhum, vreg6, vreg11, vreg16);
-					case 13: EMIT(vpkuhus, vreg6, vreg11, vreg16);
-					case 14: EMIT(vpkuwum, vreg6, vreg11, vreg16);
-					case 15: EMIT(vpkuwus, vreg6, vreg11, vreg16);
-				}
-			}
-			else
+			switch (vxo22)
 			{
-				switch (vxo22)
-				{
-					case 0: EMIT(vaddfp, vreg6, vreg11, vreg16);
-					case 1: EMIT(vsubfp, vreg6, vreg11, vreg16);
-					case 2: EMIT(vmulfp128, vreg6, vreg11, vreg16);
+				case 0: EMIT(vaddfp, vreg6, vreg11, vreg16);
+				case 1: EMIT(vsubfp, vreg6, vreg11, vreg16);
+				case 2: EMIT(vmulfp128, vreg6, vreg11, vreg16);
 
-					case 3: EMIT(vmaddfp, vreg6, vreg11, vreg16, vreg6);
-					case 4: EMIT(vmaddfp, vreg6, vreg11, vreg6, vreg16); // addc
+				case 3: EMIT(vmaddfp, vreg6, vreg11, vreg16, vreg6);
+				case 4: EMIT(vmaddfp, vreg6, vreg11, vreg6, vreg16); // addc
 
-					case 5: EMIT(vnmsubfp, vreg6, vreg11, vreg16, vreg6);
+				case 5: EMIT(vnmsubfp, vreg6, vreg11, vreg16, vreg6);
 
-					case 6: EMIT(vdot3fp, vreg6, vreg11, vreg16);
-					case 7: EMIT(vdot4fp, vreg6, vreg11, vreg16);
+				case 6: EMIT(vdot3fp, vreg6, vreg11, vreg16);
+				case 7: EMIT(vdot4fp, vreg6, vreg11, vreg16);
 
-					case 8: EMIT(vand, vreg6, vreg11, vreg16);
-					case 9: EMIT(vandc, vreg6, vreg11, vreg16);
-					case 10: EMIT(vnor, vreg6, vreg11, vreg16);
-					case 12: EMIT(vxor, vreg6, vreg11, vreg16);
-					case 13: EMIT(vsel, vreg6, vreg11, vreg16, vreg6); // arg3 == arg0
-					case 14: EMIT(vslo, vreg6, vreg11, vreg16);
-					case 15: EMIT(vsro, vreg6, vreg11, vreg16);
+				case 8: EMIT(vand, vreg6, vreg11, vreg16);
+				case 9: EMIT(vandc, vreg6, vreg11, vreg16);
+				case 10: EMIT(vnor, vreg6, vreg11, vreg16);
+				case 12: EMIT(vxor, vreg6, vreg11, vreg16);
+				case 13: EMIT(vsel, vreg6, vreg11, vreg16, vreg6); // arg3 == arg0
+				case 14: EMIT(vslo, vreg6, vreg11, vreg16);
+				case 15: EMIT(vsro, vreg6, vreg11, vreg16);
 
-					case 11:
+				case 11:
+				{
+					if (vreg11 == vreg16)
 					{
-						if (vreg11 == vreg16)
-						{
-							EMIT(mr, vreg6, vreg11);
-						}
-						else
-						{
-							EMIT(vor, vreg6, vreg11, vreg16);
-						}
+						EMIT(mr, vreg6, vreg11);
+					}
+					else
+					{
+						EMIT(vor, vreg6, vreg11, vreg16);
 					}
 				}
 			}
-
-			// unknown
-			ERROR("Decode: Unmatched secondary opcode xo22=%d for primary opcode %d", 
-				vxo22, pri);
-		}
-
-		// extended VMX
-		case 6:
-		{
-			const BitField<26,6> vxo26(instrWord);
-			const BitField<21,11> vxo21(instrWord);
-			const BitField<21,7> vxo21e(instrWord);
-			const BitField<22,4> vxo22(instrWord);
-			const BitField<27,1> vxo27(instrWord);
-			const BitField<30,2> vxo30(instrWord);
-
-			const BitField<11,3> b11x3(instrWord);
-
-			// match
-			switch (vxo21e)
-			{
-				case (33+(0*4)): EMIT(vpermwi128, vreg6, vreg16, b11+0*32);
-				case (33+(1*4)): EMIT(vpermwi128, vreg6, vreg16, b11+1*32);
-				case (33+(2*4)): EMIT(vpermwi128, vreg6, vreg16, b11+2*32);
-				case (33+(3*4)): EMIT(vpermwi128, vreg6, vreg16, b11+3*32);
-				case (33+(4*4)): EMIT(vpermwi128, vreg6, vreg16, b11+4*32);
-				case (33+(5*4)): EMIT(vpermwi128, vreg6, vreg16, b11+5*32);
-				case (33+(6*4)): EMIT(vpermwi128, vreg6, vreg16, b11+6*32);
-				case (33+(7*4)): EMIT(vpermwi128, vreg6, vreg16, b11+7*32);
-
-				case 35: EMIT(vcfpsxws, vreg6, vreg16, b11);
-				case 39: EMIT(vcfpuxws, vreg6, vreg16, b11);
-
-				case 43: EMIT(vcsxwfp, vreg6, vreg16, b11);
-				case 47: EMIT(vcuxwfp, vreg6, vreg16, b11);
-					
-				case 51: CHECK(b11==0); EMIT(vrfim, vreg6, vreg16);
-				case 55: CHECK(b11==0); EMIT(vrfin, vreg6, vreg16);
-				case 63: CHECK(b11==0); EMIT(vrfiz, vreg6, vreg16);
-
-				case 56: CHECK(b11==0); EMIT(vupkhsb, vreg6, vreg16);
-				case 122: CHECK(b11==0); EMIT(vupkhsh, vreg6, vreg16);
-				case 60: CHECK(b11==0); EMIT(vupklsb, vreg6, vreg16);
-				case 126: CHECK(b11==0); EMIT(vupklsh, vreg6, vreg16);
-
-				case 97: EMIT(vpkd3d128, vreg6, vreg16, (uint32)(b11/4), (uint32)(b11&3), (uint32)(0));
-				case 101: EMIT(vpkd3d128, vreg6, vreg16, (uint32)(b11/4),(uint32)( b11&3), (uint32)(1));
-				case 105: EMIT(vpkd3d128, vreg6, vreg16, (uint32)(b11/4), (uint32)(b11&3), (uint32)(2));
-				case 109: EMIT(vpkd3d128, vreg6, vreg16, (uint32)(b11/4), (uint32)(b11&3), (uint32)(3));
-
-				case 111: CHECK(b11==0); EMIT(vlogefp, vreg6, vreg16);
-				case 107: CHECK(b11==0); EMIT(vexptefp, vreg6, vreg16);
-
-				case 99: CHECK(b11==0); EMIT(vrefp, vreg6, vreg16);
-
-				case 103: CHECK(b11==0); EMIT(vrsqrtefp, vreg6, vreg16);
-
-				case 113: EMIT(vrlimi128, vreg6, vreg16, b11, (uint32)0);
-				case 117: EMIT(vrlimi128, vreg6, vreg16, b11, (uint32)1);
-				case 121: EMIT(vrlimi128, vreg6, vreg16, b11, (uint32)2);
-				case 125: EMIT(vrlimi128, vreg6, vreg16, b11, (uint32)3);
-				case 115: EMIT(vspltw, vreg6, vreg16, b11);
-				case 119: EMIT(vspltisw, vreg6, b11);
-
-				case 127: EMIT(vupkd3d128, vreg6, vreg16, b11x3 );
-			}
-
-			// match
-			if ( vxo27 == 0 )
-			{
-				switch (vxo22)
-				{
-					case 0: EMIT(vcmpeqfp, vreg6, vreg11, vreg16);
-					case 1: EMIT(vcmpeqfpRC, vreg6, vreg11, vreg16);
-					case 2: EMIT(vcmpgefp, vreg6, vreg11, vreg16);
-					case 3: EMIT(vcmpgefpRC, vreg6, vreg11, vreg16);
-					case 4: EMIT(vcmpgtfp, vreg6, vreg11, vreg16);
-					case 5: EMIT(vcmpgtfpRC, vreg6, vreg11, vreg16);
-					case 6: EMIT(vcmpbfp, vreg6, vreg11, vreg16);
-					case 7: EMIT(vcmpbfpRC, vreg6, vreg11, vreg16);
-					case 8: EMIT(vcmpequw, vreg6, vreg11, vreg16);
-					case 9: EMIT(vcmpequwRC, vreg6, vreg11, vreg16);
-					case 10: EMIT(vmaxfp, vreg6, vreg11, vreg16);
-					case 11: EMIT(vminfp, vreg6, vreg11, vreg16);
-					case 12: EMIT(vmrghw, vreg6, vreg11, vreg16);
-					case 13: EMIT(vmrglw, vreg6, vreg11, vreg16);
-				}
-			}
-			else
-			{
-				switch (vxo22)
-				{
-					case 1: EMIT(vrlw, vreg6, vreg11, vreg16);
-					case 3: EMIT(vslw, vreg6, vreg11, vreg16);
-					case 5: EMIT(vsraw, vreg6, vreg11, vreg16);
-					case 7: EMIT(vsrw, vreg6, vreg11, vreg16);
-
-					case 12: EMIT(vrfim, vreg6, vreg16);
-					case 13: EMIT(vrfin, vreg6, vreg16);
-					case 14: EMIT(vrfip, vreg6, vreg16);
-					case 15: EMIT(vrfiz, vreg6, vreg16);
-				}
-			}
-
-			// unknown
-			ERROR("Decode: Unmatched secondary opcode xo21=%d, xo26=%d, xo21e=%d, xo22=%d for primary opcode %d", 
-				vxo21, vxo26, vxo21e, vxo22, pri);
 		}
 
-		// muli (multiply with immediate)
-		case 7: EMIT(mulli, REG(b6), REG(b11), si);
-
-		// subf( subtract from)
-		case 8: EMIT(subfic, REG(b6), REG(b11), si);
+		// unknown
+		ERROR("Decode: Unmatched secondary opcode xo22=%d for primary opcode %d",
+			vxo22, pri);
+	) );
 
-		// cmplwi, cmpldi
-		case 10:
+	// extended VMX
+	SetDefaultDecoder( 6, DECODER(
+		// match
+		switch (vxo21e)
 		{
-			const BitField<10,1> l(instrWord);
-			if (!l) EMIT(cmplwi, CREG(bf), REG(b11), ui);
-			EMIT(cmpldi, CREG(bf), REG(b11), ui);
+			case (33+(0*4)): EMIT(vpermwi128, vreg6, vreg16, b11+0*32);
+			case (33+(1*4)): EMIT(vpermwi128, vreg6, vreg16, b11+1*32);
+			case (33+(2*4)): EMIT(vpermwi128, vreg6, vreg16, b11+2*32);
+			case (33+(3*4)): EMIT(vpermwi128, vreg6, vreg16, b11+3*32);
+			case (33+(4*4)): EMIT(vpermwi128, vreg6, vreg16, b11+4*32);
+			case (33+(5*4)): EMIT(vpermwi128, vreg6, vreg16, b11+5*32);
+			case (33+(6*4)): EMIT(vpermwi128, vreg6, vreg16, b11+6*32);
+			case (33+(7*4)): EMIT(vpermwi128, vreg6, vreg16, b11+7*32);
+
+			case 35: EMIT(vcfpsxws, vreg6, vreg16, b11);
+			case 39: EMIT(vcfpuxws, vreg6, vreg16, b11);
+
+			case 43: EMIT(vcsxwfp, vreg6, vreg16, b11);
+			case 47: EMIT(vcuxwfp, vreg6, vreg16, b11);
+
+			case 51: CHECK(b11==0); EMIT(vrfim, vreg6, vreg16);
+			case 55: CHECK(b11==0); EMIT(vrfin, vreg6, vreg16);
+			case 63: CHECK(b11==0); EMIT(vrfiz, vreg6, vreg16);
+
+			case 56: CHECK(b11==0); EMIT(vupkhsb, vreg6, vreg16);
+			case 122: CHECK(b11==0); EMIT(vupkhsh, vreg6, vreg16);
+			case 60: CHECK(b11==0); EMIT(vupklsb, vreg6, vreg16);
+			case 126: CHECK(b11==0); EMIT(vupklsh, vreg6, vreg16);
+
+			case 97: EMIT(vpkd3d128, vreg6, vreg16, (uint32)(b11/4), (uint32)(b11&3), (uint32)(0));
+			case 101: EMIT(vpkd3d128, vreg6, vreg16, (uint32)(b11/4),(uint32)( b11&3), (uint32)(1));
+			case 105: EMIT(vpkd3d128, vreg6, vreg16, (uint32)(b11/4), (uint32)(b11&3), (uint32)(2));
+			case 109: EMIT(vpkd3d128, vreg6, vreg16, (uint32)(b11/4), (uint32)(b11&3), (uint32)(3));
+
+			case 111: CHECK(b11==0); EMIT(vlogefp, vreg6, vreg16);
+			case 107: CHECK(b11==0); EMIT(vexptefp, vreg6, vreg16);
+
+			case 99: CHECK(b11==0); EMIT(vrefp, vreg6, vreg16);
+
+			case 103: CHECK(b11==0); EMIT(vrsqrtefp, vreg6, vreg16);
+
+			case 113: EMIT(vrlimi128, vreg6, vreg16, b11, (uint32)0);
+			case 117: EMIT(vrlimi128, vreg6, vreg16, b11, (uint32)1);
+			case 121: EMIT(vrlimi128, vreg6, vreg16, b11, (uint32)2);
+			case 125: EMIT(vrlimi128, vreg6, vreg16, b11, (uint32)3);
+			case 115: EMIT(vspltw, vreg6, vreg16, b11);
+			case 119: EMIT(vspltisw, vreg6, b11);
+
+			case 127: EMIT(vupkd3d128, vreg6, vreg16, b11x3 );
 		}
 
-		// cmpwi, cmpdi
-		case 11:
+		// match
+		if ( vxo27 == 0 )
 		{
-			const BitField<10,1> l(instrWord);
-			if (!l) EMIT(cmpwi, CREG(bf), REG(b11), si);
-			EMIT(cmpdi, CREG(bf), REG(b11), si);
-		}
-
-		// addic, addic.
-		case 12: EMIT( addic, REG(b6), REG(b11), si );
-		case 13: EMIT( addicRC, REG(b6), REG(b11), si );
-
-		// addi, addis, li, lis
-		case 14: 
-			if (b11==0) EMIT( li, REG(b6), si );
-			EMIT( addi, REG(b6), REG(b11), si );
-
-		case 15:
-			if (b11==0) EMIT( lis, REG(b6), si );
-			EMIT( addis, REG(b6), REG(b11), si );
-
-		// bc, bca, bcl, bcla
-		case 16:
-			if (!aa && !lk)	EMIT(bc, b6, CBIT(b11), bd);
-			if (!aa && lk)  EMIT(bcl, b6, CBIT(b11), bd);
-			if (aa && !lk)  EMIT(bca, b6, CBIT(b11), bd);
-			EMIT(bcla, b6, CBIT(b11), bd);;
-
-		// sc (system call)
-		case 17:
-			EMIT(sc, lev);
-
-		// b,ba,bl,bla
-		case 18:
-			if (!aa && !lk)	EMIT(b, li);
-			if (!aa && lk)  EMIT(bl, li);
-			if (aa && !lk)  EMIT(ba, li);
-			EMIT(bla, li);
-
-		// bclr, bclrl
-		case 19:
-		{
-			switch (xo21)
-			{
-				default: ERROR("Decode: Unmatched secondary opcode %d for primary opcode %d", xo21, pri);
-
-				// bclr, bclrl
-				case 16: 
-					if (lk)	EMIT(bclrl, b6, CBIT(b11));
-					EMIT(bclr, b6, CBIT(b11));
-
-				// bcctr, bcctrl
-				case 528: 
-					if (lk)	EMIT(bcctrl, b6, CBIT(b11));
-					EMIT(bcctr, b6, CBIT(b11));
-
-				// conditonal register operations
-				case 257: EMIT(crand, CBIT(b6), CBIT(b11), CBIT(b16));
-				case 449: EMIT(cror, CBIT(b6), CBIT(b11), CBIT(b16));
-				case 193: EMIT(crxor, CBIT(b6), CBIT(b11), CBIT(b16));
-				case 225: EMIT(crnand, CBIT(b6), CBIT(b11), CBIT(b16));
-				case 33: EMIT(crnor, CBIT(b6), CBIT(b11), CBIT(b16));
-				case 289: EMIT(creqv, CBIT(b6), CBIT(b11), CBIT(b16));
-				case 129: EMIT(crandc, CBIT(b6), CBIT(b11), CBIT(b16));
-				case 417: EMIT(crorc, CBIT(b6), CBIT(b11), CBIT(b16));
-
-				// mcrf (move conditional register flag)
-				case 0: EMIT(mcrf, CREG(b6), CREG(b11));
-			}
-		}
-
-	    // rlwimi, rlwimi., rlwinm, rlwinm., rlwnm, rlwnm.
-		case 20: EMIT_RC(rlwimi, REG(b11), REG(b6), sh16, mb21, me26);
-		case 21: EMIT_RC(rlwinm, REG(b11), REG(b6), sh16, mb21, me26);
-		case 23: EMIT_RC(rlwnm, REG(b11), REG(b6), REG(b16), mb21, me26);
-
-   		// andi., andis., ori, oris, xori, xoris
-		case 24: EMIT(ori, REG(b11), REG(b6), ui);
-		case 25: EMIT(oris, REG(b11), REG(b6), ui);
-		case 26: EMIT(xori, REG(b11), REG(b6), ui);
-		case 27: EMIT(xoris, REG(b11), REG(b6), ui);
-		case 28: EMIT(andiRC, REG(b11), REG(b6), ui);
-		case 29: EMIT(andisRC, REG(b11), REG(b6), ui);
-    
-		// shift opcodes
-		case 30:
-		{
-			const BitField<27,3> xo27(instrWord);
-			switch (xo27)
-			{
-				// rldicl, rldicl., rldicr, rldicr., rldic, rldic., rldimi, rldimi.
-				case 0: EMIT_RC(rldicl, REG(b11), REG(b6), sh16 + (aa?32:0), mb21 + (mb26x1?32:0));
-				case 1: EMIT_RC(rldicr, REG(b11), REG(b6), sh16 + (aa?32:0), mb21 + (mb26x1?32:0));
-				case 2: EMIT_RC(rldic, REG(b11), REG(b6), sh16 + (aa?32:0), mb21 + (mb26x1?32:0));
-				case 3: EMIT_RC(rldimi, REG(b11), REG(b6), sh16 + (aa?32:0), mb21 + (mb26x1?32:0));
-			}
-
-			const BitField<27,4> xo27x4(instrWord);
-			switch (xo27x4)
+			switch (vxo22)
 			{
-				// rldcl, rldcl., rldcr, rldcr.
-				case 8: EMIT_RC(rldcl, REG(b11), REG(b6), REG(b16), mb21 + (mb26x1?32:0));
-				case 9: EMIT_RC(rldcr, REG(b11), REG(b6), REG(b16), mb21 + (mb26x1?32:0));
+				case 0: EMIT(vcmpeqfp, vreg6, vreg11, vreg16);
+				case 1: EMIT(vcmpeqfpRC, vreg6, vreg11, vreg16);
+				case 2: EMIT(vcmpgefp, vreg6, vreg11, vreg16);
+				case 3: EMIT(vcmpgefpRC, vreg6, vreg11, vreg16);
+				case 4: EMIT(vcmpgtfp, vreg6, vreg11, vreg16);
+				case 5: EMIT(vcmpgtfpRC, vreg6, vreg11, vreg16);
+				case 6: EMIT(vcmpbfp, vreg6, vreg11, vreg16);
+				case 7: EMIT(vcmpbfpRC, vreg6, vreg11, vreg16);
+				case 8: EMIT(vcmpequw, vreg6, vreg11, vreg16);
+				case 9: EMIT(vcmpequwRC, vreg6, vreg11, vreg16);
+				case 10: EMIT(vmaxfp, vreg6, vreg11, vreg16);
+				case 11: EMIT(vminfp, vreg6, vreg11, vreg16);
+				case 12: EMIT(vmrghw, vreg6, vreg11, vreg16);
+				case 13: EMIT(vmrglw, vreg6, vreg11, vreg16);
 			}
-
-			ERROR("Decode: Unmatched secondary opcode %d for primary %d", xo27x4, pri);
 		}
-
-		// extended opcodes
-		case 31:
+		else
 		{
-			const BitField<21,10> xo21(instrWord);
-			switch (xo21)
+			switch (vxo22)
 			{
-				// lbzx, lbzxu
-				case 87: EMIT(lbzx, REG(b6), MEMREG0(b11,b16));
-				case 119: EMIT(lbzux, REG(b6), MEMREG(b11,b16));
-
-				// lhzx, lhzux, lhax, lhaux 
-				case 279: EMIT(lhzx, REG(b6), MEMREG0(b11,b16));
-				case 311: EMIT(lhzux, REG(b6), MEMREG(b11,b16));
-				case 343: EMIT(lhax, REG(b6), MEMREG0(b11,b16));
-				case 375: EMIT(lhaux, REG(b6), MEMREG(b11,b16));
-
-				// lwzx, lwzux, lwax, lwaux
-				case 23: EMIT(lwzx, REG(b6), MEMREG0(b11,b16));
-				case 55: EMIT(lwzux, REG(b6), MEMREG(b11,b16));
-				case 341: EMIT(lwax, REG(b6), MEMREG0(b11,b16));
-				case 373: EMIT(lwaux, REG(b6), MEMREG(b11,b16));
-
-				// ldx, ldux
-				case 21: EMIT(ldx, REG(b6), MEMREG0(b11,b16));
-				case 53: EMIT(ldux, REG(b6), MEMREG(b11,b16));
-
-				// stbx, stbux
-				case 215: EMIT(stbx, REG(b6), MEMREG0(b11,b16));
-				case 247: EMIT(stbux, REG(b6), MEMREG(b11,b16));
-
-				// sthx, sthux
-				case 407: EMIT(sthx, REG(b6), MEMREG0(b11,b16));
-				case 439: EMIT(sthux, REG(b6), MEMREG(b11,b16));
-
-				// stwx, stwux
-				case 151: EMIT(stwx, REG(b6), MEMREG0(b11,b16));
-				case 183: EMIT(stwux, REG(b6), MEMREG(b11,b16));
-
-				// stdx, stdux
-				case 149: EMIT(stdx, REG(b6), MEMREG0(b11,b16));
-				case 181: EMIT(stdux, REG(b6), MEMREG(b11,b16));
-
-				// lhbrx, lwbrx, sthbrx, stwbrx
-				case 790: EMIT(lhbrx, REG(b6), MEMREG0(b11,b16));
-				case 534: EMIT(lwbrx, REG(b6), MEMREG0(b11,b16));
-				case 918: EMIT(sthbrx, REG(b6), MEMREG0(b11,b16));
-				case 662: EMIT(stwbrx, REG(b6), MEMREG0(b11,b16));
-
-				// lswi, lswx, stswi, stswx
-				case 597: EMIT(lswi, REG(b6), REG0(b11), b16);
-				case 533: EMIT(lswx, REG(b6), REG0(b11), REG(b16));
-				case 725: EMIT(stswi, REG(b6), REG0(b11), b16);
-				case 661: EMIT(stswx, REG(b6), REG0(b11), REG(b16));
-
-				// lvehx, lvebx, lvewx
-				case 39: EMIT(lvehx, VREG(b6), MEMREG0(b11, b16));
-				case 7: EMIT(lvebx, VREG(b6), MEMREG0(b11, b16));
-				case 71: EMIT(lvewx, VREG(b6), MEMREG0(b11, b16));
-
-				// stvebx, stvehx, stvewx
-				case 135: EMIT(stvebx, VREG(b6), MEMREG0(b11, b16));
-				case 167: EMIT(stvehx, VREG(b6), MEMREG0(b11, b16));
-				case 199: EMIT(stvewx, VREG(b6), MEMREG0(b11, b16));
-
-				// cmpw, cmpd
-				case 0:
-				{
-					const BitField<10,1> l(instrWord);
-					if (!l) EMIT(cmpw, CREG(bf), REG(b11), REG(b16));
-					EMIT(cmpd, CREG(bf), REG(b11), REG(b16));
-				}
-
-				// cmplw, cmpld
-				case 32:
-				{
-					const BitField<10,1> l(instrWord);
-					if (!l) EMIT(cmplw, CREG(bf), REG(b11), REG(b16));
-					EMIT(cmpld, CREG(bf), REG(b11), REG(b16));
-				}
-
-				// td, tw
-				case 68: EMIT(td, b6, REG(b11), REG(b16));
-				case 4: EMIT(tw, b6, REG(b11), REG(b16));
-
-				// and, and., or, or., xor, xor., nand, nand, nor, nor., eqv, eqv., andc, andc., orc, orc
-				case 28: EMIT_RC(and, REG(b11), REG(b6), REG(b16));
-				case 444: EMIT_RC(or, REG(b11), REG(b6), REG(b16));
-				case 316: EMIT_RC(xor, REG(b11), REG(b6), REG(b16));
-				case 476: EMIT_RC(nand, REG(b11), REG(b6), REG(b16));
-				case 124: EMIT_RC(nor, REG(b11), REG(b6), REG(b16));
-				case 284: EMIT_RC(eqv, REG(b11), REG(b6), REG(b16));
-				case 60: EMIT_RC(andc, REG(b11), REG(b6), REG(b16));
-				case 412: EMIT_RC(orc, REG(b11), REG(b6), REG(b16));
-
-				// extsb, extsb., extsh, extsh., extsw, extsw., popcntb, popcntb., cntlzw, cntlzw., cntlzd, cntlzd.
-				case 954: EMIT_RC(extsb, REG(b11), REG(b6));
-				case 922: EMIT_RC(extsh, REG(b11), REG(b6));
-				case 986: EMIT_RC(extsw, REG(b11), REG(b6));
-				case 122: EMIT(popcntb, REG(b11), REG(b6));
-				case 26: EMIT_RC(cntlzw, REG(b11), REG(b6));
-				case 58: EMIT_RC(cntlzd, REG(b11), REG(b6));
-
-				// sld, sld., slw, slw., srd, srd., srw, srw., srad, srad., sraw, sraw.
-				case 27: EMIT_RC(sld, REG(b11), REG(b6), REG(b16));
-				case 24: EMIT_RC(slw, REG(b11), REG(b6), REG(b16));
-				case 539: EMIT_RC(srd, REG(b11), REG(b6), REG(b16));
-				case 536: EMIT_RC(srw, REG(b11), REG(b6), REG(b16));
-				case 794: EMIT_RC(srad, REG(b11), REG(b6), REG(b16));
-				case 792: EMIT_RC(sraw, REG(b11), REG(b6), REG(b16));
-
-				// sradi, sradi., srawi, srawi.
-				case 824: EMIT_RC(srawi, REG(b11), REG(b6), sh16);
-				case 826: EMIT_RC(sradi, REG(b11), REG(b6), sh16); // 413*3+0
-				case 827: EMIT_RC(sradi, REG(b11), REG(b6), sh16 + 32); // 413*3+1
-
-				// mtspr, mfspr (move to/from system register)
-				case 467: CHECK(SREG(spr11)); EMIT(mtspr, SREG(spr11), REG(b6));
-				case 339: CHECK(SREG(spr11)); EMIT(mfspr, REG(b6), SREG(spr11));
-
-				// mtcrf, mtocrf
-				case 144:
-					if (b11x1==0) EMIT(mtcrf, fxm, REG(b6));
-					EMIT(mtocrf, fxm, REG(b6));
-
-				// mfcr, mfocrf
-				case 19:
-					if (b11x1==0) EMIT(mfcr, REG(b6));
-					EMIT(mfocrf, fxm, REG(b6));
-
-				// mfmsr (move to/from machine state register)
-				case 83: EMIT(mfmsr, REG(b6), m_regMap[eRegister_MSR]);
-				case 178:
-					if (b11x1==0) EMIT(mtmsrd, m_regMap[eRegister_MSR], REG(b6));
-					EMIT(mtmsree, m_regMap[eRegister_MSR], REG(b6));
-
-				// mftb (move from time base register)
-				case 371: EMIT(mftb, REG(b6), b11, b16);
-
-				// lwarx/stwcx
-				case 20: EMIT(lwarx, REG(b6), MEMREG0(b11,b16));
-				case 84: EMIT(ldarx, REG(b6), MEMREG0(b11,b16));
-				case 150: CHECK(rc==1); EMIT(stwcxRC, REG(b6), MEMREG0(b11,b16));
-				case 214: CHECK(rc==1); EMIT(stdcxRC, REG(b6), MEMREG0(b11,b16));
-
-				// sync (memory bariers)
-				case 598: if (b9x2==0) EMIT(sync);
-					if (b9x2==1) EMIT(lwsync);
-					if (b9x2==2) EMIT(ptesync);
-					ERROR("Decode: Invalid sync instruction type");
-
-				// eieio
-				case 854: EMIT(eieio);
-
-				// cache operations
-				case 86: EMIT(dcbf, REG(b11), REG(b16));
-				case 54: EMIT(dcbst, REG(b11), REG(b16));
-				case 278: EMIT(dcbt, REG(b11), REG(b16));
-				case 246: EMIT(dcbtst, REG(b11), REG(b16));
-				case 1014: EMIT(dcbz, MEMREG0(b11,b16));
-
-				// lfsx, lfsux, lfdx, lfdux
-				case 535: EMIT(lfsx, FREG(b6), MEMREG0(b11, b16));
-				case 567: EMIT(lfsux, FREG(b6), MEMREG(b11, b16));
-				case 599: EMIT(lfdx, FREG(b6), MEMREG0(b11, b16));
-				case 631: EMIT(lfdux, FREG(b6), MEMREG(b11, b16));
-
-				// stfsx, stfsux, stfdx, stfdux, stfiwx
-				case 663: EMIT(stfsx, FREG(b6), MEMREG0(b11, b16));
-				case 695: EMIT(stfsux, FREG(b6), MEMREG(b11, b16));
-				case 727: EMIT(stfdx, FREG(b6), MEMREG0(b11, b16));
-				case 759: EMIT(stfdux, FREG(b6), MEMREG(b11, b16));
-				case 983: EMIT(stfiwx, FREG(b6), MEMREG0(b11, b16));
-			}
-
-			// xo21 ext
-			const BitField<21,11> xo21ext(instrWord);
-			switch (xo21ext)
-			{
-				// VMX loads
-				case 1038: EMIT(lvlx, VREG(b6), MEMREG0(b11, b16));
-				case 1550: EMIT(lvlxl, VREG(b6), MEMREG0(b11, b16));
-				case 1102: EMIT(lvrx, VREG(b6), MEMREG0(b11, b16));
-				case 1614: EMIT(lvrxl, VREG(b6), MEMREG0(b11, b16));
-				case 206: EMIT(lvx, VREG(b6), MEMREG0(b11, b16));
-				case 718: EMIT(lvxl, VREG(b6), MEMREG0(b11, b16));
-				case 12: EMIT(lvsl, VREG(b6), REG(b11), REG(b16));
-				case 76: EMIT(lvsr, VREG(b6), REG(b11), REG(b16));
-
-				// VMX stores
-				case 270: EMIT(stvebx, VREG(b6), MEMREG0(b11, b16));
-				case 334: EMIT(stvehx, VREG(b6), MEMREG0(b11, b16));
-				case 398: EMIT(stvewx, VREG(b6), MEMREG0(b11, b16));
-				case 1294: EMIT(stvlx, VREG(b6), MEMREG0(b11, b16));
-				case 1806: EMIT(stvlxl, VREG(b6), MEMREG0(b11, b16));
-				case 1358: EMIT(stvrx, VREG(b6), MEMREG0(b11, b16));
-				case 1870: EMIT(stvrxl, VREG(b6), MEMREG0(b11, b16));
-				case 462: EMIT(stvx, VREG(b6), MEMREG0(b11, b16));
-				case 974: EMIT(stvxl, VREG(b6), MEMREG0(b11, b16));
-			}
-
-			// xo22 (math)
-			const BitField<22,9> xo22(instrWord);
-			switch (xo22)
-			{
-				// add, add., addo, addo.
-				case 266: EMIT_MATH(add, REG(b6), REG(b11), REG(b16));
-
-				// addc, addc., addco, addco.
-				case 10: EMIT_MATH(addc, REG(b6), REG(b11), REG(b16));
-
-				// adde, adde., addeo, addeo.
-				case 138: EMIT_MATH(adde, REG(b6), REG(b11), REG(b16));
-
-				// addme, addme., addmeo, addmeo.
-				case 234: EMIT_MATH(addme, REG(b6), REG(b11));
-
-				// addze, addze., addzeo, addzeo.
-				case 202: EMIT_MATH(addze, REG(b6), REG(b11));
-
-				// subf, subf., subfo, subfo.
-				case 40: EMIT_MATH(subf, REG(b6), REG(b11), REG(b16));
-
-				// subfc, subfc., subfco, subfco.
-				case 8: EMIT_MATH(subfc, REG(b6), REG(b11), REG(b16));
-
-				// subfe, subfe., subfeo, subfeo.
-				case 136: EMIT_MATH(subfe, REG(b6), REG(b11), REG(b16));
-
-				// subfme, subfme., subfmeo, subfmeo.
-				case 232: EMIT_MATH(subfme, REG(b6), REG(b11));
-
-				// subfze, subfze., subfzeo, subfzeo.
-				case 200: EMIT_MATH(subfze, REG(b6), REG(b11));
-				
-			    // neg, neg., nego, nego.
-				case 104: EMIT_MATH(neg, REG(b6), REG(b11));
-
-				// mulld, mulld., mulldo, mulldo.
-				case 233: EMIT_MATH(mulld, REG(b6), REG(b11), REG(b16));
-
-				// mullw, mullw., mullwo, mullwo.
-				case 235: EMIT_MATH(mullw, REG(b6), REG(b11), REG(b16));
-
-				// mullhd, mullhd.
-				case 73: EMIT_RC(mullhd, REG(b6), REG(b11), REG(b16));
-
-				// mullhw, mullhw.
-				case 75: EMIT_RC(mullhw, REG(b6), REG(b11), REG(b16));
-
-				// mullhdu, mullhdu.
-				case 9: EMIT_RC(mulhdu, REG(b6), REG(b11), REG(b16));
-
-				// mullhwu, mullhwu.
-				case 11: EMIT_RC(mulhwu, REG(b6), REG(b11), REG(b16));
-
-				// divd, divd., divdo, divdo.
-				case 489: EMIT_MATH(divd, REG(b6), REG(b11), REG(b16));
-
-				// divw, divw., divwo, divwo.
-				case 491: EMIT_MATH(divw, REG(b6), REG(b11), REG(b16));
-
-				// divdu, divdu., divduo, divduo.
-				case 457: EMIT_MATH(divdu, REG(b6), REG(b11), REG(b16));
-
-				// divwu, divwu., divwuo, divwuo.
-				case 459: EMIT_MATH(divwu, REG(b6), REG(b11), REG(b16));
+				case 1: EMIT(vrlw, vreg6, vreg11, vreg16);
+				case 3: EMIT(vslw, vreg6, vreg11, vreg16);
+				case 5: EMIT(vsraw, vreg6, vreg11, vreg16);
+				case 7: EMIT(vsrw, vreg6, vreg11, vreg16);
+
+				case 12: EMIT(vrfim, vreg6, vreg16);
+				case 13: EMIT(vrfin, vreg6, vreg16);
+				case 14: EMIT(vrfip, vreg6, vreg16);
+				case 15: EMIT(vrfiz, vreg6, vreg16);
 			}
-
-			ERROR("Decode: Unmatched secondary opcode %d for primary %d", xo21, pri);
 		}
 
-		// lbz, lbzu
-		case 34: EMIT( lbz, REG(b6), MEMOFS0(b11,d) );
-		case 35: EMIT( lbzu, REG(b6), MEMOFS0(b11,d) );
-
-		// lhz, lhzu, lha, lhau
-		case 40: EMIT( lhz, REG(b6), MEMOFS0(b11,d) );
-		case 41: EMIT( lhzu, REG(b6), MEMOFS0(b11,d) );
-		case 42: EMIT( lha, REG(b6), MEMOFS0(b11,d) );
-		case 43: EMIT( lhau, REG(b6), MEMOFS0(b11,d) );
-
-		// lwz, lwzu
-		case 32: EMIT( lwz, REG(b6), MEMOFS0(b11,d) );
-		case 33: EMIT( lwzu, REG(b6), MEMOFS0(b11,d) );
-
-		// lwa, ld, ldu
-		case 58: 
-			if (aa && !lk) EMIT( lwa, REG(b6), MEMOFS0(b11,ds4) ); // offset is *4
-			if (!aa && !lk) EMIT( ld, REG(b6), MEMOFS0(b11,ds4) ); // offset is *4
-			if (!aa && lk) EMIT( ldu, REG(b6), MEMOFS0(b11,ds4) ); // offset is *4
-			ERROR("Decode: unsupported format of opcode %d", pri);
-
-		// stb, stbu
-		case 38: EMIT( stb, REG(b6), MEMOFS0(b11,d) );
-		case 39: EMIT( stbu, REG(b6), MEMOFS0(b11,d) );
-
-		// sth, sthu
-		case 44: EMIT( sth, REG(b6), MEMOFS0(b11,d) );
-		case 45: EMIT( sthu, REG(b6), MEMOFS0(b11,d) );
-
-		// stw, stwu
-		case 36: EMIT( stw, REG(b6), MEMOFS0(b11,d) );
-		case 37: EMIT( stwu, REG(b6), MEMOFS0(b11,d) );
-
-	    // lmw, stmw (oad/store multiple words)
-		//case 46: EMIT( lmw, REG(b6), MEMOFS0(b11,d) );
-		//case 47: EMIT( stmw, REG(b6), MEMOFS0(b11,d) );
-
-		// lfs, lfsu, lfd, lfdu
-		case 48: EMIT( lfs, FREG(b6), MEMOFS0(b11,d) );
-		case 49: EMIT( lfsu, FREG(b6), MEMOFS0(b11,d) );
-		case 50: EMIT( lfd, FREG(b6), MEMOFS0(b11,d) );
-		case 51: EMIT( lfdu, FREG(b6), MEMOFS0(b11,d) );
-
-		// stfs, stfsu, stfd, stfdu
-		case 52: EMIT( stfs, FREG(b6), MEMOFS0(b11,d) );
-		case 53: EMIT( stfsu, FREG(b6), MEMOFS0(b11,d) );
-		case 54: EMIT( stfd, FREG(b6), MEMOFS0(b11,d) );
-		case 55: EMIT( stfdu, FREG(b6), MEMOFS0(b11,d) );
-
-		// floating point math (single precission)
-		case 59:
-		{
-			const BitField<26,5> xo26(instrWord);
-			switch (xo26)
-			{
-				// fadd, fsub, fmul, fdiv
-				case 21: EMIT_RC(fadds, FREG(b6), FREG(b11), FREG(b16));
-				case 20: EMIT_RC(fsubs, FREG(b6), FREG(b11), FREG(b16));
-				case 25: EMIT_RC(fmuls, FREG(b6), FREG(b11), FREG(b21));
-				case 18: EMIT_RC(fdivs, FREG(b6), FREG(b11), FREG(b16));
-
-				// fmadd, fmsub, fnmadd, fnmsub
-				case 29: EMIT_RC(fmadds, FREG(b6), FREG(b11), FREG(b21), FREG(b16));
-				case 28: EMIT_RC(fmsubs, FREG(b6), FREG(b11), FREG(b21), FREG(b16));
-				case 31: EMIT_RC(fnmadds, FREG(b6), FREG(b11), FREG(b21), FREG(b16));
-				case 30: EMIT_RC(fnmsubs, FREG(b6), FREG(b11), FREG(b21), FREG(b16));
-
-				// fsqrts, fres
-				case 22: EMIT_RC(fsqrt, FREG(b6), FREG(b16));
-				case 24: EMIT_RC(fre, FREG(b6), FREG(b16));
-			}
+		// unknown
+		ERROR("Decode: Unmatched secondary opcode xo21=%d, xo26=%d, xo21e=%d, xo22=%d for primary opcode %d",
+			vxo21, vxo26, vxo21e, vxo22, pri);
+	) );
+
+	// muli (multiply with immediate)
+	SetDefaultDecoder( 7, DECODER( EMIT(mulli, REG(b6), REG(b11), si); ) );
+
+	// subf( subtract from)
+	SetDefaultDecoder( 8, DECODER( EMIT(subfic, REG(b6), REG(b11), si); ) );
+
+	// cmplwi, cmpldi
+	SetDefaultDecoder( 10, DECODER(
+		if (!l) EMIT(cmplwi, CREG(bf), REG(b11), ui);
+		EMIT(cmpldi, CREG(bf), REG(b11), ui);
+	) );
+
+	// cmpwi, cmpdi
+	SetDefaultDecoder( 11, DECODER(
+		if (!l) EMIT(cmpwi, CREG(bf), REG(b11), si);
+		EMIT(cmpdi, CREG(bf), REG(b11), si);
+	) );
+
+	// addic, addic.
+	SetDefaultDecoder( 12, DECODER( EMIT( addic, REG(b6), REG(b11), si ); ) );
+	SetDefaultDecoder( 13, DECODER( EMIT( addicRC, REG(b6), REG(b11), si ); ) );
+
+	// addi, addis, li, lis
+	SetDefaultDecoder( 14, DECODER(
+		if (b11==0) EMIT( li, REG(b6), si );
+		EMIT( addi, REG(b6), REG(b11), si );
+	) );
+	SetDefaultDecoder( 15, DECODER(
+		if (b11==0) EMIT( lis, REG(b6), si );
+		EMIT( addis, REG(b6), REG(b11), si );
+	) );
+
+	// bc, bca, bcl, bcla
+	SetDefaultDecoder( 16, DECODER(
+		if (!aa && !lk)	EMIT(bc, b6, CBIT(b11), bd);
+		if (!aa && lk)  EMIT(bcl, b6, CBIT(b11), bd);
+		if (aa && !lk)  EMIT(bca, b6, CBIT(b11), bd);
+		EMIT(bcla, b6, CBIT(b11), bd);;
+	) );
+
+	// sc (system call)
+	SetDefaultDecoder( 17, DECODER( EMIT(sc, lev); ) );
+
+	// b,ba,bl,bla
+	SetDefaultDecoder( 18, DECODER(
+		if (!aa && !lk)	EMIT(b, li);
+		if (!aa && lk)  EMIT(bl, li);
+		if (aa && !lk)  EMIT(ba, li);
+		EMIT(bla, li);
+	) );
+
+	// bclr, bclrl
+	AddDecoder( 19, 21, 10, 16, DECODER(
+		if (lk)	EMIT(bclrl, b6, CBIT(b11));
+		EMIT(bclr, b6, CBIT(b11));
+	) );
+
+	// bcctr, bcctrl
+	AddDecoder( 19, 21, 10, 528, DECODER(
+		if (lk)	EMIT(bcctrl, b6, CBIT(b11));
+		EMIT(bcctr, b6, CBIT(b11));
+	) );
+
+	// conditonal register operations
+	AddDecoder( 19, 21, 10, 257, DECODER( EMIT(crand, CBIT(b6), CBIT(b11), CBIT(b16)); ) );
+	AddDecoder( 19, 21, 10, 449, DECODER( EMIT(cror, CBIT(b6), CBIT(b11), CBIT(b16)); ) );
+	AddDecoder( 19, 21, 10, 193, DECODER( EMIT(crxor, CBIT(b6), CBIT(b11), CBIT(b16)); ) );
+	AddDecoder( 19, 21, 10, 225, DECODER( EMIT(crnand, CBIT(b6), CBIT(b11), CBIT(b16)); ) );
+	AddDecoder( 19, 21, 10, 33, DECODER( EMIT(crnor, CBIT(b6), CBIT(b11), CBIT(b16)); ) );
+	AddDecoder( 19, 21, 10, 289, DECODER( EMIT(creqv, CBIT(b6), CBIT(b11), CBIT(b16)); ) );
+	AddDecoder( 19, 21, 10, 129, DECODER( EMIT(crandc, CBIT(b6), CBIT(b11), CBIT(b16)); ) );
+	AddDecoder( 19, 21, 10, 417, DECODER( EMIT(crorc, CBIT(b6), CBIT(b11), CBIT(b16)); ) );
+
+	// mcrf (move conditional register flag)
+	AddDecoder( 19, 21, 10, 0, DECODER( EMIT(mcrf, CREG(b6), CREG(b11)); ) );
+
+	// unknown
+	SetDefaultDecoder( 19, DECODER( ERROR("Decode: Unmatched secondary opcode %d for primary opcode %d", xo21, pri); ) );
+
+	// rlwimi, rlwimi., rlwinm, rlwinm., rlwnm, rlwnm.
+	SetDefaultDecoder( 20, DECODER( EMIT_RC(rlwimi, REG(b11), REG(b6), sh16, mb21, me26); ) );
+	SetDefaultDecoder( 21, DECODER( EMIT_RC(rlwinm, REG(b11), REG(b6), sh16, mb21, me26); ) );
+	SetDefaultDecoder( 23, DECODER( EMIT_RC(rlwnm, REG(b11), REG(b6), REG(b16), mb21, me26); ) );
+
+	// andi., andis., ori, oris, xori, xoris
+	SetDefaultDecoder( 24, DECODER( EMIT(ori, REG(b11), REG(b6), ui); ) );
+	SetDefaultDecoder( 25, DECODER( EMIT(oris, REG(b11), REG(b6), ui); ) );
+	SetDefaultDecoder( 26, DECODER( EMIT(xori, REG(b11), REG(b6), ui); ) );
+	SetDefaultDecoder( 27, DECODER( EMIT(xoris, REG(b11), REG(b6), ui); ) );
+	SetDefaultDecoder( 28, DECODER( EMIT(andiRC, REG(b11), REG(b6), ui); ) );
+	SetDefaultDecoder( 29, DECODER( EMIT(andisRC, REG(b11), REG(b6), ui); ) );
+
+	// shift opcodes
+
+	// rldicl, rldicl., rldicr, rldicr., rldic, rldic., rldimi, rldimi.
+	AddDecoder( 30, 27, 3, 0, DECODER( EMIT_RC(rldicl, REG(b11), REG(b6), sh16 + (aa?32:0), mb21 + (mb26x1?32:0)); ) );
+	AddDecoder( 30, 27, 3, 1, DECODER( EMIT_RC(rldicr, REG(b11), REG(b6), sh16 + (aa?32:0), mb21 + (mb26x1?32:0)); ) );
+	AddDecoder( 30, 27, 3, 2, DECODER( EMIT_RC(rldic, REG(b11), REG(b6), sh16 + (aa?32:0), mb21 + (mb26x1?32:0)); ) );
+	AddDecoder( 30, 27, 3, 3, DECODER( EMIT_RC(rldimi, REG(b11), REG(b6), sh16 + (aa?32:0), mb21 + (mb26x1?32:0)); ) );
+
+	// rldcl, rldcl., rldcr, rldcr.
+	AddDecoder( 30, 27, 4, 8, DECODER( EMIT_RC(rldcl, REG(b11), REG(b6), REG(b16), mb21 + (mb26x1?32:0)); ) );
+	AddDecoder( 30, 27, 4, 9, DECODER( EMIT_RC(rldcr, REG(b11), REG(b6), REG(b16), mb21 + (mb26x1?32:0)); ) );
+
+	// unknown
+	SetDefaultDecoder( 30, DECODER( ERROR("Decode: Unmatched secondary opcode %d for primary %d", xo27x4, pri); ) );
+
+	// extended opcodes
+
+	// lbzx, lbzxu
+	AddDecoder( 31, 21, 10, 87, DECODER( EMIT(lbzx, REG(b6), MEMREG0(b11,b16)); ) );
+	AddDecoder( 31, 21, 10, 119, DECODER( EMIT(lbzux, REG(b6), MEMREG(b11,b16)); ) );
+
+	// lhzx, lhzux, lhax, lhaux
+	AddDecoder( 31, 21, 10, 279, DECODER( EMIT(lhzx, REG(b6), MEMREG0(b11,b16)); ) );
+	AddDecoder( 31, 21, 10, 311, DECODER( EMIT(lhzux, REG(b6), MEMREG(b11,b16)); ) );
+	AddDecoder( 31, 21, 10, 343, DECODER( EMIT(lhax, REG(b6), MEMREG0(b11,b16)); ) );
+	AddDecoder( 31, 21, 10, 375, DECODER( EMIT(lhaux, REG(b6), MEMREG(b11,b16)); ) );
+
+	// lwzx, lwzux, lwax, lwaux
+	AddDecoder( 31, 21, 10, 23, DECODER( EMIT(lwzx, REG(b6), MEMREG0(b11,b16)); ) );
+	AddDecoder( 31, 21, 10, 55, DECODER( EMIT(lwzux, REG(b6), MEMREG(b11,b16)); ) );
+	AddDecoder( 31, 21, 10, 341, DECODER( EMIT(lwax, REG(b6), MEMREG0(b11,b16)); ) );
+	AddDecoder( 31, 21, 10, 373, DECODER( EMIT(lwaux, REG(b6), MEMREG(b11,b16)); ) );
+
+	// ldx, ldux
+	AddDecoder( 31, 21, 10, 21, DECODER( EMIT(ldx, REG(b6), MEMREG0(b11,b16)); ) );
+	AddDecoder( 31, 21, 10, 53, DECODER( EMIT(ldux, REG(b6), MEMREG(b11,b16)); ) );
+
+	// stbx, stbux
+	AddDecoder( 31, 21, 10, 215, DECODER( EMIT(stbx, REG(b6), MEMREG0(b11,b16)); ) );
+	AddDecoder( 31, 21, 10, 247, DECODER( EMIT(stbux, REG(b6), MEMREG(b11,b16)); ) );
+
+	// sthx, sthux
+	AddDecoder( 31, 21, 10, 407, DECODER( EMIT(sthx, REG(b6), MEMREG0(b11,b16)); ) );
+	AddDecoder( 31, 21, 10, 439, DECODER( EMIT(sthux, REG(b6), MEMREG(b11,b16)); ) );
+
+	// stwx, stwux
+	AddDecoder( 31, 21, 10, 151, DECODER( EMIT(stwx, REG(b6), MEMREG0(b11,b16)); ) );
+	AddDecoder( 31, 21, 10, 183, DECODER( EMIT(stwux, REG(b6), MEMREG(b11,b16)); ) );
+
+	// stdx, stdux
+	AddDecoder( 31, 21, 10, 149, DECODER( EMIT(stdx, REG(b6), MEMREG0(b11,b16)); ) );
+	AddDecoder( 31, 21, 10, 181, DECODER( EMIT(stdux, REG(b6), MEMREG(b11,b16)); ) );
+
+	// lhbrx, lwbrx, sthbrx, stwbrx
+	AddDecoder( 31, 21, 10, 790, DECODER( EMIT(lhbrx, REG(b6), MEMREG0(b11,b16)); ) );
+	AddDecoder( 31, 21, 10, 534, DECODER( EMIT(lwbrx, REG(b6), MEMREG0(b11,b16)); ) );
+	AddDecoder( 31, 21, 10, 918, DECODER( EMIT(sthbrx, REG(b6), MEMREG0(b11,b16)); ) );
+	AddDecoder( 31, 21, 10, 662, DECODER( EMIT(stwbrx, REG(b6), MEMREG0(b11,b16)); ) );
+
+	// lswi, lswx, stswi, stswx
+	AddDecoder( 31, 21, 10, 597, DECODER( EMIT(lswi, REG(b6), REG0(b11), b16); ) );
+	AddDecoder( 31, 21, 10, 533, DECODER( EMIT(lswx, REG(b6), REG0(b11), REG(b16)); ) );
+	AddDecoder( 31, 21, 10, 725, DECODER( EMIT(stswi, REG(b6), REG0(b11), b16); ) );
+	AddDecoder( 31, 21, 10, 661, DECODER( EMIT(stswx, REG(b6), REG0(b11), REG(b16)); ) );
+
+	// lvehx, lvebx, lvewx
+	AddDecoder( 31, 21, 10, 39, DECODER( EMIT(lvehx, VREG(b6), MEMREG0(b11, b16)); ) );
+	AddDecoder( 31, 21, 10, 7, DECODER( EMIT(lvebx, VREG(b6), MEMREG0(b11, b16)); ) );
+	AddDecoder( 31, 21, 10, 71, DECODER( EMIT(lvewx, VREG(b6), MEMREG0(b11, b16)); ) );
+
+	// stvebx, stvehx, stvewx
+	AddDecoder( 31, 21, 10, 135, DECODER( EMIT(stvebx, VREG(b6), MEMREG0(b11, b16)); ) );
+	AddDecoder( 31, 21, 10, 167, DECODER( EMIT(stvehx, VREG(b6), MEMREG0(b11, b16)); ) );
+	AddDecoder( 31, 21, 10, 199, DECODER( EMIT(stvewx, VREG(b6), MEMREG0(b11, b16)); ) );
+
+	// cmpw, cmpd
+	AddDecoder( 31, 21, 10, 0, DECODER(
+		if (!l) EMIT(cmpw, CREG(bf), REG(b11), REG(b16));
+		EMIT(cmpd, CREG(bf), REG(b11), REG(b16));
+	) );
+
+	// cmplw, cmpld
+	AddDecoder( 31, 21, 10, 32, DECODER(
+		if (!l) EMIT(cmplw, CREG(bf), REG(b11), REG(b16));
+		EMIT(cmpld, CREG(bf), REG(b11), REG(b16));
+	) );
+
+	// td, tw
+	AddDecoder( 31, 21, 10, 68, DECODER( EMIT(td, b6, REG(b11), REG(b16)); ) );
+	AddDecoder( 31, 21, 10, 4, DECODER( EMIT(tw, b6, REG(b11), REG(b16)); ) );
+
+	// and, and., or, or., xor, xor., nand, nand, nor, nor., eqv, eqv., andc, andc., orc, orc
+	AddDecoder( 31, 21, 10, 28, DECODER( EMIT_RC(and, REG(b11), REG(b6), REG(b16)); ) );
+	AddDecoder( 31, 21, 10, 444, DECODER(
+		// or nops/moves
+		if (b11==b16 && b11==b6 && !rc) EMIT(nop);
+		if (b6==b16 && b11!=b6 && !rc) EMIT(mr, REG(b11), REG(b6));
+		EMIT_RC(or, REG(b11), REG(b6), REG(b16));
+	) );
+	AddDecoder( 31, 21, 10, 316, DECODER( EMIT_RC(xor, REG(b11), REG(b6), REG(b16)); ) );
+	AddDecoder( 31, 21, 10, 476, DECODER( EMIT_RC(nand, REG(b11), REG(b6), REG(b16)); ) );
+	AddDecoder( 31, 21, 10, 124, DECODER( EMIT_RC(nor, REG(b11), REG(b6), REG(b16)); ) );
+	AddDecoder( 31, 21, 10, 284, DECODER( EMIT_RC(eqv, REG(b11), REG(b6), REG(b16)); ) );
+	AddDecoder( 31, 21, 10, 60, DECODER( EMIT_RC(andc, REG(b11), REG(b6), REG(b16)); ) );
+	AddDecoder( 31, 21, 10, 412, DECODER( EMIT_RC(orc, REG(b11), REG(b6), REG(b16)); ) );
+
+	// extsb, extsb., extsh, extsh., extsw, extsw., popcntb, popcntb., cntlzw, cntlzw., cntlzd, cntlzd.
+	AddDecoder( 31, 21, 10, 954, DECODER( EMIT_RC(extsb, REG(b11), REG(b6)); ) );
+	AddDecoder( 31, 21, 10, 922, DECODER( EMIT_RC(extsh, REG(b11), REG(b6)); ) );
+	AddDecoder( 31, 21, 10, 986, DECODER( EMIT_RC(extsw, REG(b11), REG(b6)); ) );
+	AddDecoder( 31, 21, 10, 122, DECODER( EMIT(popcntb, REG(b11), REG(b6)); ) );
+	AddDecoder( 31, 21, 10, 26, DECODER( EMIT_RC(cntlzw, REG(b11), REG(b6)); ) );
+	AddDecoder( 31, 21, 10, 58, DECODER( EMIT_RC(cntlzd, REG(b11), REG(b6)); ) );
+
+	// sld, sld., slw, slw., srd, srd., srw, srw., srad, srad., sraw, sraw.
+	AddDecoder( 31, 21, 10, 27, DECODER( EMIT_RC(sld, REG(b11), REG(b6), REG(b16)); ) );
+	AddDecoder( 31, 21, 10, 24, DECODER( EMIT_RC(slw, REG(b11), REG(b6), REG(b16)); ) );
+	AddDecoder( 31, 21, 10, 539, DECODER( EMIT_RC(srd, REG(b11), REG(b6), REG(b16)); ) );
+	AddDecoder( 31, 21, 10, 536, DECODER( EMIT_RC(srw, REG(b11), REG(b6), REG(b16)); ) );
+	AddDecoder( 31, 21, 10, 794, DECODER( EMIT_RC(srad, REG(b11), REG(b6), REG(b16)); ) );
+	AddDecoder( 31, 21, 10, 792, DECODER( EMIT_RC(sraw, REG(b11), REG(b6), REG(b16)); ) );
+
+	// sradi, sradi., srawi, srawi.
+	AddDecoder( 31, 21, 10, 824, DECODER( EMIT_RC(srawi, REG(b11), REG(b6), sh16); ) );
+	AddDecoder( 31, 21, 10, 826, DECODER( EMIT_RC(sradi, REG(b11), REG(b6), sh16); ) ); // 413*3+0
+	AddDecoder( 31, 21, 10, 827, DECODER( EMIT_RC(sradi, REG(b11), REG(b6), sh16 + 32); ) ); // 413*3+1
+
+	// mtspr, mfspr (move to/from system register)
+	AddDecoder( 31, 21, 10, 467, DECODER( CHECK(SREG(spr11)); EMIT(mtspr, SREG(spr11), REG(b6)); ) );
+	AddDecoder( 31, 21, 10, 339, DECODER( CHECK(SREG(spr11)); EMIT(mfspr, REG(b6), SREG(spr11)); ) );
+
+	// mtcrf, mtocrf
+	AddDecoder( 31, 21, 10, 144, DECODER(
+		if (b11x1==0) EMIT(mtcrf, fxm, REG(b6));
+		EMIT(mtocrf, fxm, REG(b6));
+	) );
+
+	// mfcr, mfocrf
+	AddDecoder( 31, 21, 10, 19, DECODER(
+		if (b11x1==0) EMIT(mfcr, REG(b6));
+		EMIT(mfocrf, fxm, REG(b6));
+	) );
+
+	// mfmsr (move to/from machine state register)
+	AddDecoder( 31, 21, 10, 83, DECODER( EMIT(mfmsr, REG(b6), self->m_regMap[eRegister_MSR]); ) );
+	AddDecoder( 31, 21, 10, 178, DECODER(
+		if (b11x1==0) EMIT(mtmsrd, self->m_regMap[eRegister_MSR], REG(b6));
+		EMIT(mtmsree, self->m_regMap[eRegister_MSR], REG(b6));
+	) );
+
+	// mftb (move from time base register)
+	AddDecoder( 31, 21, 10, 371, DECODER( EMIT(mftb, REG(b6), b11, b16); ) );
+
+	// lwarx/stwcx
+	AddDecoder( 31, 21, 10, 20, DECODER( EMIT(lwarx, REG(b6), MEMREG0(b11,b16)); ) );
+	AddDecoder( 31, 21, 10, 84, DECODER( EMIT(ldarx, REG(b6), MEMREG0(b11,b16)); ) );
+	AddDecoder( 31, 21, 10, 150, DECODER( CHECK(rc==1); EMIT(stwcxRC, REG(b6), MEMREG0(b11,b16)); ) );
+	AddDecoder( 31, 21, 10, 214, DECODER( CHECK(rc==1); EMIT(stdcxRC, REG(b6), MEMREG0(b11,b16)); ) );
+
+	// sync (memory bariers)
+	AddDecoder( 31, 21, 10, 598, DECODER(
+		if (b9x2==0) EMIT(sync);
+		if (b9x2==1) EMIT(lwsync);
+		if (b9x2==2) EMIT(ptesync);
+		ERROR("Decode: Invalid sync instruction type");
+	) );
+
+	// eieio
+	AddDecoder( 31, 21, 10, 854, DECODER( EMIT(eieio); ) );
+
+	// cache operations
+	AddDecoder( 31, 21, 10, 86, DECODER( EMIT(dcbf, REG(b11), REG(b16)); ) );
+	AddDecoder( 31, 21, 10, 54, DECODER( EMIT(dcbst, REG(b11), REG(b16)); ) );
+	AddDecoder( 31, 21, 10, 278, DECODER( EMIT(dcbt, REG(b11), REG(b16)); ) );
+	AddDecoder( 31, 21, 10, 246, DECODER( EMIT(dcbtst, REG(b11), REG(b16)); ) );
+	AddDecoder( 31, 21, 10, 1014, DECODER( EMIT(dcbz, MEMREG0(b11,b16)); ) );
+
+	// lfsx, lfsux, lfdx, lfdux
+	AddDecoder( 31, 21, 10, 535, DECODER( EMIT(lfsx, FREG(b6), MEMREG0(b11, b16)); ) );
+	AddDecoder( 31, 21, 10, 567, DECODER( EMIT(lfsux, FREG(b6), MEMREG(b11, b16)); ) );
+	AddDecoder( 31, 21, 10, 599, DECODER( EMIT(lfdx, FREG(b6), MEMREG0(b11, b16)); ) );
+	AddDecoder( 31, 21, 10, 631, DECODER( EMIT(lfdux, FREG(b6), MEMREG(b11, b16)); ) );
+
+	// stfsx, stfsux, stfdx, stfdux, stfiwx
+	AddDecoder( 31, 21, 10, 663, DECODER( EMIT(stfsx, FREG(b6), MEMREG0(b11, b16)); ) );
+	AddDecoder( 31, 21, 10, 695, DECODER( EMIT(stfsux, FREG(b6), MEMREG(b11, b16)); ) );
+	AddDecoder( 31, 21, 10, 727, DECODER( EMIT(stfdx, FREG(b6), MEMREG0(b11, b16)); ) );
+	AddDecoder( 31, 21, 10, 759, DECODER( EMIT(stfdux, FREG(b6), MEMREG(b11, b16)); ) );
+	AddDecoder( 31, 21, 10, 983, DECODER( EMIT(stfiwx, FREG(b6), MEMREG0(b11, b16)); ) );
+
+	// xo21 ext
+
+	// VMX loads
+	AddDecoder( 31, 21, 11, 1038, DECODER( EMIT(lvlx, VREG(b6), MEMREG0(b11, b16)); ) );
+	AddDecoder( 31, 21, 11, 1550, DECODER( EMIT(lvlxl, VREG(b6), MEMREG0(b11, b16)); ) );
+	AddDecoder( 31, 21, 11, 1102, DECODER( EMIT(lvrx, VREG(b6), MEMREG0(b11, b16)); ) );
+	AddDecoder( 31, 21, 11, 1614, DECODER( EMIT(lvrxl, VREG(b6), MEMREG0(b11, b16)); ) );
+	AddDecoder( 31, 21, 11, 206, DECODER( EMIT(lvx, VREG(b6), MEMREG0(b11, b16)); ) );
+	AddDecoder( 31, 21, 11, 718, DECODER( EMIT(lvxl, VREG(b6), MEMREG0(b11, b16)); ) );
+	AddDecoder( 31, 21, 11, 12, DECODER( EMIT(lvsl, VREG(b6), REG(b11), REG(b16)); ) );
+	AddDecoder( 31, 21, 11, 76, DECODER( EMIT(lvsr, VREG(b6), REG(b11), REG(b16)); ) );
+
+	// VMX stores
+	AddDecoder( 31, 21, 11, 270, DECODER( EMIT(stvebx, VREG(b6), MEMREG0(b11, b16)); ) );
+	AddDecoder( 31, 21, 11, 334, DECODER( EMIT(stvehx, VREG(b6), MEMREG0(b11, b16)); ) );
+	AddDecoder( 31, 21, 11, 398, DECODER( EMIT(stvewx, VREG(b6), MEMREG0(b11, b16)); ) );
+	AddDecoder( 31, 21, 11, 1294, DECODER( EMIT(stvlx, VREG(b6), MEMREG0(b11, b16)); ) );
+	AddDecoder( 31, 21, 11, 1806, DECODER( EMIT(stvlxl, VREG(b6), MEMREG0(b11, b16)); ) );
+	AddDecoder( 31, 21, 11, 1358, DECODER( EMIT(stvrx, VREG(b6), MEMREG0(b11, b16)); ) );
+	AddDecoder( 31, 21, 11, 1870, DECODER( EMIT(stvrxl, VREG(b6), MEMREG0(b11, b16)); ) );
+	AddDecoder( 31, 21, 11, 462, DECODER( EMIT(stvx, VREG(b6), MEMREG0(b11, b16)); ) );
+	AddDecoder( 31, 21, 11, 974, DECODER( EMIT(stvxl, VREG(b6), MEMREG0(b11, b16)); ) );
+
+	// xo22 (math)
+
+	// add, add., addo, addo.
+	AddDecoder( 31, 22, 9, 266, DECODER( EMIT_MATH(add, REG(b6), REG(b11), REG(b16)); ) );
+
+	// addc, addc., addco, addco.
+	AddDecoder( 31, 22, 9, 10, DECODER( EMIT_MATH(addc, REG(b6), REG(b11), REG(b16)); ) );
+
+	// adde, adde., addeo, addeo.
+	AddDecoder( 31, 22, 9, 138, DECODER( EMIT_MATH(adde, REG(b6), REG(b11), REG(b16)); ) );
+
+	// addme, addme., addmeo, addmeo.
+	AddDecoder( 31, 22, 9, 234, DECODER( EMIT_MATH(addme, REG(b6), REG(b11)); ) );
+
+	// addze, addze., addzeo, addzeo.
+	AddDecoder( 31, 22, 9, 202, DECODER( EMIT_MATH(addze, REG(b6), REG(b11)); ) );
+
+	// subf, subf., subfo, subfo.
+	AddDecoder( 31, 22, 9, 40, DECODER( EMIT_MATH(subf, REG(b6), REG(b11), REG(b16)); ) );
+
+	// subfc, subfc., subfco, subfco.
+	AddDecoder( 31, 22, 9, 8, DECODER( EMIT_MATH(subfc, REG(b6), REG(b11), REG(b16)); ) );
+
+	// subfe, subfe., subfeo, subfeo.
+	AddDecoder( 31, 22, 9, 136, DECODER( EMIT_MATH(subfe, REG(b6), REG(b11), REG(b16)); ) );
+
+	// subfme, subfme., subfmeo, subfmeo.
+	AddDecoder( 31, 22, 9, 232, DECODER( EMIT_MATH(subfme, REG(b6), REG(b11)); ) );
+
+	// subfze, subfze., subfzeo, subfzeo.
+	AddDecoder( 31, 22, 9, 200, DECODER( EMIT_MATH(subfze, REG(b6), REG(b11)); ) );
+
+	// neg, neg., nego, nego.
+	AddDecoder( 31, 22, 9, 104, DECODER( EMIT_MATH(neg, REG(b6), REG(b11)); ) );
+
+	// mulld, mulld., mulldo, mulldo.
+	AddDecoder( 31, 22, 9, 233, DECODER( EMIT_MATH(mulld, REG(b6), REG(b11), REG(b16)); ) );
+
+	// mullw, mullw., mullwo, mullwo.
+	AddDecoder( 31, 22, 9, 235, DECODER( EMIT_MATH(mullw, REG(b6), REG(b11), REG(b16)); ) );
+
+	// mullhd, mullhd.
+	AddDecoder( 31, 22, 9, 73, DECODER( EMIT_RC(mullhd, REG(b6), REG(b11), REG(b16)); ) );
+
+	// mullhw, mullhw.
+	AddDecoder( 31, 22, 9, 75, DECODER( EMIT_RC(mullhw, REG(b6), REG(b11), REG(b16)); ) );
+
+	// mullhdu, mullhdu.
+	AddDecoder( 31, 22, 9, 9, DECODER( EMIT_RC(mulhdu, REG(b6), REG(b11), REG(b16)); ) );
+
+	// mullhwu, mullhwu.
+	AddDecoder( 31, 22, 9, 11, DECODER( EMIT_RC(mulhwu, REG(b6), REG(b11), REG(b16)); ) );
+
+	// divd, divd., divdo, divdo.
+	AddDecoder( 31, 22, 9, 489, DECODER( EMIT_MATH(divd, REG(b6), REG(b11), REG(b16)); ) );
+
+	// divw, divw., divwo, divwo.
+	AddDecoder( 31, 22, 9, 491, DECODER( EMIT_MATH(divw, REG(b6), REG(b11), REG(b16)); ) );
+
+	// divdu, divdu., divduo, divduo.
+	AddDecoder( 31, 22, 9, 457, DECODER( EMIT_MATH(divdu, REG(b6), REG(b11), REG(b16)); ) );
+
+	// divwu, divwu., divwuo, divwuo.
+	AddDecoder( 31, 22, 9, 459, DECODER( EMIT_MATH(divwu, REG(b6), REG(b11), REG(b16)); ) );
+
+	// unknown
+	SetDefaultDecoder( 31, DECODER( ERROR("Decode: Unmatched secondary opcode %d for primary %d", xo21, pri); ) );
+
+	// lbz, lbzu
+	SetDefaultDecoder( 34, DECODER( EMIT( lbz, REG(b6), MEMOFS0(b11,d) ); ) );
+	SetDefaultDecoder( 35, DECODER( EMIT( lbzu, REG(b6), MEMOFS0(b11,d) ); ) );
+
+	// lhz, lhzu, lha, lhau
+	SetDefaultDecoder( 40, DECODER( EMIT( lhz, REG(b6), MEMOFS0(b11,d) ); ) );
+	SetDefaultDecoder( 41, DECODER( EMIT( lhzu, REG(b6), MEMOFS0(b11,d) ); ) );
+	SetDefaultDecoder( 42, DECODER( EMIT( lha, REG(b6), MEMOFS0(b11,d) ); ) );
+	SetDefaultDecoder( 43, DECODER( EMIT( lhau, REG(b6), MEMOFS0(b11,d) ); ) );
+
+	// lwz, lwzu
+	SetDefaultDecoder( 32, DECODER( EMIT( lwz, REG(b6), MEMOFS0(b11,d) ); ) );
+	SetDefaultDecoder( 33, DECODER( EMIT( lwzu, REG(b6), MEMOFS0(b11,d) ); ) );
+
+	// lwa, ld, ldu
+	SetDefaultDecoder( 58, DECODER(
+		if (aa && !lk) EMIT( lwa, REG(b6), MEMOFS0(b11,ds4) ); // offset is *4
+		if (!aa && !lk) EMIT( ld, REG(b6), MEMOFS0(b11,ds4) ); // offset is *4
+		if (!aa && lk) EMIT( ldu, REG(b6), MEMOFS0(b11,ds4) ); // offset is *4
+		ERROR("Decode: unsupported format of opcode %d", pri);
+	) );
+
+	// stb, stbu
+	SetDefaultDecoder( 38, DECODER( EMIT( stb, REG(b6), MEMOFS0(b11,d) ); ) );
+	SetDefaultDecoder( 39, DECODER( EMIT( stbu, REG(b6), MEMOFS0(b11,d) ); ) );
+
+	// sth, sthu
+	SetDefaultDecoder( 44, DECODER( EMIT( sth, REG(b6), MEMOFS0(b11,d) ); ) );
+	SetDefaultDecoder( 45, DECODER( EMIT( sthu, REG(b6), MEMOFS0(b11,d) ); ) );
 
-			ERROR("Decode: Unmatched secondary opcode xo26=%d for primary %d", xo26, pri);
-		}
-
-		// std, stdu
-		case 62:
-			if (!aa && !lk) EMIT( std, REG(b6), MEMOFS0(b11,ds4) ); // offset is *4
-			if (!aa && lk) EMIT( stdu, REG(b6), MEMOFS0(b11,ds4) ); // offset is *4
-			ERROR("Decode: unsupported format of opcode %d", pri);
+	// stw, stwu
+	SetDefaultDecoder( 36, DECODER( EMIT( stw, REG(b6), MEMOFS0(b11,d) ); ) );
+	SetDefaultDecoder( 37, DECODER( EMIT( stwu, REG(b6), MEMOFS0(b11,d) ); ) );
 
-		// floating point math (double precission)
-		case 63:
-		{
-			const BitField<21,10> xo21(instrWord);
-			switch (xo21)
-			{
-				// fmr, fneg, fabs, fnabs
-				case 72: EMIT_RC(fmr, FREG(b6), FREG(b16));
-				case 40: EMIT_RC(fneg, FREG(b6), FREG(b16));
-				case 264: EMIT_RC(fabs, FREG(b6), FREG(b16));
-				case 136: EMIT_RC(fnabs, FREG(b6), FREG(b16));
-
-				// frsp, fctid, fctidz, fctiw, fctiwz, fcfid
-				case 12: EMIT_RC(frsp, FREG(b6), FREG(b16));
-				case 814: EMIT_RC(fctid, FREG(b6), FREG(b16));
-				case 815: EMIT_RC(fctidz, FREG(b6), FREG(b16));
-				case 14: EMIT_RC(fctiw, FREG(b6), FREG(b16));
-				case 15: EMIT_RC(fctiwz, FREG(b6), FREG(b16));
-				case 846: EMIT_RC(fcfid, FREG(b6), FREG(b16));
-
-				// fcmpu, fcmpo
-				case 0: EMIT(fcmpu, CREG(bf), FREG(b11), FREG(b16));
-				case 32: EMIT(fcmpo, CREG(bf), FREG(b11), FREG(b16));
-
-				// mffs, mcrfs, mtfsfi, mtfsf, mtfsb0, mtfsb1
-				case 583: EMIT_RC(mffs, FREG(b6));
-				case 64: EMIT(mcrfs, CREG(bf), FCREG(bfa));
-				case 134: EMIT_RC(mtfsfi, FCREG(bf), u16x4);
-				case 711: EMIT_RC(mtfsf, flm, FREG(frb));
-				case 70: EMIT_RC(mtfsb0, FCBIT(b6));
-				case 38: EMIT_RC(mtfsb1, FCBIT(b6));
-			}
+	// lmw, stmw (oad/store multiple words)
+	//case 46: EMIT( lmw, REG(b6), MEMOFS0(b11,d) );
+	//case 47: EMIT( stmw, REG(b6), MEMOFS0(b11,d) );
+
+	// lfs, lfsu, lfd, lfdu
+	SetDefaultDecoder( 48, DECODER( EMIT( lfs, FREG(b6), MEMOFS0(b11,d) ); ) );
+	SetDefaultDecoder( 49, DECODER( EMIT( lfsu, FREG(b6), MEMOFS0(b11,d) ); ) );
+	SetDefaultDecoder( 50, DECODER( EMIT( lfd, FREG(b6), MEMOFS0(b11,d) ); ) );
+	SetDefaultDecoder( 51, DECODER( EMIT( lfdu, FREG(b6), MEMOFS0(b11,d) ); ) );
+
+	// stfs, stfsu, stfd, stfdu
+	SetDefaultDecoder( 52, DECODER( EMIT( stfs, FREG(b6), MEMOFS0(b11,d) ); ) );
+	SetDefaultDecoder( 53, DECODER( EMIT( stfsu, FREG(b6), MEMOFS0(b11,d) ); ) );
+	SetDefaultDecoder( 54, DECODER( EMIT( stfd, FREG(b6), MEMOFS0(b11,d) ); ) );
+	SetDefaultDecoder( 55, DECODER( EMIT( stfdu, FREG(b6), MEMOFS0(b11,d) ); ) );
+
+	// floating point math (single precission)
+
+	// fadd, fsub, fmul, fdiv
+	AddDecoder( 59, 26, 5, 21, DECODER( EMIT_RC(fadds, FREG(b6), FREG(b11), FREG(b16)); ) );
+	AddDecoder( 59, 26, 5, 20, DECODER( EMIT_RC(fsubs, FREG(b6), FREG(b11), FREG(b16)); ) );
+	AddDecoder( 59, 26, 5, 25, DECODER( EMIT_RC(fmuls, FREG(b6), FREG(b11), FREG(b21)); ) );
+	AddDecoder( 59, 26, 5, 18, DECODER( EMIT_RC(fdivs, FREG(b6), FREG(b11), FREG(b16)); ) );
+
+	// fmadd, fmsub, fnmadd, fnmsub
+	AddDecoder( 59, 26, 5, 29, DECODER( EMIT_RC(fmadds, FREG(b6), FREG(b11), FREG(b21), FREG(b16)); ) );
+	AddDecoder( 59, 26, 5, 28, DECODER( EMIT_RC(fmsubs, FREG(b6), FREG(b11), FREG(b21), FREG(b16)); ) );
+	AddDecoder( 59, 26, 5, 31, DECODER( EMIT_RC(fnmadds, FREG(b6), FREG(b11), FREG(b21), FREG(b16)); ) );
+	AddDecoder( 59, 26, 5, 30, DECODER( EMIT_RC(fnmsubs, FREG(b6), FREG(b11), FREG(b21), FREG(b16)); ) );
+
+	// fsqrts, fres
+	AddDecoder( 59, 26, 5, 22, DECODER( EMIT_RC(fsqrt, FREG(b6), FREG(b16)); ) );
+	AddDecoder( 59, 26, 5, 24, DECODER( EMIT_RC(fre, FREG(b6), FREG(b16)); ) );
+
+	// unknown
+	SetDefaultDecoder( 59, DECODER( ERROR("Decode: Unmatched secondary opcode xo26=%d for primary %d", xo26, pri); ) );
+
+	// std, stdu
+	SetDefaultDecoder( 62, DECODER(
+		if (!aa && !lk) EMIT( std, REG(b6), MEMOFS0(b11,ds4) ); // offset is *4
+		if (!aa && lk) EMIT( stdu, REG(b6), MEMOFS0(b11,ds4) ); // offset is *4
+		ERROR("Decode: unsupported format of opcode %d", pri);
+	) );
+
+	// floating point math (double precission)
+
+	// fmr, fneg, fabs, fnabs
+	AddDecoder( 63, 21, 10, 72, DECODER( EMIT_RC(fmr, FREG(b6), FREG(b16)); ) );
+	AddDecoder( 63, 21, 10, 40, DECODER( EMIT_RC(fneg, FREG(b6), FREG(b16)); ) );
+	AddDecoder( 63, 21, 10, 264, DECODER( EMIT_RC(fabs, FREG(b6), FREG(b16)); ) );
+	AddDecoder( 63, 21, 10, 136, DECODER( EMIT_RC(fnabs, FREG(b6), FREG(b16)); ) );
+
+	// frsp, fctid, fctidz, fctiw, fctiwz, fcfid
+	AddDecoder( 63, 21, 10, 12, DECODER( EMIT_RC(frsp, FREG(b6), FREG(b16)); ) );
+	AddDecoder( 63, 21, 10, 814, DECODER( EMIT_RC(fctid, FREG(b6), FREG(b16)); ) );
+	AddDecoder( 63, 21, 10, 815, DECODER( EMIT_RC(fctidz, FREG(b6), FREG(b16)); ) );
+	AddDecoder( 63, 21, 10, 14, DECODER( EMIT_RC(fctiw, FREG(b6), FREG(b16)); ) );
+	AddDecoder( 63, 21, 10, 15, DECODER( EMIT_RC(fctiwz, FREG(b6), FREG(b16)); ) );
+	AddDecoder( 63, 21, 10, 846, DECODER( EMIT_RC(fcfid, FREG(b6), FREG(b16)); ) );
+
+	// fcmpu, fcmpo
+	AddDecoder( 63, 21, 10, 0, DECODER( EMIT(fcmpu, CREG(bf), FREG(b11), FREG(b16)); ) );
+	AddDecoder( 63, 21, 10, 32, DECODER( EMIT(fcmpo, CREG(bf), FREG(b11), FREG(b16)); ) );
+
+	// mffs, mcrfs, mtfsfi, mtfsf, mtfsb0, mtfsb1
+	AddDecoder( 63, 21, 10, 583, DECODER( EMIT_RC(mffs, FREG(b6)); ) );
+	AddDecoder( 63, 21, 10, 64, DECODER( EMIT(mcrfs, CREG(bf), FCREG(bfa)); ) );
+	AddDecoder( 63, 21, 10, 134, DECODER( EMIT_RC(mtfsfi, FCREG(bf), u16x4); ) );
+	AddDecoder( 63, 21, 10, 711, DECODER( EMIT_RC(mtfsf, flm, FREG(frb)); ) );
+	AddDecoder( 63, 21, 10, 70, DECODER( EMIT_RC(mtfsb0, FCBIT(b6)); ) );
+	AddDecoder( 63, 21, 10, 38, DECODER( EMIT_RC(mtfsb1, FCBIT(b6)); ) );
+
+	// fadd, fsub, fmul, fdiv
+	AddDecoder( 63, 26, 5, 21, DECODER( EMIT_RC(fadd, FREG(b6), FREG(b11), FREG(b16)); ) );
+	AddDecoder( 63, 26, 5, 20, DECODER( EMIT_RC(fsub, FREG(b6), FREG(b11), FREG(b16)); ) );
+	AddDecoder( 63, 26, 5, 25, DECODER( EMIT_RC(fmul, FREG(b6), FREG(b11), FREG(b21)); ) ); // BEWARE, the second arg is at bit 21
+	AddDecoder( 63, 26, 5, 18, DECODER( EMIT_RC(fdiv, FREG(b6), FREG(b11), FREG(b16)); ) );
+
+	// fmadd, fmsub, fnmadd, fnmsub
+	AddDecoder( 63, 26, 5, 29, DECODER( EMIT_RC(fmadd, FREG(b6), FREG(b11), FREG(b21), FREG(b16)); ) );
+	AddDecoder( 63, 26, 5, 28, DECODER( EMIT_RC(fmsub, FREG(b6), FREG(b11), FREG(b21), FREG(b16)); ) );
+	AddDecoder( 63, 26, 5, 31, DECODER( EMIT_RC(fnmadd, FREG(b6), FREG(b11), FREG(b21), FREG(b16)); ) );
+	AddDecoder( 63, 26, 5, 30, DECODER( EMIT_RC(fnmsub, FREG(b6), FREG(b11), FREG(b21), FREG(b16)); ) );
+
+	// fsel
+	AddDecoder( 63, 26, 5, 23, DECODER( EMIT_RC(fsel, FREG(b6), FREG(b11), FREG(b21), FREG(b16)); ) );
+
+	// fsqrt and some other optional instructions
+	AddDecoder( 63, 26, 5, 22, DECODER( EMIT_RC(fsqrt, FREG(b6), FREG(b16)); ) );
+	AddDecoder( 63, 26, 5, 24, DECODER( EMIT_RC(fre, FREG(b6), FREG(b16)); ) );
+	AddDecoder( 63, 26, 5, 26, DECODER( EMIT_RC(frsqrtx, FREG(b6), FREG(b16)); ) );
+
+	// unknown
+	SetDefaultDecoder( 63, DECODER( ERROR("Decode: Unmatched secondary opcode x21=%d, xo26=%d for primary %d", xo21, xo26, pri); ) );
+}
 
-			const BitField<26,5> xo26(instrWord);
-			switch (xo26)
-			{
-				// fadd, fsub, fmul, fdiv
-				case 21: EMIT_RC(fadd, FREG(b6), FREG(b11), FREG(b16));
-				case 20: EMIT_RC(fsub, FREG(b6), FREG(b11), FREG(b16));
-				case 25: EMIT_RC(fmul, FREG(b6), FREG(b11), FREG(b21)); // BEWARE, the second arg is at bit 21
-				case 18: EMIT_RC(fdiv, FREG(b6), FREG(b11), FREG(b16));
-
-				// fmadd, fmsub, fnmadd, fnmsub
-				case 29: EMIT_RC(fmadd, FREG(b6), FREG(b11), FREG(b21), FREG(b16));
-				case 28: EMIT_RC(fmsub, FREG(b6), FREG(b11), FREG(b21), FREG(b16));
-				case 31: EMIT_RC(fnmadd, FREG(b6), FREG(b11), FREG(b21), FREG(b16));
-				case 30: EMIT_RC(fnmsub, FREG(b6), FREG(b11), FREG(b21), FREG(b16));
-
-				// fsel
-				case 23: EMIT_RC(fsel, FREG(b6), FREG(b11), FREG(b21), FREG(b16));
-
-				// fsqrt and some other optional instructions
-				case 22: EMIT_RC(fsqrt, FREG(b6), FREG(b16));
-				case 24: EMIT_RC(fre, FREG(b6), FREG(b16));
-				case 26: EMIT_RC(frsqrtx, FREG(b6), FREG(b16));					
-			}
+uint32 CPU_XenonPPC::DecodeInstruction(const uint8* inputStream, class decoding::Instruction& outOp) const
+{
+	return DecodeInstruction(inputStream, outOp, true);
+}
 
+uint32 CPU_XenonPPC::DecodeInstruction(const uint8* inputStream, class decoding::Instruction& outOp, const bool reportErrors) const
+{
+	const uint32 instrWord = EndianReverse32( *(const uint32*)inputStream );
 
-			ERROR("Decode: Unmatched secondary opcode x21=%d, xo26=%d for primary %d", xo21, xo26, pri);
-		}
+	// match the extended opcode tables of the primary opcode
+	const PrimaryDecoding& primary = m_decoding[ instrWord >> 26 ];
+	for (const auto& table : primary.m_tables)
+	{
+		const TDecodingFunction func = table.m_functions[ (instrWord >> table.m_shift) & table.m_mask ];
+		if (func)
+			return func(this, instrWord, outOp, reportErrors);
 	}
 
-	// valid instruction parsed
-	return 0;
+	// not matched by any table
+	return primary.m_default(this, instrWord, outOp, reportErrors);
 }
-
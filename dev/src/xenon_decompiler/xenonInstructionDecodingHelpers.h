@@ -0,0 +1,236 @@
+#pragma once
+
+#include "xenonCPU.h"
+
+// Building blocks of the instruction decoders, shared by the decoding tables and the reference decoder of the decoding test (dev/tools/xdecode)
+
+//---------------------------------------------------------------------------
+
+// reporting is slow, lots of data gets decoded as code when scanning the image
+#ifdef _DEBUG
+	#define REPORT_DECODING_ERRORS
+#endif
+
+//---------------------------------------------------------------------------
+
+template< const uint32 bestart, const uint32 length, const bool signExtend = false, const int shift = 0 >
+class BitField
+{
+public:
+	static const uint32 start = (32-bestart) - length;
+
+	BitField(const uint32 input)
+	{
+		const uint32 mask = ((1<<length) - 1);
+		uint32 bitSize = length;
+		uint32 ext = (input >> start) & mask;
+
+		// additional left shift
+		if (shift > 0)
+		{
+			ext <<= shift;
+			bitSize += shift;
+		}
+
+		// if signed expand copy the sign bit
+		if (signExtend)
+		{
+			const uint32 signBitValue = ext & (1 << (bitSize-1));
+			if (signBitValue != 0)
+			{
+				const uint32 signMask = ((uint32)-1) << bitSize;
+				ext |= signMask;
+			}
+		}
+
+		// right shift (always do that after sign conversion)
+		if (shift < 0)
+		{
+			ext >>= (-shift);
+		}
+
+		// save value
+		m_val = ext;
+	}
+
+	inline const uint32 Get() const
+	{
+		return m_val;
+	}
+
+	inline operator uint32() const
+	{
+		return m_val;
+	}
+
+private:
+	uint32 m_val;
+};
+
+extern "C" __declspec(dllimport) void __stdcall OutputDebugStringA(const char* lpOutputString);
+extern "C" __declspec(dllimport) void __stdcall DebugBreak();
+
+static inline void ReportDecodingError(const char* txt, ...)
+{
+	char buf[512];
+	va_list args;
+
+	va_start(args, txt);
+	vsprintf_s(buf, txt, args);
+	va_end(args);
+
+	strcat_s(buf, "\n");
+	OutputDebugStringA(buf);
+	//DebugBreak();
+}
+
+#ifdef REPORT_DECODING_ERRORS
+
+	// "reportErrors" is passed to every decoding function, it's disabled when decoding lots of invalid instructions on purpose
+	#define ERROR(x,...) if (reportErrors) ReportDecodingError(x, __VA_ARGS__); return false;
+
+#else
+
+	#define ERROR(x,...) return false;
+
+#endif
+
+template< typename T >
+static decoding::Instruction::Operand MakeOperand( T data )
+{
+	decoding::Instruction::Operand ret;
+	ret.m_type = decoding::Instruction::eType_None;
+	return ret;
+}
+
+template<>
+static decoding::Instruction::Operand MakeOperand( const uint32 data )
+{
+	decoding::Instruction::Operand ret;
+	ret.m_type = decoding::Instruction::eType_Imm;
+	ret.m_imm = data;
+	return ret;
+}
+
+template< const uint32 bestart, const uint32 length, const bool signExtend, const int shift >
+static decoding::Instruction::Operand MakeOperand( const BitField<bestart, length, signExtend, shift> data )
+{
+	decoding::Instruction::Operand ret;
+	ret.m_type = decoding::Instruction::eType_Imm;
+	ret.m_imm = (uint32)data;
+	return ret;
+}
+
+template<>
+static decoding::Instruction::Operand MakeOperand( const platform::CPURegister* reg )
+{
+	decoding::Instruction::Operand ret;
+
+	if (!reg)
+	{
+		ret.m_type = decoding::Instruction::eType_Imm;
+		ret.m_imm = 0;
+	}
+	else
+	{
+		ret.m_type = decoding::Instruction::eType_Reg;
+		ret.m_reg = reg;
+	}
+
+	return ret;
+}
+
+template<>
+static decoding::Instruction::Operand MakeOperand( const MemReg memreg )
+{
+	decoding::Instruction::Operand ret;
+	ret.m_type = decoding::Instruction::eType_Mem;
+	ret.m_reg = memreg.m_reg;
+	ret.m_index = memreg.m_index;
+	ret.m_imm = memreg.m_offset;
+	ret.m_scale = 1;
+	return ret;
+}
+
+static inline void SetupInstruction(decoding::Instruction& outOp, const platform::CPUInstruction* opcode)
+{
+	outOp.Setup(4, opcode);
+}
+
+template<typename Arg0>
+static inline void SetupInstruction(decoding::Instruction& outOp, const platform::CPUInstruction* opcode, Arg0 arg0)
+{
+	outOp.Setup(4, opcode, MakeOperand(arg0));
+}
+
+template<typename Arg0, typename Arg1>
+static inline void SetupInstruction(decoding::Instruction& outOp, const platform::CPUInstruction* opcode, Arg0 arg0, Arg1 arg1)
+{
+	outOp.Setup(4, opcode, MakeOperand(arg0), MakeOperand(arg1));
+}
+
+template<typename Arg0, typename Arg1, typename Arg2>
+static inline void SetupInstruction(decoding::Instruction& outOp, const platform::CPUInstruction* opcode, Arg0 arg0, Arg1 arg1, Arg2 arg2)
+{
+	outOp.Setup(4, opcode, MakeOperand(arg0), MakeOperand(arg1), MakeOperand(arg2));
+}
+
+template<typename Arg0, typename Arg1, typename Arg2, typename Arg3>
+static inline void SetupInstruction(decoding::Instruction& outOp, const platform::CPUInstruction* opcode, Arg0 arg0, Arg1 arg1, Arg2 arg2, Arg3 arg3)
+{
+	outOp.Setup(4, opcode, MakeOperand(arg0), MakeOperand(arg1), MakeOperand(arg2), MakeOperand(arg3));
+}
+
+template<typename Arg0, typename Arg1, typename Arg2, typename Arg3, typename Arg4>
+static inline void SetupInstruction(decoding::Instruction& outOp, const platform::CPUInstruction* opcode, Arg0 arg0, Arg1 arg1, Arg2 arg2, Arg3 arg3, Arg4 arg4)
+{
+	outOp.Setup(4, opcode, MakeOperand(arg0), MakeOperand(arg1), MakeOperand(arg2), MakeOperand(arg3), MakeOperand(arg4));
+}
+
+template<typename Arg0, typename Arg1, typename Arg2, typename Arg3, typename Arg4, typename Arg5>
+static inline void SetupInstruction(decoding::Instruction& outOp, const platform::CPUInstruction* opcode, Arg0 arg0, Arg1 arg1, Arg2 arg2, Arg3 arg3, Arg4 arg4, Arg5 arg5)
+{
+	outOp.Setup(4, opcode, MakeOperand(arg0), MakeOperand(arg1), MakeOperand(arg2), MakeOperand(arg3), MakeOperand(arg4), MakeOperand(arg5));
+}
+
+#define CHECK(x) { if (!(x)) { ERROR("Decode: Usupported instruction format for opcode %d", pri); return false; } }
+
+// decoding functions are not members of the CPU, it's accessed via "self"
+#define EMIT(opname, ...) { SetupInstruction(outOp, self->m_opMap[ CPU_XenonPPC::eInstruction_##opname ], __VA_ARGS__ ); return 4; }
+
+#define EMIT_RC(opname, ...)							\
+	if (!rc) EMIT(opname, __VA_ARGS__ );				\
+	EMIT(##opname##RC, __VA_ARGS__);
+
+#define EMIT_MATH(opname, ...)							\
+	if (!oe && !rc) EMIT(opname, __VA_ARGS__ );			\
+	if (!oe && rc) EMIT(##opname##RC, __VA_ARGS__);		\
+	if (oe && !rc) EMIT(##opname##o, __VA_ARGS__);		\
+	EMIT(##opname##oRC, __VA_ARGS__ );
+
+static inline uint32 EndianReverse32( const uint32 v )
+{
+	uint32 ret;
+	const uint8* p = (const uint8*)&v;
+	uint8* q = (uint8*)&ret;
+	q[0] = p[3]; 
+	q[1] = p[2]; 
+	q[2] = p[1]; 
+	q[3] = p[0];
+	return ret;
+}
+
+// registers are also taken from the CPU passed as "self"
+#define REG(x) self->REG(x)
+#define REG0(x) self->REG0(x)
+#define SREG(x) self->SREG(x)
+#define FREG(x) self->FREG(x)
+#define VREG(x) self->VREG(x)
+#define CREG(x) self->CREG(x)
+#define CBIT(x) self->CBIT(x)
+#define FCREG(x) self->FCREG(x)
+#define FCBIT(x) self->FCBIT(x)
+#define MEMREG(x,y) self->MEMREG(x,y)
+#define MEMREG0(x,y) self->MEMREG0(x,y)
+#define MEMOFS(x,y) self->MEMOFS(x,y)
+#define MEMOFS0(x,y) self->MEMOFS0(x,y)
@@ -1,5 +1,12 @@
 #pragma once
 
+#if defined(XENON_GPU_STANDALONE)
+
+// GPU command processor built without the rest of the platform
+#include "xenonGPUStandalone.h"
+
+#else
+
 #include <stdlib.h>
 #include <stdio.h>
 #include <math.h>
@@ -29,4 +36,4 @@
 #include "xenonKernel.h"
 #include "xenonPlatform.h"
 
-
+#endif
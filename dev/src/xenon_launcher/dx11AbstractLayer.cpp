@@ -16,9 +16,10 @@
 
 //-----------------------------------------------------------------------------------------------
 
-CDX11AbstractLayer::CDX11AbstractLayer()
+CDX11AbstractLayer::CDX11AbstractLayer( CXenonGPUShaderStore* shaderStore )
 	: m_device( nullptr )
 	, m_mainContext( nullptr )
+	, m_shaderStore( shaderStore )
 	, m_window( nullptr )
 	, m_swapChain( nullptr )
 	, m_backBufferView( nullptr )
@@ -126,7 +127,7 @@ bool CDX11AbstractLayer::Initialize()
 	m_stateCache = new CDX11StateCache( m_device, m_mainContext );
 
 	// create geometry drawer
-	m_drawer = new CDX11GeometryDrawer( m_device, m_mainContext );
+	m_drawer = new CDX11GeometryDrawer( m_device, m_mainContext, m_shaderStore );
 	m_drawer->SetShaderDumpDirector( L"H:\\shaderdump\\" );
 
 	// create shader constants buffers
@@ -15,11 +15,12 @@ class CDX11GeometryDrawer;
 class CDX11TextureManager;
 class CDX11StateCache;
 class CXenonGPURegisters;
+class CXenonGPUShaderStore;
 
 class CDX11AbstractLayer : public IXenonGPUAbstractLayer
 {
 public:
-	CDX11AbstractLayer();
+	CDX11AbstractLayer( CXenonGPUShaderStore* shaderStore );
 	~CDX11AbstractLayer();
 
 	// interface
@@ -101,6 +102,9 @@ private:
 	ID3D11Device*				m_device;
 	ID3D11DeviceContext*		m_mainContext;
 
+	// persistent shader storage, optional
+	CXenonGPUShaderStore*		m_shaderStore;
+
 	// debug interface
 	ID3DUserDefinedAnnotation*	m_eventDevice;
 
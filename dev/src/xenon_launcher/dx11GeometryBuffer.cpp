@@ -13,6 +13,8 @@ CDX11GeometryBuffer::CDX11GeometryBuffer( ID3D11Device* dev, ID3D11DeviceContext
 	, m_geometryDataAllocator( 1024 * 1024 * 32 )
 	, m_geomeryDataSwapped(false)
 	, m_geometryData( nullptr )
+	, m_staticGeometryData( nullptr )
+	, m_geometryCache( 1024 * 1024 * 32 )
 {
 	// create the vertex buffer cache
 	{
@@ -39,10 +41,30 @@ CDX11GeometryBuffer::CDX11GeometryBuffer( ID3D11Device* dev, ID3D11DeviceContext
 		HRESULT hRet = dev->CreateBuffer( &bufferDesc, NULL, &m_geometryDataSecondary );
 		DEBUG_CHECK( SUCCEEDED(hRet) );
 	}	
+
+	// create persistent buffer, updated only when the cached data changes
+	{
+		D3D11_BUFFER_DESC bufferDesc;
+		bufferDesc.BindFlags = D3D11_BIND_SHADER_RESOURCE;
+		bufferDesc.ByteWidth = m_geometryCache.GetStorageSize();
+		bufferDesc.CPUAccessFlags = 0;
+		bufferDesc.MiscFlags = 0;
+		bufferDesc.StructureByteStride = 0;
+		bufferDesc.Usage = D3D11_USAGE_DEFAULT;
+		HRESULT hRet = dev->CreateBuffer( &bufferDesc, NULL, &m_staticGeometryData );
+		DEBUG_CHECK( SUCCEEDED(hRet) );
+	}
 }
 
 CDX11GeometryBuffer::~CDX11GeometryBuffer()
 {
+	// release the persistent buffer
+	if ( m_staticGeometryData )
+	{
+		m_staticGeometryData->Release();
+		m_staticGeometryData = nullptr;
+	}
+
 	// release the helper buffer
 	if ( m_geometryDataSecondary )
 	{
@@ -155,11 +177,44 @@ CDX11GeometryBuffer::BufferHandle CDX11GeometryBuffer::UploadStagingData( const
 	return ret;
 }
 
+bool CDX11GeometryBuffer::UploadCachedData( const void* sourceMemory, const uint32 numElements, const CXenonGPUGeometryCache::Format format, const bool swap, const uint32 type, BufferHandle& outHandle )
+{
+	CXenonGPUGeometryCache::Result cached;
+	if ( !m_staticGeometryData || !m_geometryCache.Get( sourceMemory, numElements, format, swap, cached ) )
+		return false;
+
+	// update the persistent copy
+	if ( cached.m_uploadData )
+	{
+		D3D11_BOX box;
+		box.left = cached.m_offset;
+		box.right = cached.m_offset + cached.m_size;
+		box.top = 0;
+		box.bottom = 1;
+		box.front = 0;
+		box.back = 1;
+		m_mainContext->UpdateSubresource( m_staticGeometryData, 0, &box, cached.m_uploadData, 0, 0 );
+	}
+
+	// return the persistent region
+	outHandle.m_generation = m_geometryDataGeneration;
+	outHandle.m_offset = cached.m_offset;
+	outHandle.m_size = cached.m_size;
+	outHandle.m_type = type;
+	outHandle.m_static = 1;
+	return true;
+}
+
 const CDX11GeometryBuffer::BufferHandle CDX11GeometryBuffer::UploadVertices( const void* sourceMemory, const uint32 sourceMemorySize, const bool verticesNeedSwapping )
 {
 	DEBUG_CHECK( sourceMemory != nullptr );
 	DEBUG_CHECK( (sourceMemorySize & 3) == 0 );
 
+	// use the persistent copy
+	BufferHandle cachedHandle;
+	if ( UploadCachedData( sourceMemory, sourceMemorySize / 4, CXenonGPUGeometryCache::Format::Vertex32, verticesNeedSwapping, BUFFER_VERTEX, cachedHandle ) )
+		return cachedHandle;
+
 	// get data
 	void* stagingPtr = nullptr;
 	uint32 dataOffset = 0;
@@ -167,19 +222,7 @@ const CDX11GeometryBuffer::BufferHandle CDX11GeometryBuffer::UploadVertices( con
 		return BufferHandle();
 
 	// copy data SWAPPING it along the way
-	uint32* dest = (uint32*) stagingPtr;
-	const uint32* src = (const uint32*) sourceMemory;
-	if ( verticesNeedSwapping )
-	{
-		for ( uint32 i=0; i<(sourceMemorySize/4); ++i )
-		{
-			*dest++ = _byteswap_ulong( *src++ );
-		}
-	}
-	else
-	{
-		memcpy( dest, src, sourceMemorySize );
-	}
+	CXenonGPUGeometryCache::Convert( stagingPtr, sourceMemory, sourceMemorySize / 4, CXenonGPUGeometryCache::Format::Vertex32, verticesNeedSwapping );
 
 	// upload staging data
 	return UploadStagingData( sourceMemorySize, dataOffset, BUFFER_VERTEX );	
@@ -189,6 +232,11 @@ const CDX11GeometryBuffer::BufferHandle CDX11GeometryBuffer::UploadIndices16( co
 {
 	DEBUG_CHECK( sourceMemory != nullptr );
 
+	// use the persistent copy
+	BufferHandle cachedHandle;
+	if ( UploadCachedData( sourceMemory, numIndices, CXenonGPUGeometryCache::Format::Index16, indicesNeedSwapping, BUFFER_INDEX, cachedHandle ) )
+		return cachedHandle;
+
 	// count size of memory
 	const uint32 sourceMemorySize = numIndices * sizeof(uint32);
 
@@ -198,23 +246,8 @@ const CDX11GeometryBuffer::BufferHandle CDX11GeometryBuffer::UploadIndices16( co
 	if ( !AllocStagingBuffer( sourceMemorySize, stagingPtr, dataOffset ) )
 		return BufferHandle();
 
-	// copy data SWAPPING it along the way
-	uint32* dest = (uint32*) stagingPtr;
-	const uint16* src = (const uint16*) sourceMemory;
-	if ( indicesNeedSwapping )
-	{
-		for ( uint32 i=0; i<numIndices; ++i )
-		{
-			*dest++ = _byteswap_ushort( *src++ ); // notice: 16 bit swap
-		}
-	}
-	else
-	{
-		for ( uint32 i=0; i<numIndices; ++i )
-		{
-			*dest++ = *src++; 
-		}
-	}
+	// copy data SWAPPING it along the way, notice: 16 bit swap
+	CXenonGPUGeometryCache::Convert( stagingPtr, sourceMemory, numIndices, CXenonGPUGeometryCache::Format::Index16, indicesNeedSwapping );
 
 	// upload staging data
 	return UploadStagingData( sourceMemorySize, dataOffset, BUFFER_INDEX );
@@ -224,6 +257,11 @@ const CDX11GeometryBuffer::BufferHandle CDX11GeometryBuffer::UploadIndices32( co
 {
 	DEBUG_CHECK( sourceMemory != nullptr );
 
+	// use the persistent copy
+	BufferHandle cachedHandle;
+	if ( UploadCachedData( sourceMemory, numIndices, CXenonGPUGeometryCache::Format::Index32, indicesNeedSwapping, BUFFER_INDEX, cachedHandle ) )
+		return cachedHandle;
+
 	// count size of memory
 	const uint32 sourceMemorySize = numIndices * sizeof(uint32);
 
@@ -233,20 +271,8 @@ const CDX11GeometryBuffer::BufferHandle CDX11GeometryBuffer::UploadIndices32( co
 	if ( !AllocStagingBuffer( sourceMemorySize, stagingPtr, dataOffset ) )
 		return BufferHandle();
 
-	// copy data SWAPPING it along the way
-	uint32* dest = (uint32*) stagingPtr;
-	const uint16* src = (const uint16*) sourceMemory;
-	if ( indicesNeedSwapping )
-	{
-		for ( uint32 i=0; i<numIndices; ++i )
-		{
-			*dest++ = _byteswap_ulong( *src++ ); // notice: 32 bit swap
-		}
-	}
-	else
-	{
-		memcpy( dest, src, sourceMemorySize );
-	}
+	// copy data SWAPPING it along the way, notice: 32 bit swap
+	CXenonGPUGeometryCache::Convert( stagingPtr, sourceMemory, numIndices, CXenonGPUGeometryCache::Format::Index32, indicesNeedSwapping );
 
 	// upload staging data
 	return UploadStagingData( sourceMemorySize, dataOffset, BUFFER_INDEX );
@@ -268,7 +294,8 @@ const bool CDX11GeometryBuffer::BindData( BufferHandle data, const uint32 buffer
 
 	// create view
 	ID3D11ShaderResourceView* view = nullptr;
-	HRESULT hRet = m_device->CreateShaderResourceView( m_geometryData, &bufferView, &view );
+	ID3D11Buffer* buffer = data.m_static ? m_staticGeometryData : m_geometryData;
+	HRESULT hRet = m_device->CreateShaderResourceView( buffer, &bufferView, &view );
 	DEBUG_CHECK( SUCCEEDED(hRet) && view );
 
 	// bind the buffer view
@@ -5,6 +5,7 @@
 #include <d3dcompiler.h>
 
 #include "xenonGPUConstants.h"
+#include "xenonGPUGeometryCache.h"
 
 /// Buffer management for the drawable geometry (vertex & index buffers)
 class CDX11GeometryBuffer
@@ -22,14 +23,16 @@ public:
 	{
 		uint32	m_generation;
 		uint32	m_offset;
-		uint32	m_size:30;
+		uint32	m_size:29;
 		uint32  m_type:2; // 1-vb, 2-ib
+		uint32	m_static:1; // data is in the persistent buffer
 
 		inline BufferHandle()
 			: m_generation(0)
 			, m_offset(0)
 			, m_size(0)
 			, m_type(0)
+			, m_static(0)
 		{}
 	};
 
@@ -86,7 +89,13 @@ private:
 	uint32						m_geometryDataTransferSize;	// transfer buffer helper
 	LinearAllocator				m_geometryDataAllocator;	// data allocator
 	bool						m_geomeryDataSwapped;		// data was just swapped
-	
+
+	// Persistent buffer memory for the data that does not change between frames
+	ID3D11Buffer*				m_staticGeometryData;		// persistent geometry data buffer
+	CXenonGPUGeometryCache		m_geometryCache;			// converted data cache, manages the persistent buffer
+
+	// use the persistent copy of the data if possible, returns false if the data is not cached
+	bool UploadCachedData( const void* sourceMemory, const uint32 numElements, const CXenonGPUGeometryCache::Format format, const bool swap, const uint32 type, BufferHandle& outHandle );
 
 	// ensure there's enough room in the staging buffer and lock it
 	bool AllocStagingBuffer( const uint32 sourceMemorySize, void*& outPtr, uint32& outOffset ); 
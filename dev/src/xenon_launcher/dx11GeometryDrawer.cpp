@@ -19,11 +19,26 @@
 CDX11GeometryDrawer::ShaderData::ShaderData()
 	: m_changed( false )
 	, m_microcode( nullptr )
+	, m_sourceData( nullptr )
+	, m_sourceWords( 0 )
+	, m_sourceEpoch( 0 )
 {
 }
 
 bool CDX11GeometryDrawer::ShaderData::SetData( CDX11MicrocodeCache* cache, const void* data, const uint32 numWords )
 {
+	// same microcode memory as last time and it was not written since then
+	const uint32 writeEpoch = GPlatform.GetMemory().GetLastWriteEpoch( data, numWords * sizeof(uint32) );
+	if ( m_microcode && data == m_sourceData && numWords == m_sourceWords && writeEpoch == m_sourceEpoch )
+	{
+		m_changed = false;
+		return false;
+	}
+
+	m_sourceData = data;
+	m_sourceWords = numWords;
+	m_sourceEpoch = writeEpoch;
+
 	// swap data
 	uint32 words[ 8192 ];
 	for ( uint32 i=0; i<numWords; ++i )
@@ -50,7 +65,7 @@ bool CDX11GeometryDrawer::ShaderData::SetData( CDX11MicrocodeCache* cache, const
 
 //----------------------
 
-CDX11GeometryDrawer::CDX11GeometryDrawer( ID3D11Device* dev, ID3D11DeviceContext* context )
+CDX11GeometryDrawer::CDX11GeometryDrawer( ID3D11Device* dev, ID3D11DeviceContext* context, CXenonGPUShaderStore* shaderStore )
 	: m_device( dev )
 	, m_mainContext( context )
 	, m_defaultTexture1D( nullptr )
@@ -78,12 +93,17 @@ CDX11GeometryDrawer::CDX11GeometryDrawer( ID3D11Device* dev, ID3D11DeviceContext
 	m_samplerCache = new CDX11SamplerCache( dev );
 
 	// create shader cache
-	m_shaderCache = new CDX11ShaderCache( dev );
+	m_shaderCache = new CDX11ShaderCache( dev, shaderStore );
 	m_shaderCache->SetDumpPath( L"Q://shaderdump//" );
 
 	// create microcode cache
 	m_microcodeCache = new CDX11MicrocodeCache();
 	m_microcodeCache->SetDumpPath( L"Q://shaderdump//" );
+	m_microcodeCache->SetShaderStore( shaderStore );
+
+	// create all shaders seen in the previous sessions
+	m_microcodeCache->WarmUp();
+	m_shaderCache->WarmUp( m_microcodeCache );
 
 	// create constant buffer
 	m_vertexViewportState.Create( dev );
@@ -817,13 +837,19 @@ bool CDX11GeometryDrawer::Draw( const class CXenonGPURegisters& regs, class IXen
 	vsContext.m_psRegs = programCtnl.ps_regs;
 	vsContext.m_vsRegs = programCtnl.vs_regs;
 
-	// compile actual renderable DX11 pixel & vertex shaders
-	CDX11VertexShader* vs = m_shaderCache->GetVertexShader( m_vertexShader.m_microcode, vsContext );
-	CDX11PixelShader* ps = m_shaderCache->GetPixelShader( m_pixelShader.m_microcode, psContext );
+	// compile actual renderable DX11 pixel & vertex shaders, the traced draws are not skipped so the dump is complete
+	const bool bWaitForShaders = (traceDump != nullptr);
+	bool bShadersPending = false;
+	CDX11VertexShader* vs = m_shaderCache->GetVertexShader( m_vertexShader.m_microcode, vsContext, bWaitForShaders, bShadersPending );
+	CDX11PixelShader* ps = m_shaderCache->GetPixelShader( m_pixelShader.m_microcode, psContext, bWaitForShaders, bShadersPending );
 
 	// no drawable shaders
 	if ( !vs || !ps )
+	{
+		if ( bShadersPending )
+			m_shaderCache->CountSkippedDraw();
 		return false;
+	}
 
 	// quad list - generate ad hock vertex&index buffer
 	//if ( ds.m_primitiveType == XenonPrimitiveType::PrimitiveQuadList )
@@ -17,12 +17,13 @@ class CDX11GeometryBuffer;
 class CDX11SamplerCache;
 class CDX11AbstractTexture;
 class CXenonGPURegisters;
+class CXenonGPUShaderStore;
 
 /// Geometry drawer, handles input assembly and shader dispatching
 class CDX11GeometryDrawer
 {
 public:
-	CDX11GeometryDrawer( ID3D11Device* dev, ID3D11DeviceContext* context );
+	CDX11GeometryDrawer( ID3D11Device* dev, ID3D11DeviceContext* context, CXenonGPUShaderStore* shaderStore );
 	~CDX11GeometryDrawer();
 
 	// Reset geometry cache
@@ -74,6 +75,11 @@ private:
 		bool					m_changed;
 		CDX11MicrocodeShader*	m_microcode;
 
+		// source of the cached microcode, used to skip the decoding if the memory was not written
+		const void*				m_sourceData;
+		uint32					m_sourceWords;
+		uint32					m_sourceEpoch;
+
 		ShaderData();
 
 		// set new data, returns false if data is up to date
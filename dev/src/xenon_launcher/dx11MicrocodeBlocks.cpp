@@ -486,7 +486,8 @@ Shader* Shader::DecompileMicroCode( const void* code, const uint32 codeLength, X
 
 	// extract instructions from all statements in all control flow blocks 
 	Helper::GlobalInstructionExtractor instructionExtractor;
-	Helper::VisitAll( cf, Helper::AllExpressionVisitor( &instructionExtractor ) );
+	Helper::AllExpressionVisitor expressionVisitor( &instructionExtractor );
+	Helper::VisitAll( cf, expressionVisitor );
 
 	// transfer
 	ret->m_vertexFetches = std::move( instructionExtractor.m_vfetch );
@@ -3,8 +3,10 @@
 #include "dx11MicrocodeShader.h"
 #include "dx11MicrocodeDecompiler.h"
 #include "dx11MicrocodeCache.h"
+#include "xenonGPUShaderStore.h"
 
 CDX11MicrocodeCache::CDX11MicrocodeCache()
+	: m_shaderStore( nullptr )
 {
 }
 
@@ -22,6 +24,29 @@ void CDX11MicrocodeCache::SetDumpPath( const std::wstring& absPath )
 	m_dumpPath = absPath;
 }
 
+void CDX11MicrocodeCache::SetShaderStore( CXenonGPUShaderStore* shaderStore )
+{
+	m_shaderStore = shaderStore;
+}
+
+void CDX11MicrocodeCache::WarmUp()
+{
+	if ( !m_shaderStore )
+		return;
+
+	std::vector< CXenonGPUShaderStore::Entry > pixelEntries, vertexEntries;
+	m_shaderStore->GetEntries( CXenonGPUShaderStore::EntryType::PixelMicrocode, pixelEntries );
+	m_shaderStore->GetEntries( CXenonGPUShaderStore::EntryType::VertexMicrocode, vertexEntries );
+
+	for ( const auto& entry : pixelEntries )
+		GetCachedPixelShader( entry.m_data, entry.m_dataSize );
+
+	for ( const auto& entry : vertexEntries )
+		GetCachedVertexShader( entry.m_data, entry.m_dataSize );
+
+	GLog.Log( "D3D: Decompiled %u pixel and %u vertex shaders from the shader store", (uint32) pixelEntries.size(), (uint32) vertexEntries.size() );
+}
+
 CDX11MicrocodeCache::TMicrocodeHash CDX11MicrocodeCache::ComputeHash( const void* shaderCode, const uint32 shaderCodeSize )
 {
 	return XenonGPUCalcCRC64( shaderCode, shaderCodeSize );
@@ -110,13 +135,18 @@ CDX11MicrocodeShader* CDX11MicrocodeCache::GetCachedPixelShader( const void* sha
 				};
 
 				CDX11MicrocodeDecompiler decompiler( XenonShaderType::ShaderPixel );
-				decompiler.DisassembleShader( TextFileWriter( f ), (const uint32*) shaderCode, shaderCodeSize/4 );
+				TextFileWriter writer( f );
+				decompiler.DisassembleShader( writer, (const uint32*) shaderCode, shaderCodeSize/4 );
 
 				fclose(f);
 			}
 		}
 	}
 
+	// remember the microcode for the next sessions
+	if ( m_shaderStore )
+		m_shaderStore->Store( CXenonGPUShaderStore::EntryType::PixelMicrocode, hash, 0, 0, shaderCode, shaderCodeSize );
+
 	// store in cache
 	DEBUG_CHECK( newShader->GetHash() == hash );
 	m_cachedPixelShaders[ hash ] = newShader;
@@ -206,13 +236,18 @@ CDX11MicrocodeShader* CDX11MicrocodeCache::GetCachedVertexShader( const void* sh
 				};
 
 				CDX11MicrocodeDecompiler decompiler( XenonShaderType::ShaderVertex );
-				decompiler.DisassembleShader( TextFileWriter( f ), (const uint32*) shaderCode, shaderCodeSize/4 );
+				TextFileWriter writer( f );
+				decompiler.DisassembleShader( writer, (const uint32*) shaderCode, shaderCodeSize/4 );
 
 				fclose(f);
 			}
 		}
 	}
 
+	// remember the microcode for the next sessions
+	if ( m_shaderStore )
+		m_shaderStore->Store( CXenonGPUShaderStore::EntryType::VertexMicrocode, hash, 0, 0, shaderCode, shaderCodeSize );
+
 	// store in cache
 	DEBUG_CHECK( newShader->GetHash() == hash );
 	m_cachedVertexShaders[ hash ] = newShader;
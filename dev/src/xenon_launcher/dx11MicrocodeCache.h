@@ -1,5 +1,7 @@
 #pragma once
 
+class CXenonGPUShaderStore;
+
 //----------------------------------------------------------------------------
 
 /// Cache for decompiled microcode
@@ -12,6 +14,12 @@ public:
 	/// Set shader dump path
 	void SetDumpPath( const std::wstring& absPath );
 
+	/// Set persistent storage for the seen microcode, optional
+	void SetShaderStore( CXenonGPUShaderStore* shaderStore );
+
+	/// Decompile all microcode seen in the previous sessions
+	void WarmUp();
+
 	/// Decompile pixel shader (can use cached version)
 	CDX11MicrocodeShader* GetCachedPixelShader( const void* shaderCode, const uint32 shaderCodeSize );
 
@@ -28,4 +36,6 @@ private:
 	TMicrocodeMap		m_cachedPixelShaders;
 
 	std::wstring		m_dumpPath;
+
+	CXenonGPUShaderStore*	m_shaderStore;
 };
\ No newline at end of file
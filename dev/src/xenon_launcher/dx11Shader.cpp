@@ -2,8 +2,8 @@
 #include "xenonGPUUtils.h"
 #include "dx11Shader.h"
 #include "dx11MicrocodeShader.h"
-#include "dx11ShaderBuilder.h"
 #include "dx11FetchLayout.h"
+#include "xenonGPUShaderStore.h"
 
 //---------------------------------------------------------------------------
 
@@ -38,23 +38,7 @@ CDX11VertexShader::~CDX11VertexShader()
 	}
 }
 
-CDX11VertexShader::DrawingContext::DrawingContext()
-	: m_bTest( false )
-	, m_psRegs( 0 )
-	, m_vsRegs( 0 )
-{
-}
-
-uint32 CDX11VertexShader::DrawingContext::GetHash() const
-{
-	uint32 ret = 0;
-	ret |= (m_bTest ? 1 : 0) << 0;
-	ret |= (m_psRegs & 0x3F) << 1;
-	ret |= (m_vsRegs & 0x3F) << 7;
-	return ret;
-}
-
-CDX11VertexShader* CDX11VertexShader::Compile( ID3D11Device* device, CDX11MicrocodeShader* sourceMicrocode, const DrawingContext& context, const std::wstring& dumpDir )
+CDX11VertexShader* CDX11VertexShader::Compile( ID3D11Device* device, CDX11MicrocodeShader* sourceMicrocode, const DrawingContext& context, const std::string& code, const std::wstring& dumpDir, CXenonGPUShaderStore* shaderStore )
 {
 	DEBUG_CHECK( device != nullptr );
 
@@ -62,47 +46,6 @@ CDX11VertexShader* CDX11VertexShader::Compile( ID3D11Device* device, CDX11Microc
 	if ( !sourceMicrocode )
 		return nullptr;
 
-	// microcode must be a vertex shader
-	if ( sourceMicrocode->IsPixelShader() )
-	{
-		GLog.Err( "D3D: Cannot build vertex shader from microcode for pixel shader" );
-		return nullptr;
-	}
-
-	// generate source code
-	std::string code;
-	CDX11ShaderHLSLGenerator codeGenerator;
-	CDX11ShaderHLSLGenerator::Context codeContext;
-	codeContext.m_numIncomingInputs = 0;
-	if ( !codeGenerator.GenerateHLSL( *sourceMicrocode, codeContext, code ) )
-	{
-		GLog.Err( "D3D: Error converting microcode shader hash 0x%016llX to HLSL", sourceMicrocode->GetHash() );
-		return nullptr;
-	}
-
-	// generate the input layout
-	CDX11FetchLayout* fetchLayout = CDX11FetchLayout::ExtractFromMicrocode( sourceMicrocode );
-	if ( !fetchLayout )
-	{
-		GLog.Err( "D3D: Error extracting vertex layout from microcode shader hash 0x%016llX", sourceMicrocode->GetHash() );
-		return nullptr;
-	}
-
-	// dump generated code
-	if ( !dumpDir.empty() )
-	{
-		wchar_t fileName[512];
-		swprintf_s( fileName, ARRAYSIZE(fileName), L"%sshader_%08llX_%d_vertex_fx.txt", dumpDir.c_str(), sourceMicrocode->GetHash(), context.GetHash() );
-
-		FILE* f = NULL;
-		_wfopen_s( &f, fileName, L"w" );
-		if ( f )
-		{
-			fwrite( code.c_str(), code.length(), 1, f );
-			fclose(f);
-		}
-	}
-
 	// compile the shader
 	DWORD flags = 0;
 	DWORD flags2 = 0;
@@ -142,16 +85,6 @@ CDX11VertexShader* CDX11VertexShader::Compile( ID3D11Device* device, CDX11Microc
 	if ( !codeBlob)
 		return nullptr;
 
-	// create vertex shader
-	ID3D11VertexShader* vs = nullptr;
-	hRet = device->CreateVertexShader( codeBlob->GetBufferPointer(), codeBlob->GetBufferSize(), NULL, &vs );
-	if ( FAILED(hRet) )
-	{
-		GLog.Err( "D3D: Failed to create vertex shader, error 0x%08X", hRet );
-		codeBlob->Release();
-		return nullptr;
-	}
-
 	// decompile
 	if ( !dumpDir.empty() )
 	{
@@ -174,28 +107,61 @@ CDX11VertexShader* CDX11VertexShader::Compile( ID3D11Device* device, CDX11Microc
 		}
 	}
 
+	// create the shader
+	CDX11VertexShader* ret = CreateFromBinary( device, sourceMicrocode, codeBlob->GetBufferPointer(), (uint32) codeBlob->GetBufferSize() );
+
+	// save the compiled code for the next sessions
+	if ( ret && shaderStore )
+		shaderStore->Store( CXenonGPUShaderStore::EntryType::VertexBinary, sourceMicrocode->GetHash(), context.GetHash(), DX11_SHADER_TRANSLATOR_VERSION, codeBlob->GetBufferPointer(), (uint32) codeBlob->GetBufferSize() );
+
+	// code no longer needed
+	codeBlob->Release();
+
+	// keep the source for debug
+	if ( ret )
+		ret->m_sourceCodeHLSL = code;
+
+	return ret;
+}
+
+CDX11VertexShader* CDX11VertexShader::CreateFromBinary( ID3D11Device* device, CDX11MicrocodeShader* sourceMicrocode, const void* code, const uint32 codeSize )
+{
+	// generate the input layout
+	CDX11FetchLayout* fetchLayout = CDX11FetchLayout::ExtractFromMicrocode( sourceMicrocode );
+	if ( !fetchLayout )
+	{
+		GLog.Err( "D3D: Error extracting vertex layout from microcode shader hash 0x%016llX", sourceMicrocode->GetHash() );
+		return nullptr;
+	}
+
+	// create vertex shader
+	ID3D11VertexShader* vs = nullptr;
+	HRESULT hRet = device->CreateVertexShader( code, codeSize, NULL, &vs );
+	if ( FAILED(hRet) )
+	{
+		GLog.Err( "D3D: Failed to create vertex shader, error 0x%08X", hRet );
+		delete fetchLayout;
+		return nullptr;
+	}
+
 	// create empty (no buffers) input layout descriptor for the IA stage
 	ID3D11InputLayout* inputLayout = 0;
 	D3D11_INPUT_ELEMENT_DESC desc;
 	memset( &desc, 0, sizeof(desc) );
-	hRet = device->CreateInputLayout( &desc, 0, codeBlob->GetBufferPointer(), codeBlob->GetBufferSize(), &inputLayout );
+	hRet = device->CreateInputLayout( &desc, 0, code, codeSize, &inputLayout );
 	if ( FAILED(hRet) || !inputLayout )
 	{
 		GLog.Err( "D3D: Failed to create vertex input layout, error 0x%08X", hRet );
-		codeBlob->Release();
+		delete fetchLayout;
 		vs->Release();
 		return nullptr;
 	}
 
-	// code no longer needed
-	codeBlob->Release();
-
 	// return wrapper
 	CDX11VertexShader* ret = new CDX11VertexShader();
 	ret->m_source = sourceMicrocode;
 	ret->m_fetchLayout = fetchLayout;
 	ret->m_vertexInputLayout = inputLayout;
-	ret->m_sourceCodeHLSL = code;
 	ret->m_vertexShader = vs;
 	return ret;
 }
@@ -218,28 +184,7 @@ CDX11PixelShader::~CDX11PixelShader()
 	}
 }
 
-CDX11PixelShader::DrawingContext::DrawingContext()
-	: m_bSRGBWrite( false )
-	, m_bAlphaTestEnabled( false )
-	, m_psRegs( 0 )
-	, m_vsRegs( 0 )
-	, m_interp( 0 )
-{
-}
-
-uint32 CDX11PixelShader::DrawingContext::GetHash() const
-{
-	uint32 ret = 0;
-	ret |= (m_bAlphaTestEnabled ? 1 : 0) << 0;
-	ret |= (m_bSRGBWrite ? 1 : 0) << 1;
-	ret |= (m_psRegs & 0x3F) << 2;
-	ret |= (m_vsRegs & 0x3F) << 8;
-	ret |= (m_interp & 0xF) << 14;
-
-	return ret;
-}
-
-CDX11PixelShader* CDX11PixelShader::Compile( ID3D11Device* device, CDX11MicrocodeShader* sourceMicrocode, const DrawingContext& context, const std::wstring& dumpDir )
+CDX11PixelShader* CDX11PixelShader::Compile( ID3D11Device* device, CDX11MicrocodeShader* sourceMicrocode, const DrawingContext& context, const std::string& code, const std::wstring& dumpDir, CXenonGPUShaderStore* shaderStore )
 {
 	DEBUG_CHECK( device != nullptr );
 
@@ -247,39 +192,6 @@ CDX11PixelShader* CDX11PixelShader::Compile( ID3D11Device* device, CDX11Microcod
 	if ( !sourceMicrocode )
 		return nullptr;
 
-	// microcode must be a vertex shader
-	if ( !sourceMicrocode->IsPixelShader() )
-	{
-		GLog.Err( "D3D: Cannot build pixel shader from microcode for vertex shader" );
-		return nullptr;
-	}
-
-	// generate source code
-	std::string code;
-	CDX11ShaderHLSLGenerator codeGenerator;
-	CDX11ShaderHLSLGenerator::Context codeContext;
-	codeContext.m_numIncomingInputs = context.m_interp;
-	if ( !codeGenerator.GenerateHLSL( *sourceMicrocode, codeContext, code ) )
-	{
-		GLog.Err( "D3D: Error converting microcode shader hash 0x%016llX to HLSL", sourceMicrocode->GetHash() );
-		return nullptr;
-	}
-
-	// dump generated code
-	if ( !dumpDir.empty() )
-	{
-		wchar_t fileName[512];
-		swprintf_s( fileName, ARRAYSIZE(fileName), L"%sshader_%08llX_%d_pixel_fx.txt", dumpDir.c_str(), sourceMicrocode->GetHash(), context.GetHash() );
-
-		FILE* f = NULL;
-		_wfopen_s( &f, fileName, L"w" );
-		if ( f )
-		{
-			fwrite( code.c_str(), code.length(), 1, f );
-			fclose(f);
-		}
-	}
-
 	// compile the shader
 	DWORD flags = 0;
 	DWORD flags2 = 0;
@@ -319,17 +231,6 @@ CDX11PixelShader* CDX11PixelShader::Compile( ID3D11Device* device, CDX11Microcod
 	if ( !codeBlob)
 		return nullptr;
 
-	// create vertex shader
-	ID3D11PixelShader* ps = nullptr;
-	hRet = device->CreatePixelShader( codeBlob->GetBufferPointer(), codeBlob->GetBufferSize(), NULL, &ps );
-	if ( FAILED(hRet) )
-	{
-		GLog.Err( "D3D: Failed to create pixel shader, error 0x%08X", hRet );
-		codeBlob->Release();
-		return nullptr;
-	}
-
-
 	// decompile
 	if ( !dumpDir.empty() )
 	{
@@ -352,14 +253,38 @@ CDX11PixelShader* CDX11PixelShader::Compile( ID3D11Device* device, CDX11Microcod
 		}
 	}
 
+	// create the shader
+	CDX11PixelShader* ret = CreateFromBinary( device, sourceMicrocode, codeBlob->GetBufferPointer(), (uint32) codeBlob->GetBufferSize() );
+
+	// save the compiled code for the next sessions
+	if ( ret && shaderStore )
+		shaderStore->Store( CXenonGPUShaderStore::EntryType::PixelBinary, sourceMicrocode->GetHash(), context.GetHash(), DX11_SHADER_TRANSLATOR_VERSION, codeBlob->GetBufferPointer(), (uint32) codeBlob->GetBufferSize() );
+
 	// code no longer needed
 	codeBlob->Release();
 
+	// keep the source for debug
+	if ( ret )
+		ret->m_sourceCodeHLSL = code;
+
+	return ret;
+}
+
+CDX11PixelShader* CDX11PixelShader::CreateFromBinary( ID3D11Device* device, CDX11MicrocodeShader* sourceMicrocode, const void* code, const uint32 codeSize )
+{
+	// create pixel shader
+	ID3D11PixelShader* ps = nullptr;
+	HRESULT hRet = device->CreatePixelShader( code, codeSize, NULL, &ps );
+	if ( FAILED(hRet) )
+	{
+		GLog.Err( "D3D: Failed to create pixel shader, error 0x%08X", hRet );
+		return nullptr;
+	}
+
 	// return wrapper
 	CDX11PixelShader* ret = new CDX11PixelShader();
 	ret->m_source = sourceMicrocode;
 	ret->m_pixelShader = ps;
-	ret->m_sourceCodeHLSL = code;
 	return ret;
 }
 
@@ -4,8 +4,14 @@
 #include <d3d11.h>
 #include <d3dcompiler.h>
 
+#include "dx11ShaderTranslator.h"
+
 class CDX11FetchLayout;
 class CDX11MicrocodeShader;
+class CXenonGPUShaderStore;
+
+/// Version of the microcode to HLSL translation, bump it when the generated code changes so the stored shader binaries are not used
+static const uint32 DX11_SHADER_TRANSLATOR_VERSION = 1;
 
 /// Rendering vertex shader (includes the vertex format information)
 class CDX11VertexShader
@@ -15,16 +21,7 @@ public:
 	~CDX11VertexShader();
 
 	// drawing context (may affect outcome of actual shader compilation)
-	struct DrawingContext
-	{
-		bool	m_bTest;
-		uint32	m_vsRegs:6;				// number of vertex shader regs
-		uint32	m_psRegs:6;				// number of pixel shader regs
-
-		DrawingContext();
-
-		uint32 GetHash() const;
-	};
+	typedef CDX11ShaderTranslator::VertexContext DrawingContext;
 
 	// Get fetch format
 	inline const CDX11FetchLayout* GetFetchLayout() const { return m_fetchLayout; }
@@ -36,9 +33,13 @@ public:
 	inline ID3D11InputLayout* GetBindableInputLayout() const { return m_vertexInputLayout; }
 	inline ID3D11VertexShader* GetBindableShader() const { return m_vertexShader; }
 
-	// Create vertex shader out of decompiled microcode	
+	// Compile vertex shader from the HLSL code translated from the microcode (see CDX11ShaderTranslator)
 	// NOTE: the decompiled microcode can be shared between multiple actual shaders
-	static CDX11VertexShader* Compile( ID3D11Device* device, CDX11MicrocodeShader* sourceMicrocode, const DrawingContext& context, const std::wstring& dumpDir );
+	// NOTE: if the shader store is given the compiled code is saved to it
+	static CDX11VertexShader* Compile( ID3D11Device* device, CDX11MicrocodeShader* sourceMicrocode, const DrawingContext& context, const std::string& code, const std::wstring& dumpDir, CXenonGPUShaderStore* shaderStore );
+
+	// Create vertex shader out of already compiled code
+	static CDX11VertexShader* CreateFromBinary( ID3D11Device* device, CDX11MicrocodeShader* sourceMicrocode, const void* code, const uint32 codeSize );
 
 private:
 	// source shader
@@ -63,18 +64,7 @@ public:
 	~CDX11PixelShader();
 
 	// drawing context (may affect outcome of actual shader compilation)
-	struct DrawingContext
-	{
-		bool	m_bSRGBWrite;			// srgb write to render targets
-		bool	m_bAlphaTestEnabled;	// alpha test is enabled
-		uint32	m_vsRegs:6;				// number of vertex shader regs
-		uint32	m_psRegs:6;				// number of pixel shader regs
-		uint32  m_interp:4;				// number of used vertex shader interpolators
-
-		DrawingContext();
-
-		uint32 GetHash() const;
-	};
+	typedef CDX11ShaderTranslator::PixelContext DrawingContext;
 
 	// D3D resources
 	inline ID3D11PixelShader* GetBindableShader() const { return m_pixelShader; }
@@ -85,9 +75,13 @@ public:
 	// Get the debug source code
 	inline const std::string& GetSourceCode() const { return m_sourceCodeHLSL; }
 
-	// Create pixel shader out of decompiled microcode	
+	// Compile pixel shader from the HLSL code translated from the microcode (see CDX11ShaderTranslator)
 	// NOTE: the decompiled microcode can be shared between multiple actual shaders
-	static CDX11PixelShader* Compile( ID3D11Device* device, CDX11MicrocodeShader* sourceMicrocode, const DrawingContext& context, const std::wstring& dumpDir );
+	// NOTE: if the shader store is given the compiled code is saved to it
+	static CDX11PixelShader* Compile( ID3D11Device* device, CDX11MicrocodeShader* sourceMicrocode, const DrawingContext& context, const std::string& code, const std::wstring& dumpDir, CXenonGPUShaderStore* shaderStore );
+
+	// Create pixel shader out of already compiled code
+	static CDX11PixelShader* CreateFromBinary( ID3D11Device* device, CDX11MicrocodeShader* sourceMicrocode, const void* code, const uint32 codeSize );
 
 private:
 	// source shader
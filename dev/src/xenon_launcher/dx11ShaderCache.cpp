@@ -1,11 +1,40 @@
 #include "build.h"
 #include "xenonGPUUtils.h"
 #include "dx11MicrocodeShader.h"
+#include "dx11MicrocodeCache.h"
 #include "dx11ShaderCache.h"
+#include "dx11ShaderTranslator.h"
+#include "xenonGPUShaderStore.h"
+#include "xenonGPUWorkerPool.h"
 
-CDX11ShaderCache::CDX11ShaderCache( ID3D11Device* dev )
+namespace Helper
+{
+	static inline uint64 GetTime()
+	{
+		LARGE_INTEGER time;
+		QueryPerformanceCounter( &time );
+		return time.QuadPart;
+	}
+
+	static inline double GetTimeMS( const uint64 start, const uint64 end )
+	{
+		LARGE_INTEGER freq;
+		QueryPerformanceFrequency( &freq );
+		return (double)( end - start ) * 1000.0 / (double) freq.QuadPart;
+	}
+}
+
+CDX11ShaderCache::CDX11ShaderCache( ID3D11Device* dev, CXenonGPUShaderStore* shaderStore )
 	: m_device( dev )
+	, m_shaderStore( shaderStore )
+	, m_numTranslated( 0 )
+	, m_numFailed( 0 )
+	, m_totalTranslationTime( 0.0 )
+	, m_maxTranslationTime( 0.0 )
+	, m_numSkippedDraws( 0 )
 {
+	m_workerPool = new CXenonGPUWorkerPool( 0 );
+	GLog.Log( "D3D: Using %u threads for shader translation", m_workerPool->GetNumThreads() );
 }
 
 void CDX11ShaderCache::SetDumpPath( const std::wstring& absPath )
@@ -15,14 +44,102 @@ void CDX11ShaderCache::SetDumpPath( const std::wstring& absPath )
 
 CDX11ShaderCache::~CDX11ShaderCache()
 {
-	for ( auto it : m_pixelShaders )
-		delete it.second;
+	// stop the translation, the shaders that are still waiting are not created
+	delete m_workerPool;
+	m_workerPool = nullptr;
+
+	GLog.Log( "D3D: Translated %u shaders (%u failed) in %1.2f ms, longest %1.2f ms, %u draws skipped waiting for shaders",
+		m_numTranslated, m_numFailed, m_totalTranslationTime, m_maxTranslationTime, m_numSkippedDraws );
+
+	m_pixelShaders.ForEach( []( const Key&, TPixelEntry* entry )
+	{
+		delete entry->m_shader;
+		delete entry;
+	} );
+
+	m_vertexShaders.ForEach( []( const Key&, TVertexEntry* entry )
+	{
+		delete entry->m_shader;
+		delete entry;
+	} );
+}
+
+template< typename T >
+T* CDX11ShaderCache::GetReadyShader( Entry< T >* entry, const bool bWait, bool& outPending )
+{
+	if ( !entry->m_ready.load( std::memory_order_acquire ) )
+	{
+		if ( !bWait )
+		{
+			outPending = true;
+			return nullptr;
+		}
+
+		// the jobs are not cancelled while we are alive, the shader will be ready after all of them finish
+		m_workerPool->WaitForAll();
+		DEBUG_CHECK( entry->m_ready.load( std::memory_order_acquire ) );
+	}
+
+	return entry->m_shader;
+}
+
+CDX11VertexShader* CDX11ShaderCache::CreateVertexShader( CDX11MicrocodeShader* sourceMicrocode, const CDX11VertexShader::DrawingContext& context )
+{
+	// use the code compiled in the previous sessions
+	if ( m_shaderStore )
+	{
+		CXenonGPUShaderStore::Entry entry;
+		if ( m_shaderStore->Find( CXenonGPUShaderStore::EntryType::VertexBinary, sourceMicrocode->GetHash(), context.GetHash(), DX11_SHADER_TRANSLATOR_VERSION, entry ) )
+			return CDX11VertexShader::CreateFromBinary( m_device, sourceMicrocode, entry.m_data, entry.m_dataSize );
+	}
+
+	// translate microcode to HLSL and compile it
+	std::string code;
+	if ( !CDX11ShaderTranslator::TranslateVertexShader( *sourceMicrocode, context, m_dumpPath, code ) )
+		return nullptr;
+
+	return CDX11VertexShader::Compile( m_device, sourceMicrocode, context, code, m_dumpPath, m_shaderStore );
+}
+
+CDX11PixelShader* CDX11ShaderCache::CreatePixelShader( CDX11MicrocodeShader* sourceMicrocode, const CDX11PixelShader::DrawingContext& context )
+{
+	// use the code compiled in the previous sessions
+	if ( m_shaderStore )
+	{
+		CXenonGPUShaderStore::Entry entry;
+		if ( m_shaderStore->Find( CXenonGPUShaderStore::EntryType::PixelBinary, sourceMicrocode->GetHash(), context.GetHash(), DX11_SHADER_TRANSLATOR_VERSION, entry ) )
+			return CDX11PixelShader::CreateFromBinary( m_device, sourceMicrocode, entry.m_data, entry.m_dataSize );
+	}
 
-	for ( auto it : m_vertexShaders )
-		delete it.second;
+	// translate microcode to HLSL and compile it
+	std::string code;
+	if ( !CDX11ShaderTranslator::TranslatePixelShader( *sourceMicrocode, context, m_dumpPath, code ) )
+		return nullptr;
+
+	return CDX11PixelShader::Compile( m_device, sourceMicrocode, context, code, m_dumpPath, m_shaderStore );
 }
 
-CDX11VertexShader* CDX11ShaderCache::GetVertexShader( CDX11MicrocodeShader* sourceMicrocode, const CDX11VertexShader::DrawingContext& context )
+void CDX11ShaderCache::ReportTranslation( const char* type, const uint64 shaderHash, const uint32 contextHash, const bool valid, const uint64 requestTime, const uint64 startTime )
+{
+	const uint64 endTime = Helper::GetTime();
+	const double translationTime = Helper::GetTimeMS( startTime, endTime );
+	const double waitTime = Helper::GetTimeMS( requestTime, startTime );
+
+	{
+		std::lock_guard< std::mutex > lock( m_statsLock );
+
+		m_numTranslated += 1;
+		m_numFailed += valid ? 0 : 1;
+		m_totalTranslationTime += translationTime;
+		if ( translationTime > m_maxTranslationTime )
+			m_maxTranslationTime = translationTime;
+	}
+
+	GLog.Spam( "D3D: %hs shader 0x%016llX (context %08X) translated in %1.2f ms (waited %1.2f ms)%hs",
+		type, shaderHash, contextHash, translationTime, waitTime, valid ? "" : ", FAILED" );
+}
+
+CDX11VertexShader* CDX11ShaderCache::GetVertexShader( CDX11MicrocodeShader* sourceMicrocode, const CDX11VertexShader::DrawingContext& context, const bool bWait, bool& outPending )
 {
 	// no source
 	if ( !sourceMicrocode )
@@ -30,17 +147,39 @@ CDX11VertexShader* CDX11ShaderCache::GetVertexShader( CDX11MicrocodeShader* sour
 
 	// search
 	const Key key( sourceMicrocode->GetHash(), context.GetHash() );
-	const auto it = m_vertexShaders.find( key );
-	if ( it != m_vertexShaders.end() )
-		return it->second;
+	TVertexEntry** existing = m_vertexShaders.Find( key );
+	if ( existing )
+		return GetReadyShader( *existing, bWait, outPending );
+
+	// the caller can't skip the draw, create the shader right away
+	const uint64 requestTime = Helper::GetTime();
+	if ( bWait )
+	{
+		TVertexEntry* entry = new TVertexEntry( CreateVertexShader( sourceMicrocode, context ), true );
+		m_vertexShaders.Insert( key, entry );
+
+		ReportTranslation( "Vertex", key.m_shaderHash, key.m_contextHash, entry->m_shader != nullptr, requestTime, requestTime );
+		return entry->m_shader;
+	}
+
+	// translate in the background, the microcode is owned by the microcode cache that outlives us
+	TVertexEntry* entry = new TVertexEntry( nullptr, false );
+	m_vertexShaders.Insert( key, entry );
 
-	// create new
-	CDX11VertexShader* vs = CDX11VertexShader::Compile( m_device, sourceMicrocode, context, m_dumpPath );
-	m_vertexShaders[ key ] = vs;
-	return vs;
+	m_workerPool->Submit( [this, entry, sourceMicrocode, context, key, requestTime]()
+	{
+		const uint64 startTime = Helper::GetTime();
+		entry->m_shader = CreateVertexShader( sourceMicrocode, context );
+		entry->m_ready.store( true, std::memory_order_release );
+
+		ReportTranslation( "Vertex", key.m_shaderHash, key.m_contextHash, entry->m_shader != nullptr, requestTime, startTime );
+	} );
+
+	outPending = true;
+	return nullptr;
 }
 
-CDX11PixelShader* CDX11ShaderCache::GetPixelShader( CDX11MicrocodeShader* sourceMicrocode, const CDX11PixelShader::DrawingContext& context )
+CDX11PixelShader* CDX11ShaderCache::GetPixelShader( CDX11MicrocodeShader* sourceMicrocode, const CDX11PixelShader::DrawingContext& context, const bool bWait, bool& outPending )
 {
 	// no source
 	if ( !sourceMicrocode )
@@ -48,12 +187,100 @@ CDX11PixelShader* CDX11ShaderCache::GetPixelShader( CDX11MicrocodeShader* source
 
 	// search
 	const Key key( sourceMicrocode->GetHash(), context.GetHash() );
-	const auto it = m_pixelShaders.find( key );
-	if ( it != m_pixelShaders.end() )
-		return it->second;
-
-	// create new
-	CDX11PixelShader* ps = CDX11PixelShader::Compile( m_device, sourceMicrocode, context, m_dumpPath );
-	m_pixelShaders[ key ] = ps;
-	return ps;
+	TPixelEntry** existing = m_pixelShaders.Find( key );
+	if ( existing )
+		return GetReadyShader( *existing, bWait, outPending );
+
+	// the caller can't skip the draw, create the shader right away
+	const uint64 requestTime = Helper::GetTime();
+	if ( bWait )
+	{
+		TPixelEntry* entry = new TPixelEntry( CreatePixelShader( sourceMicrocode, context ), true );
+		m_pixelShaders.Insert( key, entry );
+
+		ReportTranslation( "Pixel", key.m_shaderHash, key.m_contextHash, entry->m_shader != nullptr, requestTime, requestTime );
+		return entry->m_shader;
+	}
+
+	// translate in the background, the microcode is owned by the microcode cache that outlives us
+	TPixelEntry* entry = new TPixelEntry( nullptr, false );
+	m_pixelShaders.Insert( key, entry );
+
+	m_workerPool->Submit( [this, entry, sourceMicrocode, context, key, requestTime]()
+	{
+		const uint64 startTime = Helper::GetTime();
+		entry->m_shader = CreatePixelShader( sourceMicrocode, context );
+		entry->m_ready.store( true, std::memory_order_release );
+
+		ReportTranslation( "Pixel", key.m_shaderHash, key.m_contextHash, entry->m_shader != nullptr, requestTime, startTime );
+	} );
+
+	outPending = true;
+	return nullptr;
+}
+
+void CDX11ShaderCache::WarmUp( CDX11MicrocodeCache* microcodeCache )
+{
+	if ( !m_shaderStore )
+		return;
+
+	uint32 numCreated = 0;
+
+	// vertex shaders
+	{
+		std::vector< CXenonGPUShaderStore::Entry > entries;
+		m_shaderStore->GetEntries( CXenonGPUShaderStore::EntryType::VertexBinary, entries );
+		for ( const auto& entry : entries )
+		{
+			// compiled with different translator
+			if ( entry.m_version != DX11_SHADER_TRANSLATOR_VERSION )
+				continue;
+
+			CXenonGPUShaderStore::Entry microcodeEntry;
+			if ( !m_shaderStore->Find( CXenonGPUShaderStore::EntryType::VertexMicrocode, entry.m_hash, 0, 0, microcodeEntry ) )
+				continue;
+
+			CDX11MicrocodeShader* microcode = microcodeCache->GetCachedVertexShader( microcodeEntry.m_data, microcodeEntry.m_dataSize );
+			if ( !microcode )
+				continue;
+
+			const Key key( entry.m_hash, entry.m_contextHash );
+			if ( m_vertexShaders.Find( key ) )
+				continue;
+
+			CDX11VertexShader* vs = CDX11VertexShader::CreateFromBinary( m_device, microcode, entry.m_data, entry.m_dataSize );
+			m_vertexShaders.Insert( key, new TVertexEntry( vs, true ) );
+			numCreated += vs ? 1 : 0;
+		}
+	}
+
+	// pixel shaders
+	{
+		std::vector< CXenonGPUShaderStore::Entry > entries;
+		m_shaderStore->GetEntries( CXenonGPUShaderStore::EntryType::PixelBinary, entries );
+		for ( const auto& entry : entries )
+		{
+			// compiled with different translator
+			if ( entry.m_version != DX11_SHADER_TRANSLATOR_VERSION )
+				continue;
+
+			CXenonGPUShaderStore::Entry microcodeEntry;
+			if ( !m_shaderStore->Find( CXenonGPUShaderStore::EntryType::PixelMicrocode, entry.m_hash, 0, 0, microcodeEntry ) )
+				continue;
+
+			CDX11MicrocodeShader* microcode = microcodeCache->GetCachedPixelShader( microcodeEntry.m_data, microcodeEntry.m_dataSize );
+			if ( !microcode )
+				continue;
+
+			const Key key( entry.m_hash, entry.m_contextHash );
+			if ( m_pixelShaders.Find( key ) )
+				continue;
+
+			CDX11PixelShader* ps = CDX11PixelShader::CreateFromBinary( m_device, microcode, entry.m_data, entry.m_dataSize );
+			m_pixelShaders.Insert( key, new TPixelEntry( ps, true ) );
+			numCreated += ps ? 1 : 0;
+		}
+	}
+
+	GLog.Log( "D3D: Created %u shaders from the shader store", numCreated );
 }
\ No newline at end of file
@@ -1,68 +1,117 @@
 #pragma once
 
 #include "dx11Shader.h"
+#include "xenonGPUHashMap.h"
+
+class CDX11MicrocodeCache;
+class CXenonGPUShaderStore;
+class CXenonGPUWorkerPool;
 
 /// Cache for shaders
+/// New shaders are translated and compiled in the background, the draws that use them are skipped until they are ready unless the caller asks to wait
 class CDX11ShaderCache
 {
 public:
-	CDX11ShaderCache( ID3D11Device* dev );
+	CDX11ShaderCache( ID3D11Device* dev, CXenonGPUShaderStore* shaderStore );
 	~CDX11ShaderCache();
 
 	/// Set shader dump path
 	void SetDumpPath( const std::wstring& absPath );
 
-	/// Get renderable vertex shader for given microcode and drawing context  (can return cached one)
-	CDX11VertexShader* GetVertexShader( CDX11MicrocodeShader* sourceMicrocode, const CDX11VertexShader::DrawingContext& context );
+	/// Get renderable vertex shader for given microcode and drawing context  (can return cached one), returns NULL if the shader is not ready yet (outPending is set) or failed
+	/// If asked to wait a new shader is created right away and the pending one is waited for (used when the draws can't be skipped, ex: trace dump)
+	CDX11VertexShader* GetVertexShader( CDX11MicrocodeShader* sourceMicrocode, const CDX11VertexShader::DrawingContext& context, const bool bWait, bool& outPending );
+
+	/// Get renderable pixel shader for given microcode and drawing context (can return cached one), returns NULL if the shader is not ready yet (outPending is set) or failed
+	/// If asked to wait a new shader is created right away and the pending one is waited for (used when the draws can't be skipped, ex: trace dump)
+	CDX11PixelShader* GetPixelShader( CDX11MicrocodeShader* sourceMicrocode, const CDX11PixelShader::DrawingContext& context, const bool bWait, bool& outPending );
+
+	/// Count a draw that was skipped because its shaders are not ready yet (reported in the stats)
+	inline void CountSkippedDraw() { m_numSkippedDraws += 1; }
 
-	/// Get renderable pixel shader for given microcode and drawing context (can return cached one)
-	CDX11PixelShader* GetPixelShader( CDX11MicrocodeShader* sourceMicrocode, const CDX11PixelShader::DrawingContext& context );
+	/// Create all shaders compiled in the previous sessions, the microcode is taken from the microcode cache
+	void WarmUp( CDX11MicrocodeCache* microcodeCache );
 
 private:
 	// cached device
 	ID3D11Device*		m_device;
 
+	// persistent storage for the compiled shaders, optional
+	CXenonGPUShaderStore*	m_shaderStore;
+
+	// background translation of the shaders
+	CXenonGPUWorkerPool*	m_workerPool;
+
 	// cache key
 	struct Key
 	{
 		uint64 m_shaderHash;
 		uint32 m_contextHash;
 
+		inline Key()
+			: m_shaderHash( 0 )
+			, m_contextHash( 0 )
+		{}
+
 		inline Key( const uint64 shaderHash, const uint32 contextHash )
 			: m_shaderHash( shaderHash )
 			, m_contextHash( contextHash )
 		{}
+	};
 
-		inline Key( const Key& other )
-			: m_shaderHash( other.m_shaderHash )
-			, m_contextHash( other.m_contextHash )
-		{}
-
-		inline const bool operator==( const Key& other ) const
+	// key hashing, the shader hash is already well distributed
+	struct KeyTraits
+	{
+		static inline uint32 Hash( const Key& key )
 		{
-			return (other.m_contextHash == m_contextHash) && (other.m_shaderHash == other.m_shaderHash);
+			return (uint32)( key.m_shaderHash ^ (key.m_shaderHash >> 32) ) ^ ( key.m_contextHash * 2654435761U );
 		}
 
-		inline const bool operator!=( const Key& other ) const
+		static inline bool Equal( const Key& a, const Key& b )
 		{
-			return (other.m_contextHash != m_contextHash) || (other.m_shaderHash != other.m_shaderHash);
+			return (a.m_shaderHash == b.m_shaderHash) && (a.m_contextHash == b.m_contextHash);
 		}
+	};
 
-		inline const bool operator<( const Key& other ) const
-		{
-			if ( other.m_shaderHash < m_shaderHash )
-				return true;
-			if (other.m_shaderHash > m_shaderHash)
-				return false;
+	// cache entry, the shader is filled by the worker thread
+	template< typename T >
+	struct Entry
+	{
+		T*						m_shader;
+		std::atomic< bool >		m_ready;
 
-			return other.m_contextHash < m_contextHash;
-		}
+		inline Entry( T* shader, const bool ready )
+			: m_shader( shader )
+			, m_ready( ready )
+		{}
 	};
-	
+
+	typedef Entry< CDX11PixelShader >		TPixelEntry;
+	typedef Entry< CDX11VertexShader >		TVertexEntry;
+
 	// pixel/vertex caches
-	std::map< Key, CDX11PixelShader* >		m_pixelShaders;
-	std::map< Key, CDX11VertexShader* >		m_vertexShaders;
+	TXenonGPUHashMap< Key, TPixelEntry*, KeyTraits >		m_pixelShaders;
+	TXenonGPUHashMap< Key, TVertexEntry*, KeyTraits >		m_vertexShaders;
 
 	// dump path for shaders
 	std::wstring							m_dumpPath;
+
+	// translation stats
+	std::mutex								m_statsLock;
+	uint32									m_numTranslated;
+	uint32									m_numFailed;
+	double									m_totalTranslationTime;
+	double									m_maxTranslationTime;
+	uint32									m_numSkippedDraws;		// accessed only from the GPU thread
+
+	// get the shader if it's ready (or wait for it)
+	template< typename T >
+	T* GetReadyShader( Entry< T >* entry, const bool bWait, bool& outPending );
+
+	// create shader from the stored binary or translate the microcode and compile it, called on the worker threads or directly when waiting
+	CDX11VertexShader* CreateVertexShader( CDX11MicrocodeShader* sourceMicrocode, const CDX11VertexShader::DrawingContext& context );
+	CDX11PixelShader* CreatePixelShader( CDX11MicrocodeShader* sourceMicrocode, const CDX11PixelShader::DrawingContext& context );
+
+	// report finished translation
+	void ReportTranslation( const char* type, const uint64 shaderHash, const uint32 contextHash, const bool valid, const uint64 requestTime, const uint64 startTime );
 };
\ No newline at end of file
@@ -0,0 +1,117 @@
+#include "build.h"
+#include "xenonGPUUtils.h"
+#include "dx11ShaderTranslator.h"
+#include "dx11MicrocodeShader.h"
+#include "dx11ShaderBuilder.h"
+
+//---------------------------------------------------------------------------
+
+namespace Helper
+{
+	static void DumpShaderCode( const std::wstring& dumpDir, const uint64 shaderHash, const uint32 contextHash, const wchar_t* type, const std::string& code )
+	{
+		wchar_t fileName[512];
+		swprintf_s( fileName, ARRAYSIZE(fileName), L"%lsshader_%08llX_%d_%ls_fx.txt", dumpDir.c_str(), shaderHash, contextHash, type );
+
+		FILE* f = NULL;
+		_wfopen_s( &f, fileName, L"w" );
+		if ( f )
+		{
+			fwrite( code.c_str(), code.length(), 1, f );
+			fclose(f);
+		}
+	}
+}
+
+//---------------------------------------------------------------------------
+
+CDX11ShaderTranslator::VertexContext::VertexContext()
+	: m_bTest( false )
+	, m_psRegs( 0 )
+	, m_vsRegs( 0 )
+{
+}
+
+uint32 CDX11ShaderTranslator::VertexContext::GetHash() const
+{
+	uint32 ret = 0;
+	ret |= (m_bTest ? 1 : 0) << 0;
+	ret |= (m_psRegs & 0x3F) << 1;
+	ret |= (m_vsRegs & 0x3F) << 7;
+	return ret;
+}
+
+CDX11ShaderTranslator::PixelContext::PixelContext()
+	: m_bSRGBWrite( false )
+	, m_bAlphaTestEnabled( false )
+	, m_psRegs( 0 )
+	, m_vsRegs( 0 )
+	, m_interp( 0 )
+{
+}
+
+uint32 CDX11ShaderTranslator::PixelContext::GetHash() const
+{
+	uint32 ret = 0;
+	ret |= (m_bAlphaTestEnabled ? 1 : 0) << 0;
+	ret |= (m_bSRGBWrite ? 1 : 0) << 1;
+	ret |= (m_psRegs & 0x3F) << 2;
+	ret |= (m_vsRegs & 0x3F) << 8;
+	ret |= (m_interp & 0xF) << 14;
+
+	return ret;
+}
+
+//---------------------------------------------------------------------------
+
+bool CDX11ShaderTranslator::TranslateVertexShader( const CDX11MicrocodeShader& sourceMicrocode, const VertexContext& context, const std::wstring& dumpDir, std::string& outCode )
+{
+	// microcode must be a vertex shader
+	if ( sourceMicrocode.IsPixelShader() )
+	{
+		GLog.Err( "D3D: Cannot build vertex shader from microcode for pixel shader" );
+		return false;
+	}
+
+	// generate source code
+	CDX11ShaderHLSLGenerator codeGenerator;
+	CDX11ShaderHLSLGenerator::Context codeContext;
+	codeContext.m_numIncomingInputs = 0;
+	if ( !codeGenerator.GenerateHLSL( sourceMicrocode, codeContext, outCode ) )
+	{
+		GLog.Err( "D3D: Error converting microcode shader hash 0x%016llX to HLSL", sourceMicrocode.GetHash() );
+		return false;
+	}
+
+	// dump generated code
+	if ( !dumpDir.empty() )
+		Helper::DumpShaderCode( dumpDir, sourceMicrocode.GetHash(), context.GetHash(), L"vertex", outCode );
+
+	return true;
+}
+
+bool CDX11ShaderTranslator::TranslatePixelShader( const CDX11MicrocodeShader& sourceMicrocode, const PixelContext& context, const std::wstring& dumpDir, std::string& outCode )
+{
+	// microcode must be a pixel shader
+	if ( !sourceMicrocode.IsPixelShader() )
+	{
+		GLog.Err( "D3D: Cannot build pixel shader from microcode for vertex shader" );
+		return false;
+	}
+
+	// generate source code
+	CDX11ShaderHLSLGenerator codeGenerator;
+	CDX11ShaderHLSLGenerator::Context codeContext;
+	codeContext.m_numIncomingInputs = context.m_interp;
+	if ( !codeGenerator.GenerateHLSL( sourceMicrocode, codeContext, outCode ) )
+	{
+		GLog.Err( "D3D: Error converting microcode shader hash 0x%016llX to HLSL", sourceMicrocode.GetHash() );
+		return false;
+	}
+
+	// dump generated code
+	if ( !dumpDir.empty() )
+		Helper::DumpShaderCode( dumpDir, sourceMicrocode.GetHash(), context.GetHash(), L"pixel", outCode );
+
+	return true;
+}
@@ -0,0 +1,41 @@
+#pragma once
+
+class CDX11MicrocodeShader;
+
+/// Translation of the decompiled microcode into the HLSL code of the rendering shaders
+/// This is the first stage of the shader creation, it does not depend on D3D and can be tested without the device
+class CDX11ShaderTranslator
+{
+public:
+	// vertex shader drawing context (may affect outcome of actual shader compilation)
+	struct VertexContext
+	{
+		bool	m_bTest;
+		uint32	m_vsRegs:6;				// number of vertex shader regs
+		uint32	m_psRegs:6;				// number of pixel shader regs
+
+		VertexContext();
+
+		uint32 GetHash() const;
+	};
+
+	// pixel shader drawing context (may affect outcome of actual shader compilation)
+	struct PixelContext
+	{
+		bool	m_bSRGBWrite;			// srgb write to render targets
+		bool	m_bAlphaTestEnabled;	// alpha test is enabled
+		uint32	m_vsRegs:6;				// number of vertex shader regs
+		uint32	m_psRegs:6;				// number of pixel shader regs
+		uint32  m_interp:4;				// number of used vertex shader interpolators
+
+		PixelContext();
+
+		uint32 GetHash() const;
+	};
+
+	// Generate HLSL code of the vertex shader, the code is dumped if the dump directory is given
+	static bool TranslateVertexShader( const CDX11MicrocodeShader& sourceMicrocode, const VertexContext& context, const std::wstring& dumpDir, std::string& outCode );
+
+	// Generate HLSL code of the pixel shader, the code is dumped if the dump directory is given
+	static bool TranslatePixelShader( const CDX11MicrocodeShader& sourceMicrocode, const PixelContext& context, const std::wstring& dumpDir, std::string& outCode );
+};
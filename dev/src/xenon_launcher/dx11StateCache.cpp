@@ -23,12 +23,9 @@ void CDX11StateCache::PurgeCache()
 
 bool CDX11StateCache::SetDepthStencil( const D3D11_DEPTH_STENCIL_DESC& dsState, const uint32 stencilRef )
 {
-	// compute input hash
-	const TDSStates::THash hash = TDSStates::ComputeHash( dsState );
-
 	// use existing data
 	{
-		auto* ds = m_dsStates.Get( hash );
+		auto* ds = m_dsStates.Get( dsState );
 		if ( ds )
 		{
 			m_mainContext->OMSetDepthStencilState( ds, stencilRef );
@@ -45,8 +42,8 @@ bool CDX11StateCache::SetDepthStencil( const D3D11_DEPTH_STENCIL_DESC& dsState,
 		return false;
 	}
 
-	// store in hash
-	m_dsStates.Insert( hash, ds );
+	// store in cache
+	m_dsStates.Insert( dsState, ds );
 
 	// bind
 	m_mainContext->OMSetDepthStencilState( ds, stencilRef );
@@ -55,12 +52,9 @@ bool CDX11StateCache::SetDepthStencil( const D3D11_DEPTH_STENCIL_DESC& dsState,
 
 bool CDX11StateCache::SetBlendState( const D3D11_BLEND_DESC& blendState, const float blendFactors[4] )
 {
-	// compute input hash
-	const TBlendStates::THash hash = TBlendStates::ComputeHash( blendState );
-
 	// use existing data
 	{
-		auto* bs = m_blendStates.Get( hash );
+		auto* bs = m_blendStates.Get( blendState );
 		if ( bs )
 		{
 			m_mainContext->OMSetBlendState( bs, blendFactors, 0xFFFFFFFF );
@@ -77,8 +71,8 @@ bool CDX11StateCache::SetBlendState( const D3D11_BLEND_DESC& blendState, const f
 		return false;
 	}
 
-	// store in hash
-	m_blendStates.Insert( hash, bs );
+	// store in cache
+	m_blendStates.Insert( blendState, bs );
 
 	// bind
 	m_mainContext->OMSetBlendState( bs, blendFactors, 0xFFFFFFFF );
@@ -87,12 +81,9 @@ bool CDX11StateCache::SetBlendState( const D3D11_BLEND_DESC& blendState, const f
 
 bool CDX11StateCache::SetRasterState( const D3D11_RASTERIZER_DESC& rasterState )
 {
-	// compute input hash
-	const TRasterStates::THash hash = TRasterStates::ComputeHash( rasterState );
-
 	// use existing data
 	{
-		auto* rs = m_rasterStates.Get( hash );
+		auto* rs = m_rasterStates.Get( rasterState );
 		if ( rs )
 		{
 			m_mainContext->RSSetState( rs );
@@ -109,8 +100,8 @@ bool CDX11StateCache::SetRasterState( const D3D11_RASTERIZER_DESC& rasterState )
 		return false;
 	}
 
-	// store in hash
-	m_rasterStates.Insert( hash, rs );
+	// store in cache
+	m_rasterStates.Insert( rasterState, rs );
 
 	// bind
 	m_mainContext->RSSetState( rs );
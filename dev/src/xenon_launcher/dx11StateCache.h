@@ -4,17 +4,14 @@
 #include <d3d11.h>
 #include <d3dcompiler.h>
 
-#include <map>
-
 #include "xenonGPUUtils.h"
+#include "xenonGPUHashMap.h"
 
-/// State cache
-template< typename T >
+/// State cache, states are keyed by the whole descriptor (descriptors must be zero initialized)
+template< typename D, typename T >
 class TDX11StateMap
 {
 public:
-	typedef uint32 THash;
-
 	TDX11StateMap()
 	{
 	}
@@ -26,38 +23,28 @@ public:
 
 	inline void Clear()
 	{
-		for ( auto it : m_map )
+		m_map.ForEach( []( const D&, T* ptr )
 		{
-			if ( it.second )
-				it.second->Release();
-		}
-
-		m_map.clear();
-	}
-
-	inline T* Get( const THash hash )
-	{
-		const auto it = m_map.find( hash );
-		if ( it != m_map.end() )
-			return it->second;
+			if ( ptr )
+				ptr->Release();
+		} );
 
-		return nullptr;
+		m_map.Clear();
 	}
 
-	inline void Insert( const THash hash, T* ptr )
+	inline T* Get( const D& desc )
 	{
-		m_map[ hash ] = ptr;
+		T** ptr = m_map.Find( desc );
+		return ptr ? *ptr : nullptr;
 	}
 
-	// Compute object hash
-	template< typename D >
-	static THash ComputeHash( const D& data )
+	inline void Insert( const D& desc, T* ptr )
 	{
-		return (THash) XenonGPUCalcCRC( &data, sizeof(data) );
+		m_map.Insert( desc, ptr );
 	}
 
 private:	
-	std::map< THash, T* >		m_map;
+	TXenonGPUHashMap< D, T* >		m_map;
 };
 
 /// DX11 internal state cache
@@ -85,12 +72,12 @@ private:
 	ID3D11DeviceContext*		m_mainContext;
 
 	// Cached objects
-	typedef TDX11StateMap< ID3D11DepthStencilState >	 TDSStates;
+	typedef TDX11StateMap< D3D11_DEPTH_STENCIL_DESC, ID3D11DepthStencilState >	TDSStates;
 	TDSStates					m_dsStates;
 
-	typedef TDX11StateMap< ID3D11BlendState >			TBlendStates;
+	typedef TDX11StateMap< D3D11_BLEND_DESC, ID3D11BlendState >				TBlendStates;
 	TBlendStates				m_blendStates;
 
-	typedef TDX11StateMap< ID3D11RasterizerState >		TRasterStates;
+	typedef TDX11StateMap< D3D11_RASTERIZER_DESC, ID3D11RasterizerState >		TRasterStates;
 	TRasterStates				m_rasterStates;
 };
\ No newline at end of file
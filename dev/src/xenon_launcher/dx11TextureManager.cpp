@@ -3,7 +3,9 @@
 #include "xenonGPUTextures.h"
 #include "dx11TextureManager.h"
 #include "dx11Staging.h"
+#include "xenonGPUTextureConversion.h"
 #include <xutility>
+#include <future>
 
 #undef min
 //#pragma optimize( "", off )
@@ -74,35 +76,9 @@ uint32 CDX11AbstractSurface::GetSourceMemoryAddress() const
 	return m_sourceMemoryOffset;
 }
 
-namespace Helper
-{
-	static void ConvertGPUEndianess(void* dest, const void* src, const uint32 length, XenonGPUEndianFormat endianess)
-	{
-		// endianess
-		if (endianess == XenonGPUEndianFormat::Format8in16)
-		{
-			for (uint32 i = 0; i<length / 2; ++i)
-				*((unsigned short*)dest + i) = _byteswap_ushort(*((const unsigned short*)src + i));
-		}
-		else if (endianess == XenonGPUEndianFormat::Format8in32)
-		{
-			for (uint32 i = 0; i<length / 4; ++i)
-				*((unsigned int*)dest + i) = _byteswap_ulong(*((const unsigned int*)src + i));
-		}
-		else if (endianess == XenonGPUEndianFormat::FormatUnspecified)
-		{
-			memcpy(dest, src, length);
-		}
-		else
-		{
-			DEBUG_CHECK(!"Unknown endianess format");
-		}
-	}
-}
-
 void CDX11AbstractSurface::Upload(const void* srcTextureData, void* destData, uint32 destRowPitch, uint32 destSlicePitch) const
 {
-	uint8 TempData[8192];
+	std::vector<uint8> tempData;
 
 	for (uint32 z = 0; z<m_depth; ++z)
 	{
@@ -110,63 +86,45 @@ void CDX11AbstractSurface::Upload(const void* srcTextureData, void* destData, ui
 		const uint8* srcData = (const uint8*)((uint32)srcTextureData + m_sourceMemoryOffset + m_sourceSlicePitch*z);
 		uint8* targetData = (uint8*)destData + (z*destSlicePitch);
 
-		// max write address
-		const auto maxWriteOffset = destSlicePitch;
-
 		// copy data
 		// texture is tiled - hard case
 		if (m_sourceIsTiled)
 		{
-			// Size of the block to copy (assumed to be the same in source and dest data)
-			const uint32 blockSize = m_sourceBlockSize;
-
-			// Log of BPP (1, 2, 3)
-			const uint32 bppLog = (m_sourceBlockSize >> 2) + ((m_sourceBlockSize >> 1) >> (m_sourceBlockSize >> 2));
-
-			// copy range
-			const uint32 copyWidth = m_sourceBlockWidth;
-			const uint32 copyHeight = std::min(m_sourceBlockHeight, m_height);
-
 			// Tiled textures can be packed; get the offset into the packed texture
 			// The packing place depends on the size of the tiled texture
-			uint32 destOffsetY = 0;
-
-			for (uint32 y = 0, outputOffset = 0; y<copyHeight; ++y, destOffsetY += destRowPitch)
-			{
-				const uint32 srcOffsetY = XenonTextureInfo::TiledOffset2DOuter(m_sourcePackedTileOffsetY + y, m_sourceWidth / m_sourceFormatBlockWidth, bppLog);
-
-				uint32 destOffsetX = destOffsetY;
-
-				for (uint32 x = 0; x<copyWidth; ++x, destOffsetX += blockSize)
-				{
-					const uint32 srcX = m_sourcePackedTileOffsetX + x;
-					const uint32 srcY = m_sourcePackedTileOffsetY + y;
-					const uint32 srcOffset = XenonTextureInfo::TiledOffset2DInner(srcX, srcY, bppLog, srcOffsetY) >> bppLog;
-
-					if (destOffsetX < maxWriteOffset)
-						Helper::ConvertGPUEndianess(targetData + destOffsetX, srcData + srcOffset*blockSize, blockSize, m_sourceEndianess);
-				}
-			}
+			XenonGPUUntileInfo info;
+			info.m_blockSize = m_sourceBlockSize;
+			info.m_sourceWidthInBlocks = m_sourceWidth / m_sourceFormatBlockWidth;
+			info.m_sourceOffsetX = m_sourcePackedTileOffsetX;
+			info.m_sourceOffsetY = m_sourcePackedTileOffsetY;
+			info.m_copyWidth = m_sourceBlockWidth;
+			info.m_copyHeight = std::min(m_sourceBlockHeight, m_height);
+			info.m_destRowPitch = destRowPitch;
+			info.m_destMaxOffset = destSlicePitch;
+			info.m_endianess = m_sourceEndianess;
+
+			XenonGPUUntileSurface(info, srcData, targetData);
 		}
 		// texture is not tiled and the pitch matches
 		else if (m_sourceRowPitch == destRowPitch)
 		{
 			const uint32 totalSize = destRowPitch * m_sourceHeight;
-			Helper::ConvertGPUEndianess(targetData, srcData, totalSize, m_sourceEndianess);
+			XenonGPUConvertEndianess(targetData, srcData, totalSize, m_sourceEndianess);
 		}
 		// custom format support
 		else if (m_sourceFormat == XenonTextureFormat::Format_4_4_4_4)
 		{
 			const uint32 copyPitch = std::min(m_sourceRowPitch, destRowPitch);
 			uint32 copyHeight = std::min(m_sourceBlockHeight, m_height);
-			uint32 copyWidth = m_width;
+			uint32 copyWidth = std::min(m_width, copyPitch / 2);
+			tempData.resize(copyPitch);
 			for (uint32 y = 0; y<copyHeight; ++y)
 			{
-				Helper::ConvertGPUEndianess(TempData, srcData, copyPitch, m_sourceEndianess);
+				XenonGPUConvertEndianess(tempData.data(), srcData, copyPitch, m_sourceEndianess);
 				srcData += m_sourceRowPitch;
 
 				{
-					const uint16* tempPtr = (const uint16*)&TempData;
+					const uint16* tempPtr = (const uint16*)tempData.data();
 					uint8* destWrite = (uint8*)targetData;
 					for (uint32 x = 0; x<copyWidth; ++x, ++tempPtr, destWrite += 4)
 					{
@@ -194,7 +152,7 @@ void CDX11AbstractSurface::Upload(const void* srcTextureData, void* destData, ui
 			uint32 copyHeight = std::min(m_sourceBlockHeight, m_sourceHeight);
 			for (uint32 y = 0; y<copyHeight; ++y)
 			{
-				Helper::ConvertGPUEndianess(targetData, srcData, copyPitch, m_sourceEndianess);
+				XenonGPUConvertEndianess(targetData, srcData, copyPitch, m_sourceEndianess);
 				targetData += destRowPitch;
 				srcData += m_sourceRowPitch;
 			}
@@ -213,6 +171,7 @@ CDX11AbstractTexture::CDX11AbstractTexture()
 	, m_viewFormat(DXGI_FORMAT_UNKNOWN)
 	, m_view(nullptr)
 	, m_initialDirty(true)
+	, m_uploadEpoch(0)
 {
 }
 
@@ -919,15 +878,25 @@ CDX11AbstractTexture* CDX11AbstractTexture::Create(ID3D11Device* device, CDX11St
 	return ret.release();
 }
 
-bool CDX11AbstractTexture::ShouldBeUpdated() const
+uint32 CDX11AbstractTexture::GetSourceWriteEpoch() const
+{
+	const uint32 baseAddress = GPlatform.GetMemory().TranslatePhysicalAddress(GetBaseAddress());
+	const uint32 memorySize = m_sourceInfo.CalculateMemoryRegionSize();
+	return GPlatform.GetMemory().GetLastWriteEpoch((const void*)baseAddress, memorySize);
+}
+
+bool CDX11AbstractTexture::ShouldBeUpdated()
 {
 	// texture has never been updated
 	if (m_initialDirty)
 		return true;
 
-	// TODO: memory range check :)
+	// no staging buffers (render targets), nothing to upload
+	if (m_stagingBuffers.empty())
+		return false;
 
-	return false;
+	// source memory was written since the last upload
+	return GetSourceWriteEpoch() != m_uploadEpoch;
 }
 
 void CDX11AbstractTexture::EnsureUpToDate()
@@ -941,15 +910,28 @@ void CDX11AbstractTexture::EnsureUpToDate()
 
 }
 
+// surfaces smaller than this are converted on the calling thread
+static const uint32 MIN_PARALLEL_UPLOAD_SIZE = 256 * 1024;
+
 void CDX11AbstractTexture::Update()
 {
 	// get address for the SOURCE texture data
 	const uint32 baseAddress = GetBaseAddress();
 	const void* srcData = (const void*)GPlatform.GetMemory().TranslatePhysicalAddress(baseAddress);
 
+	// capture the write epoch before reading the data so writes done during the upload are not lost
+	if (!m_stagingBuffers.empty())
+		m_uploadEpoch = GetSourceWriteEpoch();
+
 	// upload ALL mips and slices
+	// staging buffers are per mip so the mips of a single slice are converted in parallel
+	std::vector<std::pair<CDX11StagingTexture*, uint32>> lockedStaging;
+	std::vector<std::future<void>> pendingUploads;
 	for (uint32 slice = 0; slice<m_sourceArraySlices; ++slice)
 	{
+		lockedStaging.clear();
+		pendingUploads.clear();
+
 		for (uint32 mip = 0; mip<m_sourceMips; ++mip)
 		{
 			// target mip
@@ -973,12 +955,23 @@ void CDX11AbstractTexture::Update()
 			if (!destPtr)
 				continue;
 
-			// upload surface
-			surfacePtr->Upload(srcData, destPtr, destRowPitch, destSlicePitch);
+			// upload surface, small mips are not worth the thread
+			const uint32 uploadSize = destSlicePitch * surfacePtr->GetDepth();
+			if (uploadSize >= MIN_PARALLEL_UPLOAD_SIZE)
+				pendingUploads.push_back(std::async(std::launch::async, [=]() { surfacePtr->Upload(srcData, destPtr, destRowPitch, destSlicePitch); }));
+			else
+				surfacePtr->Upload(srcData, destPtr, destRowPitch, destSlicePitch);
 
-			// upload staging buffer
-			stagingPtr->Flush(m_runtimeTexture, runtimeSliceIndex);
+			lockedStaging.push_back(std::make_pair(stagingPtr, runtimeSliceIndex));
 		}
+
+		// wait for the conversion
+		for (auto& upload : pendingUploads)
+			upload.wait();
+
+		// upload staging buffers, the device context is not thread safe
+		for (const auto& it : lockedStaging)
+			it.first->Flush(m_runtimeTexture, it.second);
 	}
 
 	// mark as updated at least once
@@ -124,6 +124,7 @@ protected:
 	ID3D11ShaderResourceView*	m_view; // for shaders only
 
 	bool						m_initialDirty;
+	uint32						m_uploadEpoch; // memory write epoch of the uploaded data
 
 	std::vector< CDX11AbstractSurface* >	m_surfaces; // per slices, per mip
 	std::vector< CDX11StagingTexture* >		m_stagingBuffers; // per mip
@@ -138,7 +139,10 @@ protected:
 	bool CreateStagingBuffers(CDX11StagingTextureCache* stagingDataCache);
 
 	// should texture be updated ?
-	bool ShouldBeUpdated() const;
+	bool ShouldBeUpdated();
+
+	// get the write epoch of the source memory
+	uint32 GetSourceWriteEpoch() const;
 
 	// update texture (forced)
 	void Update();
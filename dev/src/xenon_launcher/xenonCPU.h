@@ -2121,7 +2121,7 @@ namespace cpu
 
 		// Build 111110000 bit pattern (M = number of zeros, 0-32)
 		template <>
-		static CPU_INLINE uint32 HalfMask32LE<32>()
+		CPU_INLINE uint32 HalfMask32LE<32>()
 		{
 			return 0;
 		}
@@ -2136,7 +2136,7 @@ namespace cpu
 
 		// Build 111110000 bit pattern (M = number of zeros, 0-64)
 		template <>
-		static CPU_INLINE uint64 HalfMask64LE<64>()
+		CPU_INLINE uint64 HalfMask64LE<64>()
 		{
 			return 0;
 		}
@@ -2151,7 +2151,7 @@ namespace cpu
 
 		// Build 111110000 bit pattern (M = number of zeros, 0-64)
 		template <>
-		static CPU_INLINE uint64 HalfMask64BE<64>()
+		CPU_INLINE uint64 HalfMask64BE<64>()
 		{
 			return 0;
 		}
@@ -2362,13 +2362,13 @@ namespace cpu
 		template<uint8 N>
 		static CPU_INLINE int32 SafeShiftR32(const int32 a) { return a >> N; }
 		template<>
-		static CPU_INLINE int32 SafeShiftR32<32>(const int32 a) { return (a < 0) ? -1 : 0; }
+		CPU_INLINE int32 SafeShiftR32<32>(const int32 a) { return (a < 0) ? -1 : 0; }
 
 		// safe right shift for 64 bit values
 		template<uint8 N>
 		static CPU_INLINE int64 SafeShiftR64(const int64 a) { return a >> N; }
 		template<>
-		static CPU_INLINE int64 SafeShiftR64<64>(const int64 a) { return (a < 0) ? -1 : 0; }
+		CPU_INLINE int64 SafeShiftR64<64>(const int64 a) { return (a < 0) ? -1 : 0; }
 
 		// sradi - Shift Right Algebraic Doubleword Immediate XS-form
 		template <uint8 CTRL, uint8 N>
@@ -3997,6 +3997,87 @@ namespace cpu
 			return (int8)val;
 		}
 
+		static CPU_INLINE uint16 vsat16u(CpuRegs& regs, uint32 val)
+		{
+			if (val > 65535)
+			{
+				regs.SAT = 1;
+				val = 65535;
+			}
+			return (uint16)val;
+		}
+
+		static CPU_INLINE int16 vsat16i(CpuRegs& regs, int32 val)
+		{
+			if (val > SHORT_MAX)
+			{
+				regs.SAT = 1;
+				val = SHORT_MAX;
+			}
+			else if (val < SHORT_MIN)
+			{
+				regs.SAT = 1;
+				val = SHORT_MIN;
+			}
+			return (int16)val;
+		}
+
+		static CPU_INLINE uint32 vsat32(CpuRegs& regs, uint64 val)
+		{
+			if (val > UINT_MAX)
+			{
+				regs.SAT = 1;
+				val = UINT_MAX;
+			}
+			return (uint32)val;
+		}
+
+		static CPU_INLINE int32_t vsat32i(CpuRegs& regs, int64_t val)
+		{
+			if (val > INT_MAX)
+			{
+				regs.SAT = 1;
+				val = INT_MAX;
+			}
+			else if (val < INT_MIN)
+			{
+				regs.SAT = 1;
+				val = INT_MIN;
+			}
+			return (int32_t)val;
+		}
+
+		static CPU_INLINE int32_t SaturateInt32(CpuRegs& regs, int64_t x)
+		{
+			if (x < INT_MIN)
+			{
+				regs.SAT = 1;
+				return INT_MIN;
+			}
+
+			if (x > INT_MAX)
+			{
+				regs.SAT = 1;
+				return INT_MAX;
+			}
+			return (int32_t)x;
+		}
+
+		static CPU_INLINE uint32_t SaturateUint32(CpuRegs& regs, int64_t x)
+		{
+			if (x < 0)
+			{
+				regs.SAT = 1;
+				return 0;
+			}
+			if (x > UINT_MAX)
+			{
+				regs.SAT = 1;
+				return UINT_MAX;
+			}
+			return (uint32_t)x;
+		}
+
 		template <uint8 CTRL>
 		static CPU_INLINE void vaddubs(CpuRegs& regs, TVReg* out, const TVReg a, const TVReg b)
 		{
@@ -4081,10 +4162,10 @@ namespace cpu
 		static CPU_INLINE void vsubsws(CpuRegs& regs, TVReg* out, const TVReg a, const TVReg b)
 		{
 			ASM_CHECK(CTRL == 0);
-			out->AsInt32<0>() = vsat32i(regs, (int32)a.AsInt32<0>() - (int32)b.AsInt32<0>());
-			out->AsInt32<1>() = vsat32i(regs, (int32)a.AsInt32<1>() - (int32)b.AsInt32<1>());
-			out->AsInt32<2>() = vsat32i(regs, (int32)a.AsInt32<2>() - (int32)b.AsInt32<2>());
-			out->AsInt32<3>() = vsat32i(regs, (int32)a.AsInt32<3>() - (int32)b.AsInt32<3>());
+			out->AsInt32<0>() = vsat32i(regs, (int64_t)a.AsInt32<0>() - (int64_t)b.AsInt32<0>());
+			out->AsInt32<1>() = vsat32i(regs, (int64_t)a.AsInt32<1>() - (int64_t)b.AsInt32<1>());
+			out->AsInt32<2>() = vsat32i(regs, (int64_t)a.AsInt32<2>() - (int64_t)b.AsInt32<2>());
+			out->AsInt32<3>() = vsat32i(regs, (int64_t)a.AsInt32<3>() - (int64_t)b.AsInt32<3>());
 		}
 		
 		//Vector Subtract Unsigned Byte Saturate
@@ -4128,31 +4209,6 @@ namespace cpu
 			out->AsInt16<7>() = a.AsInt16<7>() - b.AsInt16<7>();
 		}
 
-		static CPU_INLINE uint16 vsat16u(CpuRegs& regs, uint32 val)
-		{
-			if (val > 65535)
-			{
-				regs.SAT = 1;
-				val = 65535;
-			}
-			return (uint16)val;
-		}
-
-		static CPU_INLINE int16 vsat16i(CpuRegs& regs, int32 val)
-		{
-			if (val > SHORT_MAX)
-			{
-				regs.SAT = 1;
-				val = SHORT_MAX;
-			}
-			else if (val < SHORT_MIN)
-			{
-				regs.SAT = 1;
-				val = SHORT_MIN;
-			}
-			return (int16)val;
-		}
-
 		template <uint8 CTRL>
 		static CPU_INLINE void vadduhs(CpuRegs& regs, TVReg* out, const TVReg a, const TVReg b)
 		{
@@ -4233,31 +4289,6 @@ namespace cpu
 			out->AsInt16<7>() = vsat16i(regs, (int32)a.AsInt16<7>() + (int32)b.AsInt16<7>());
 		}
 
-		static CPU_INLINE uint32 vsat32(CpuRegs& regs, uint64 val)
-		{
-			if (val > UINT_MAX)
-			{
-				regs.SAT = 1;
-				val = UINT_MAX;
-			}
-			return (uint32)val;
-		}
-
-		static CPU_INLINE int32_t vsat32i(CpuRegs& regs, int32_t val)
-		{
-			if (val > INT_MAX)
-			{
-				regs.SAT = 1;
-				val = INT_MAX;
-			}
-			else if (val < INT_MIN)
-			{
-				regs.SAT = 1;
-				val = INT_MIN;
-			}
-			return (int32_t)val;
-		}
-
 		template <uint8 CTRL>
 		static CPU_INLINE void vadduws(CpuRegs& regs, TVReg* out, const TVReg a, const TVReg b)
 		{
@@ -4384,7 +4415,7 @@ namespace cpu
 		{
 			static const uint32 bit_le = 0x80000000; // le
 			static const uint32 bit_ge = 0x40000000; // ge
-			if (std::isnan<float>(a) || std::isnan<float>(b)) return bit_le | bit_ge;
+			if (std::isnan(a) || std::isnan(b)) return bit_le | bit_ge;
 			return vcmpf_le(a, b, 0, bit_le) | vcmpf_ge(a, -b, 0, bit_ge);
 		}
 
@@ -4579,7 +4610,7 @@ namespace cpu
 
 		static CPU_INLINE float vneg(float f)
 		{
-			if (std::isnan<float>(f)) return vnan(f);
+			if (std::isnan(f)) return vnan(f);
 			(uint32&)f ^= 0x80000000;
 			return f;
 		}
@@ -4872,37 +4903,6 @@ namespace cpu
 			return x;
 		}
 
-		static CPU_INLINE int32_t SaturateInt32(CpuRegs& regs, int64_t x)
-		{
-			if (x < INT_MIN)
-			{
-				regs.SAT = 1;
-				return INT_MIN;
-			}
-
-			if (x > INT_MAX)
-			{
-				regs.SAT = 1;
-				return INT_MAX;
-			}
-			return (int32_t)x;
-		}
-
-		static CPU_INLINE uint32_t SaturateUint32(CpuRegs& regs, int64_t x)
-		{
-			if (x < 0)
-			{
-				regs.SAT = 1;
-				return 0;
-			}
-			if (x > UINT_MAX)
-			{
-				regs.SAT = 1;
-				return UINT_MAX;
-			}
-			return (uint32_t)x;
-		}
-
 		// endian conversion
 		//    BE: AH AL BH BL
 		//    LE: BL BH AL AH
@@ -2,19 +2,57 @@
 #include "xenonGPU.h"
 #include "xenonGPUThread.h"
 #include "xenonGPUExecutor.h"
+#include "xenonGPUDumpReplay.h"
+#include "xenonGPUNullAbstractLayer.h"
+#include "xenonGPUShaderStore.h"
+#include "../host_core/launcherCommandline.h"
 
 #include "dx11AbstractLayer.h"
 
 CXenonGPU::CXenonGPU(const launcher::Commandline& cmdLine)
 	: m_abstractLayer( nullptr )
+	, m_nullLayer( nullptr )
 	, m_executor( nullptr)
 	, m_thread(nullptr)
+	, m_shaderStore(nullptr)
+	, m_stateBenchmark(false)
 {
-	// create rendering abstraction layer
-	m_abstractLayer = new CDX11AbstractLayer();
+	// open the persistent shader storage
+	if ( cmdLine.HasOption("shadercache") )
+	{
+		const std::wstring shaderCachePath = cmdLine.GetOptionValueW("shadercache");
+
+		m_shaderStore = new CXenonGPUShaderStore();
+		if ( !m_shaderStore->Open( shaderCachePath ) )
+		{
+			GLog.Warn( "GPU: Failed to open shader cache '%ls', shaders will not be cached", shaderCachePath.c_str() );
+			delete m_shaderStore;
+			m_shaderStore = nullptr;
+		}
+	}
+
+	// measure the draws per second of the replayed dump with each kind of the state cache
+	if ( cmdLine.HasOption("statebenchmark") )
+	{
+		m_stateBenchmark = cmdLine.HasOption("gpureplay");
+		if ( !m_stateBenchmark )
+			GLog.Warn( "GPU: State benchmark requires a GPU dump to replay (-gpureplay)" );
+	}
+
+	// create rendering abstraction layer, the replay is always headless
+	if ( cmdLine.HasOption("nullgpu") || cmdLine.HasOption("gpureplay") )
+	{
+		m_nullLayer = new CXenonGPUNullAbstractLayer( m_shaderStore );
+		m_abstractLayer = m_nullLayer;
+	}
+	else
+	{
+		m_abstractLayer = new CDX11AbstractLayer( m_shaderStore );
+	}
 
 	// create execution wrapper
-	m_executor = new CXenonGPUExecutor(m_abstractLayer, cmdLine);
+	const std::wstring gpuLogFile = cmdLine.HasOption("gpulog") ? cmdLine.GetOptionValueW("gpulog") : std::wstring();
+	m_executor = new CXenonGPUExecutor(m_abstractLayer, gpuLogFile);
 }
 
 void CXenonGPU::RequestTraceDump()
@@ -60,7 +98,48 @@ void CXenonGPU::Close()
 	{
 		delete m_abstractLayer;
 		m_abstractLayer = nullptr;
-	}	
+		m_nullLayer = nullptr;
+	}
+
+	// close shader storage, after all the users are gone
+	if ( m_shaderStore )
+	{
+		delete m_shaderStore;
+		m_shaderStore = nullptr;
+	}
+}
+
+bool CXenonGPU::ReplayDump( const std::wstring& path, const uint32 numFrames )
+{
+	if ( !m_nullLayer )
+	{
+		GLog.Err( "GPU: Dump replay requires the null rendering layer" );
+		return false;
+	}
+
+	if ( m_thread )
+	{
+		GLog.Err( "GPU: Dump replay is not possible when the GPU is already running" );
+		return false;
+	}
+
+	CXenonGPUDumpReplay replay;
+	if ( !replay.Load( path ) )
+	{
+		GLog.Err( "GPU: Failed to load GPU dump from '%ls'", path.c_str() );
+		return false;
+	}
+
+	m_nullLayer->Initialize();
+
+	if ( m_stateBenchmark )
+	{
+		GLog.Log( "GPU: Benchmarking state cache with '%ls' %u times", path.c_str(), numFrames );
+		return replay.RunStateBenchmark( *m_executor, *m_nullLayer, numFrames );
+	}
+
+	GLog.Log( "GPU: Replaying '%ls' %u times", path.c_str(), numFrames );
+	return replay.Run( *m_executor, m_nullLayer, numFrames );
 }
 
 void CXenonGPU::WriteWord( const uint64 val, const uint32 addr)
@@ -3,6 +3,8 @@
 class IXenonGPUAbstractLayer;
 class CXenonGPUThread;
 class CXenonGPUExecutor;
+class CXenonGPUNullAbstractLayer;
+class CXenonGPUShaderStore;
 
 #include "xenonGPUCommandBuffer.h"
 
@@ -38,6 +40,10 @@ public:
 	// set internal interrupt callback
 	void SetInterruptCallbackAddr( const uint32 addr, const uint32 userData );
 
+	// replay GPU dump given number of times, requires the null layer, must be called before the ring buffer is initialized
+	// with -statebenchmark the dump is replayed with each kind of the state cache to measure the draws per second
+	bool ReplayDump( const std::wstring& path, const uint32 numFrames );
+
 private:
 	// low level command buffer
 	CXenonGPUCommandBuffer		m_commandBuffer;
@@ -50,4 +56,13 @@ private:
 
 	// abstract layer
 	IXenonGPUAbstractLayer*		m_abstractLayer;
+
+	// headless layer, same as the abstract layer if used
+	CXenonGPUNullAbstractLayer*	m_nullLayer;
+
+	// persistent shader storage, optional
+	CXenonGPUShaderStore*		m_shaderStore;
+
+	// replay measures the state cache (-statebenchmark)
+	bool						m_stateBenchmark;
 };
\ No newline at end of file
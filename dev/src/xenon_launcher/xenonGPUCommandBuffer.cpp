@@ -1,8 +1,8 @@
 #include "build.h"
-#include "xenonLibNatives.h"
+#include "xenonGPUUtils.h"
 #include "xenonGPUCommandBuffer.h"
-#include "xenonCPU.h"
-#include "xenonMemory.h"
+
+#include <tmmintrin.h>
 
 //-------------------------------------
 
@@ -18,6 +18,8 @@ CXenonGPUCommandBufferReader::CXenonGPUCommandBufferReader()
 	, m_readIndex(0)
 	, m_readCount(0)
 	, m_readMaxCount(0)
+	, m_linearData(nullptr)
+	, m_linearStart(0)
 {
 }
 
@@ -28,6 +30,8 @@ CXenonGPUCommandBufferReader::CXenonGPUCommandBufferReader(const uint32* bufferB
 	, m_readEndIndex(readEndIndex)
 	, m_readIndex(readStartIndex)
 	, m_readCount(0)
+	, m_linearData(nullptr)
+	, m_linearStart(0)
 {
 	auto end = m_readEndIndex;
 	if (end < m_readStartIndex)
@@ -39,10 +43,56 @@ CXenonGPUCommandBufferReader::CXenonGPUCommandBufferReader(const uint32* bufferB
 	DEBUG_CHECK(bufferSize > 0);
 }
 
+static void CopyAndSwapWords(uint32* writePtr, const uint32* readPtr, const uint32 numWords)
+{
+	// 4 words at a time
+	const __m128i swapMask = _mm_set_epi8(12, 13, 14, 15, 8, 9, 10, 11, 4, 5, 6, 7, 0, 1, 2, 3);
+	uint32 index = 0;
+	for (; index + 4 <= numWords; index += 4)
+	{
+		const __m128i data = _mm_loadu_si128((const __m128i*)(readPtr + index));
+		_mm_storeu_si128((__m128i*)(writePtr + index), _mm_shuffle_epi8(data, swapMask));
+	}
+
+	// tail
+	for (; index < numWords; ++index)
+		writePtr[index] = _byteswap_ulong(readPtr[index]);
+}
+
+void CXenonGPUCommandBufferReader::Linearize(std::vector<uint32>& storage)
+{
+	const uint32 numWords = m_readMaxCount - m_readCount;
+	storage.resize(numWords);
+	if (!numWords)
+		return;
+
+	// single fence for the whole batch
+	std::atomic_thread_fence(std::memory_order_acq_rel);
+
+	// first segment, up to the end of the ring buffer
+	const uint32 firstPart = std::min<uint32>(numWords, m_bufferSize - m_readIndex);
+	CopyAndSwapWords(storage.data(), m_bufferBase + m_readIndex, firstPart);
+
+	// wrapped segment
+	if (firstPart < numWords)
+		CopyAndSwapWords(storage.data() + firstPart, m_bufferBase, numWords - firstPart);
+
+	m_linearData = storage.data();
+	m_linearStart = m_readCount;
+}
+
 const uint32 CXenonGPUCommandBufferReader::Read()
 {
 	DEBUG_CHECK(m_readIndex != m_readEndIndex);
 
+	// fast path
+	if (m_linearData)
+	{
+		const auto ret = m_linearData[m_readCount - m_linearStart];
+		Advance(1);
+		return ret;
+	}
+
 	std::atomic_thread_fence(std::memory_order_acq_rel);
 	auto ret = cpu::mem::load< uint32 >(m_bufferBase + m_readIndex);
 	Advance(1);
@@ -54,6 +104,13 @@ void CXenonGPUCommandBufferReader::GetBatch(const uint32 numWords, uint32* write
 {
 	DEBUG_CHECK(m_readCount + numWords <= m_readMaxCount);
 
+	// the linear data is already swapped, swap it back
+	if (m_linearData)
+	{
+		CopyAndSwapWords(writePtr, m_linearData + (m_readCount - m_linearStart), numWords);
+		return;
+	}
+
 	std::atomic_thread_fence(std::memory_order_acq_rel);
 
 	auto pos = m_readIndex;
@@ -87,11 +144,15 @@ void CXenonGPUCommandBufferReader::Advance(const uint32 numWords)
 CXenonGPUCommandBuffer::CXenonGPUCommandBuffer()
 	: m_commandBufferPtr(nullptr)
 	, m_writeBackPtr(0)
+	, m_spinCount(MIN_SPIN_COUNT)
 {
+	m_hDataEvent = ::CreateEventA(NULL, FALSE, FALSE, NULL);
 }
 
 CXenonGPUCommandBuffer::~CXenonGPUCommandBuffer()
 {
+	CloseHandle(m_hDataEvent);
+	m_hDataEvent = NULL;
 }
 
 void CXenonGPUCommandBuffer::Initialize(const void* ptr, const uint32 numPages)
@@ -113,6 +174,10 @@ void CXenonGPUCommandBuffer::AdvanceWriteIndex(const uint32 newIndex)
 	std::atomic_thread_fence(std::memory_order_acq_rel);
 	uint32 oldIndex = m_writeIndex.exchange(newIndex);
 
+	// wake up the GPU thread
+	if (oldIndex != newIndex)
+		SetEvent(m_hDataEvent);
+
 #ifdef DUMP_COMMAND_BUFFER
 	GLog.Log( "GPU: Command buffer writeIndex=%d (delta: %d)", newIndex, newIndex - oldIndex );
 	for ( uint32 i=oldIndex; i<newIndex; ++i )
@@ -123,6 +188,45 @@ void CXenonGPUCommandBuffer::AdvanceWriteIndex(const uint32 newIndex)
 #endif
 }
 
+bool CXenonGPUCommandBuffer::WaitForData(const uint32 timeoutMs)
+{
+	// spin, the CPU usually submits the commands in bursts
+	for (uint32 i = 0; i < m_spinCount; ++i)
+	{
+		if (HasData())
+		{
+			// data came while we were spinning, spin longer next time
+			m_spinCount = std::min<uint32>(m_spinCount * 2, MAX_SPIN_COUNT);
+			return true;
+		}
+
+		YieldProcessor();
+	}
+
+	// give up the time slice few times
+	for (uint32 i = 0; i < YIELD_COUNT; ++i)
+	{
+		if (HasData())
+			return true;
+
+		SwitchToThread();
+	}
+
+	// spinning was a waste of time, spin less next time
+	m_spinCount = std::max<uint32>(m_spinCount / 2, MIN_SPIN_COUNT);
+
+	// sleep until the write index changes
+	if (!HasData())
+		WaitForSingleObject(m_hDataEvent, timeoutMs);
+
+	return HasData();
+}
+
+void CXenonGPUCommandBuffer::Wake()
+{
+	SetEvent(m_hDataEvent);
+}
+
 void CXenonGPUCommandBuffer::SetWriteBackPointer(const uint32 addr)
 {
 	m_writeBackPtr = addr;
@@ -153,7 +257,8 @@ bool CXenonGPUCommandBuffer::BeginRead(CXenonGPUCommandBufferReader& outReader)
 	}
 #endif
 	// copy data out
-	memcpy(&outReader, &CXenonGPUCommandBufferReader(m_commandBufferPtr, m_numWords, readStartIndex, readEndIndex), sizeof(CXenonGPUCommandBufferReader));
+	const CXenonGPUCommandBufferReader reader(m_commandBufferPtr, m_numWords, readStartIndex, readEndIndex);
+	memcpy(&outReader, &reader, sizeof(CXenonGPUCommandBufferReader));
 	m_readIndex = curWriteIndex;
 
 	// advance
@@ -21,6 +21,17 @@ public:
 	/// Read single value from command buffer (Peek + Advance(1))
 	const uint32 Read();
 
+	/// Copy the whole readable span (including the wrapped part) into given storage as contiguous, already byteswapped words
+	/// All following reads are served from the storage, the storage must outlive the reader
+	void Linearize(std::vector<uint32>& storage);
+
+	/// Get pointer to given number of byteswapped words at current read position, valid only for linearized reader
+	inline const uint32* GetLinearData(const uint32 numWords) const
+	{
+		DEBUG_CHECK(m_readCount + numWords <= m_readMaxCount);
+		return m_linearData ? (m_linearData + (m_readCount - m_linearStart)) : nullptr;
+	}
+
 private:
 	const uint32* m_bufferBase; // const, absolute
 	const uint32 m_bufferSize; // const, in words
@@ -31,6 +42,9 @@ private:
 	uint32 m_readIndex;
 	uint32 m_readCount;
 	uint32 m_readMaxCount;
+
+	const uint32* m_linearData; // byteswapped data, null if not linearized
+	uint32 m_linearStart; // read count at the moment of linearization
 };
 
 /// Command buffer management for the GPU
@@ -56,7 +70,20 @@ public:
 	/// Signal completed read
 	void EndRead();
 
+	/// Do we have data to read ?
+	inline const bool HasData() const { return m_readIndex != m_writeIndex.load(); }
+
+	/// Wait for new data, spins for a while before going to sleep, returns true if there's data to read
+	bool WaitForData(const uint32 timeoutMs);
+
+	/// Wake up the waiting reader (used during shutdown)
+	void Wake();
+
 private:
+	static const uint32 MIN_SPIN_COUNT = 64;
+	static const uint32 MAX_SPIN_COUNT = 16384;
+	static const uint32 YIELD_COUNT = 4;
+
 	// command buffer initialization data
 	const uint32* m_commandBufferPtr;
 
@@ -71,4 +98,10 @@ private:
 
 	// event used to synchronize reading from command buffer
 	uint32 m_writeBackPtr;
+
+	// signaled when write index is advanced
+	HANDLE m_hDataEvent;
+
+	// current spin budget before going to sleep, adapted to how fast the data usually comes
+	uint32 m_spinCount;
 };
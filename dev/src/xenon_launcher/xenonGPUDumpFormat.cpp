@@ -1,7 +1,7 @@
 #include "build.h"
 #include "xenonGPUDumpFormat.h"
 
-const uint32 CXenonGPUDumpFormat::FILE_MAGIC = 'GPUD';
+const uint32 CXenonGPUDumpFormat::FILE_MAGIC = ('G' << 24) | ('P' << 16) | ('U' << 8) | 'D'; // 'GPUD'
 const uint32 CXenonGPUDumpFormat::FILE_VERSION = 1;
 
 CXenonGPUDumpFormat::CXenonGPUDumpFormat()
@@ -189,10 +189,8 @@ bool CXenonGPUDumpFormat::Save( const std::wstring& path, const std::wstring& me
 					fwrite( buf, size, 1, f );
 				}
 
-				fpos_t size = 0;
-				fgetpos( fc, &size );
-
-				GLog.Log( "GPU Trace: Saved %ull memory bytes", size );
+				const uint64 size = _ftelli64( fc );
+				GLog.Log( "GPU Trace: Saved %llu memory bytes", size );
 				fclose( fc );
 			}
 		}
@@ -63,7 +63,7 @@ public:
 
 		uint64		m_memoryDumpOffset;		// offset to memory dump block
 	};
-#pragma pack( pop, 4 )
+#pragma pack( pop )
 
 	std::vector< Block >		m_blocks;		// blocks (top level hierarchy of the frame)
 	std::vector< Packet >		m_packets;		// packets to execute (NON recursive)
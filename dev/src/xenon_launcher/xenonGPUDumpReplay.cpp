@@ -0,0 +1,265 @@
+#include "build.h"
+#include "xenonGPUDumpReplay.h"
+#include "xenonGPUCommandBuffer.h"
+#include "xenonGPUExecutor.h"
+#include "xenonGPUNullAbstractLayer.h"
+
+#include <algorithm>
+
+//----------------------
+
+CXenonGPUDumpReplay::CXenonGPUDumpReplay()
+{
+}
+
+bool CXenonGPUDumpReplay::Load( const std::wstring& path )
+{
+	// load tables
+	uint64 memoryDumpOffset = 0;
+	if ( !m_dump.Load( path, memoryDumpOffset ) )
+		return false;
+
+	// load the memory blob, it's at the end of the file
+	{
+		FILE* f = NULL;
+		_wfopen_s( &f, path.c_str(), L"rb" );
+		if ( !f )
+		{
+			GLog.Err( "Failed to open file '%ls'", path.c_str() );
+			return false;
+		}
+
+		_fseeki64( f, 0, SEEK_END );
+		const uint64 fileSize = _ftelli64( f );
+		if ( fileSize < memoryDumpOffset )
+		{
+			GLog.Err( "Memory dump in '%ls' is truncated", path.c_str() );
+			fclose( f );
+			return false;
+		}
+
+		m_memory.resize( (size_t)( fileSize - memoryDumpOffset ) );
+		_fseeki64( f, memoryDumpOffset, SEEK_SET );
+		if ( !m_memory.empty() )
+			fread( &m_memory[0], 1, m_memory.size(), f );
+		fclose( f );
+
+		GLog.Log( "Loaded %llu bytes of memory dump", (uint64) m_memory.size() );
+	}
+
+	// validate memory blocks
+	for ( const auto& block : m_dump.m_memoryBlocks )
+	{
+		if ( block.m_fileOffset + block.m_size > m_memory.size() )
+		{
+			GLog.Err( "Memory block at 0x%08X (size %u) is outside the memory dump", block.m_address, block.m_size );
+			return false;
+		}
+	}
+
+	// build the command stream, the dumped words are already swapped so swap them back to the command buffer format
+	m_commands.clear();
+	m_commandOffsets.clear();
+	m_commandOffsets.reserve( m_dump.m_packets.size() );
+	for ( const auto& packet : m_dump.m_packets )
+	{
+		if ( packet.m_firstDataWord + packet.m_numDataWords > m_dump.m_dataRegs.size() )
+		{
+			GLog.Err( "Packet 0x%08X references data outside the dump", packet.m_packetData );
+			return false;
+		}
+
+		m_commandOffsets.push_back( (uint32) m_commands.size() );
+		m_commands.push_back( _byteswap_ulong( packet.m_packetData ) );
+
+		for ( uint32 i=0; i<packet.m_numDataWords; ++i )
+			m_commands.push_back( _byteswap_ulong( m_dump.m_dataRegs[ packet.m_firstDataWord + i ] ) );
+	}
+
+	GLog.Log( "Prepared %u command words for replay", (uint32) m_commands.size() );
+	return true;
+}
+
+uint64 CXenonGPUDumpReplay::ExecuteFrame( CXenonGPUExecutor& executor, uint64& restoreTicks )
+{
+	uint64 frameTicks = 0;
+
+	for ( uint32 i=0; i<m_dump.m_packets.size(); ++i )
+	{
+		const auto& packet = m_dump.m_packets[i];
+
+		// restore memory, not measured as part of the frame
+		LARGE_INTEGER restoreStart, execStart, execEnd;
+		QueryPerformanceCounter( &restoreStart );
+		RestoreMemory( packet );
+
+		// execute the packet
+		QueryPerformanceCounter( &execStart );
+		const uint32 numWords = 1 + packet.m_numDataWords;
+		CXenonGPUCommandBufferReader reader( &m_commands[ m_commandOffsets[i] ], numWords, 0, numWords );
+		executor.Execute( reader );
+		QueryPerformanceCounter( &execEnd );
+
+		restoreTicks += execStart.QuadPart - restoreStart.QuadPart;
+		frameTicks += execEnd.QuadPart - execStart.QuadPart;
+	}
+
+	return frameTicks;
+}
+
+void CXenonGPUDumpReplay::RestoreMemory( const CXenonGPUDumpFormat::Packet& packet )
+{
+	for ( uint32 i=0; i<packet.m_numMemoryRefs; ++i )
+	{
+		const auto& ref = m_dump.m_memoryRefs[ packet.m_firstMemoryRef + i ];
+
+		// only the memory that was read is restored, writes are the results of the GPU work
+		if ( ref.m_mode != 0 )
+			continue;
+
+		const auto& block = m_dump.m_memoryBlocks[ ref.m_blockIndex ];
+		memcpy( (void*)(size_t) block.m_address, &m_memory[ (size_t) block.m_fileOffset ], block.m_size );
+	}
+}
+
+bool CXenonGPUDumpReplay::Run( CXenonGPUExecutor& executor, CXenonGPUNullAbstractLayer* nullLayer, const uint32 numFrames )
+{
+	if ( m_dump.m_packets.empty() )
+	{
+		GLog.Err( "GPU Replay: Nothing to replay" );
+		return false;
+	}
+
+	LARGE_INTEGER freq;
+	QueryPerformanceFrequency( &freq );
+	const double tickToMs = 1000.0 / (double) freq.QuadPart;
+
+	if ( nullLayer )
+		nullLayer->ResetStats();
+
+	// replay
+	std::vector< double > frameTimes;
+	frameTimes.reserve( numFrames );
+	uint64 restoreTicks = 0;
+	for ( uint32 frame=0; frame<numFrames; ++frame )
+	{
+		const uint64 frameTicks = ExecuteFrame( executor, restoreTicks );
+		frameTimes.push_back( frameTicks * tickToMs );
+	}
+
+	// frame stats
+	double totalTime = 0.0;
+	for ( const auto time : frameTimes )
+		totalTime += time;
+
+	std::sort( frameTimes.begin(), frameTimes.end() );
+	const double avgTime = totalTime / (double) frameTimes.size();
+	const double packetsPerSecond = ( totalTime > 0.0 ) ? ( (double) m_dump.m_packets.size() * numFrames ) / ( totalTime / 1000.0 ) : 0.0;
+
+	GLog.Log( "GPU Replay: %u frames, %u packets per frame", numFrames, (uint32) m_dump.m_packets.size() );
+	GLog.Log( "GPU Replay: Frame time avg %1.3f ms, min %1.3f ms, median %1.3f ms, max %1.3f ms",
+		avgTime, frameTimes.front(), frameTimes[ frameTimes.size() / 2 ], frameTimes.back() );
+	GLog.Log( "GPU Replay: Command processing %1.0f packets/s", packetsPerSecond );
+	GLog.Log( "GPU Replay: Memory restore %1.3f ms per frame (not included)", ( restoreTicks * tickToMs ) / numFrames );
+	GLog.Log( "GPU Replay: Wait time %1.3f ms total", executor.GetWaitTime() * 1000.0 );
+
+	// abstract layer stats
+	if ( nullLayer )
+	{
+		const auto& stats = nullLayer->GetStats();
+
+		const double shaderTime = stats.m_shaderDecodeTicks * tickToMs;
+		const double textureTime = stats.m_textureHashTicks * tickToMs;
+		const double textureMB = stats.m_textureBytesHashed / (1024.0 * 1024.0);
+
+		GLog.Log( "GPU Replay: %1.1f draws, %1.1f resolves, %1.1f clears, %1.1f state changes per frame",
+			(double) stats.m_numDraws / numFrames, (double) stats.m_numResolves / numFrames, (double) stats.m_numClears / numFrames, (double) stats.m_numStateChanges / numFrames );
+		GLog.Log( "GPU Replay: Shaders: %llu binds, %llu unique, decode %1.3f ms per frame",
+			stats.m_numShaderBinds, stats.m_numShadersDecoded, shaderTime / numFrames );
+		GLog.Log( "GPU Replay: Textures: %llu binds, %llu unique, %1.2f MB hashed (not decoded), %1.3f ms per frame (%1.1f MB/s hashed)",
+			stats.m_numTextureBinds, stats.m_numTexturesHashed, textureMB, textureTime / numFrames, ( textureTime > 0.0 ) ? textureMB / ( textureTime / 1000.0 ) : 0.0 );
+	}
+
+	return true;
+}
+
+bool CXenonGPUDumpReplay::RunStateBenchmark( CXenonGPUExecutor& executor, CXenonGPUNullAbstractLayer& nullLayer, const uint32 numFrames )
+{
+	if ( m_dump.m_packets.empty() )
+	{
+		GLog.Err( "GPU Replay: Nothing to replay" );
+		return false;
+	}
+
+	LARGE_INTEGER freq;
+	QueryPerformanceFrequency( &freq );
+	const double tickToMs = 1000.0 / (double) freq.QuadPart;
+
+	// first frame decodes the shaders and reads the textures, it's the same for all the modes
+	uint64 restoreTicks = 0;
+	nullLayer.SetStateCacheMode( CXenonGPUNullAbstractLayer::StateCacheMode::None );
+	ExecuteFrame( executor, restoreTicks );
+
+	// replay the draws through IssueDraw with each kind of the state cache, the cache is persistent between the frames like the DX11 one
+	struct ModeInfo
+	{
+		CXenonGPUNullAbstractLayer::StateCacheMode	m_mode;
+		const char*									m_name;
+		double										m_time;
+		uint32										m_numStates;
+	};
+
+	ModeInfo modes[] = {
+		{ CXenonGPUNullAbstractLayer::StateCacheMode::None, "no state cache", 0.0, 0 },
+		{ CXenonGPUNullAbstractLayer::StateCacheMode::OrderedMap, "ordered map", 0.0, 0 },
+		{ CXenonGPUNullAbstractLayer::StateCacheMode::FlatMap, "flat map", 0.0, 0 },
+	};
+
+	uint64 numDraws = 0;
+	uint64 numStateLookups = 0;
+	for ( auto& mode : modes )
+	{
+		nullLayer.SetStateCacheMode( mode.m_mode );
+		nullLayer.ResetStats();
+
+		uint64 ticks = 0;
+		for ( uint32 frame=0; frame<numFrames; ++frame )
+			ticks += ExecuteFrame( executor, restoreTicks );
+
+		mode.m_time = ticks * tickToMs;
+		mode.m_numStates = nullLayer.GetNumCachedStates();
+
+		numDraws = nullLayer.GetStats().m_numDraws;
+		numStateLookups = nullLayer.GetStats().m_numStateLookups;
+	}
+
+	nullLayer.SetStateCacheMode( CXenonGPUNullAbstractLayer::StateCacheMode::None );
+
+	if ( !numDraws )
+	{
+		GLog.Err( "GPU Replay: No draws in the dump, nothing to benchmark" );
+		return false;
+	}
+
+	// both maps should find the same states
+	if ( modes[1].m_numStates != modes[2].m_numStates )
+	{
+		GLog.Err( "GPU Replay: State cache mismatch, %u states in the ordered map, %u states in the flat map", modes[1].m_numStates, modes[2].m_numStates );
+		return false;
+	}
+
+	GLog.Log( "GPU Replay: State benchmark, %u frames, %1.1f draws and %1.1f state lookups per frame, %u unique states",
+		numFrames, (double) numDraws / numFrames, (double) numStateLookups / numFrames, modes[2].m_numStates );
+
+	const double baseTime = modes[0].m_time;
+	for ( const auto& mode : modes )
+	{
+		const double drawsPerSecond = ( mode.m_time > 0.0 ) ? (double) numDraws / ( mode.m_time / 1000.0 ) : 0.0;
+		const double cacheTime = mode.m_time - baseTime;
+		GLog.Log( "GPU Replay: Draws with %hs: %1.3f ms per frame, %1.0f draws/s, state cache %1.1f ns per draw, %1.1f ns per lookup",
+			mode.m_name, mode.m_time / numFrames, drawsPerSecond,
+			( cacheTime * 1000000.0 ) / numDraws, numStateLookups ? ( cacheTime * 1000000.0 ) / numStateLookups : 0.0 );
+	}
+
+	return true;
+}
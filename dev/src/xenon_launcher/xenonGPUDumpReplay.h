@@ -0,0 +1,44 @@
+#pragma once
+
+#include "xenonGPUDumpFormat.h"
+
+class CXenonGPUExecutor;
+class CXenonGPUNullAbstractLayer;
+
+/// Replays saved GPU dump through the executor and measures the CPU side cost of the command processing
+/// Memory read by the packets is restored from the dump just before each packet is executed
+class CXenonGPUDumpReplay
+{
+public:
+	CXenonGPUDumpReplay();
+
+	/// Load dump from file
+	bool Load( const std::wstring& path );
+
+	/// Get the loaded dump
+	inline const CXenonGPUDumpFormat& GetDump() const { return m_dump; }
+
+	/// Replay the dump given number of times, each replay is a single frame, stats are printed to the log
+	/// Detailed stats are printed only if the null layer is used
+	bool Run( CXenonGPUExecutor& executor, CXenonGPUNullAbstractLayer* nullLayer, const uint32 numFrames );
+
+	/// Replay the dump given number of times with each kind of the state cache in the null layer (none, ordered map, flat map) and report the draws per second
+	bool RunStateBenchmark( CXenonGPUExecutor& executor, CXenonGPUNullAbstractLayer& nullLayer, const uint32 numFrames );
+
+private:
+	// loaded dump tables
+	CXenonGPUDumpFormat		m_dump;
+
+	// memory block data
+	std::vector< uint8 >	m_memory;
+
+	// packets in the format of the command buffer (big endian), one packet after another
+	std::vector< uint32 >	m_commands;
+	std::vector< uint32 >	m_commandOffsets;
+
+	// execute all packets once, returns the execution time (without the memory restore) in performance counter ticks
+	uint64 ExecuteFrame( CXenonGPUExecutor& executor, uint64& restoreTicks );
+
+	// restore memory read by given packet
+	void RestoreMemory( const CXenonGPUDumpFormat::Packet& packet );
+};
@@ -337,7 +337,7 @@ namespace Helper
 uint32 CXenonGPUDumpWriterImpl::MapMemoryBlock( const uint32 address, const uint32 size )
 {
 	// get true data pointer
-	const void* ptr = (const void*) address;
+	const void* ptr = (const void*)(size_t) address;
 
 	// compute the data CRC
 	const uint64 crc = Helper::Crc64( 0, (const unsigned char*) ptr, size );
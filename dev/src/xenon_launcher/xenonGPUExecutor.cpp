@@ -27,21 +27,17 @@
 */
 
 #include "build.h"
-#include "xenonPlatform.h"
-#include "xenonLibNatives.h"
 #include "xenonGPUCommandBuffer.h"
 #include "xenonGPUExecutor.h"
 #include "xenonGPUOpcodes.h"
 #include "xenonGPUUtils.h"
 #include "xenonGPUDumpWriter.h"
 #include "xenonGPUTraceWriter.h"
-
-#include "dx11AbstractLayer.h"
-#include "../host_core/launcherCommandline.h"
+#include "xenonGPUAbstractLayer.h"
 
 //-----------
 
-CXenonGPUExecutor::CXenonGPUExecutor(IXenonGPUAbstractLayer* abstractionLayer, const launcher::Commandline& cmdLine)
+CXenonGPUExecutor::CXenonGPUExecutor(IXenonGPUAbstractLayer* abstractionLayer, const std::wstring& gpuLogFile)
 	: m_abstractLayer(abstractionLayer)
 	, m_tiledMask(0xFFFFFFFFull)
 	, m_tiledSelector(0xFFFFFFFFull)
@@ -49,13 +45,20 @@ CXenonGPUExecutor::CXenonGPUExecutor(IXenonGPUAbstractLayer* abstractionLayer, c
 	, m_vblankCounter(0)
 	, m_interruptAddr(0)
 	, m_interruptUserData(0)
+	, m_batchDepth(0)
 	, m_traceDumpRequested(false)
 	, m_traceDumpFile(nullptr)
 	, m_logWriter(nullptr)
+	, m_waitStart(0)
+	, m_waitTicks(0)
 {
-	if (cmdLine.HasOption("gpulog"))
+	// timer resolution
+	LARGE_INTEGER freq;
+	QueryPerformanceFrequency(&freq);
+	m_tickToSeconds = 1.0 / (double)freq.QuadPart;
+
+	if (!gpuLogFile.empty())
 	{
-		std::wstring gpuLogFile = cmdLine.GetOptionValueW("gpulog");
 		GLog.Log("GPU: Logging gpu activity to '%ls'", gpuLogFile.c_str());
 
 		m_logWriter = CXenonGPUTraceWriter::Create(gpuLogFile);
@@ -130,7 +133,19 @@ private:
 
 void CXenonGPUExecutor::Execute(CXenonGPUCommandBufferReader& reader)
 {
+	// copy the whole batch out of the ring buffer once, all packets are decoded from the linear copy
+	reader.Linearize(AcquireBatchStorage());
 	ExecutePrimaryBuffer(reader);
+	m_batchDepth -= 1;
+}
+
+std::vector<uint32>& CXenonGPUExecutor::AcquireBatchStorage()
+{
+	// the storage is reused between batches so we don't reallocate all the time
+	if (m_batchDepth >= m_batchStorage.size())
+		m_batchStorage.emplace_back();
+
+	return m_batchStorage[m_batchDepth++];
 }
 
 void CXenonGPUExecutor::SetInterruptCallbackAddr(const uint32 addr, const uint32 userData)
@@ -213,6 +228,27 @@ bool CXenonGPUExecutor::ExecutePacket(CXenonGPUCommandBufferReader& reader)
 	return false;
 }
 
+// can we write given register range directly, without the side effects from WriteRegister
+static inline bool CanWriteRegisterRange(const uint32 baseIndex, const uint32 regCount)
+{
+	const uint32 endIndex = baseIndex + regCount;
+	if (endIndex > CXenonGPURegisters::NUM_REGISTER_RAWS)
+		return false;
+
+	// COHER status
+	const uint32 coherIndex = (uint32)XenonGPURegister::REG_COHER_STATUS_HOST;
+	if (baseIndex <= coherIndex && coherIndex < endIndex)
+		return false;
+
+	// scratch registers
+	const uint32 scratchFirst = (uint32)XenonGPURegister::REG_SCRATCH_REG0;
+	const uint32 scratchLast = (uint32)XenonGPURegister::REG_SCRATCH_REG7;
+	if (baseIndex <= scratchLast && scratchFirst < endIndex)
+		return false;
+
+	return true;
+}
+
 bool CXenonGPUExecutor::ExecutePacketType0(CXenonGPUCommandBufferReader& reader, const uint32 packetData)
 {
 	CXenonGPULogBlock block2(m_logWriter, "Packet0");
@@ -242,6 +278,15 @@ bool CXenonGPUExecutor::ExecutePacketType0(CXenonGPUCommandBufferReader& reader,
 		m_traceDumpFile->Packet(packetData, wordsData, regCount);
 	}
 
+	// fast path - write the whole range at once directly from the linearized data
+	const uint32* linearData = reader.GetLinearData(regCount);
+	if (linearData && !writeOneReg && !m_logWriter && CanWriteRegisterRange(baseIndex, regCount))
+	{
+		m_registers.WriteRange(baseIndex, linearData, regCount, m_registerDirtyMask);
+		reader.Advance(regCount);
+		return true;
+	}
+
 	for (uint32 i = 0; i<regCount; i++)
 	{
 		const uint32 regData = reader.Read();
@@ -356,105 +401,9 @@ bool CXenonGPUExecutor::ExecutePacketType3(CXenonGPUCommandBufferReader& reader,
 	const CFullReadCheck readerCheck(reader, count);
 
 	// process opcode
-	switch (opcode)
-	{
-		case PM4_ME_INIT:
-			return ExecutePacketType3_ME_INIT(reader, packetData, count);
-
-		case PM4_NOP:
-			return ExecutePacketType3_NOP(reader, packetData, count);
-
-		case PM4_INTERRUPT:
-			return ExecutePacketType3_INTERRUPT(reader, packetData, count);
-
-		case PM4_HACK_SWAP:
-			return ExecutePacketType3_HACK_SWAP(reader, packetData, count);
-
-		case PM4_INDIRECT_BUFFER:
-			return ExecutePacketType3_INDIRECT_BUFFER(reader, packetData, count);
-
-		case PM4_WAIT_REG_MEM:
-			return ExecutePacketType3_WAIT_REG_MEM(reader, packetData, count);
-
-		case PM4_REG_RMW:
-			return ExecutePacketType3_REG_RMW(reader, packetData, count);
-
-		case PM4_COND_WRITE:
-			return ExecutePacketType3_COND_WRITE(reader, packetData, count);
-
-		case PM4_EVENT_WRITE:
-			return ExecutePacketType3_EVENT_WRITE(reader, packetData, count);
-
-		case PM4_EVENT_WRITE_SHD:
-			return ExecutePacketType3_EVENT_WRITE_SHD(reader, packetData, count);
-
-		case PM4_EVENT_WRITE_EXT:
-			return ExecutePacketType3_EVENT_WRITE_EXT(reader, packetData, count);
-
-		case PM4_DRAW_INDX:
-			return ExecutePacketType3_DRAW_INDX(reader, packetData, count);
-
-		case PM4_DRAW_INDX_2:
-			return ExecutePacketType3_DRAW_INDX_2(reader, packetData, count);
-
-		case PM4_SET_CONSTANT:
-			return ExecutePacketType3_SET_CONSTANT(reader, packetData, count);
-
-		case PM4_SET_CONSTANT2:
-			return ExecutePacketType3_SET_CONSTANT2(reader, packetData, count);
-
-		case PM4_LOAD_ALU_CONSTANT:
-			return ExecutePacketType3_LOAD_ALU_CONSTANT(reader, packetData, count);
-
-		case PM4_SET_SHADER_CONSTANTS:
-			return ExecutePacketType3_SET_SHADER_CONSTANTS(reader, packetData, count);
-
-		case PM4_IM_LOAD:
-			return ExecutePacketType3_IM_LOAD(reader, packetData, count);
-
-		case PM4_IM_LOAD_IMMEDIATE:
-			return ExecutePacketType3_IM_LOAD_IMMEDIATE(reader, packetData, count);
-
-		case PM4_INVALIDATE_STATE:
-			return ExecutePacketType3_INVALIDATE_STATE(reader, packetData, count);
-
-			// tiled rendering bit mask
-		case PM4_SET_BIN_MASK_LO:
-		{
-			const uint32 loMask = reader.Read();
-			m_tiledMask = (m_tiledMask & 0xFFFFFFFF00000000ull) | loMask;
-			return true;
-		}
-
-		case PM4_SET_BIN_MASK_HI:
-		{
-			const uint32 hiMask = reader.Read();
-			m_tiledMask = (m_tiledMask & 0xFFFFFFFFull) | (static_cast<uint64>(hiMask) << 32);
-			return true;
-		}
-
-		case PM4_SET_BIN_SELECT_LO:
-		{
-			const uint32 loSelect = reader.Read();
-			m_tiledSelector = (m_tiledSelector & 0xFFFFFFFF00000000ull) | loSelect;
-			return true;
-		}
-
-		case PM4_SET_BIN_SELECT_HI:
-		{
-			const uint32 hiSelect = reader.Read();
-			m_tiledSelector = (m_tiledSelector & 0xFFFFFFFFull) | (static_cast<uint64>(hiSelect) << 32);
-			return true;
-		}
-
-		// Ignored packets - useful if breaking on the default handler below.
-		case 0x50:  // 0xC0015000 usually 2 words, 0xFFFFFFFF / 0x00000000
-		case 0x51:  // 0xC0015100 usually 2 words, 0xFFFFFFFF / 0xFFFFFFFF
-		{
-			reader.Advance(count);
-			break;
-		}
-	}
+	const auto func = st_packetType3Table.m_funcs[opcode];
+	if (func)
+		return (this->*func)(reader, packetData, count);
 
 	// ERROR
 	GLog.Err("GPU: Unknown Type3 opcode: %d, packet data: 0x%08X, count: %d", opcode, packetData, count);
@@ -462,6 +411,42 @@ bool CXenonGPUExecutor::ExecutePacketType3(CXenonGPUCommandBufferReader& reader,
 	return false;
 }
 
+constexpr CXenonGPUExecutor::PacketType3Table CXenonGPUExecutor::BuildPacketType3Table()
+{
+	PacketType3Table table = {};
+	table.m_funcs[PM4_ME_INIT] = &CXenonGPUExecutor::ExecutePacketType3_ME_INIT;
+	table.m_funcs[PM4_NOP] = &CXenonGPUExecutor::ExecutePacketType3_NOP;
+	table.m_funcs[PM4_INTERRUPT] = &CXenonGPUExecutor::ExecutePacketType3_INTERRUPT;
+	table.m_funcs[PM4_HACK_SWAP] = &CXenonGPUExecutor::ExecutePacketType3_HACK_SWAP;
+	table.m_funcs[PM4_INDIRECT_BUFFER] = &CXenonGPUExecutor::ExecutePacketType3_INDIRECT_BUFFER;
+	table.m_funcs[PM4_WAIT_REG_MEM] = &CXenonGPUExecutor::ExecutePacketType3_WAIT_REG_MEM;
+	table.m_funcs[PM4_REG_RMW] = &CXenonGPUExecutor::ExecutePacketType3_REG_RMW;
+	table.m_funcs[PM4_COND_WRITE] = &CXenonGPUExecutor::ExecutePacketType3_COND_WRITE;
+	table.m_funcs[PM4_EVENT_WRITE] = &CXenonGPUExecutor::ExecutePacketType3_EVENT_WRITE;
+	table.m_funcs[PM4_EVENT_WRITE_SHD] = &CXenonGPUExecutor::ExecutePacketType3_EVENT_WRITE_SHD;
+	table.m_funcs[PM4_EVENT_WRITE_EXT] = &CXenonGPUExecutor::ExecutePacketType3_EVENT_WRITE_EXT;
+	table.m_funcs[PM4_DRAW_INDX] = &CXenonGPUExecutor::ExecutePacketType3_DRAW_INDX;
+	table.m_funcs[PM4_DRAW_INDX_2] = &CXenonGPUExecutor::ExecutePacketType3_DRAW_INDX_2;
+	table.m_funcs[PM4_SET_CONSTANT] = &CXenonGPUExecutor::ExecutePacketType3_SET_CONSTANT;
+	table.m_funcs[PM4_SET_CONSTANT2] = &CXenonGPUExecutor::ExecutePacketType3_SET_CONSTANT2;
+	table.m_funcs[PM4_LOAD_ALU_CONSTANT] = &CXenonGPUExecutor::ExecutePacketType3_LOAD_ALU_CONSTANT;
+	table.m_funcs[PM4_SET_SHADER_CONSTANTS] = &CXenonGPUExecutor::ExecutePacketType3_SET_SHADER_CONSTANTS;
+	table.m_funcs[PM4_IM_LOAD] = &CXenonGPUExecutor::ExecutePacketType3_IM_LOAD;
+	table.m_funcs[PM4_IM_LOAD_IMMEDIATE] = &CXenonGPUExecutor::ExecutePacketType3_IM_LOAD_IMMEDIATE;
+	table.m_funcs[PM4_INVALIDATE_STATE] = &CXenonGPUExecutor::ExecutePacketType3_INVALIDATE_STATE;
+	table.m_funcs[PM4_SET_BIN_MASK_LO] = &CXenonGPUExecutor::ExecutePacketType3_SET_BIN_MASK_LO;
+	table.m_funcs[PM4_SET_BIN_MASK_HI] = &CXenonGPUExecutor::ExecutePacketType3_SET_BIN_MASK_HI;
+	table.m_funcs[PM4_SET_BIN_SELECT_LO] = &CXenonGPUExecutor::ExecutePacketType3_SET_BIN_SELECT_LO;
+	table.m_funcs[PM4_SET_BIN_SELECT_HI] = &CXenonGPUExecutor::ExecutePacketType3_SET_BIN_SELECT_HI;
+
+	// Ignored packets - useful if breaking on the default handler.
+	table.m_funcs[PM4_SET_BIN_MASK] = &CXenonGPUExecutor::ExecutePacketType3_IGNORED; // 0xC0015000 usually 2 words, 0xFFFFFFFF / 0x00000000
+	table.m_funcs[PM4_SET_BIN_SELECT] = &CXenonGPUExecutor::ExecutePacketType3_IGNORED; // 0xC0015100 usually 2 words, 0xFFFFFFFF / 0xFFFFFFFF
+	return table;
+}
+
+const CXenonGPUExecutor::PacketType3Table CXenonGPUExecutor::st_packetType3Table = CXenonGPUExecutor::BuildPacketType3Table();
+
 bool CXenonGPUExecutor::ExecutePacketType3_ME_INIT(CXenonGPUCommandBufferReader& reader, const uint32 packetData, const uint32 count)
 {
 	CXenonGPULogBlock block(m_logWriter, "ME_INIT");
@@ -560,14 +545,16 @@ bool CXenonGPUExecutor::ExecutePacketType3_INDIRECT_BUFFER(CXenonGPUCommandBuffe
 	}
 
 	// create indirect reader
-	const uint32* memBase = (const uint32*)GPlatform.GetMemory().TranslatePhysicalAddress(listAddr);
+	const uint32* memBase = (const uint32*)(size_t)GPlatform.GetMemory().TranslatePhysicalAddress(listAddr);
 	CXenonGPUCommandBufferReader indirectReader(memBase, listLength, 0, listLength);
 
-	// execute indirect commands
+	// execute indirect commands from a linear copy
+	indirectReader.Linearize(AcquireBatchStorage());
 	while (indirectReader.CanRead())
 	{
 		ExecutePacket(indirectReader);
 	}
+	m_batchDepth -= 1;
 
 	// done
 	return true;
@@ -595,6 +582,7 @@ bool CXenonGPUExecutor::ExecutePacketType3_WAIT_REG_MEM(CXenonGPUCommandBufferRe
 	}
 
 	bool matched = false;
+	uint32 numRetries = 0;
 	do
 	{
 		uint32 value;
@@ -680,11 +668,21 @@ bool CXenonGPUExecutor::ExecutePacketType3_WAIT_REG_MEM(CXenonGPUCommandBufferRe
 				MemoryBarrier();
 				FinishWait();
 			}
-			else
+			else if (numRetries < WAIT_REG_MEM_YIELD_COUNT)
 			{
-				// just yield
+				// just yield, the value usually changes quickly
 				SwitchToThread();
 			}
+			else
+			{
+				// we are waiting for a long time, stop burning the core
+				BeingWait();
+				Sleep(1);
+				MemoryBarrier();
+				FinishWait();
+			}
+
+			numRetries += 1;
 		}
 	} while (!matched);
 	return true;
@@ -784,7 +782,7 @@ bool CXenonGPUExecutor::ExecutePacketType3_COND_WRITE(CXenonGPUCommandBufferRead
 		}
 
 		// load data (raw)
-		const uint32 rawValue = *(const uint32*)addr;
+		const uint32 rawValue = *(const uint32*)(size_t)addr;
 
 		// swap value
 		value = XenonGPUSwap32(rawValue, format);
@@ -854,7 +852,7 @@ bool CXenonGPUExecutor::ExecutePacketType3_COND_WRITE(CXenonGPUCommandBufferRead
 			const uint32 rawValue = XenonGPUSwap32(writeData, format);
 
 			// write it
-			*(uint32*)addr = rawValue;
+			*(uint32*)(size_t)addr = rawValue;
 
 			// log the read
 			if (m_logWriter)
@@ -942,7 +940,7 @@ bool CXenonGPUExecutor::ExecutePacketType3_EVENT_WRITE_SHD(CXenonGPUCommandBuffe
 	const uint32 writeAddr = GPlatform.GetMemory().TranslatePhysicalAddress(address & ~0x3);
 
 	// store it
-	*(uint32*)writeAddr = rawValue;
+	*(uint32*)(size_t)writeAddr = rawValue;
 
 	// log the write
 	if (m_logWriter)
@@ -1027,7 +1025,7 @@ bool CXenonGPUExecutor::ExecutePacketType3_DRAW_INDX(CXenonGPUCommandBufferReade
 
 		// setup draw state
 		CXenonGPUState::DrawIndexState ds;
-		ds.m_indexData = (const void*)GPlatform.GetMemory().TranslatePhysicalAddress(indexAddr);;
+		ds.m_indexData = (const void*)(size_t)GPlatform.GetMemory().TranslatePhysicalAddress(indexAddr);
 		ds.m_indexFormat = indexFormat;
 		ds.m_indexEndianess = indexEndianess;
 		ds.m_indexCount = indexCount;
@@ -1209,7 +1207,7 @@ bool CXenonGPUExecutor::ExecutePacketType3_LOAD_ALU_CONSTANT(CXenonGPUCommandBuf
 
 	for (uint32 n = 0; n < size_dwords; n++, index++)
 	{
-		const auto data = _byteswap_ulong(*(const uint32*)GPlatform.GetMemory().TranslatePhysicalAddress(address + n * 4));
+		const auto data = _byteswap_ulong(*(const uint32*)(size_t)GPlatform.GetMemory().TranslatePhysicalAddress(address + n * 4));
 		WriteRegister(index, data);
 	}
 
@@ -1254,12 +1252,12 @@ bool CXenonGPUExecutor::ExecutePacketType3_IM_LOAD(CXenonGPUCommandBufferReader&
 
 	if (shaderType == XenonShaderType::ShaderPixel)
 	{
-		const void* actualMem = (const void*)actualMemAddr;
+		const void* actualMem = (const void*)(size_t)actualMemAddr;
 		m_abstractLayer->SetPixelShader(actualMem, sizeDwords);
 	}
 	else if (shaderType == XenonShaderType::ShaderVertex)
 	{
-		const void* actualMem = (const void*)actualMemAddr;
+		const void* actualMem = (const void*)(size_t)actualMemAddr;
 		m_abstractLayer->SetVertexShader(actualMem, sizeDwords);
 	}
 
@@ -1288,7 +1286,7 @@ bool CXenonGPUExecutor::ExecutePacketType3_IM_LOAD_IMMEDIATE(CXenonGPUCommandBuf
 		auto* actualMem = (uint32*)alloca(sizeof(uint32) * sizeDwords);
 		reader.GetBatch(sizeDwords, actualMem);
 
-		m_traceDumpFile->MemoryAccessRead((uint32)actualMem, sizeDwords * 4, shaderType == XenonShaderType::ShaderPixel ? "PixelShader" : "VertexShader");
+		m_traceDumpFile->MemoryAccessRead((uint32)(size_t)actualMem, sizeDwords * 4, shaderType == XenonShaderType::ShaderPixel ? "PixelShader" : "VertexShader");
 	}
 
 	if (shaderType == XenonShaderType::ShaderPixel)
@@ -1317,6 +1315,41 @@ bool CXenonGPUExecutor::ExecutePacketType3_INVALIDATE_STATE(CXenonGPUCommandBuff
 	return true;
 }
 
+// tiled rendering bit mask
+bool CXenonGPUExecutor::ExecutePacketType3_SET_BIN_MASK_LO(CXenonGPUCommandBufferReader& reader, const uint32 packetData, const uint32 count)
+{
+	const uint32 loMask = reader.Read();
+	m_tiledMask = (m_tiledMask & 0xFFFFFFFF00000000ull) | loMask;
+	return true;
+}
+
+bool CXenonGPUExecutor::ExecutePacketType3_SET_BIN_MASK_HI(CXenonGPUCommandBufferReader& reader, const uint32 packetData, const uint32 count)
+{
+	const uint32 hiMask = reader.Read();
+	m_tiledMask = (m_tiledMask & 0xFFFFFFFFull) | (static_cast<uint64>(hiMask) << 32);
+	return true;
+}
+
+bool CXenonGPUExecutor::ExecutePacketType3_SET_BIN_SELECT_LO(CXenonGPUCommandBufferReader& reader, const uint32 packetData, const uint32 count)
+{
+	const uint32 loSelect = reader.Read();
+	m_tiledSelector = (m_tiledSelector & 0xFFFFFFFF00000000ull) | loSelect;
+	return true;
+}
+
+bool CXenonGPUExecutor::ExecutePacketType3_SET_BIN_SELECT_HI(CXenonGPUCommandBufferReader& reader, const uint32 packetData, const uint32 count)
+{
+	const uint32 hiSelect = reader.Read();
+	m_tiledSelector = (m_tiledSelector & 0xFFFFFFFFull) | (static_cast<uint64>(hiSelect) << 32);
+	return true;
+}
+
+bool CXenonGPUExecutor::ExecutePacketType3_IGNORED(CXenonGPUCommandBufferReader& reader, const uint32 packetData, const uint32 count)
+{
+	reader.Advance(count);
+	return true;
+}
+
 void CXenonGPUExecutor::WriteRegister(const XenonGPURegister registerIndex, const uint32 registerData)
 {
 	WriteRegister((const uint32)registerIndex, registerData);
@@ -1406,12 +1439,21 @@ void CXenonGPUExecutor::MakeCoherent()
 
 void CXenonGPUExecutor::BeingWait()
 {
-	// not implemented
+	LARGE_INTEGER time;
+	QueryPerformanceCounter(&time);
+	m_waitStart = time.QuadPart;
 }
 
 void CXenonGPUExecutor::FinishWait()
 {
-	// not implemented
+	LARGE_INTEGER time;
+	QueryPerformanceCounter(&time);
+	m_waitTicks += time.QuadPart - m_waitStart;
+}
+
+const double CXenonGPUExecutor::GetWaitTime() const
+{
+	return m_waitTicks.load() * m_tickToSeconds;
 }
 
 void CXenonGPUExecutor::DispatchInterrupt(const uint32 source, const uint32 cpu)
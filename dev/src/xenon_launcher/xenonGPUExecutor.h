@@ -11,7 +11,7 @@ class CXenonGPUTraceWriter;
 class CXenonGPUExecutor
 {
 public:
-	CXenonGPUExecutor( IXenonGPUAbstractLayer* abstractionLayer, const launcher::Commandline& cmdLine );
+	CXenonGPUExecutor( IXenonGPUAbstractLayer* abstractionLayer, const std::wstring& gpuLogFile );
 	~CXenonGPUExecutor();
 
 	/// Process command from command buffer
@@ -29,7 +29,12 @@ public:
 	/// Request a trace dump of the next frame
 	void RequestTraceDump();
 
+	/// Get time (in seconds) spent stalled in WAIT_REG_MEM
+	const double GetWaitTime() const;
+
 private:	
+	static const uint32 WAIT_REG_MEM_YIELD_COUNT = 64; // yields before WAIT_REG_MEM goes to sleep
+
 	// gpu abstraction layer (owned externally)
 	IXenonGPUAbstractLayer*		m_abstractLayer;
 
@@ -59,7 +64,27 @@ private:
 	uint32		m_interruptAddr;
 	uint32		m_interruptUserData;
 
+	// storage for the linearized command data, one per nesting level of indirect buffers
+	std::deque< std::vector< uint32 > >	m_batchStorage;
+	uint32								m_batchDepth;
+
+	// type3 packet dispatch table
+	typedef bool (CXenonGPUExecutor::*TPacketType3Func)( CXenonGPUCommandBufferReader& reader, const uint32 packetData, const uint32 count );
+	struct PacketType3Table
+	{
+		TPacketType3Func	m_funcs[ 128 ];
+	};
+
+	static const PacketType3Table	st_packetType3Table;
+	static constexpr PacketType3Table BuildPacketType3Table();
+
+	// wait stats
+	uint64					m_waitStart;
+	std::atomic< uint64 >	m_waitTicks;
+	double					m_tickToSeconds;
+
 	// command buffer execution (pasted from AMD driver)
+	std::vector< uint32 >& AcquireBatchStorage();
 	void ExecutePrimaryBuffer( CXenonGPUCommandBufferReader& reader );
 	bool ExecutePacket( CXenonGPUCommandBufferReader& reader );
 
@@ -89,6 +114,11 @@ private:
 	bool ExecutePacketType3_IM_LOAD( CXenonGPUCommandBufferReader& reader, const uint32 packetData, const uint32 count );
 	bool ExecutePacketType3_IM_LOAD_IMMEDIATE( CXenonGPUCommandBufferReader& reader, const uint32 packetData, const uint32 count );
 	bool ExecutePacketType3_INVALIDATE_STATE( CXenonGPUCommandBufferReader& reader, const uint32 packetData, const uint32 count );
+	bool ExecutePacketType3_SET_BIN_MASK_LO( CXenonGPUCommandBufferReader& reader, const uint32 packetData, const uint32 count );
+	bool ExecutePacketType3_SET_BIN_MASK_HI( CXenonGPUCommandBufferReader& reader, const uint32 packetData, const uint32 count );
+	bool ExecutePacketType3_SET_BIN_SELECT_LO( CXenonGPUCommandBufferReader& reader, const uint32 packetData, const uint32 count );
+	bool ExecutePacketType3_SET_BIN_SELECT_HI( CXenonGPUCommandBufferReader& reader, const uint32 packetData, const uint32 count );
+	bool ExecutePacketType3_IGNORED( CXenonGPUCommandBufferReader& reader, const uint32 packetData, const uint32 count );
 
 	// Hacks
 	bool ExecutePacketType3_HACK_SWAP( CXenonGPUCommandBufferReader& reader, const uint32 packetData, const uint32 count );
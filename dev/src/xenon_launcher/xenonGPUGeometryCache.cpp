@@ -0,0 +1,137 @@
+#include "build.h"
+#include "xenonGPUUtils.h"
+#include "xenonGPUGeometryCache.h"
+#include "xenonGPUTextureConversion.h"
+
+#include <emmintrin.h>
+
+//----------------------
+
+CXenonGPUGeometryCache::CXenonGPUGeometryCache( const uint32 storageSize )
+	: m_storageSize( storageSize )
+	, m_storageOffset( 0 )
+	, m_numHits( 0 )
+	, m_numUploads( 0 )
+	, m_numUploadedBytes( 0 )
+	, m_numFlushes( 0 )
+{
+}
+
+CXenonGPUGeometryCache::~CXenonGPUGeometryCache()
+{
+	GLog.Log( "GPU: Geometry cache: %u hits, %u uploads (%1.2f MB), %u flushes",
+		m_numHits, m_numUploads, m_numUploadedBytes / (1024.0 * 1024.0), m_numFlushes );
+}
+
+void CXenonGPUGeometryCache::Flush()
+{
+	m_entries.Clear();
+	m_storageOffset = 0;
+	m_numFlushes += 1;
+}
+
+const bool CXenonGPUGeometryCache::Get( const void* sourceMemory, const uint32 numElements, const Format format, const bool swap, Result& outResult )
+{
+	const uint32 sourceSize = numElements * ( (format == Format::Index16) ? sizeof(uint16) : sizeof(uint32) );
+	const uint32 dataSize = numElements * sizeof(uint32);
+
+	// big buffers would flush the whole cache
+	if ( !dataSize || dataSize > m_storageSize / 4 )
+		return false;
+
+	// memory that is not tracked always returns new epoch so it's never cached
+	const uint32 writeEpoch = GPlatform.GetMemory().GetLastWriteEpoch( sourceMemory, sourceSize );
+
+	Key key;
+	key.m_address = (uint32) sourceMemory;
+	key.m_numElements = numElements;
+	key.m_format = ((uint32) format << 1) | (swap ? 1 : 0);
+
+	// first use, remember it but don't cache yet (most of the dynamic geometry is used only once)
+	Entry* entry = m_entries.Find( key );
+	if ( !entry )
+	{
+		if ( m_entries.GetSize() >= MAX_ENTRIES )
+			Flush();
+
+		Entry newEntry;
+		newEntry.m_writeEpoch = writeEpoch;
+		newEntry.m_offset = INVALID_OFFSET;
+		m_entries.Insert( key, newEntry );
+		return false;
+	}
+
+	// memory was modified since we've last seen it
+	const bool modified = (entry->m_writeEpoch != writeEpoch);
+	entry->m_writeEpoch = writeEpoch;
+
+	// not in the storage yet, place it there if it's reused without changes
+	if ( entry->m_offset == INVALID_OFFSET )
+	{
+		if ( modified )
+			return false;
+
+		if ( m_storageOffset + dataSize > m_storageSize )
+		{
+			Flush();
+			return false;
+		}
+
+		entry->m_offset = m_storageOffset;
+		m_storageOffset += dataSize;
+	}
+	else if ( !modified )
+	{
+		// storage is up to date
+		outResult.m_offset = entry->m_offset;
+		outResult.m_size = dataSize;
+		outResult.m_uploadData = nullptr;
+		m_numHits += 1;
+		return true;
+	}
+
+	// convert the data
+	m_uploadData.resize( numElements );
+	Convert( m_uploadData.data(), sourceMemory, numElements, format, swap );
+
+	outResult.m_offset = entry->m_offset;
+	outResult.m_size = dataSize;
+	outResult.m_uploadData = m_uploadData.data();
+	m_numUploads += 1;
+	m_numUploadedBytes += dataSize;
+	return true;
+}
+
+void CXenonGPUGeometryCache::Convert( void* dest, const void* src, const uint32 numElements, const Format format, const bool swap )
+{
+	// 32-bit data, use the texture conversion routines
+	if ( format != Format::Index16 )
+	{
+		const uint32 size = numElements * sizeof(uint32);
+		if ( swap )
+			XenonGPUConvertEndianess( dest, src, size, XenonGPUEndianFormat::Format8in32 );
+		else
+			memcpy( dest, src, size );
+		return;
+	}
+
+	// 16-bit indices, swap and expand 8 at a time
+	const uint16* readPtr = (const uint16*) src;
+	uint32* writePtr = (uint32*) dest;
+	const __m128i zero = _mm_setzero_si128();
+
+	uint32 i = 0;
+	for ( ; i + 8 <= numElements; i += 8 )
+	{
+		__m128i indices = _mm_loadu_si128( (const __m128i*)( readPtr + i ) );
+		if ( swap )
+			indices = _mm_or_si128( _mm_slli_epi16( indices, 8 ), _mm_srli_epi16( indices, 8 ) );
+
+		_mm_storeu_si128( (__m128i*)( writePtr + i ), _mm_unpacklo_epi16( indices, zero ) );
+		_mm_storeu_si128( (__m128i*)( writePtr + i + 4 ), _mm_unpackhi_epi16( indices, zero ) );
+	}
+
+	// tail
+	for ( ; i < numElements; ++i )
+		writePtr[i] = swap ? _byteswap_ushort( readPtr[i] ) : readPtr[i];
+}
@@ -0,0 +1,76 @@
+#pragma once
+
+#include "xenonGPUHashMap.h"
+
+/// Backend independent cache of the vertex and index data converted to the host format
+/// Entries are keyed by the guest memory range and the conversion, changes of the guest memory are detected via the memory write epochs
+/// Data that is reused without being modified is moved to a persistent storage (owned by the backend, only the ranges are managed here) so it's converted and uploaded only once
+class CXenonGPUGeometryCache
+{
+public:
+	/// Format of the source data, converted data is always in 32-bit elements
+	enum class Format : uint32
+	{
+		Vertex32,	// vertex data, 32-bit words
+		Index16,	// 16-bit indices, expanded to 32-bit
+		Index32,	// 32-bit indices
+	};
+
+	/// Cached data
+	struct Result
+	{
+		uint32			m_offset;		// offset in the persistent storage
+		uint32			m_size;			// size of the converted data
+		const void*		m_uploadData;	// converted data that must be written to the storage at m_offset, NULL if the storage is up to date
+	};
+
+	CXenonGPUGeometryCache( const uint32 storageSize );
+	~CXenonGPUGeometryCache();
+
+	/// Get size of the persistent storage
+	inline const uint32 GetStorageSize() const { return m_storageSize; }
+
+	/// Get data for given guest memory range from the persistent storage
+	/// Returns false if the data is not cached (not reused yet or changing) and should be converted by the caller
+	const bool Get( const void* sourceMemory, const uint32 numElements, const Format format, const bool swap, Result& outResult );
+
+	/// Convert data to host format, dest must have space for numElements 32-bit values
+	static void Convert( void* dest, const void* src, const uint32 numElements, const Format format, const bool swap );
+
+private:
+	static const uint32 INVALID_OFFSET = 0xFFFFFFFF;
+	static const uint32 MAX_ENTRIES = 65536;
+
+	// cache key, guest memory range and the conversion
+	struct Key
+	{
+		uint32		m_address;
+		uint32		m_numElements;
+		uint32		m_format;	// Format and swap flag
+	};
+
+	// cache entry
+	struct Entry
+	{
+		uint32		m_writeEpoch;	// memory write epoch of the source data when it was last seen
+		uint32		m_offset;		// offset in the persistent storage, INVALID_OFFSET if not stored yet
+	};
+
+	TXenonGPUHashMap< Key, Entry >	m_entries;
+
+	// persistent storage allocation, everything is discarded when it's full
+	uint32							m_storageSize;
+	uint32							m_storageOffset;
+
+	// converted data waiting for upload
+	std::vector< uint32 >			m_uploadData;
+
+	// stats
+	uint32							m_numHits;
+	uint32							m_numUploads;
+	uint64							m_numUploadedBytes;
+	uint32							m_numFlushes;
+
+	// discard all entries
+	void Flush();
+};
@@ -0,0 +1,170 @@
+#pragma once
+
+#include <vector>
+
+/// Default key traits, key is a POD structure hashed and compared as raw memory
+/// NOTE: padding in the key structure must be zeroed
+template< typename K >
+struct TXenonGPUHashTraitsPOD
+{
+	static_assert( (sizeof(K) % sizeof(uint32)) == 0, "Key size must be multiple of 4 bytes" );
+
+	static inline uint32 Hash( const K& key )
+	{
+		// FNV-1a on words
+		const uint32* words = (const uint32*) &key;
+		uint32 hash = 2166136261U;
+		for ( uint32 i=0; i<sizeof(K) / sizeof(uint32); ++i )
+			hash = (hash ^ words[i]) * 16777619U;
+		return hash;
+	}
+
+	static inline bool Equal( const K& a, const K& b )
+	{
+		return 0 == memcmp( &a, &b, sizeof(K) );
+	}
+};
+
+/// Flat hash map (open addressing with linear probing) for the caches that are queried on every draw
+/// Remembers the last found entry so repeated queries for the same key are not even hashed
+/// Entries cannot be removed, only the whole map can be cleared
+template< typename K, typename V, typename Traits = TXenonGPUHashTraitsPOD< K > >
+class TXenonGPUHashMap
+{
+public:
+	TXenonGPUHashMap()
+		: m_numEntries( 0 )
+		, m_lastEntry( INVALID_INDEX )
+	{
+		m_entries.resize( INITIAL_CAPACITY );
+	}
+
+	/// Get number of entries in the map
+	inline const uint32 GetSize() const { return m_numEntries; }
+
+	/// Remove all entries
+	inline void Clear()
+	{
+		m_entries.clear();
+		m_entries.resize( INITIAL_CAPACITY );
+		m_numEntries = 0;
+		m_lastEntry = INVALID_INDEX;
+	}
+
+	/// Find value for given key, returns NULL if not found
+	inline V* Find( const K& key )
+	{
+		// same as last time
+		if ( m_lastEntry != INVALID_INDEX && Traits::Equal( m_entries[ m_lastEntry ].m_key, key ) )
+			return &m_entries[ m_lastEntry ].m_value;
+
+		const uint32 index = FindIndex( key, Traits::Hash( key ) );
+		if ( index == INVALID_INDEX )
+			return nullptr;
+
+		m_lastEntry = index;
+		return &m_entries[ index ].m_value;
+	}
+
+	/// Insert value for given key, existing value is overwritten
+	inline void Insert( const K& key, const V& value )
+	{
+		// keep the load factor below 50%
+		if ( (m_numEntries+1) * 2 > (uint32) m_entries.size() )
+			Grow();
+
+		const uint32 hash = Traits::Hash( key );
+		const uint32 mask = (uint32) m_entries.size() - 1;
+
+		uint32 index = hash & mask;
+		while ( m_entries[ index ].m_used )
+		{
+			if ( m_entries[ index ].m_hash == hash && Traits::Equal( m_entries[ index ].m_key, key ) )
+				break;
+			index = (index + 1) & mask;
+		}
+
+		Entry& entry = m_entries[ index ];
+		if ( !entry.m_used )
+		{
+			entry.m_used = true;
+			entry.m_hash = hash;
+			entry.m_key = key;
+			m_numEntries += 1;
+		}
+
+		entry.m_value = value;
+		m_lastEntry = index;
+	}
+
+	/// Visit all values
+	template< typename F >
+	inline void ForEach( const F& func )
+	{
+		for ( auto& entry : m_entries )
+		{
+			if ( entry.m_used )
+				func( entry.m_key, entry.m_value );
+		}
+	}
+
+private:
+	static const uint32 INITIAL_CAPACITY = 64;
+	static const uint32 INVALID_INDEX = 0xFFFFFFFF;
+
+	struct Entry
+	{
+		K			m_key;
+		V			m_value;
+		uint32		m_hash;
+		bool		m_used;
+
+		inline Entry()
+			: m_value()
+			, m_hash( 0 )
+			, m_used( false )
+		{}
+	};
+
+	std::vector< Entry >	m_entries;		// always power of two
+	uint32					m_numEntries;
+	uint32					m_lastEntry;	// last found entry, checked before hashing
+
+	inline uint32 FindIndex( const K& key, const uint32 hash ) const
+	{
+		const uint32 mask = (uint32) m_entries.size() - 1;
+
+		uint32 index = hash & mask;
+		while ( m_entries[ index ].m_used )
+		{
+			if ( m_entries[ index ].m_hash == hash && Traits::Equal( m_entries[ index ].m_key, key ) )
+				return index;
+			index = (index + 1) & mask;
+		}
+
+		return INVALID_INDEX;
+	}
+
+	inline void Grow()
+	{
+		std::vector< Entry > oldEntries;
+		oldEntries.swap( m_entries );
+		m_entries.resize( oldEntries.size() * 2 );
+
+		// reinsert, stored hashes are reused
+		const uint32 mask = (uint32) m_entries.size() - 1;
+		for ( const auto& entry : oldEntries )
+		{
+			if ( !entry.m_used )
+				continue;
+
+			uint32 index = entry.m_hash & mask;
+			while ( m_entries[ index ].m_used )
+				index = (index + 1) & mask;
+
+			m_entries[ index ] = entry;
+		}
+
+		m_lastEntry = INVALID_INDEX;
+	}
+};
@@ -0,0 +1,424 @@
+#include "build.h"
+#include "xenonGPUNullAbstractLayer.h"
+#include "xenonGPUTextures.h"
+#include "xenonGPUUtils.h"
+#include "dx11MicrocodeShader.h"
+#include "dx11MicrocodeCache.h"
+
+//----------------------
+
+static inline uint64 GetTicks()
+{
+	LARGE_INTEGER time;
+	QueryPerformanceCounter(&time);
+	return time.QuadPart;
+}
+
+//----------------------
+
+CXenonGPUNullAbstractLayer::Stats::Stats()
+{
+	memset(this, 0, sizeof(Stats));
+}
+
+CXenonGPUNullAbstractLayer::DepthStencilState::DepthStencilState()
+{
+	memset(this, 0, sizeof(DepthStencilState));
+}
+
+CXenonGPUNullAbstractLayer::BlendState::BlendState()
+{
+	memset(this, 0, sizeof(BlendState));
+}
+
+CXenonGPUNullAbstractLayer::RasterState::RasterState()
+{
+	memset(this, 0, sizeof(RasterState));
+}
+
+//----------------------
+
+CXenonGPUNullAbstractLayer::CXenonGPUNullAbstractLayer(CXenonGPUShaderStore* shaderStore)
+	: m_microcodeCache(new CDX11MicrocodeCache())
+	, m_pixelShader(nullptr)
+	, m_vertexShader(nullptr)
+	, m_stateCacheMode(StateCacheMode::None)
+{
+	memset(m_pixelShaderConsts, 0, sizeof(m_pixelShaderConsts));
+	memset(m_vertexShaderConsts, 0, sizeof(m_vertexShaderConsts));
+	memset(m_booleanConsts, 0, sizeof(m_booleanConsts));
+
+	m_microcodeCache->SetShaderStore(shaderStore);
+}
+
+CXenonGPUNullAbstractLayer::~CXenonGPUNullAbstractLayer()
+{
+	delete m_microcodeCache;
+	m_microcodeCache = nullptr;
+}
+
+void CXenonGPUNullAbstractLayer::ResetStats()
+{
+	m_stats = Stats();
+}
+
+void CXenonGPUNullAbstractLayer::SetStateCacheMode(const StateCacheMode mode)
+{
+	m_stateCacheMode = mode;
+	m_depthStencilStates.Clear();
+	m_blendStates.Clear();
+	m_rasterStates.Clear();
+}
+
+const uint32 CXenonGPUNullAbstractLayer::GetNumCachedStates() const
+{
+	return m_depthStencilStates.GetSize() + m_blendStates.GetSize() + m_rasterStates.GetSize();
+}
+
+bool CXenonGPUNullAbstractLayer::Initialize()
+{
+	GLog.Log("GPU: Using null rendering layer, nothing will be displayed");
+
+	// decompile the microcode seen in the previous sessions
+	m_microcodeCache->WarmUp();
+	return true;
+}
+
+bool CXenonGPUNullAbstractLayer::SetDisplayMode(const uint32 width, const uint32 height)
+{
+	return true;
+}
+
+void CXenonGPUNullAbstractLayer::BeingFrame()
+{
+}
+
+void CXenonGPUNullAbstractLayer::Swap(const CXenonGPUState::SwapState& ss)
+{
+	m_stats.m_numFrames += 1;
+}
+
+void CXenonGPUNullAbstractLayer::BeginEvent(const char* name)
+{
+}
+
+void CXenonGPUNullAbstractLayer::EndEvent()
+{
+}
+
+void CXenonGPUNullAbstractLayer::BindColorRenderTarget(const uint32 index, const XenonColorRenderTargetFormat format, const XenonMsaaSamples msaa, const uint32 base, const uint32 pitch)
+{
+}
+
+void CXenonGPUNullAbstractLayer::BindDepthStencil(const XenonDepthRenderTargetFormat format, const XenonMsaaSamples msaa, const uint32 base, const uint32 pitch)
+{
+}
+
+void CXenonGPUNullAbstractLayer::UnbindColorRenderTarget(const uint32 index)
+{
+}
+
+void CXenonGPUNullAbstractLayer::UnbindDepthStencil()
+{
+}
+
+void CXenonGPUNullAbstractLayer::SetColorRenderTargetWriteMask(const uint32 index, const bool enableRed, const bool enableGreen, const bool enableBlue, const bool enableAlpha)
+{
+}
+
+void CXenonGPUNullAbstractLayer::ClearColorRenderTarget(const uint32 index, const float* clearColor, const bool flushToEDRAM)
+{
+	m_stats.m_numClears += 1;
+}
+
+void CXenonGPUNullAbstractLayer::ClearDepthStencilRenderTarget(const float depthClear, const uint32 stencilClear, const bool flushToEDRAM)
+{
+	m_stats.m_numClears += 1;
+}
+
+bool CXenonGPUNullAbstractLayer::ResolveColorRenderTarget(const uint32 srcIndex, const XenonColorRenderTargetFormat srcFormat, const uint32 srcBase, const XenonRect2D& srcRect, const uint32 destBase, const uint32 destLogicalWidth, const uint32 destLogicalHeight, const uint32 destBlockWidth, const uint32 destBlockHeight, const XenonTextureFormat destFormat, const XenonRect2D& destRect)
+{
+	m_stats.m_numResolves += 1;
+	return true;
+}
+
+bool CXenonGPUNullAbstractLayer::ResolveDepthRenderTarget(const XenonDepthRenderTargetFormat srcFormat, const uint32 srcBase, const XenonRect2D& srcRect, const uint32 destBase, const uint32 destLogicalWidth, const uint32 destLogicalHeight, const uint32 destBlockWidth, const uint32 destBlockHeight, const XenonTextureFormat destFormat, const XenonRect2D& destRect)
+{
+	m_stats.m_numResolves += 1;
+	return true;
+}
+
+bool CXenonGPUNullAbstractLayer::RealizeSurfaceSetup(uint32& outMainWidth, uint32& outMainHeight)
+{
+	outMainWidth = 1280;
+	outMainHeight = 720;
+	return true;
+}
+
+void CXenonGPUNullAbstractLayer::SetViewportVertexFormat(const bool xyDivied, const bool zDivied, const bool wNotInverted)
+{
+}
+
+void CXenonGPUNullAbstractLayer::SetViewportWindowScale(const bool bNormalizedXYCoordinates)
+{
+}
+
+void CXenonGPUNullAbstractLayer::EnableScisor(const uint32 x, const uint32 y, const uint32 w, const uint32 h)
+{
+}
+
+void CXenonGPUNullAbstractLayer::DisableScisor()
+{
+}
+
+void CXenonGPUNullAbstractLayer::SetViewportRange(const float x, const float y, const float w, const float h)
+{
+}
+
+void CXenonGPUNullAbstractLayer::SetDepthRange(const float offset, const float scale)
+{
+}
+
+bool CXenonGPUNullAbstractLayer::RealizeViewportSetup()
+{
+	m_stats.m_numStateChanges += 1;
+	return true;
+}
+
+void CXenonGPUNullAbstractLayer::SetDepthTest(const bool isEnabled)
+{
+	m_depthStencilState.m_depthTest = isEnabled;
+}
+
+void CXenonGPUNullAbstractLayer::SetDepthWrite(const bool isEnabled)
+{
+	m_depthStencilState.m_depthWrite = isEnabled;
+}
+
+void CXenonGPUNullAbstractLayer::SetDepthFunc(const XenonCmpFunc func)
+{
+	m_depthStencilState.m_depthFunc = func;
+}
+
+void CXenonGPUNullAbstractLayer::SetStencilTest(const bool isEnabled)
+{
+	m_depthStencilState.m_stencilTest = isEnabled;
+}
+
+void CXenonGPUNullAbstractLayer::SetStencilWriteMask(const uint8 mask)
+{
+	m_depthStencilState.m_stencilWriteMask = mask;
+}
+
+void CXenonGPUNullAbstractLayer::SetStencilReadMask(const uint8 mask)
+{
+	m_depthStencilState.m_stencilReadMask = mask;
+}
+
+void CXenonGPUNullAbstractLayer::SetStencilRef(const uint8 mask)
+{
+}
+
+void CXenonGPUNullAbstractLayer::SetStencilFunc(const bool front, const XenonCmpFunc func)
+{
+	m_depthStencilState.m_stencilFunc[front ? 1 : 0] = func;
+}
+
+void CXenonGPUNullAbstractLayer::SetStencilOps(const bool front, const XenonStencilOp sfail, const XenonStencilOp dfail, const XenonStencilOp dpass)
+{
+	auto* ops = m_depthStencilState.m_stencilOps[front ? 1 : 0];
+	ops[0] = sfail;
+	ops[1] = dfail;
+	ops[2] = dpass;
+}
+
+bool CXenonGPUNullAbstractLayer::RealizeDepthStencilState()
+{
+	m_stats.m_numStateChanges += 1;
+	m_stats.m_numStateLookups += 1;
+
+	m_depthStencilStates.Get(m_stateCacheMode, m_depthStencilState);
+
+	return true;
+}
+
+void CXenonGPUNullAbstractLayer::SetBlend(const uint32 rtIndex, const bool isEnabled)
+{
+	if (rtIndex >= ARRAYSIZE(m_blendState.m_targets))
+		return;
+
+	m_blendState.m_targets[rtIndex].m_enabled = isEnabled;
+}
+
+void CXenonGPUNullAbstractLayer::SetBlendOp(const uint32 rtIndex, const XenonBlendOp colorOp, const XenonBlendOp alphaOp)
+{
+	if (rtIndex >= ARRAYSIZE(m_blendState.m_targets))
+		return;
+
+	m_blendState.m_targets[rtIndex].m_colorOp = colorOp;
+	m_blendState.m_targets[rtIndex].m_alphaOp = alphaOp;
+}
+
+void CXenonGPUNullAbstractLayer::SetBlendArg(const uint32 rtIndex, const XenonBlendArg colorSrc, const XenonBlendArg colorDest, const XenonBlendArg alphaSrc, const XenonBlendArg alphaDest)
+{
+	if (rtIndex >= ARRAYSIZE(m_blendState.m_targets))
+		return;
+
+	auto& target = m_blendState.m_targets[rtIndex];
+	target.m_colorSrc = colorSrc;
+	target.m_colorDest = colorDest;
+	target.m_alphaSrc = alphaSrc;
+	target.m_alphaDest = alphaDest;
+}
+
+void CXenonGPUNullAbstractLayer::SetBlendColor(const float r, const float g, const float b, const float a)
+{
+}
+
+bool CXenonGPUNullAbstractLayer::RealizeBlendState()
+{
+	m_stats.m_numStateChanges += 1;
+	m_stats.m_numStateLookups += 1;
+
+	m_blendStates.Get(m_stateCacheMode, m_blendState);
+
+	return true;
+}
+
+void CXenonGPUNullAbstractLayer::SetCullMode(const XenonCullMode cullMode)
+{
+	m_rasterState.m_cullMode = cullMode;
+}
+
+void CXenonGPUNullAbstractLayer::SetFillMode(const XenonFillMode fillMode)
+{
+	m_rasterState.m_fillMode = fillMode;
+}
+
+void CXenonGPUNullAbstractLayer::SetFaceMode(const XenonFrontFace faceMode)
+{
+	m_rasterState.m_faceMode = faceMode;
+}
+
+void CXenonGPUNullAbstractLayer::SetPrimitiveRestart(const bool isEnabled)
+{
+	m_rasterState.m_primitiveRestart = isEnabled;
+}
+
+void CXenonGPUNullAbstractLayer::SetPrimitiveRestartIndex(const uint32 index)
+{
+	m_rasterState.m_primitiveRestartIndex = index;
+}
+
+bool CXenonGPUNullAbstractLayer::RealizeRasterState()
+{
+	m_stats.m_numStateChanges += 1;
+	m_stats.m_numStateLookups += 1;
+
+	m_rasterStates.Get(m_stateCacheMode, m_rasterState);
+
+	return true;
+}
+
+CDX11MicrocodeShader* CXenonGPUNullAbstractLayer::DecodeShader(const XenonShaderType type, const void* microcode, const uint32 numWords)
+{
+	if (!microcode || !numWords)
+		return nullptr;
+
+	m_stats.m_numShaderBinds += 1;
+
+	const uint64 startTicks = GetTicks();
+
+	// swap data, same as the real layer
+	std::vector<uint32> words(numWords);
+	for (uint32 i = 0; i < numWords; ++i)
+		words[i] = _byteswap_ulong(((const uint32*)microcode)[i]);
+
+	// decompile and cache the microcode
+	CDX11MicrocodeShader* ret = nullptr;
+	if (type == XenonShaderType::ShaderPixel)
+		ret = m_microcodeCache->GetCachedPixelShader(words.data(), numWords * sizeof(uint32));
+	else
+		ret = m_microcodeCache->GetCachedVertexShader(words.data(), numWords * sizeof(uint32));
+
+	m_stats.m_shaderDecodeTicks += GetTicks() - startTicks;
+
+	// new shader
+	if (ret && m_knownShaders.insert(ret).second)
+		m_stats.m_numShadersDecoded += 1;
+
+	return ret;
+}
+
+void CXenonGPUNullAbstractLayer::SetPixelShader(const void* microcode, const uint32 numWords)
+{
+	m_pixelShader = DecodeShader(XenonShaderType::ShaderPixel, microcode, numWords);
+}
+
+void CXenonGPUNullAbstractLayer::SetVertexShader(const void* microcode, const uint32 numWords)
+{
+	m_vertexShader = DecodeShader(XenonShaderType::ShaderVertex, microcode, numWords);
+}
+
+void CXenonGPUNullAbstractLayer::SetPixelShaderConsts(const uint32 firstVector, const uint32 numVectors, const float* values)
+{
+	memcpy(&m_pixelShaderConsts[firstVector * 4], values, sizeof(float) * 4 * numVectors);
+}
+
+void CXenonGPUNullAbstractLayer::SetVertexShaderConsts(const uint32 firstVector, const uint32 numVectors, const float* values)
+{
+	memcpy(&m_vertexShaderConsts[firstVector * 4], values, sizeof(float) * 4 * numVectors);
+}
+
+void CXenonGPUNullAbstractLayer::SetBooleanConstants(const uint32* boolConstants)
+{
+	memcpy(m_booleanConsts, boolConstants, sizeof(m_booleanConsts));
+}
+
+bool CXenonGPUNullAbstractLayer::RealizeShaderConstants()
+{
+	return true;
+}
+
+bool CXenonGPUNullAbstractLayer::DrawGeometry(const class CXenonGPURegisters& regs, IXenonGPUDumpWriter* traceDump, const CXenonGPUState::DrawIndexState& ds)
+{
+	m_stats.m_numDraws += 1;
+	return true;
+}
+
+uint32 CXenonGPUNullAbstractLayer::GetActiveTextureFetchSlotMask() const
+{
+	uint32 mask = 0;
+
+	if (m_pixelShader)
+		mask |= m_pixelShader->GetTextureFetchSlotMask();
+
+	if (m_vertexShader)
+		mask |= m_vertexShader->GetTextureFetchSlotMask();
+
+	return mask;
+}
+
+void CXenonGPUNullAbstractLayer::SetTexture(const uint32 fetchSlot, const XenonTextureInfo* texture)
+{
+	if (!texture || !texture->m_address)
+		return;
+
+	m_stats.m_numTextureBinds += 1;
+
+	// hash the source data the same way the texture cache would to detect changes, the data is not decoded
+	const uint64 startTicks = GetTicks();
+	const uint32 realAddress = GPlatform.GetMemory().TranslatePhysicalAddress(texture->m_address);
+	const uint32 realMemorySize = texture->CalculateMemoryRegionSize();
+	const uint64 crc = XenonGPUCalcCRC64((const void*)(size_t)realAddress, realMemorySize);
+	m_stats.m_textureBytesHashed += realMemorySize;
+	m_stats.m_textureHashTicks += GetTicks() - startTicks;
+
+	// new texture content
+	if (m_knownTextures.insert(std::make_pair(texture->m_address, crc)).second)
+		m_stats.m_numTexturesHashed += 1;
+}
+
+void CXenonGPUNullAbstractLayer::SetSampler(const uint32 fetchSlot, const XenonSamplerInfo* sampler)
+{
+}
@@ -0,0 +1,280 @@
+#pragma once
+
+#include "xenonGPUAbstractLayer.h"
+#include "xenonGPUUtils.h"
+#include "xenonGPUHashMap.h"
+
+class CDX11MicrocodeCache;
+class CDX11MicrocodeShader;
+class CXenonGPUShaderStore;
+
+/// Headless abstract layer, nothing is rendered, no window and no device are created
+/// Shader microcode is still decompiled and texture data is still read and hashed (but not decoded) so the CPU side of the pipeline can be measured without a GPU
+class CXenonGPUNullAbstractLayer : public IXenonGPUAbstractLayer
+{
+public:
+	CXenonGPUNullAbstractLayer( CXenonGPUShaderStore* shaderStore );
+	~CXenonGPUNullAbstractLayer();
+
+	/// Collected stats
+	struct Stats
+	{
+		uint64		m_numFrames;			// number of swaps
+		uint64		m_numDraws;				// number of draw calls
+		uint64		m_numResolves;			// number of EDRAM resolves
+		uint64		m_numClears;			// number of clears
+		uint64		m_numStateChanges;		// number of realized render states
+		uint64		m_numStateLookups;		// number of depth/stencil, blend and raster states looked up in the state cache
+		uint64		m_numShaderBinds;		// number of shaders bound
+		uint64		m_numShadersDecoded;	// number of unique shaders decompiled
+		uint64		m_numTextureBinds;		// number of textures bound
+		uint64		m_numTexturesHashed;	// number of unique texture contents seen
+		uint64		m_textureBytesHashed;	// number of texture bytes read and hashed
+		uint64		m_shaderDecodeTicks;	// time spent decompiling the microcode, in performance counter ticks
+		uint64		m_textureHashTicks;		// time spent reading and hashing the texture data (it's not decoded), in performance counter ticks
+
+		Stats();
+	};
+
+	/// Get collected stats
+	inline const Stats& GetStats() const { return m_stats; }
+
+	/// Reset collected stats
+	void ResetStats();
+
+	/// Depth/stencil state as set by the draws, zero initialized and compared as a whole like the DX11 state descriptors (stencil ref is not part of it)
+	struct DepthStencilState
+	{
+		uint32			m_depthTest;
+		uint32			m_depthWrite;
+		XenonCmpFunc	m_depthFunc;
+		uint32			m_stencilTest;
+		uint32			m_stencilWriteMask;
+		uint32			m_stencilReadMask;
+		XenonCmpFunc	m_stencilFunc[2];		// back, front
+		XenonStencilOp	m_stencilOps[2][3];		// back, front: fail, depth fail, pass
+
+		DepthStencilState();
+	};
+
+	/// Blend state as set by the draws, zero initialized and compared as a whole like the DX11 state descriptors (blend color is not part of it)
+	struct BlendState
+	{
+		struct Target
+		{
+			uint32			m_enabled;
+			XenonBlendOp	m_colorOp;
+			XenonBlendOp	m_alphaOp;
+			XenonBlendArg	m_colorSrc;
+			XenonBlendArg	m_colorDest;
+			XenonBlendArg	m_alphaSrc;
+			XenonBlendArg	m_alphaDest;
+		};
+
+		Target			m_targets[4];
+
+		BlendState();
+	};
+
+	/// Raster state as set by the draws, zero initialized and compared as a whole like the DX11 state descriptors
+	struct RasterState
+	{
+		XenonCullMode	m_cullMode;
+		XenonFillMode	m_fillMode;
+		XenonFrontFace	m_faceMode;
+		uint32			m_primitiveRestart;
+		uint32			m_primitiveRestartIndex;
+
+		RasterState();
+	};
+
+	/// How the realized depth/stencil, blend and raster states are looked up, done like the DX11 state cache does it with the D3D descriptors
+	enum class StateCacheMode
+	{
+		None,			// states are only stored
+		OrderedMap,		// std::map keyed by the CRC and the whole state (previous implementation of the DX11 state cache, without the CRC aliasing)
+		FlatMap,		// flat hash map keyed by the whole state (current implementation of the DX11 state cache)
+	};
+
+	/// Set the state cache mode, the cached states are discarded
+	void SetStateCacheMode( const StateCacheMode mode );
+
+	/// Get number of unique states in the state cache
+	const uint32 GetNumCachedStates() const;
+
+	// interface
+	virtual bool Initialize() override final;
+	virtual bool SetDisplayMode( const uint32 width, const uint32 height ) override final;
+	virtual void BeingFrame() override final;
+	virtual void Swap( const CXenonGPUState::SwapState& ss ) override final;
+
+	// debugging
+	virtual void BeginEvent(const char* name) override final;
+	virtual void EndEvent() override final;
+
+	// RT&DS interface
+	virtual void BindColorRenderTarget( const uint32 index, const XenonColorRenderTargetFormat format, const XenonMsaaSamples msaa, const uint32 base, const uint32 pitch ) override final;
+	virtual void BindDepthStencil( const XenonDepthRenderTargetFormat format, const XenonMsaaSamples msaa, const uint32 base, const uint32 pitch ) override final;
+	virtual void UnbindColorRenderTarget( const uint32 index ) override final;
+	virtual void UnbindDepthStencil() override final;
+	virtual void SetColorRenderTargetWriteMask( const uint32 index, const bool enableRed, const bool enableGreen, const bool enableBlue, const bool enableAlpha ) override final;
+	virtual void ClearColorRenderTarget( const uint32 index, const float* clearColor, const bool flushToEDRAM ) override final;
+	virtual void ClearDepthStencilRenderTarget( const float depthClear, const uint32 stencilClear, const bool flushToEDRAM ) override final;
+	virtual bool ResolveColorRenderTarget( const uint32 srcIndex, const XenonColorRenderTargetFormat srcFormat, const uint32 srcBase, const XenonRect2D& srcRect, const uint32 destBase, const uint32 destLogicalWidth, const uint32 destLogicalHeight, const uint32 destBlockWidth, const uint32 destBlockHeight, const XenonTextureFormat destFormat, const XenonRect2D& destRect ) override final;
+	virtual bool ResolveDepthRenderTarget( const XenonDepthRenderTargetFormat srcFormat, const uint32 srcBase, const XenonRect2D& srcRect, const uint32 destBase, const uint32 destLogicalWidth, const uint32 destLogicalHeight, const uint32 destBlockWidth, const uint32 destBlockHeight, const XenonTextureFormat destFormat, const XenonRect2D& destRect ) override final;
+	virtual bool RealizeSurfaceSetup( uint32& outMainWidth,  uint32& outMainHeight ) override final;
+
+	// Viewport interface
+	virtual void SetViewportVertexFormat( const bool xyDivied, const bool zDivied, const bool wNotInverted ) override final;
+	virtual void SetViewportWindowScale( const bool bNormalizedXYCoordinates ) override final;
+	virtual void EnableScisor( const uint32 x, const uint32 y, const uint32 w, const uint32 h ) override final;
+	virtual void DisableScisor() override final;
+	virtual void SetViewportRange( const float x, const float y, const float w, const float h ) override final;
+	virtual void SetDepthRange( const float offset, const float scale ) override final;
+	virtual bool RealizeViewportSetup() override final;
+
+	// Depth/stencil state
+	virtual void SetDepthTest( const bool isEnabled ) override final;
+	virtual void SetDepthWrite( const bool isEnabled ) override final;
+	virtual void SetDepthFunc( const XenonCmpFunc func ) override final;
+	virtual void SetStencilTest( const bool isEnabled ) override final;
+	virtual void SetStencilWriteMask( const uint8 mask ) override final;
+	virtual void SetStencilReadMask( const uint8 mask ) override final;
+	virtual void SetStencilRef( const uint8 mask ) override final;
+	virtual void SetStencilFunc( const bool front, const XenonCmpFunc func ) override final;
+	virtual void SetStencilOps( const bool front, const XenonStencilOp sfail, const XenonStencilOp dfail, const XenonStencilOp dpass ) override final;
+	virtual bool RealizeDepthStencilState() override final;
+
+	// Blending
+	virtual void SetBlend( const uint32 rtIndex, const bool isEnabled ) override final;
+	virtual void SetBlendOp( const uint32 rtIndex, const XenonBlendOp colorOp, const XenonBlendOp alphaOp ) override final;
+	virtual void SetBlendArg( const uint32 rtIndex, const XenonBlendArg colorSrc, const XenonBlendArg colorDest, const XenonBlendArg alphaSrc, const XenonBlendArg alphaDest ) override final;
+	virtual void SetBlendColor( const float r, const float g, const float b, const float a ) override final;
+	virtual bool RealizeBlendState() override final;
+
+	// Raster
+	virtual void SetCullMode( const XenonCullMode cullMode ) override final;
+	virtual void SetFillMode( const XenonFillMode fillMode ) override final;
+	virtual void SetFaceMode( const XenonFrontFace faceMode ) override final;
+	virtual void SetPrimitiveRestart( const bool isEnabled ) override final;
+	virtual void SetPrimitiveRestartIndex( const uint32 index ) override final;
+	virtual bool RealizeRasterState() override final;
+
+	// Shader interface
+	virtual void SetPixelShader( const void* microcode, const uint32 numWords ) override final;
+	virtual void SetVertexShader( const void* microcode, const uint32 numWords ) override final;
+	virtual void SetPixelShaderConsts( const uint32 firstVector, const uint32 numVectors, const float* values ) override final;
+	virtual void SetVertexShaderConsts( const uint32 firstVector, const uint32 numVectors, const float* values ) override final;
+	virtual void SetBooleanConstants( const uint32* boolConstants ) override final;
+	virtual bool RealizeShaderConstants() override final;
+
+	// Geometry interface
+	virtual bool DrawGeometry( const class CXenonGPURegisters& regs, IXenonGPUDumpWriter* traceDump, const CXenonGPUState::DrawIndexState& ds ) override final;
+
+	// Textures
+	virtual uint32 GetActiveTextureFetchSlotMask() const override final;
+	virtual void SetTexture( const uint32 fetchSlot, const XenonTextureInfo* texture ) override final;
+	virtual void SetSampler(const uint32 fetchSlot, const XenonSamplerInfo* sampler) override final;
+
+private:
+	// microcode decompiler, same as the one used by the real layer
+	CDX11MicrocodeCache*		m_microcodeCache;
+
+	// currently bound shaders
+	CDX11MicrocodeShader*		m_pixelShader;
+	CDX11MicrocodeShader*		m_vertexShader;
+
+	// shaders already decompiled
+	typedef std::set< const CDX11MicrocodeShader* >	TShaderSet;
+	TShaderSet					m_knownShaders;
+
+	// texture data already read, key is (address, crc of the data)
+	typedef std::set< std::pair< uint32, uint64 > >	TTextureSet;
+	TTextureSet					m_knownTextures;
+
+	// cache of the state objects for one kind of render state, the state object is just an index
+	template< typename S >
+	class TStateCache
+	{
+	public:
+		TStateCache()
+			: m_numStates( 0 )
+		{}
+
+		inline const uint32 GetSize() const { return m_numStates; }
+
+		inline void Clear()
+		{
+			m_orderedMap.clear();
+			m_flatMap.Clear();
+			m_numStates = 0;
+		}
+
+		// get state object for given state, new one is created if the state was not seen yet
+		inline const uint32 Get( const StateCacheMode mode, const S& state )
+		{
+			if ( mode == StateCacheMode::OrderedMap )
+			{
+				OrderedKey key;
+				key.m_crc = XenonGPUCalcCRC( &state, sizeof(state) );
+				key.m_state = state;
+
+				auto it = m_orderedMap.find( key );
+				if ( it == m_orderedMap.end() )
+					it = m_orderedMap.insert( std::make_pair( key, ++m_numStates ) ).first;
+
+				return it->second;
+			}
+			else if ( mode == StateCacheMode::FlatMap )
+			{
+				const uint32* stateObject = m_flatMap.Find( state );
+				if ( stateObject )
+					return *stateObject;
+
+				m_flatMap.Insert( state, ++m_numStates );
+				return m_numStates;
+			}
+
+			return 0;
+		}
+
+	private:
+		// CRC first, the whole state decides when the CRCs are the same
+		struct OrderedKey
+		{
+			uint32		m_crc;
+			S			m_state;
+
+			inline const bool operator<( const OrderedKey& other ) const
+			{
+				if ( m_crc != other.m_crc )
+					return m_crc < other.m_crc;
+				return memcmp( &m_state, &other.m_state, sizeof(S) ) < 0;
+			}
+		};
+
+		std::map< OrderedKey, uint32 >		m_orderedMap;
+		TXenonGPUHashMap< S, uint32 >		m_flatMap;
+		uint32								m_numStates;
+	};
+
+	// render states, stored and looked up in the state cache if requested
+	DepthStencilState			m_depthStencilState;
+	BlendState					m_blendState;
+	RasterState					m_rasterState;
+
+	StateCacheMode						m_stateCacheMode;
+	TStateCache< DepthStencilState >	m_depthStencilStates;
+	TStateCache< BlendState >			m_blendStates;
+	TStateCache< RasterState >			m_rasterStates;
+
+	// shader constants, just stored
+	float						m_pixelShaderConsts[256*4];
+	float						m_vertexShaderConsts[256*4];
+	uint32						m_booleanConsts[8];
+
+	// stats
+	Stats						m_stats;
+
+	CDX11MicrocodeShader* DecodeShader( const XenonShaderType type, const void* microcode, const uint32 numWords );
+};
@@ -1,11 +1,43 @@
 #include "build.h"
 #include "xenonGPURegisters.h"
 
+#include <emmintrin.h>
+#include <intrin.h>
+
+//-----------
+
+CXenonGPURegisterGroup::CXenonGPURegisterGroup( std::initializer_list< XenonGPURegister > registers )
+	: m_numWords( 0 )
+{
+	for ( const auto reg : registers )
+	{
+		const uint32 index = (uint32) reg;
+		const uint32 word = index / 64;
+		const uint64 mask = 1ULL << (index & 63);
+
+		// add to existing word
+		uint32 i = 0;
+		while ( i < m_numWords && m_words[i] != word )
+			++i;
+
+		if ( i == m_numWords )
+		{
+			DEBUG_CHECK( m_numWords < MAX_WORDS );
+			m_words[ m_numWords ] = word;
+			m_masks[ m_numWords ] = 0;
+			m_numWords += 1;
+		}
+
+		m_masks[i] |= mask;
+	}
+}
+
 //-----------
 
 CXenonGPUDirtyRegisterTracker::CXenonGPUDirtyRegisterTracker()
 {
-	ClearAll();
+	memset( m_mask, 0, sizeof(m_mask) );
+	memset( m_dirtyWords, 0, sizeof(m_dirtyWords) );
 }
 
 CXenonGPUDirtyRegisterTracker::~CXenonGPUDirtyRegisterTracker()
@@ -14,12 +46,30 @@ CXenonGPUDirtyRegisterTracker::~CXenonGPUDirtyRegisterTracker()
 
 void CXenonGPUDirtyRegisterTracker::ClearAll()
 {
-	memset( m_mask, 0, sizeof(m_mask) );
+	// called after every draw, clear only the words that were modified
+	for ( uint32 i=0; i<ARRAYSIZE(m_dirtyWords); ++i )
+	{
+		uint64 dirtyWords = m_dirtyWords[i];
+		while ( dirtyWords )
+		{
+			unsigned long bit = 0;
+			_BitScanForward64( &bit, dirtyWords );
+			m_mask[ i*BIT_COUNT + bit ] = 0;
+			dirtyWords &= dirtyWords - 1;
+		}
+
+		m_dirtyWords[i] = 0;
+	}
 }
 
 void CXenonGPUDirtyRegisterTracker::SetAll()
 {
 	memset( m_mask, 0xFF, sizeof(m_mask) );
+
+	// mark only the existing words
+	memset( m_dirtyWords, 0, sizeof(m_dirtyWords) );
+	for ( uint32 i=0; i<NUM_WORDS; ++i )
+		m_dirtyWords[ i / BIT_COUNT ] |= 1ULL << (i & BIT_MASK);
 }
 
 //-----------
@@ -29,6 +79,40 @@ CXenonGPURegisters::CXenonGPURegisters()
 	memset( &m_values, 0, sizeof(m_values) );
 }
 
+void CXenonGPURegisters::WriteRange( const uint32 firstIndex, const uint32* data, const uint32 count, CXenonGPUDirtyRegisterTracker& dirtyMask )
+{
+	DEBUG_CHECK( firstIndex + count <= NUM_REGISTER_RAWS );
+
+	uint32* writePtr = &m_values[ firstIndex ].m_dword;
+
+	// 4 registers at a time, compare with the current values so we only dirty what has changed
+	uint32 i = 0;
+	for ( ; i + 4 <= count; i += 4 )
+	{
+		const __m128i newValues = _mm_loadu_si128( (const __m128i*)( data + i ) );
+		const __m128i oldValues = _mm_loadu_si128( (const __m128i*)( writePtr + i ) );
+		const uint32 sameMask = _mm_movemask_ps( _mm_castsi128_ps( _mm_cmpeq_epi32( newValues, oldValues ) ) );
+		if ( sameMask != 0xF )
+		{
+			_mm_storeu_si128( (__m128i*)( writePtr + i ), newValues );
+
+			for ( uint32 j = 0; j < 4; ++j )
+				if ( !( sameMask & (1 << j) ) )
+					dirtyMask.Set( firstIndex + i + j );
+		}
+	}
+
+	// tail
+	for ( ; i < count; ++i )
+	{
+		if ( writePtr[i] != data[i] )
+		{
+			writePtr[i] = data[i];
+			dirtyMask.Set( firstIndex + i );
+		}
+	}
+}
+
 const CXenonGPURegisters::Info& CXenonGPURegisters::GetInfo( const uint32 index )
 {
 	static Info RegInfo[ NUM_REGISTER_RAWS ];
@@ -11,6 +11,8 @@ enum class XenonGPURegister : uint32
 #undef DECLARE_XENON_GPU_REGISTER	
 };
 
+class CXenonGPUDirtyRegisterTracker;
+
 /// GPU Register map
 class CXenonGPURegisters
 {
@@ -54,11 +56,32 @@ public:
 	template< typename T >
 	inline const T& GetStructAt( const XenonGPURegister index ) const { return *( const T*) &m_values[(uint32)index]; }
 
+	// write a run of registers, only the registers that actually changed are marked as dirty
+	void WriteRange( const uint32 firstIndex, const uint32* data, const uint32 count, CXenonGPUDirtyRegisterTracker& dirtyMask );
+
 private:
 	Value	m_values[ NUM_REGISTER_RAWS ];
 };
 
+/// Group of registers that are checked for changes together (state block)
+/// Registers are stored as masks for the 64-bit words of the dirty tracker so the whole group is tested with few ANDs
+class CXenonGPURegisterGroup
+{
+public:
+	CXenonGPURegisterGroup( std::initializer_list< XenonGPURegister > registers );
+
+private:
+	friend class CXenonGPUDirtyRegisterTracker;
+
+	static const uint32 MAX_WORDS = 8;
+
+	uint32		m_numWords;
+	uint32		m_words[ MAX_WORDS ];
+	uint64		m_masks[ MAX_WORDS ];
+};
+
 /// Helper to track dirty registers
+/// Besides the per register bits we track which 64-bit words are dirty so clearing and scanning touches only the modified words
 class CXenonGPUDirtyRegisterTracker
 {
 public:
@@ -70,8 +93,17 @@ public:
 
 	inline void Set( const uint32 index )
 	{
-		const uint64 mask = 1ULL << (index & BIT_MASK);
-		m_mask[ index / BIT_COUNT ] |= mask;
+		const uint32 word = index / BIT_COUNT;
+		m_mask[ word ] |= 1ULL << (index & BIT_MASK);
+		m_dirtyWords[ word / BIT_COUNT ] |= 1ULL << (word & BIT_MASK);
+	}
+
+	inline bool IsAnyDirty( const CXenonGPURegisterGroup& group ) const
+	{
+		uint64 dirty = 0;
+		for ( uint32 i=0; i<group.m_numWords; ++i )
+			dirty |= m_mask[ group.m_words[i] ] & group.m_masks[i];
+		return 0 != dirty;
 	}
 
 	inline bool Get( const uint32 index ) const
@@ -86,6 +118,13 @@ public:
 		return m_mask[ firstIndex / BIT_COUNT ];
 	}
 
+	/// Get mask of modified 64-bit words for the 64 words (4096 registers) starting at given register
+	inline uint64 GetDirtyWords( const uint32 firstIndex ) const
+	{
+		DEBUG_CHECK( (firstIndex & (BIT_COUNT*BIT_COUNT-1)) == 0 );
+		return m_dirtyWords[ firstIndex / (BIT_COUNT*BIT_COUNT) ];
+	}
+
 	inline uint64 GetAndClear( const uint32 firstIndex )
 	{
 		DEBUG_CHECK( (firstIndex & BIT_MASK) == 0 );
@@ -98,8 +137,10 @@ private:
 	static const uint32 NUM_REGISTER_RAWS = CXenonGPURegisters::NUM_REGISTER_RAWS;
 	static const uint32 BIT_COUNT = 64;
 	static const uint32 BIT_MASK = BIT_COUNT-1;
+	static const uint32 NUM_WORDS = (NUM_REGISTER_RAWS+(BIT_COUNT-1)) / BIT_COUNT;
 
-	uint64		m_mask[ (NUM_REGISTER_RAWS+(BIT_COUNT-1)) / BIT_COUNT ];
+	uint64		m_mask[ NUM_WORDS ];
+	uint64		m_dirtyWords[ (NUM_WORDS+(BIT_COUNT-1)) / BIT_COUNT ];	// words of m_mask with any bit set
 };
 
 union XenonGPUVertexFetchData
@@ -0,0 +1,311 @@
+#include "build.h"
+#include "xenonGPUUtils.h"
+#include "xenonGPUShaderStore.h"
+
+#if defined(_WIN32)
+	#include <share.h>
+#else
+	#include <fcntl.h>
+	#include <sys/mman.h>
+	#include <sys/stat.h>
+#endif
+
+//----------------------
+
+const uint32 CXenonGPUShaderStore::FILE_MAGIC = ('X' << 24) | ('S' << 16) | ('H' << 8) | 'C'; // 'XSHC'
+const uint32 CXenonGPUShaderStore::FILE_VERSION = 1;
+
+CXenonGPUShaderStore::CXenonGPUShaderStore()
+	: m_mapping( NULL )
+	, m_mappedData( nullptr )
+	, m_mappedSize( 0 )
+	, m_file( nullptr )
+{
+}
+
+CXenonGPUShaderStore::~CXenonGPUShaderStore()
+{
+	Close();
+}
+
+bool CXenonGPUShaderStore::Open( const std::wstring& path )
+{
+	TScopeLock lock( m_lock );
+
+	// map existing content
+	const uint64 validSize = MapFile( path );
+	if ( !validSize )
+	{
+		// start with empty file
+		UnmapFile();
+		m_entries.clear();
+		if ( !CreateEmptyFile( path ) )
+			return false;
+
+		GLog.Log( "GPU: Created new shader store '%ls'", path.c_str() );
+		return true;
+	}
+
+	// the end of the file is damaged (crash during write), move the valid entries to memory and write them again
+	if ( validSize < m_mappedSize )
+	{
+		GLog.Warn( "GPU: Shader store '%ls' is damaged, %llu bytes will be discarded", path.c_str(), m_mappedSize - validSize );
+
+		for ( auto& it : m_entries )
+		{
+			const uint8* data = (const uint8*) it.second.m_data;
+			m_newData.push_back( std::vector< uint8 >( data, data + it.second.m_dataSize ) );
+			it.second.m_data = m_newData.back().data();
+		}
+
+		UnmapFile();
+		if ( !CreateEmptyFile( path ) )
+			return false;
+
+		for ( const auto& it : m_entries )
+			WriteEntry( it.second );
+	}
+	else
+	{
+		// append new entries to the existing file
+		m_file = _wfsopen( path.c_str(), L"ab", _SH_DENYNO );
+		if ( !m_file )
+		{
+			GLog.Err( "GPU: Failed to open shader store '%ls' for writing", path.c_str() );
+			return false;
+		}
+	}
+
+	GLog.Log( "GPU: Loaded %u entries from shader store '%ls'", (uint32) m_entries.size(), path.c_str() );
+	return true;
+}
+
+void CXenonGPUShaderStore::Close()
+{
+	TScopeLock lock( m_lock );
+
+	if ( m_file )
+	{
+		fclose( m_file );
+		m_file = nullptr;
+	}
+
+	m_entries.clear();
+	m_newData.clear();
+	UnmapFile();
+}
+
+bool CXenonGPUShaderStore::Find( const EntryType type, const uint64 hash, const uint32 contextHash, const uint32 version, Entry& outEntry ) const
+{
+	TScopeLock lock( m_lock );
+
+	Key key;
+	key.m_hash = hash;
+	key.m_contextHash = contextHash;
+	key.m_version = version;
+	key.m_type = type;
+
+	const auto it = m_entries.find( key );
+	if ( it == m_entries.end() )
+		return false;
+
+	outEntry = it->second;
+	return true;
+}
+
+void CXenonGPUShaderStore::Store( const EntryType type, const uint64 hash, const uint32 contextHash, const uint32 version, const void* data, const uint32 dataSize )
+{
+	TScopeLock lock( m_lock );
+
+	// store was not opened
+	if ( !m_file )
+		return;
+
+	Key key;
+	key.m_hash = hash;
+	key.m_contextHash = contextHash;
+	key.m_version = version;
+	key.m_type = type;
+
+	// already stored
+	if ( m_entries.find( key ) != m_entries.end() )
+		return;
+
+	// keep a copy of the data
+	const uint8* dataPtr = (const uint8*) data;
+	m_newData.push_back( std::vector< uint8 >( dataPtr, dataPtr + dataSize ) );
+
+	Entry entry;
+	entry.m_type = type;
+	entry.m_hash = hash;
+	entry.m_contextHash = contextHash;
+	entry.m_version = version;
+	entry.m_data = m_newData.back().data();
+	entry.m_dataSize = dataSize;
+	m_entries[ key ] = entry;
+
+	// save
+	WriteEntry( entry );
+}
+
+void CXenonGPUShaderStore::GetEntries( const EntryType type, std::vector< Entry >& outEntries ) const
+{
+	TScopeLock lock( m_lock );
+
+	for ( const auto& it : m_entries )
+	{
+		if ( it.second.m_type == type )
+			outEntries.push_back( it.second );
+	}
+}
+
+uint64 CXenonGPUShaderStore::MapFile( const std::wstring& path )
+{
+#if defined(_WIN32)
+	// open existing file, writing must be allowed since we append to it later
+	HANDLE file = ::CreateFileW( path.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL );
+	if ( file == INVALID_HANDLE_VALUE )
+		return 0;
+
+	LARGE_INTEGER fileSize;
+	if ( !GetFileSizeEx( file, &fileSize ) || fileSize.QuadPart < sizeof(FileHeader) )
+	{
+		CloseHandle( file );
+		return 0;
+	}
+
+	// map the whole file, the mapping keeps the file opened
+	m_mapping = CreateFileMappingW( file, NULL, PAGE_READONLY, 0, 0, NULL );
+	CloseHandle( file );
+	if ( !m_mapping )
+		return 0;
+
+	m_mappedData = (const uint8*) MapViewOfFile( m_mapping, FILE_MAP_READ, 0, 0, 0 );
+	if ( !m_mappedData )
+		return 0;
+
+	m_mappedSize = fileSize.QuadPart;
+#else
+	// same on other hosts, the mapping does not need the descriptor
+	const int file = open( launcher::UnicodeToAnsi( path ).c_str(), O_RDONLY );
+	if ( file < 0 )
+		return 0;
+
+	struct stat fileInfo;
+	if ( fstat( file, &fileInfo ) != 0 || (uint64) fileInfo.st_size < sizeof(FileHeader) )
+	{
+		close( file );
+		return 0;
+	}
+
+	void* mappedData = mmap( NULL, (size_t) fileInfo.st_size, PROT_READ, MAP_PRIVATE, file, 0 );
+	close( file );
+	if ( mappedData == MAP_FAILED )
+		return 0;
+
+	m_mappedData = (const uint8*) mappedData;
+	m_mappedSize = (uint64) fileInfo.st_size;
+#endif
+
+	// validate header
+	const FileHeader* header = (const FileHeader*) m_mappedData;
+	if ( header->m_magic != FILE_MAGIC )
+	{
+		GLog.Warn( "GPU: Invalid shader store '%ls', it will be recreated", path.c_str() );
+		return 0;
+	}
+	if ( header->m_version != FILE_VERSION )
+	{
+		GLog.Warn( "GPU: Shader store '%ls' has unsupported version (%d), it will be recreated", path.c_str(), header->m_version );
+		return 0;
+	}
+
+	// index entries, stop on first invalid one
+	uint64 offset = sizeof(FileHeader);
+	while ( offset + sizeof(EntryHeader) <= m_mappedSize )
+	{
+		const EntryHeader* entryHeader = (const EntryHeader*)( m_mappedData + offset );
+		const uint64 entrySize = sizeof(EntryHeader) + entryHeader->m_dataSize;
+		if ( offset + entrySize > m_mappedSize )
+			break;
+
+		const uint8* data = m_mappedData + offset + sizeof(EntryHeader);
+		if ( entryHeader->m_type > (uint32) EntryType::VertexBinary || XenonGPUCalcCRC( data, entryHeader->m_dataSize ) != entryHeader->m_dataCRC )
+			break;
+
+		Key key;
+		key.m_hash = entryHeader->m_hash;
+		key.m_contextHash = entryHeader->m_contextHash;
+		key.m_version = entryHeader->m_version;
+		key.m_type = (EntryType) entryHeader->m_type;
+
+		Entry& entry = m_entries[ key ];
+		entry.m_type = key.m_type;
+		entry.m_hash = key.m_hash;
+		entry.m_contextHash = key.m_contextHash;
+		entry.m_version = key.m_version;
+		entry.m_data = data;
+		entry.m_dataSize = entryHeader->m_dataSize;
+
+		offset += entrySize;
+	}
+
+	return offset;
+}
+
+void CXenonGPUShaderStore::UnmapFile()
+{
+	if ( m_mappedData )
+	{
+#if defined(_WIN32)
+		UnmapViewOfFile( m_mappedData );
+#else
+		munmap( (void*) m_mappedData, (size_t) m_mappedSize );
+#endif
+		m_mappedData = nullptr;
+	}
+
+#if defined(_WIN32)
+	if ( m_mapping )
+	{
+		CloseHandle( m_mapping );
+		m_mapping = NULL;
+	}
+#endif
+
+	m_mappedSize = 0;
+}
+
+bool CXenonGPUShaderStore::CreateEmptyFile( const std::wstring& path )
+{
+	m_file = _wfsopen( path.c_str(), L"wb", _SH_DENYNO );
+	if ( !m_file )
+	{
+		GLog.Err( "GPU: Failed to create shader store '%ls'", path.c_str() );
+		return false;
+	}
+
+	FileHeader header;
+	header.m_magic = FILE_MAGIC;
+	header.m_version = FILE_VERSION;
+	fwrite( &header, sizeof(header), 1, m_file );
+	fflush( m_file );
+	return true;
+}
+
+void CXenonGPUShaderStore::WriteEntry( const Entry& entry )
+{
+	EntryHeader header;
+	header.m_type = (uint32) entry.m_type;
+	header.m_dataSize = entry.m_dataSize;
+	header.m_hash = entry.m_hash;
+	header.m_contextHash = entry.m_contextHash;
+	header.m_version = entry.m_version;
+	header.m_dataCRC = XenonGPUCalcCRC( entry.m_data, entry.m_dataSize );
+
+	fwrite( &header, sizeof(header), 1, m_file );
+	fwrite( entry.m_data, entry.m_dataSize, 1, m_file );
+
+	// make sure the entry survives a crash
+	fflush( m_file );
+}
@@ -0,0 +1,119 @@
+#pragma once
+
+/// Persistent on-disk storage for the shader data
+/// Keeps the microcode of every shader seen by the GPU and the backend specific compiled code of the translated shaders
+/// Existing entries are memory mapped when the store is opened, new entries are appended to the end of the file
+class CXenonGPUShaderStore
+{
+public:
+	/// Type of stored data
+	enum class EntryType : uint32
+	{
+		PixelMicrocode = 0,		// swapped pixel shader microcode
+		VertexMicrocode = 1,	// swapped vertex shader microcode
+		PixelBinary = 2,		// compiled pixel shader (backend specific)
+		VertexBinary = 3,		// compiled vertex shader (backend specific)
+	};
+
+	/// Stored entry
+	struct Entry
+	{
+		EntryType		m_type;			// type of the data
+		uint64			m_hash;			// microcode hash
+		uint32			m_contextHash;	// backend specific drawing context hash (binaries only)
+		uint32			m_version;		// backend specific translator version (binaries only)
+		const void*		m_data;			// stored data, valid as long as the store is opened
+		uint32			m_dataSize;		// size of the stored data
+	};
+
+	CXenonGPUShaderStore();
+	~CXenonGPUShaderStore();
+
+	/// Open the store file, file is created if missing
+	bool Open( const std::wstring& path );
+
+	/// Close the store
+	void Close();
+
+	/// Find stored entry
+	bool Find( const EntryType type, const uint64 hash, const uint32 contextHash, const uint32 version, Entry& outEntry ) const;
+
+	/// Store new entry, ignored if already stored
+	void Store( const EntryType type, const uint64 hash, const uint32 contextHash, const uint32 version, const void* data, const uint32 dataSize );
+
+	/// Get all stored entries of given type
+	void GetEntries( const EntryType type, std::vector< Entry >& outEntries ) const;
+
+private:
+	static const uint32 FILE_MAGIC;
+	static const uint32 FILE_VERSION;
+
+#pragma pack( push, 4 )
+	struct FileHeader
+	{
+		uint32		m_magic;		// file magic number
+		uint32		m_version;		// file version number
+	};
+
+	struct EntryHeader
+	{
+		uint32		m_type;			// EntryType
+		uint32		m_dataSize;		// size of the data following the header
+		uint64		m_hash;			// microcode hash
+		uint32		m_contextHash;	// drawing context hash
+		uint32		m_version;		// translator version
+		uint32		m_dataCRC;		// CRC of the data, detects partially written entries
+	};
+#pragma pack( pop )
+
+	// entry key
+	struct Key
+	{
+		uint64		m_hash;
+		uint32		m_contextHash;
+		uint32		m_version;
+		EntryType	m_type;
+
+		inline const bool operator<( const Key& other ) const
+		{
+			if ( m_hash != other.m_hash )
+				return m_hash < other.m_hash;
+			if ( m_contextHash != other.m_contextHash )
+				return m_contextHash < other.m_contextHash;
+			if ( m_version != other.m_version )
+				return m_version < other.m_version;
+			return m_type < other.m_type;
+		}
+	};
+
+	typedef std::map< Key, Entry >	TEntries;
+	TEntries					m_entries;
+
+	// mapped file content
+	HANDLE						m_mapping;
+	const uint8*				m_mappedData;
+	uint64						m_mappedSize;
+
+	// file for appending new entries
+	FILE*						m_file;
+
+	// data of the entries added in this session
+	std::deque< std::vector< uint8 > >	m_newData;
+
+	// access lock
+	typedef std::mutex					TLock;
+	typedef std::lock_guard<TLock>		TScopeLock;
+	mutable TLock				m_lock;
+
+	// map existing file, returns size of the valid content (0 if the file is not valid)
+	uint64 MapFile( const std::wstring& path );
+
+	// unmap the file content
+	void UnmapFile();
+
+	// create new empty file and open it for appending
+	bool CreateEmptyFile( const std::wstring& path );
+
+	// append entry to the file
+	void WriteEntry( const Entry& entry );
+};
@@ -0,0 +1,277 @@
+// Platform subset for the standalone GPU build (XENON_GPU_STANDALONE), not part of the launcher project
+#include "build.h"
+
+#include <condition_variable>
+
+#if !defined(_WIN32)
+	#include <sys/mman.h>
+#endif
+
+//---------------------------------------------------------------------------
+
+namespace launcher
+{
+	OutputTTY::OutputTTY()
+		: m_bVerboseMode(false)
+	{
+	}
+
+	OutputTTY& OutputTTY::GetInstance()
+	{
+		static OutputTTY theInstance;
+		return theInstance;
+	}
+
+	void OutputTTY::SetVerboseMode(const bool bVerboseMode)
+	{
+		m_bVerboseMode = bVerboseMode;
+	}
+
+	void OutputTTY::DoWrite(FILE* f, const char* prefix, const char* txt, va_list args)
+	{
+		char buffer[4096];
+		vsnprintf(buffer, sizeof(buffer), txt, args);
+
+		std::lock_guard<std::mutex> lock(m_outputLock);
+		fprintf(f, "%s%s\n", prefix, buffer);
+	}
+
+	void OutputTTY::Spam(const char* txt, ...)
+	{
+		if (!m_bVerboseMode)
+			return;
+
+		va_list args;
+		va_start(args, txt);
+		DoWrite(stdout, "", txt, args);
+		va_end(args);
+	}
+
+	void OutputTTY::Log(const char* txt, ...)
+	{
+		va_list args;
+		va_start(args, txt);
+		DoWrite(stdout, "", txt, args);
+		va_end(args);
+	}
+
+	void OutputTTY::Warn(const char* txt, ...)
+	{
+		va_list args;
+		va_start(args, txt);
+		DoWrite(stdout, "Warning: ", txt, args);
+		va_end(args);
+	}
+
+	void OutputTTY::Err(const char* txt, ...)
+	{
+		va_list args;
+		va_start(args, txt);
+		DoWrite(stderr, "Error: ", txt, args);
+		va_end(args);
+	}
+
+	std::string UnicodeToAnsi(const std::wstring& src)
+	{
+		std::string ret;
+		ret.reserve(src.length());
+
+		for (const wchar_t ch : src)
+		{
+			const uint32 code = (uint32)ch;
+			if (code < 0x80)
+			{
+				ret.push_back((char)code);
+			}
+			else if (code < 0x800)
+			{
+				ret.push_back((char)(0xC0 | (code >> 6)));
+				ret.push_back((char)(0x80 | (code & 0x3F)));
+			}
+			else if (code < 0x10000)
+			{
+				ret.push_back((char)(0xE0 | (code >> 12)));
+				ret.push_back((char)(0x80 | ((code >> 6) & 0x3F)));
+				ret.push_back((char)(0x80 | (code & 0x3F)));
+			}
+			else
+			{
+				ret.push_back((char)(0xF0 | (code >> 18)));
+				ret.push_back((char)(0x80 | ((code >> 12) & 0x3F)));
+				ret.push_back((char)(0x80 | ((code >> 6) & 0x3F)));
+				ret.push_back((char)(0x80 | (code & 0x3F)));
+			}
+		}
+
+		return ret;
+	}
+
+	std::wstring AnsiToUnicode(const std::string& src)
+	{
+		std::wstring ret;
+		ret.reserve(src.length());
+
+		for (size_t i = 0; i < src.length(); )
+		{
+			const uint8 ch = (uint8)src[i];
+			uint32 code = ch;
+			uint32 extra = 0;
+			if (ch >= 0xF0) { code = ch & 0x07; extra = 3; }
+			else if (ch >= 0xE0) { code = ch & 0x0F; extra = 2; }
+			else if (ch >= 0xC0) { code = ch & 0x1F; extra = 1; }
+
+			++i;
+			for (uint32 j = 0; j < extra && i < src.length(); ++j, ++i)
+				code = (code << 6) | ((uint8)src[i] & 0x3F);
+
+			ret.push_back((wchar_t)code);
+		}
+
+		return ret;
+	}
+
+} // launcher
+
+//---------------------------------------------------------------------------
+
+#if !defined(_WIN32)
+
+int _wfopen_s(FILE** outFile, const wchar_t* path, const wchar_t* mode)
+{
+	*outFile = fopen(launcher::UnicodeToAnsi(path).c_str(), launcher::UnicodeToAnsi(mode).c_str());
+	return *outFile ? 0 : 1;
+}
+
+FILE* _wfsopen(const wchar_t* path, const wchar_t* mode, const int shareFlags)
+{
+	FILE* f = nullptr;
+	_wfopen_s(&f, path, mode);
+	return f;
+}
+
+int DeleteFileW(const wchar_t* path)
+{
+	return 0 == unlink(launcher::UnicodeToAnsi(path).c_str());
+}
+
+namespace Helper
+{
+	struct Event
+	{
+		std::mutex				m_lock;
+		std::condition_variable	m_cond;
+		bool					m_signaled;
+	};
+}
+
+HANDLE CreateEventA(void* attributes, const int manualReset, const int initialState, const char* name)
+{
+	auto* ret = new Helper::Event();
+	ret->m_signaled = (initialState != 0);
+	return ret;
+}
+
+int SetEvent(HANDLE event)
+{
+	auto* ev = (Helper::Event*)event;
+	{
+		std::lock_guard<std::mutex> lock(ev->m_lock);
+		ev->m_signaled = true;
+	}
+	ev->m_cond.notify_one();
+	return 1;
+}
+
+uint32 WaitForSingleObject(HANDLE event, const uint32 timeoutMs)
+{
+	auto* ev = (Helper::Event*)event;
+	std::unique_lock<std::mutex> lock(ev->m_lock);
+
+	if (timeoutMs == INFINITE)
+		ev->m_cond.wait(lock, [ev] { return ev->m_signaled; });
+	else if (!ev->m_cond.wait_for(lock, std::chrono::milliseconds(timeoutMs), [ev] { return ev->m_signaled; }))
+		return 258; // WAIT_TIMEOUT
+
+	// auto reset
+	ev->m_signaled = false;
+	return 0;
+}
+
+int CloseHandle(HANDLE event)
+{
+	delete (Helper::Event*)event;
+	return 1;
+}
+
+#endif
+
+//---------------------------------------------------------------------------
+
+namespace xenon
+{
+	Memory::Memory()
+		: m_base(nullptr)
+		, m_size(0)
+	{
+	}
+
+	Memory::~Memory()
+	{
+		if (m_base)
+		{
+#if defined(_WIN32)
+			VirtualFree(m_base, 0, MEM_RELEASE);
+#else
+			munmap(m_base, m_size);
+#endif
+			m_base = nullptr;
+		}
+	}
+
+	const bool Memory::Initialize(const uint32 base, const uint32 size)
+	{
+		// guest pointers are 32-bit, the memory must be placed exactly where it was in the launcher
+#if defined(_WIN32)
+		void* ptr = VirtualAlloc((void*)(size_t)base, size, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE);
+#else
+		void* ptr = mmap((void*)(size_t)base, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE | MAP_FIXED_NOREPLACE, -1, 0);
+		if (ptr == MAP_FAILED)
+			ptr = nullptr;
+#endif
+		if (ptr != (void*)(size_t)base)
+		{
+			GLog.Err("Memory: Unable to map %u MB of physical memory at 0x%08X", size >> 20, base);
+			return false;
+		}
+
+		m_base = ptr;
+		m_size = size;
+		GLog.Log("Memory: Mapped %u MB of physical memory at 0x%08X", size >> 20, base);
+		return true;
+	}
+
+	const uint32 Memory::TranslatePhysicalAddress(const uint32 localAddress) const
+	{
+		const uint32 physicalMemoryAddrMask = 0x1FFFFFFF;
+		return (uint32)(size_t)m_base + (localAddress & physicalMemoryAddrMask);
+	}
+
+	const bool Memory::Contains(const uint32 address, const uint32 size) const
+	{
+		const uint64 base = (uint64)(size_t)m_base;
+		return m_base && (address >= base) && ((uint64)address + size <= base + m_size);
+	}
+
+	//--
+
+	Kernel::Kernel()
+		: m_numInterrupts(0)
+	{
+	}
+
+	void Kernel::ExecuteInterrupt(const uint32 cpuIndex, const uint32 callback, const uint64* args, const uint32 numArgs, const char* name)
+	{
+		m_numInterrupts += 1;
+	}
+
+} // xenon
@@ -0,0 +1,269 @@
+#pragma once
+
+// Configuration used when the GPU command processor is compiled without the rest of the platform (XENON_GPU_STANDALONE)
+// Used by the GPU dump replay tool and the GPU tests, they run on any host, no kernel, CPU or window is created
+// Only the small part of the platform touched by the GPU code is provided here: guest memory, interrupts and logging
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdarg.h>
+#include <stdint.h>
+#include <string.h>
+#include <cstring>
+#include <cmath>
+#include <math.h>
+#include <float.h>
+#include <time.h>
+
+#include <vector>
+#include <string>
+#include <deque>
+#include <map>
+#include <set>
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <chrono>
+#include <fstream>
+#include <unordered_map>
+
+#if defined(_WIN32)
+	#include <Windows.h>
+	#include <intrin.h>
+#else
+	#include <x86intrin.h>
+	#include <unistd.h>
+	#include <sched.h>
+#endif
+
+//---------------------------------------------------------------------------
+
+#define LAUNCHER_API
+
+typedef unsigned char uint8;
+typedef unsigned short uint16;
+typedef unsigned int uint32;
+typedef unsigned long long uint64;
+
+typedef char int8;
+typedef short int16;
+typedef int int32;
+typedef long long int64;
+
+//---------------------------------------------------------------------------
+
+#if !defined(_WIN32)
+
+// MSVC/Win32 API subset used by the GPU code
+#define __forceinline inline __attribute__((always_inline))
+#define ARRAYSIZE(x) (sizeof(x) / sizeof(x[0]))
+
+static inline uint16 _byteswap_ushort(const uint16 x) { return __builtin_bswap16(x); }
+static inline uint32 _byteswap_ulong(const uint32 x) { return __builtin_bswap32(x); }
+static inline uint64 _byteswap_uint64(const uint64 x) { return __builtin_bswap64(x); }
+
+typedef union _LARGE_INTEGER { struct { uint32 LowPart; int32 HighPart; }; long long QuadPart; } LARGE_INTEGER;
+
+static inline int QueryPerformanceCounter(LARGE_INTEGER* value) { timespec ts; clock_gettime(CLOCK_MONOTONIC, &ts); value->QuadPart = (long long)ts.tv_sec * 1000000000LL + ts.tv_nsec; return 1; }
+static inline int QueryPerformanceFrequency(LARGE_INTEGER* value) { value->QuadPart = 1000000000LL; return 1; }
+static inline void Sleep(const uint32 ms) { usleep(ms * 1000); }
+static inline void DebugBreak() { __builtin_trap(); }
+static inline void YieldProcessor() { _mm_pause(); }
+static inline void SwitchToThread() { sched_yield(); }
+static inline void MemoryBarrier() { __sync_synchronize(); }
+
+static inline uint32 __lzcnt(const uint32 x) { return x ? __builtin_clz(x) : 32; }
+static inline unsigned char _BitScanForward64(unsigned long* index, const uint64 mask) { if (!mask) return 0; *index = __builtin_ctzll(mask); return 1; }
+
+typedef void* HANDLE;
+
+// auto reset events only
+#define FALSE 0
+#define TRUE 1
+#define INFINITE 0xFFFFFFFF
+extern HANDLE CreateEventA(void* attributes, const int manualReset, const int initialState, const char* name);
+extern int SetEvent(HANDLE event);
+extern uint32 WaitForSingleObject(HANDLE event, const uint32 timeoutMs);
+extern int CloseHandle(HANDLE event);
+
+// secure CRT variants
+static inline int strcpy_s(char* dest, const size_t size, const char* src) { snprintf(dest, size, "%s", src); return 0; }
+static inline int strncpy_s(char* dest, const size_t size, const char* src, const size_t count) { snprintf(dest, size, "%.*s", (int)count, src); return 0; }
+static inline int vsprintf_s(char* buf, const size_t size, const char* txt, va_list args) { return vsnprintf(buf, size, txt, args); }
+static inline int _vscprintf(const char* txt, va_list args) { va_list copy; va_copy(copy, args); const int ret = vsnprintf(nullptr, 0, txt, copy); va_end(copy); return ret; }
+static inline int localtime_s(struct tm* outTime, const time_t* time) { return localtime_r(time, outTime) ? 0 : 1; }
+template< size_t N > static inline int strcpy_s(char (&dest)[N], const char* src) { return strcpy_s(dest, N, src); }
+template< size_t N > static inline int strncpy_s(char (&dest)[N], const char* src, const size_t count) { return strncpy_s(dest, N, src, count); }
+template< size_t N > static inline int vsprintf_s(char (&buf)[N], const char* txt, va_list args) { return vsprintf_s(buf, N, txt, args); }
+template< typename... Args > static inline int swprintf_s(wchar_t* buf, const size_t size, const wchar_t* txt, Args... args) { return swprintf(buf, size, txt, args...); }
+template< size_t N, typename... Args > static inline int swprintf_s(wchar_t (&buf)[N], const wchar_t* txt, Args... args) { return swprintf(buf, N, txt, args...); }
+
+// file paths are converted to UTF-8
+#define _SH_DENYNO 0
+extern int _wfopen_s(FILE** outFile, const wchar_t* path, const wchar_t* mode);
+extern FILE* _wfsopen(const wchar_t* path, const wchar_t* mode, const int shareFlags);
+extern int DeleteFileW(const wchar_t* path);
+static inline int _fseeki64(FILE* f, const int64 offset, const int origin) { return fseeko(f, offset, origin); }
+static inline int64 _ftelli64(FILE* f) { return ftello(f); }
+
+#endif
+
+//---------------------------------------------------------------------------
+
+namespace launcher
+{
+	/// Console output, same interface as the launcher output
+	class OutputTTY
+	{
+	public:
+		static OutputTTY& GetInstance();
+
+		void SetVerboseMode(const bool bVerboseMode);
+
+		void Spam(const char* txt, ...);
+		void Log(const char* txt, ...);
+		void Warn(const char* txt, ...);
+		void Err(const char* txt, ...);
+
+	private:
+		OutputTTY();
+
+		std::mutex	m_outputLock;
+		bool		m_bVerboseMode;
+
+		void DoWrite(FILE* f, const char* prefix, const char* txt, va_list args);
+	};
+
+	/// Convert path to UTF-8
+	extern std::string UnicodeToAnsi(const std::wstring& src);
+
+	/// Convert path from UTF-8
+	extern std::wstring AnsiToUnicode(const std::string& src);
+
+} // launcher
+
+#define GLog launcher::OutputTTY::GetInstance()
+
+#define DEBUG_CHECK(x) if (!(x)) { GLog.Err( "Debug check failed, %s(%d)", __FILE__, __LINE__ ); GLog.Err( #x ); DebugBreak(); }
+
+//---------------------------------------------------------------------------
+
+namespace cpu
+{
+	namespace mem
+	{
+		// guest memory is big endian
+		template< typename T >
+		static inline T swap(const T& val)
+		{
+			static_assert(sizeof(T) == 1 || sizeof(T) == 2 || sizeof(T) == 4 || sizeof(T) == 8, "Unsupported access size");
+
+			T ret;
+			if (sizeof(T) == 2)
+			{
+				uint16 data;
+				memcpy(&data, &val, sizeof(data));
+				data = _byteswap_ushort(data);
+				memcpy(&ret, &data, sizeof(data));
+			}
+			else if (sizeof(T) == 4)
+			{
+				uint32 data;
+				memcpy(&data, &val, sizeof(data));
+				data = _byteswap_ulong(data);
+				memcpy(&ret, &data, sizeof(data));
+			}
+			else if (sizeof(T) == 8)
+			{
+				uint64 data;
+				memcpy(&data, &val, sizeof(data));
+				data = _byteswap_uint64(data);
+				memcpy(&ret, &data, sizeof(data));
+			}
+			else
+			{
+				ret = val;
+			}
+			return ret;
+		}
+
+		template< typename T >
+		static inline T load(const void* ptr)
+		{
+			return swap(*(const T*)ptr);
+		}
+
+		template< typename T >
+		static inline void storeAddr(const uint32 addr, const T& val)
+		{
+			*(T*)(size_t)addr = swap(val);
+		}
+
+	} // mem
+} // cpu
+
+//---------------------------------------------------------------------------
+
+namespace xenon
+{
+	/// Guest memory, the physical memory is mapped at the same host address as in the launcher so the dumped addresses can be used directly
+	class Memory
+	{
+	public:
+		Memory();
+		~Memory();
+
+		// map the physical memory at given host address
+		const bool Initialize(const uint32 base, const uint32 size);
+
+		// translate GPU physical address to the host address
+		const uint32 TranslatePhysicalAddress(const uint32 localAddress) const;
+
+		// is the given host memory range mapped ?
+		const bool Contains(const uint32 address, const uint32 size) const;
+
+	private:
+		void*		m_base;
+		uint32		m_size;
+	};
+
+	/// Interrupts are not delivered anywhere, only counted
+	class Kernel
+	{
+	public:
+		Kernel();
+
+		void ExecuteInterrupt(const uint32 cpuIndex, const uint32 callback, const uint64* args, const uint32 numArgs, const char* name = "IRQ");
+
+		inline const uint64 GetNumInterrupts() const { return m_numInterrupts; }
+
+	private:
+		std::atomic<uint64>		m_numInterrupts;
+	};
+
+	/// Platform subset visible to the GPU
+	class Platform
+	{
+	public:
+		inline Memory& GetMemory() { return m_memory; }
+		inline Kernel& GetKernel() { return m_kernel; }
+
+	private:
+		Memory		m_memory;
+		Kernel		m_kernel;
+	};
+
+	// memory tracing is not available, ignored
+	static inline void TagMemoryWrite(const uint64 addr, const uint32 size, const char* txt, ...) {}
+
+} // xenon
+
+extern xenon::Platform GPlatform;
+
+#define TAG_MEMORY_WRITE_PTR(data, size)
+#define TAG_MEMORY_WRITE_ADDR(addr, size)
+
+//---------------------------------------------------------------------------
+
+#include "xenonUtils.h"
@@ -1,10 +1,10 @@
 #include "build.h"
-#include "xenonLibNatives.h"
 #include "xenonGPUUtils.h"
 #include "xenonGPUState.h"
 #include "xenonGPUAbstractLayer.h"
 #include "xenonGPURegisters.h"
-#include <xutility>
+#include <algorithm>
+#include <intrin.h>
 #include "xenonGPUTextures.h"
 #include "xenonGPUDumpWriter.h"
 
@@ -88,16 +88,57 @@ namespace Helper
 		return XenonTextureFormat::Format_Unknown;
 	}
 
+	// registers of the state blocks, must match the registers read by the Update*State functions
+	static const CXenonGPURegisterGroup RenderTargetRegisters( {
+		XenonGPURegister::REG_RB_MODECONTROL, XenonGPURegister::REG_RB_SURFACE_INFO,
+		XenonGPURegister::REG_RB_COLOR_INFO, XenonGPURegister::REG_RB_COLOR1_INFO, XenonGPURegister::REG_RB_COLOR2_INFO, XenonGPURegister::REG_RB_COLOR3_INFO,
+		XenonGPURegister::REG_RB_COLOR_MASK, XenonGPURegister::REG_RB_DEPTHCONTROL, XenonGPURegister::REG_RB_STENCILREFMASK, XenonGPURegister::REG_RB_DEPTH_INFO } );
+
+	static const CXenonGPURegisterGroup ViewportRegisters( {
+		XenonGPURegister::REG_RB_SURFACE_INFO, XenonGPURegister::REG_PA_CL_VTE_CNTL, XenonGPURegister::REG_PA_SU_SC_MODE_CNTL,
+		XenonGPURegister::REG_PA_SC_WINDOW_OFFSET, XenonGPURegister::REG_PA_SC_WINDOW_SCISSOR_TL, XenonGPURegister::REG_PA_SC_WINDOW_SCISSOR_BR,
+		XenonGPURegister::REG_PA_CL_VPORT_XOFFSET, XenonGPURegister::REG_PA_CL_VPORT_YOFFSET, XenonGPURegister::REG_PA_CL_VPORT_ZOFFSET,
+		XenonGPURegister::REG_PA_CL_VPORT_XSCALE, XenonGPURegister::REG_PA_CL_VPORT_YSCALE, XenonGPURegister::REG_PA_CL_VPORT_ZSCALE } );
+
+	static const CXenonGPURegisterGroup RasterRegisters( {
+		XenonGPURegister::REG_PA_SU_SC_MODE_CNTL, XenonGPURegister::REG_PA_SC_SCREEN_SCISSOR_TL, XenonGPURegister::REG_PA_SC_SCREEN_SCISSOR_BR,
+		XenonGPURegister::REG_VGT_MULTI_PRIM_IB_RESET_INDX } );
+
+	static const CXenonGPURegisterGroup BlendRegisters( {
+		XenonGPURegister::REG_RB_BLENDCONTROL_0, XenonGPURegister::REG_RB_BLENDCONTROL_1, XenonGPURegister::REG_RB_BLENDCONTROL_2, XenonGPURegister::REG_RB_BLENDCONTROL_3,
+		XenonGPURegister::REG_RB_BLEND_RED, XenonGPURegister::REG_RB_BLEND_GREEN, XenonGPURegister::REG_RB_BLEND_BLUE, XenonGPURegister::REG_RB_BLEND_ALPHA } );
+
+	static const CXenonGPURegisterGroup DepthRegisters( {
+		XenonGPURegister::REG_RB_DEPTHCONTROL, XenonGPURegister::REG_RB_STENCILREFMASK } );
+
 } // Helper
 
 CXenonGPUState::CXenonGPUState()
+	: m_dirtyBlocks( eStateBlock_All )
 {
 	m_physicalRenderHeight = 0;
 	m_physicalRenderWidth = 0;
 }
 
+void CXenonGPUState::CollectDirtyBlocks( const CXenonGPUDirtyRegisterTracker& dirtyRegs )
+{
+	if ( dirtyRegs.IsAnyDirty( Helper::RenderTargetRegisters ) )
+		m_dirtyBlocks |= eStateBlock_RenderTargets;
+	if ( dirtyRegs.IsAnyDirty( Helper::ViewportRegisters ) )
+		m_dirtyBlocks |= eStateBlock_Viewport;
+	if ( dirtyRegs.IsAnyDirty( Helper::RasterRegisters ) )
+		m_dirtyBlocks |= eStateBlock_Raster;
+	if ( dirtyRegs.IsAnyDirty( Helper::BlendRegisters ) )
+		m_dirtyBlocks |= eStateBlock_Blend;
+	if ( dirtyRegs.IsAnyDirty( Helper::DepthRegisters ) )
+		m_dirtyBlocks |= eStateBlock_Depth;
+}
+
 bool CXenonGPUState::IssueDraw( IXenonGPUAbstractLayer* abstractLayer, IXenonGPUDumpWriter* traceDump, const CXenonGPURegisters& regs, const CXenonGPUDirtyRegisterTracker& dirtyRegs, const DrawIndexState& ds )
 {
+	// remember which state blocks were modified, even if the draw is not executed
+	CollectDirtyBlocks( dirtyRegs );
+
 	// global state
 	const auto enableMode = (XenonModeControl)( regs[XenonGPURegister::REG_RB_MODECONTROL].m_dword & 0x7 );
 	if ( enableMode == XenonModeControl::Ignore )
@@ -236,7 +277,7 @@ bool CXenonGPUState::IssueCopy( IXenonGPUAbstractLayer* abstractLayer, IXenonGPU
 				DEBUG_CHECK(fetch->endian == 2);
 				DEBUG_CHECK(fetch->size == 6);
 
-				const float* vertexData = (const float*) GPlatform.GetMemory().TranslatePhysicalAddress( fetch->address << 2 );
+				const float* vertexData = (const float*)(size_t) GPlatform.GetMemory().TranslatePhysicalAddress( fetch->address << 2 );
 
 				// fetch vertex data
 				float vertexX[3]; // x coords
@@ -357,6 +398,10 @@ bool CXenonGPUState::ReportFailedDraw( const char* reason )
 
 bool CXenonGPUState::UpdateRenderTargets( IXenonGPUAbstractLayer* abstractLayer, const CXenonGPURegisters& regs )
 {
+	// no registers changed since last update
+	if ( !ConsumeDirtyBlock( eStateBlock_RenderTargets ) )
+		return true;
+
 	/// update state and check if it's different
 	bool stateChanged = false;
 	stateChanged |= Helper::UpdateRegister( regs, XenonGPURegister::REG_RB_MODECONTROL, m_rtState.regModeControl );
@@ -380,6 +425,10 @@ bool CXenonGPUState::UpdateRenderTargets( IXenonGPUAbstractLayer* abstractLayer,
 
 bool CXenonGPUState::UpdateViewportState( IXenonGPUAbstractLayer* abstractLayer, const CXenonGPURegisters& regs )
 {
+	// no registers changed since last update
+	if ( !ConsumeDirtyBlock( eStateBlock_Viewport ) )
+		return true;
+
 	/// update state and check if it's different
 	bool stateChanged = false;
 	stateChanged |= Helper::UpdateRegister( regs, XenonGPURegister::REG_RB_SURFACE_INFO, m_viewState.regSurfaceInfo );
@@ -405,6 +454,10 @@ bool CXenonGPUState::UpdateViewportState( IXenonGPUAbstractLayer* abstractLayer,
 
 bool CXenonGPUState::UpdateRasterState( IXenonGPUAbstractLayer* abstractLayer, const CXenonGPURegisters& regs )
 {
+	// no registers changed since last update
+	if ( !ConsumeDirtyBlock( eStateBlock_Raster ) )
+		return true;
+
 	/// update state and check if it's different
 	bool stateChanged = false;
 	stateChanged |= Helper::UpdateRegister( regs, XenonGPURegister::REG_PA_SU_SC_MODE_CNTL, m_rasterState.regPaSuScModeCntl );
@@ -422,16 +475,19 @@ bool CXenonGPUState::UpdateRasterState( IXenonGPUAbstractLayer* abstractLayer, c
 
 bool CXenonGPUState::UpdateBlendState( IXenonGPUAbstractLayer* abstractLayer, const CXenonGPURegisters& regs )
 {
-	/// update state and check if it's different
+	/// update state and check if it's different, registers are read only if they changed since last update
 	bool stateChanged = false;
-	stateChanged |= Helper::UpdateRegister( regs, XenonGPURegister::REG_RB_BLENDCONTROL_0, m_blendState.regRbBlendControl[0] );
-	stateChanged |= Helper::UpdateRegister( regs, XenonGPURegister::REG_RB_BLENDCONTROL_1, m_blendState.regRbBlendControl[1] );
-	stateChanged |= Helper::UpdateRegister( regs, XenonGPURegister::REG_RB_BLENDCONTROL_2, m_blendState.regRbBlendControl[2] );
-	stateChanged |= Helper::UpdateRegister( regs, XenonGPURegister::REG_RB_BLENDCONTROL_3, m_blendState.regRbBlendControl[3] );
-	stateChanged |= Helper::UpdateRegister( regs, XenonGPURegister::REG_RB_BLEND_RED, m_blendState.regRbBlendRGBA[0] );
-	stateChanged |= Helper::UpdateRegister( regs, XenonGPURegister::REG_RB_BLEND_GREEN, m_blendState.regRbBlendRGBA[1] );
-	stateChanged |= Helper::UpdateRegister( regs, XenonGPURegister::REG_RB_BLEND_BLUE, m_blendState.regRbBlendRGBA[2] );
-	stateChanged |= Helper::UpdateRegister( regs, XenonGPURegister::REG_RB_BLEND_ALPHA, m_blendState.regRbBlendRGBA[3] );
+	if ( ConsumeDirtyBlock( eStateBlock_Blend ) )
+	{
+		stateChanged |= Helper::UpdateRegister( regs, XenonGPURegister::REG_RB_BLENDCONTROL_0, m_blendState.regRbBlendControl[0] );
+		stateChanged |= Helper::UpdateRegister( regs, XenonGPURegister::REG_RB_BLENDCONTROL_1, m_blendState.regRbBlendControl[1] );
+		stateChanged |= Helper::UpdateRegister( regs, XenonGPURegister::REG_RB_BLENDCONTROL_2, m_blendState.regRbBlendControl[2] );
+		stateChanged |= Helper::UpdateRegister( regs, XenonGPURegister::REG_RB_BLENDCONTROL_3, m_blendState.regRbBlendControl[3] );
+		stateChanged |= Helper::UpdateRegister( regs, XenonGPURegister::REG_RB_BLEND_RED, m_blendState.regRbBlendRGBA[0] );
+		stateChanged |= Helper::UpdateRegister( regs, XenonGPURegister::REG_RB_BLEND_GREEN, m_blendState.regRbBlendRGBA[1] );
+		stateChanged |= Helper::UpdateRegister( regs, XenonGPURegister::REG_RB_BLEND_BLUE, m_blendState.regRbBlendRGBA[2] );
+		stateChanged |= Helper::UpdateRegister( regs, XenonGPURegister::REG_RB_BLEND_ALPHA, m_blendState.regRbBlendRGBA[3] );
+	}
 
 	// check if state is up to date
 	//if ( !stateChanged )
@@ -443,6 +499,10 @@ bool CXenonGPUState::UpdateBlendState( IXenonGPUAbstractLayer* abstractLayer, co
 
 bool CXenonGPUState::UpdateDepthState( IXenonGPUAbstractLayer* abstractLayer, const CXenonGPURegisters& regs )
 {
+	// no registers changed since last update
+	if ( !ConsumeDirtyBlock( eStateBlock_Depth ) )
+		return true;
+
 	/// update state and check if it's different
 	bool stateChanged = false;
 	stateChanged |= Helper::UpdateRegister( regs, XenonGPURegister::REG_RB_DEPTHCONTROL, m_depthState.regRbDepthControl );
@@ -828,45 +888,41 @@ bool CXenonGPUState::ApplyDepthState( IXenonGPUAbstractLayer* abstractLayer, con
 
 bool CXenonGPUState::UpdateShaderConstants( IXenonGPUAbstractLayer* abstractLayer, const CXenonGPURegisters& regs, const CXenonGPUDirtyRegisterTracker& dirtyRegs )
 {
+	// the vertex and pixel constants are covered by one word of the dirty word mask, visit only the modified 64 register blocks
+	const uint32 firstConstReg = (uint32) XenonGPURegister::REG_SHADER_CONSTANT_000_X;
+	const uint64 dirtyWords = dirtyRegs.GetDirtyWords( firstConstReg );
+
 	// pixel shader constants
 	{
 		const uint32 firstReg = (uint32) XenonGPURegister::REG_SHADER_CONSTANT_256_X;
-		const uint32 lastReg  = (uint32) XenonGPURegister::REG_SHADER_CONSTANT_511_W;
 
-		uint32 regIndex = firstReg;
-		while ( regIndex < lastReg )
+		uint64 dirtyMask = (dirtyWords >> ((firstReg - firstConstReg) / 64)) & 0xFFFF; // 16 blocks of 64 registers
+		while ( dirtyMask )
 		{
-			const uint32 baseShaderVector = (regIndex - firstReg) / 4;
+			unsigned long block = 0;
+			_BitScanForward64( &block, dirtyMask );
+			dirtyMask &= dirtyMask - 1;
 
-			const uint64 dirtyMask = dirtyRegs.GetBlock( regIndex ); // 64 registers
-			if ( dirtyMask )
-			{
-				const float* values = &regs[ regIndex ].m_float;
-				abstractLayer->SetPixelShaderConsts( baseShaderVector, 16, values );
-			}
-
-			regIndex += 64;
+			const uint32 regIndex = firstReg + block*64;
+			const float* values = &regs[ regIndex ].m_float;
+			abstractLayer->SetPixelShaderConsts( block*16, 16, values );
 		}
 	}
 
 	// vertex shader constants
 	{
 		const uint32 firstReg = (uint32) XenonGPURegister::REG_SHADER_CONSTANT_000_X;
-		const uint32 lastReg  = (uint32) XenonGPURegister::REG_SHADER_CONSTANT_255_W;
 
-		uint32 regIndex = firstReg;
-		while ( regIndex < lastReg )
+		uint64 dirtyMask = (dirtyWords >> ((firstReg - firstConstReg) / 64)) & 0xFFFF; // 16 blocks of 64 registers
+		while ( dirtyMask )
 		{
-			const uint32 baseShaderVector = (regIndex - firstReg) / 4;
-
-			const uint64 dirtyMask = dirtyRegs.GetBlock( regIndex ); // 64 registers
-			if ( dirtyMask )
-			{
-				const float* values = &regs[ regIndex ].m_float;
-				abstractLayer->SetVertexShaderConsts( baseShaderVector, 16, values );
-			}
+			unsigned long block = 0;
+			_BitScanForward64( &block, dirtyMask );
+			dirtyMask &= dirtyMask - 1;
 
-			regIndex += 64;
+			const uint32 regIndex = firstReg + block*64;
+			const float* values = &regs[ regIndex ].m_float;
+			abstractLayer->SetVertexShaderConsts( block*16, 16, values );
 		}
 	}
 
@@ -170,6 +170,33 @@ private:
 	/// NOTE: the function is static only to ensure there are NO dependencies on anything else than the passed state
 	static bool ApplyDepthState( IXenonGPUAbstractLayer* abstractLayer, const XenonStateDepthStencilRegisters& depthState );
 
+	// state blocks, the registers of a block are re-read only if any of them changed
+	enum EStateBlock
+	{
+		eStateBlock_RenderTargets = 1 << 0,
+		eStateBlock_Viewport = 1 << 1,
+		eStateBlock_Raster = 1 << 2,
+		eStateBlock_Blend = 1 << 3,
+		eStateBlock_Depth = 1 << 4,
+
+		eStateBlock_All = 0x1F,
+	};
+
+	// blocks with registers modified since the block was last updated
+	// NOTE: the register dirty mask is cleared after every draw, including the skipped ones, so we accumulate the changes here
+	uint32									m_dirtyBlocks;
+
+	// collect the blocks with modified registers
+	void CollectDirtyBlocks( const CXenonGPUDirtyRegisterTracker& dirtyRegs );
+
+	// check if block should be updated, resets the dirty flag
+	inline const bool ConsumeDirtyBlock( const EStateBlock block )
+	{
+		const bool dirty = 0 != (m_dirtyBlocks & block);
+		m_dirtyBlocks &= ~block;
+		return dirty;
+	}
+
 	// state vectors
 	XenonStateRenderTargetsRegisters		m_rtState;
 	XenonStateViewportRegisters				m_viewState;
@@ -0,0 +1,261 @@
+#include "build.h"
+#include "xenonGPUTextures.h"
+#include "xenonGPUTextureConversion.h"
+
+#include <intrin.h>
+#include <tmmintrin.h>
+#include <immintrin.h>
+
+//---------------------------------------------------------------------------
+
+namespace Helper
+{
+	// check if we can use the AVX2 path, needs both the CPU and the OS support (saving of the YMM registers)
+	static bool CheckAVX2Support()
+	{
+		int info[4];
+		__cpuid( info, 0 );
+		if ( info[0] < 7 )
+			return false;
+
+		__cpuid( info, 1 );
+		const bool hasOSXSave = (info[2] & (1 << 27)) != 0;
+		const bool hasAVX = (info[2] & (1 << 28)) != 0;
+		if ( !hasOSXSave || !hasAVX )
+			return false;
+
+		if ( (_xgetbv( 0 ) & 6) != 6 )
+			return false;
+
+		__cpuidex( info, 7, 0 );
+		return (info[1] & (1 << 5)) != 0;
+	}
+
+	static const bool GHasAVX2 = CheckAVX2Support();
+
+	// shuffle mask for given endianess swap
+	static inline __m128i GetSwapMask( const XenonGPUEndianFormat format )
+	{
+		switch ( format )
+		{
+			case XenonGPUEndianFormat::Format8in16:
+				return _mm_set_epi8( 14, 15, 12, 13, 10, 11, 8, 9, 6, 7, 4, 5, 2, 3, 0, 1 );
+
+			case XenonGPUEndianFormat::Format8in32:
+				return _mm_set_epi8( 12, 13, 14, 15, 8, 9, 10, 11, 4, 5, 6, 7, 0, 1, 2, 3 );
+
+			case XenonGPUEndianFormat::Format16in32:
+				return _mm_set_epi8( 13, 12, 15, 14, 9, 8, 11, 10, 5, 4, 7, 6, 1, 0, 3, 2 );
+		}
+
+		// identity
+		return _mm_set_epi8( 15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0 );
+	}
+
+	// log2 of the block size (1, 2, 4, 8, 16 bytes)
+	static inline uint32 GetBlockSizeLog( const uint32 blockSize )
+	{
+		return (blockSize >> 2) + ((blockSize >> 1) >> (blockSize >> 2));
+	}
+
+	// the swap works on the memory words, each byte is read from the address xored with this value
+	static inline uint32 GetSwapAddressXor( const XenonGPUEndianFormat format )
+	{
+		switch ( format )
+		{
+			case XenonGPUEndianFormat::Format8in16: return 1;
+			case XenonGPUEndianFormat::Format8in32: return 3;
+			case XenonGPUEndianFormat::Format16in32: return 2;
+		}
+
+		return 0;
+	}
+
+	// convert single block, blocks smaller than the swapped word take their bytes from the neighbouring blocks in the same word
+	static inline void ConvertBlockReference( void* dest, const uint8* srcData, const uint32 srcOffset, const uint32 blockSize, const XenonGPUEndianFormat format )
+	{
+		const uint32 swapXor = GetSwapAddressXor( format );
+		const uint32 wordSize = (format == XenonGPUEndianFormat::Format8in16) ? 2 : 4;
+		if ( blockSize >= wordSize )
+		{
+			XenonGPUConvertEndianessReference( dest, srcData + srcOffset, blockSize, format );
+			return;
+		}
+
+		for ( uint32 i=0; i<blockSize; ++i )
+			((uint8*)dest)[i] = srcData[ (srcOffset + i) ^ swapXor ];
+	}
+
+	// size of the run of blocks that is contiguous in the tiled memory, in blocks
+	// runs are 16 bytes long but never span more than 8 blocks (the x>>3 term breaks the continuity)
+	static inline uint32 GetContiguousRunLength( const uint32 bppLog )
+	{
+		const uint32 run = 16 >> bppLog;
+		return (run > 8) ? 8 : ((run < 1) ? 1 : run);
+	}
+}
+
+//---------------------------------------------------------------------------
+
+void XenonGPUConvertEndianessReference( void* dest, const void* src, const uint32 length, const XenonGPUEndianFormat format )
+{
+	if ( format == XenonGPUEndianFormat::Format8in16 )
+	{
+		for ( uint32 i=0; i<length/2; ++i )
+			*((uint16*)dest + i) = _byteswap_ushort( *((const uint16*)src + i) );
+	}
+	else if ( format == XenonGPUEndianFormat::Format8in32 )
+	{
+		for ( uint32 i=0; i<length/4; ++i )
+			*((uint32*)dest + i) = _byteswap_ulong( *((const uint32*)src + i) );
+	}
+	else if ( format == XenonGPUEndianFormat::Format16in32 )
+	{
+		for ( uint32 i=0; i<length/4; ++i )
+		{
+			const uint32 value = *((const uint32*)src + i);
+			*((uint32*)dest + i) = (value >> 16) | (value << 16);
+		}
+	}
+	else if ( format == XenonGPUEndianFormat::FormatUnspecified )
+	{
+		if ( dest != src )
+			memcpy( dest, src, length );
+		return;
+	}
+	else
+	{
+		DEBUG_CHECK( !"Unknown endianess format" );
+		return;
+	}
+
+	// bytes that don't fill the whole word are copied as they are
+	const uint32 wordSize = (format == XenonGPUEndianFormat::Format8in16) ? 2 : 4;
+	const uint32 tail = length & (wordSize - 1);
+	if ( tail && dest != src )
+		memcpy( (uint8*)dest + (length - tail), (const uint8*)src + (length - tail), tail );
+}
+
+void XenonGPUConvertEndianess( void* dest, const void* src, const uint32 length, const XenonGPUEndianFormat format )
+{
+	// plain copy
+	if ( format == XenonGPUEndianFormat::FormatUnspecified )
+	{
+		if ( dest != src )
+			memcpy( dest, src, length );
+		return;
+	}
+
+	const uint8* readPtr = (const uint8*) src;
+	uint8* writePtr = (uint8*) dest;
+	const __m128i mask = Helper::GetSwapMask( format );
+
+	uint32 pos = 0;
+
+	// 32 bytes at a time
+	if ( Helper::GHasAVX2 && length >= 64 )
+	{
+		const __m256i mask256 = _mm256_broadcastsi128_si256( mask );
+		for ( ; pos + 32 <= length; pos += 32 )
+		{
+			const __m256i data = _mm256_loadu_si256( (const __m256i*)(readPtr + pos) );
+			_mm256_storeu_si256( (__m256i*)(writePtr + pos), _mm256_shuffle_epi8( data, mask256 ) );
+		}
+
+		_mm256_zeroupper();
+	}
+
+	// 16 bytes at a time
+	for ( ; pos + 16 <= length; pos += 16 )
+	{
+		const __m128i data = _mm_loadu_si128( (const __m128i*)(readPtr + pos) );
+		_mm_storeu_si128( (__m128i*)(writePtr + pos), _mm_shuffle_epi8( data, mask ) );
+	}
+
+	// tail
+	if ( pos < length )
+		XenonGPUConvertEndianessReference( writePtr + pos, readPtr + pos, length - pos, format );
+}
+
+//---------------------------------------------------------------------------
+
+void XenonGPUUntileSurfaceReference( const XenonGPUUntileInfo& info, const void* src, void* dest )
+{
+	const uint8* srcData = (const uint8*) src;
+	uint8* targetData = (uint8*) dest;
+
+	const uint32 blockSize = info.m_blockSize;
+	const uint32 bppLog = Helper::GetBlockSizeLog( blockSize );
+
+	uint32 destOffsetY = 0;
+	for ( uint32 y=0; y<info.m_copyHeight; ++y, destOffsetY += info.m_destRowPitch )
+	{
+		const uint32 srcY = info.m_sourceOffsetY + y;
+		const uint32 srcOffsetY = XenonTextureInfo::TiledOffset2DOuter( srcY, info.m_sourceWidthInBlocks, bppLog );
+
+		uint32 destOffsetX = destOffsetY;
+		for ( uint32 x=0; x<info.m_copyWidth; ++x, destOffsetX += blockSize )
+		{
+			const uint32 srcX = info.m_sourceOffsetX + x;
+			const uint32 srcOffset = XenonTextureInfo::TiledOffset2DInner( srcX, srcY, bppLog, srcOffsetY ) >> bppLog;
+
+			if ( destOffsetX < info.m_destMaxOffset )
+				Helper::ConvertBlockReference( targetData + destOffsetX, srcData, srcOffset*blockSize, blockSize, info.m_endianess );
+		}
+	}
+}
+
+void XenonGPUUntileSurface( const XenonGPUUntileInfo& info, const void* src, void* dest )
+{
+	const uint8* srcData = (const uint8*) src;
+	uint8* targetData = (uint8*) dest;
+
+	const uint32 blockSize = info.m_blockSize;
+	const uint32 bppLog = Helper::GetBlockSizeLog( blockSize );
+
+	// the fast path copies whole runs of blocks that are contiguous in the source memory
+	const uint32 runBlocks = Helper::GetContiguousRunLength( bppLog );
+	const uint32 runBytes = runBlocks * blockSize;
+	const uint32 runMask = runBlocks - 1;
+	const __m128i mask = Helper::GetSwapMask( info.m_endianess );
+
+	uint32 destOffsetY = 0;
+	for ( uint32 y=0; y<info.m_copyHeight; ++y, destOffsetY += info.m_destRowPitch )
+	{
+		const uint32 srcY = info.m_sourceOffsetY + y;
+		const uint32 srcOffsetY = XenonTextureInfo::TiledOffset2DOuter( srcY, info.m_sourceWidthInBlocks, bppLog );
+
+		uint32 x = 0;
+		while ( x < info.m_copyWidth )
+		{
+			const uint32 destOffsetX = destOffsetY + x*blockSize;
+			if ( destOffsetX >= info.m_destMaxOffset )
+				break;
+
+			const uint32 srcX = info.m_sourceOffsetX + x;
+			const uint32 srcOffset = (XenonTextureInfo::TiledOffset2DInner( srcX, srcY, bppLog, srcOffsetY ) >> bppLog) * blockSize;
+
+			// full run
+			if ( !(srcX & runMask) && (x + runBlocks <= info.m_copyWidth) && (destOffsetX + runBytes <= info.m_destMaxOffset) )
+			{
+				if ( runBytes == 16 )
+				{
+					const __m128i data = _mm_loadu_si128( (const __m128i*)(srcData + srcOffset) );
+					_mm_storeu_si128( (__m128i*)(targetData + destOffsetX), _mm_shuffle_epi8( data, mask ) );
+				}
+				else
+				{
+					const __m128i data = _mm_loadl_epi64( (const __m128i*)(srcData + srcOffset) );
+					_mm_storel_epi64( (__m128i*)(targetData + destOffsetX), _mm_shuffle_epi8( data, mask ) );
+				}
+
+				x += runBlocks;
+				continue;
+			}
+
+			// single block (unaligned start of the row or the row end)
+			Helper::ConvertBlockReference( targetData + destOffsetX, srcData, srcOffset, blockSize, info.m_endianess );
+			x += 1;
+		}
+	}
+}
@@ -0,0 +1,32 @@
+#pragma once
+
+#include "xenonGPUConstants.h"
+
+/// Backend independent texture data conversion - endianess swap and untiling
+/// The fast paths work on whole 16 byte runs (SSSE3) or 32 byte runs (AVX2, if supported by the CPU), the scalar versions are kept as a reference
+
+/// Setup for untiling single 2D surface
+struct XenonGPUUntileInfo
+{
+	uint32					m_blockSize;			// size of the single block (texel or compressed block) in bytes, the same in source and dest
+	uint32					m_sourceWidthInBlocks;	// width of the source (tiled) surface, in blocks
+	uint32					m_sourceOffsetX;		// offset of the surface in the packed tile, in blocks
+	uint32					m_sourceOffsetY;		// offset of the surface in the packed tile, in blocks
+	uint32					m_copyWidth;			// number of blocks to copy in each row
+	uint32					m_copyHeight;			// number of rows to copy
+	uint32					m_destRowPitch;			// pitch of the destination rows, in bytes
+	uint32					m_destMaxOffset;		// size of the destination memory, nothing is written past it
+	XenonGPUEndianFormat	m_endianess;			// endianess of the source data
+};
+
+/// Convert endianess of the data, length is in bytes, dest and source can be the same but can't partially overlap
+extern void XenonGPUConvertEndianess( void* dest, const void* src, const uint32 length, const XenonGPUEndianFormat format );
+
+/// Untile 2D surface into linear memory, converts endianess on the way
+extern void XenonGPUUntileSurface( const XenonGPUUntileInfo& info, const void* src, void* dest );
+
+/// Reference (scalar) version of the endianess conversion, bytes that don't fill the whole swapped word are copied as they are
+extern void XenonGPUConvertEndianessReference( void* dest, const void* src, const uint32 length, const XenonGPUEndianFormat format );
+
+/// Reference (block by block) version of the untiling, blocks smaller than the swapped word are swapped with their neighbours in memory
+extern void XenonGPUUntileSurfaceReference( const XenonGPUUntileInfo& info, const void* src, void* dest );
@@ -98,7 +98,7 @@ bool XenonTextureInfo::Parse(const XenonGPUTextureFetch& fetchInfo, XenonTexture
 	outInfo.m_swizzle = fetchInfo.swizzle;
 
 	// get size
-	switch (fetchInfo.dimension)
+	switch ((XenonTextureDimension)fetchInfo.dimension)
 	{
 		case XenonTextureDimension::Dimmension_1D:
 		{
@@ -273,8 +273,8 @@ void XenonTextureInfo::CalculateTextureSizes2D(const XenonGPUTextureFetch& fetch
 	const uint32 blockHeight = Helper::RoundUp(m_size2D.m_logicalHeight, m_format->m_blockHeight) / m_format->m_blockHeight;
 
 	// Tiles are 32x32 blocks. All textures must be multiples of tile dimensions.
-	const uint32 tileWidth = (uint32)(std::ceilf(blockWidth / 32.0f));
-	const uint32 tileHeight = (uint32)(std::ceilf(blockHeight / 32.0f));
+	const uint32 tileWidth = (uint32)(std::ceil(blockWidth / 32.0f));
+	const uint32 tileHeight = (uint32)(std::ceil(blockHeight / 32.0f));
 	m_size2D.m_actualBlockWidth = tileWidth * 32;
 	m_size2D.m_actualBlockHeight = tileHeight * 32;
 
@@ -301,8 +301,8 @@ void XenonTextureInfo::CalculateTextureSizesCube(const XenonGPUTextureFetch& fet
 	const uint32 blockHeight = Helper::RoundUp(m_sizeCube.m_logicalHeight, m_format->m_blockHeight) / m_format->m_blockHeight;
 
 	// Tiles are 32x32 blocks. All textures must be multiples of tile dimensions.
-	const int32 tileWidth = (uint32)(std::ceilf(blockWidth / 32.0f));
-	const int32 tileHeight = (uint32)(std::ceilf(blockHeight / 32.0f));
+	const int32 tileWidth = (uint32)(std::ceil(blockWidth / 32.0f));
+	const int32 tileHeight = (uint32)(std::ceil(blockHeight / 32.0f));
 	m_sizeCube.m_actualBlockWidth = tileWidth * 32;
 	m_sizeCube.m_actualBlockHeight = tileHeight * 32;
 
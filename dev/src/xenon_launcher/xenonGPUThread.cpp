@@ -5,6 +5,7 @@
 #include "xenonGPUExecutor.h"
 #include "xenonGPUCommandBuffer.h"
 #include "xenonPlatform.h"
+#include "xenonMemory.h"
 #include "../host_core/runtimeTraceFile.h"
 
 CXenonGPUThread::CXenonGPUThread( CXenonGPUCommandBuffer& cmdBuffer, CXenonGPUExecutor& executor, IXenonGPUAbstractLayer* abstractionLayer )
@@ -16,7 +17,15 @@ CXenonGPUThread::CXenonGPUThread( CXenonGPUCommandBuffer& cmdBuffer, CXenonGPUEx
 	, m_hVSyncTimer( nullptr )
 	, m_killRequest( false )
 	, m_traceWriter(nullptr)
+	, m_idleTicks( 0 )
+	, m_busyTicks( 0 )
+	, m_numBatches( 0 )
 {
+	// timer resolution
+	LARGE_INTEGER freq;
+	QueryPerformanceFrequency( &freq );
+	m_tickToSeconds = 1.0 / (double)freq.QuadPart;
+
 	// create the trace writer
 	if (GPlatform.GetTraceFile())
 		m_traceWriter = GPlatform.GetTraceFile()->CreateInterruptWriter("GPU_THREAD");
@@ -44,6 +53,7 @@ CXenonGPUThread::~CXenonGPUThread()
 {
 	// signal kill request
 	m_killRequest = true;
+	m_commandBuffer->Wake();
 
 	// stop timer
 	if ( m_hTimerQueue != NULL )
@@ -81,6 +91,9 @@ CXenonGPUThread::~CXenonGPUThread()
 	CloseHandle( m_hSync );
 	m_hSync = NULL;
 
+	// stats
+	GLog.Log( "GPU: Processed %llu command batches, busy %1.2fs (waiting %1.2fs), idle %1.2fs", m_numBatches.load(), GetBusyTime(), m_executor->GetWaitTime(), GetIdleTime() );
+
 	// final message
 	GLog.Log( "GPU: Emulation thread closed" );
 }
@@ -112,6 +125,9 @@ void CXenonGPUThread::ThreadFunc()
 {
 	xenon::BindMemoryTraceWriter(m_traceWriter);
 
+	LARGE_INTEGER startTime;
+	QueryPerformanceCounter( &startTime );
+
 	while ( !m_killRequest )
 	{
 		// TODO: the output "frame" should be cached here, if nothing gets rendered than we deal with this shit ourselves
@@ -120,12 +136,41 @@ void CXenonGPUThread::ThreadFunc()
 		CXenonGPUCommandBufferReader reader;
 		if ( m_commandBuffer->BeginRead( reader ) )
 		{
+			// the memory written by the CPU so far is visible to the GPU from now on
+			GPlatform.GetMemory().CollectWrites();
+
 			m_executor->Execute( reader );
 			m_commandBuffer->EndRead();
-		}		
+
+			LARGE_INTEGER endTime;
+			QueryPerformanceCounter( &endTime );
+			m_busyTicks += endTime.QuadPart - startTime.QuadPart;
+			m_numBatches += 1;
+			startTime = endTime;
+		}
+		else
+		{
+			// nothing to do, wait for the CPU to give us more work
+			m_commandBuffer->WaitForData( IDLE_WAIT_TIMEOUT );
+
+			LARGE_INTEGER endTime;
+			QueryPerformanceCounter( &endTime );
+			m_idleTicks += endTime.QuadPart - startTime.QuadPart;
+			startTime = endTime;
+		}
 	}
 }
 
+const double CXenonGPUThread::GetIdleTime() const
+{
+	return m_idleTicks.load() * m_tickToSeconds;
+}
+
+const double CXenonGPUThread::GetBusyTime() const
+{
+	return m_busyTicks.load() * m_tickToSeconds;
+}
+
 void CXenonGPUThread::VsyncCallbackThunk( LPVOID lpParameter, BOOLEAN )
 {
 	static bool bThreadNamed = false;
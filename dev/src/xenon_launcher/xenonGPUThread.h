@@ -1,5 +1,7 @@
 #pragma once
 
+#include <atomic>
+
 class CXenonGPUExecutor;
 class CXenonGPUCommandBuffer;
 class IXenonGPUAbstractLayer;
@@ -16,7 +18,18 @@ public:
 	/// NOTE: without GPU thread application will eventually stall
 	~CXenonGPUThread();
 
+	/// Get time (in seconds) spent waiting for the commands
+	const double GetIdleTime() const;
+
+	/// Get time (in seconds) spent processing the commands
+	const double GetBusyTime() const;
+
+	/// Get number of command batches processed
+	inline const uint64 GetNumBatches() const { return m_numBatches.load(); }
+
 private:
+	static const uint32 IDLE_WAIT_TIMEOUT = 5; // ms, so we can notice the kill request
+
 	HANDLE	m_hThread;		// managing thread
 	HANDLE	m_hSync;		// helper sync object
 
@@ -27,6 +40,12 @@ private:
 
 	volatile bool	m_killRequest;
 
+	// timing stats, in performance counter ticks
+	std::atomic< uint64 >	m_idleTicks;
+	std::atomic< uint64 >	m_busyTicks;
+	std::atomic< uint64 >	m_numBatches;
+	double					m_tickToSeconds;
+
 	CXenonGPUCommandBuffer*		m_commandBuffer;	// related command buffer
 	CXenonGPUExecutor*			m_executor;			// command data executor
 	IXenonGPUAbstractLayer*		m_abstractionLayer;	// rendering abstraction layer
@@ -1,8 +1,12 @@
 #pragma once
 
 #include "xenonGPUConstants.h"
-#include "xenonPlatform.h"
-#include "xenonMemory.h"
+
+// the standalone build has its own minimal platform
+#if !defined(XENON_GPU_STANDALONE)
+	#include "xenonPlatform.h"
+	#include "xenonMemory.h"
+#endif
 
 #define XENON_GPU_MAKE_SWIZZLE(x, y, z, w)								\
 	(((eXenonGPUSwizzle_##x) << 0) | ((eXenonGPUSwizzle_##y) << 3) |	\
@@ -99,39 +103,39 @@ inline uint32 XenonCPUAddrToGPUAddr( const uint32 addr )
 inline uint32 XenonGPULoadPhysical( const uint32 addr )
 {
 	const uint32 cpuAddr = GPlatform.GetMemory().TranslatePhysicalAddress( addr );
-	return *(const uint32*) cpuAddr;
+	return *(const uint32*)(size_t) cpuAddr;
 }
 
 inline uint32 XenonGPULoadPhysical( const uint32 addr, const XenonGPUEndianFormat format )
 {
 	const uint32 cpuAddr = GPlatform.GetMemory().TranslatePhysicalAddress( addr );
-	return XenonGPUSwap32( *(const uint32*) cpuAddr, format );
+	return XenonGPUSwap32( *(const uint32*)(size_t) cpuAddr, format );
 }
 
 inline uint32 XenonGPULoadPhysicalAddWithFormat( const uint32 addrWithFormat )
 {
 	const XenonGPUEndianFormat format = static_cast< XenonGPUEndianFormat >( addrWithFormat & 0x3 );
 	const uint32 cpuAddr = GPlatform.GetMemory().TranslatePhysicalAddress( addrWithFormat & ~0x3 );
-	return XenonGPUSwap32( *(const uint32*) cpuAddr, format );
+	return XenonGPUSwap32( *(const uint32*)(size_t) cpuAddr, format );
 }
 
 inline void XenonGPUStorePhysical( const uint32 addr, const uint32 value )
 {
 	const uint32 cpuAddr = GPlatform.GetMemory().TranslatePhysicalAddress( addr );
-	*(uint32*) cpuAddr = value;
+	*(uint32*)(size_t) cpuAddr = value;
 }
 
 inline void XenonGPUStorePhysical( const uint32 addr, const uint32 value, const XenonGPUEndianFormat format )
 {
 	const uint32 cpuAddr = GPlatform.GetMemory().TranslatePhysicalAddress( addr );
-	*(uint32*) cpuAddr = XenonGPUSwap32( value, format );
+	*(uint32*)(size_t) cpuAddr = XenonGPUSwap32( value, format );
 }
 
 inline void XenonGPUStorePhysicalAddrWithFormat( const uint32 addrWithFormat, const uint32 value )
 {
 	const XenonGPUEndianFormat format = static_cast< XenonGPUEndianFormat >( addrWithFormat & 0x3 );
 	const uint32 cpuAddr = GPlatform.GetMemory().TranslatePhysicalAddress( addrWithFormat & ~0x3 );
-	*(uint32*) cpuAddr = XenonGPUSwap32( value, format );
+	*(uint32*)(size_t) cpuAddr = XenonGPUSwap32( value, format );
 }
 
 extern uint32 XenonGPUCalcCRC( const void* memory, const uint32 memorySize );
@@ -238,19 +242,19 @@ private:
 class CodeChunk
 {
 public:
-	CodeChunk::CodeChunk();
-	CodeChunk::CodeChunk( const CodeChunk& other );
-	CodeChunk::CodeChunk( const char* txt );
-	CodeChunk::~CodeChunk();
+	CodeChunk();
+	CodeChunk( const CodeChunk& other );
+	CodeChunk( const char* txt );
+	~CodeChunk();
 
-	CodeChunk& CodeChunk::operator=( const char* txt );
-	CodeChunk& CodeChunk::operator=( const CodeChunk& other );
+	CodeChunk& operator=( const char* txt );
+	CodeChunk& operator=( const CodeChunk& other );
 
-	void CodeChunk::Set( const char* txt );
+	void Set( const char* txt );
 
-	CodeChunk& CodeChunk::Append( const char* txt );
-	CodeChunk& CodeChunk::Append( const CodeChunk& txt );
-	CodeChunk& CodeChunk::Appendf( const char* txt, ... );
+	CodeChunk& Append( const char* txt );
+	CodeChunk& Append( const CodeChunk& txt );
+	CodeChunk& Appendf( const char* txt, ... );
 
 	inline const char* c_str() const
 	{
@@ -0,0 +1,83 @@
+#include "build.h"
+#include "xenonGPUWorkerPool.h"
+
+//----------------------
+
+CXenonGPUWorkerPool::CXenonGPUWorkerPool( const uint32 numThreads )
+	: m_numRunningJobs( 0 )
+	, m_killRequest( false )
+{
+	// leave some cores for the CPU and GPU threads
+	uint32 threadCount = numThreads;
+	if ( !threadCount )
+	{
+		const uint32 numCores = std::thread::hardware_concurrency();
+		threadCount = (numCores > 4) ? (numCores - 4) : 1;
+		threadCount = (threadCount > 4) ? 4 : threadCount;
+	}
+
+	for ( uint32 i=0; i<threadCount; ++i )
+		m_threads.push_back( std::thread( &CXenonGPUWorkerPool::ThreadFunc, this ) );
+}
+
+CXenonGPUWorkerPool::~CXenonGPUWorkerPool()
+{
+	// discard jobs that were not started
+	{
+		std::lock_guard< std::mutex > lock( m_lock );
+		m_jobs.clear();
+		m_killRequest = true;
+	}
+
+	m_jobAvailable.notify_all();
+
+	for ( auto& thread : m_threads )
+		thread.join();
+}
+
+void CXenonGPUWorkerPool::Submit( const TJob& job )
+{
+	{
+		std::lock_guard< std::mutex > lock( m_lock );
+		m_jobs.push_back( job );
+	}
+
+	m_jobAvailable.notify_one();
+}
+
+void CXenonGPUWorkerPool::WaitForAll()
+{
+	std::unique_lock< std::mutex > lock( m_lock );
+	m_jobsDone.wait( lock, [this]() { return m_jobs.empty() && !m_numRunningJobs; } );
+}
+
+void CXenonGPUWorkerPool::ThreadFunc()
+{
+	for (;;)
+	{
+		TJob job;
+
+		// get next job
+		{
+			std::unique_lock< std::mutex > lock( m_lock );
+			m_jobAvailable.wait( lock, [this]() { return m_killRequest || !m_jobs.empty(); } );
+			if ( m_killRequest )
+				break;
+
+			job = m_jobs.front();
+			m_jobs.pop_front();
+			m_numRunningJobs += 1;
+		}
+
+		// run it
+		job();
+
+		// notify waiting threads
+		{
+			std::lock_guard< std::mutex > lock( m_lock );
+			m_numRunningJobs -= 1;
+		}
+
+		m_jobsDone.notify_all();
+	}
+}
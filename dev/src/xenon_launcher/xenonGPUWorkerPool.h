@@ -0,0 +1,40 @@
+#pragma once
+
+#include <thread>
+#include <condition_variable>
+#include <functional>
+
+/// Pool of worker threads for the background GPU work (shader translation, etc)
+/// Does not depend on the rendering backend, jobs are executed in the order they were submitted
+class CXenonGPUWorkerPool
+{
+public:
+	typedef std::function< void() >		TJob;
+
+	/// Create pool, zero threads means the number of threads is picked based on the CPU
+	CXenonGPUWorkerPool( const uint32 numThreads );
+
+	/// Stop the pool, waits for the running jobs, jobs not yet started are discarded
+	~CXenonGPUWorkerPool();
+
+	/// Get number of worker threads
+	inline const uint32 GetNumThreads() const { return (uint32) m_threads.size(); }
+
+	/// Submit job for execution
+	void Submit( const TJob& job );
+
+	/// Wait for all submitted jobs to finish
+	void WaitForAll();
+
+private:
+	std::vector< std::thread >	m_threads;
+
+	std::mutex					m_lock;
+	std::condition_variable		m_jobAvailable;
+	std::condition_variable		m_jobsDone;
+	std::deque< TJob >			m_jobs;
+	uint32						m_numRunningJobs;
+	bool						m_killRequest;
+
+	void ThreadFunc();
+};
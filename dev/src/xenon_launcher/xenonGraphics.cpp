@@ -113,4 +113,15 @@ namespace xenon
 		m_gpu->RequestTraceDump();
 	}
 
+	bool Graphics::ReplayDump(const std::wstring& path, const uint32 numFrames)
+	{
+		if (m_gpuInitialized)
+		{
+			GLog.Err("GPU: Ring buffer already initialized, unable to replay the dump");
+			return false;
+		}
+
+		return m_gpu->ReplayDump(path, numFrames);
+	}
+
 } // xenon
\ No newline at end of file
@@ -25,6 +25,9 @@ namespace xenon
 		// request a trace dump of the whole GPU frame
 		void RequestTraceDump();
 
+		// replay saved GPU dump without running the application
+		bool ReplayDump(const std::wstring& path, const uint32 numFrames);
+
 	private:
 		// mapped global stuff
 		lib::XenonNativeData	m_nativeVdGlobalDevice;
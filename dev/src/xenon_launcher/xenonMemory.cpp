@@ -5,14 +5,27 @@ namespace xenon
 {
 	Memory::Memory(native::IMemory& nativeMemory)
 		: m_nativeMemory(nativeMemory)
+		, m_writeEpoch(0)
 	{}
 
 	//--
 
-	const bool Memory::MemoryClass::Initialize(native::IMemory& memory, const uint32 prefferedBase, const uint32 totalVirtualMemoryAvaiable)
+	const bool Memory::MemoryClass::Initialize(native::IMemory& memory, const uint32 prefferedBase, const uint32 totalVirtualMemoryAvaiable, const bool writeWatch)
 	{
 		// allocate the virtual address space range that will be used as virtual memory
-		m_base = memory.AllocVirtualMemory(prefferedBase, totalVirtualMemoryAvaiable);
+		// if requested try to allocate it with the write tracking enabled first
+		m_base = NULL;
+		m_writeWatch = false;
+		if (writeWatch)
+		{
+			m_base = memory.AllocWatchedVirtualMemory(prefferedBase, totalVirtualMemoryAvaiable);
+			m_writeWatch = (NULL != m_base);
+			if (!m_writeWatch)
+				GLog.Warn("Mem: Write tracking is not available, memory at %06Xh will be considered always dirty", prefferedBase);
+		}
+
+		if (NULL == m_base)
+			m_base = memory.AllocVirtualMemory(prefferedBase, totalVirtualMemoryAvaiable);
 		if (NULL == m_base)
 		{
 			GLog.Warn("Mem: Failed to initialize memory range at preferred address %06Xh", prefferedBase);
@@ -93,12 +106,19 @@ namespace xenon
 
 	const bool Memory::InitializeVirtualMemory(const uint32 prefferedBase, const uint32 totalPhysicalMemoryAvaiable)
 	{
-		return m_virtual.Initialize(m_nativeMemory, prefferedBase, totalPhysicalMemoryAvaiable);
+		return m_virtual.Initialize(m_nativeMemory, prefferedBase, totalPhysicalMemoryAvaiable, false);
 	}
 
 	const bool Memory::InitializePhysicalMemory(const uint32 prefferedBase, const uint32 totalPhysicalMemoryAvaiable)
 	{
-		return m_physical.Initialize(m_nativeMemory, prefferedBase, totalPhysicalMemoryAvaiable);
+		if (!m_physical.Initialize(m_nativeMemory, prefferedBase, totalPhysicalMemoryAvaiable, true))
+			return false;
+
+		// nothing written yet
+		m_pageWriteEpochs.resize(m_physical.m_totalPages, 0);
+		if (m_physical.m_writeWatch)
+			m_writtenPages.resize(m_physical.m_totalPages);
+		return true;
 	}
 
 	const bool Memory::IsVirtualMemory(void* base, const uint32 size) const
@@ -203,6 +223,53 @@ namespace xenon
 		return (const uint32)m_physical.m_base + (localAddress & physicalMemoryAddrMask);
 	}
 
+	void Memory::CollectWrites()
+	{
+		if (!m_physical.m_writeWatch)
+			return;
+
+		std::lock_guard<std::mutex> lock(m_writeWatchLock);
+
+		// get the pages written since the last collection, the OS tracking is reset for the whole range
+		uint64_t numWrittenPages = m_writtenPages.size();
+		if (!m_nativeMemory.GetWrittenPages(m_physical.m_base, m_physical.m_totalPages * PAGE_SIZE, m_writtenPages.data(), numWrittenPages))
+		{
+			// we don't know what was written, everything is dirty
+			const uint32 epoch = ++m_writeEpoch;
+			std::fill(m_pageWriteEpochs.begin(), m_pageWriteEpochs.end(), epoch);
+			return;
+		}
+
+		// stamp the written pages with new epoch
+		if (numWrittenPages > 0)
+		{
+			const uint32 epoch = ++m_writeEpoch;
+			for (uint32 i = 0; i < numWrittenPages; ++i)
+				m_pageWriteEpochs[m_physical.PageFromAddress(m_writtenPages[i])] = epoch;
+		}
+	}
+
+	const uint32 Memory::GetLastWriteEpoch(const void* base, const uint32 size)
+	{
+		// not tracked, assume the memory is always changing
+		if (!m_physical.m_writeWatch || !size || !m_physical.Contains(base, size))
+			return ++m_writeEpoch;
+
+		// pages covered by the range
+		const uint32 firstPage = m_physical.PageFromAddress(base);
+		const uint32 lastPage = m_physical.PageFromAddress((const uint8*)base + size - 1);
+
+		// most recent collected write in the range
+		uint32 lastEpoch = 0;
+		for (uint32 page = firstPage; page <= lastPage; ++page)
+		{
+			if (m_pageWriteEpochs[page] > lastEpoch)
+				lastEpoch = m_pageWriteEpochs[page];
+		}
+
+		return lastEpoch;
+	}
+
 	//--
 
 	void* Memory::AllocateSmallBlock(const uint32 size)
@@ -51,6 +51,15 @@ namespace xenon
 		// translate local physical memory address to absolute address
 		const uint32 TranslatePhysicalAddress(const uint32 localAddress) const;
 
+		// collect the physical memory writes detected by the OS write tracking since the last call, the written pages are stamped with new epoch
+		// called by the GPU thread once per command buffer batch, this is the only place the OS is asked about the writes
+		void CollectWrites();
+
+		// get the write epoch of the most recent write to given physical memory range (absolute address), only the collected writes are visible
+		// ranges never written return 0, if the tracking is not available for the range a new epoch is returned every time (range is always dirty)
+		// does not lock, the epoch table is written only by CollectWrites on the GPU thread
+		const uint32 GetLastWriteEpoch(const void* base, const uint32 size);
+
 		//--
 
 		// allocate small memory block that will be accessible by the simulated Xenon platform
@@ -76,6 +85,7 @@ namespace xenon
 			uint32					m_totalPages;		// total number of memory pages
 			uint32					m_allocatedPages;	// allocated number of memory pages
 			utils::BlockAllocator	m_allocator;		// page allocator
+			bool					m_writeWatch;		// OS write tracking is enabled for this memory range
 
 			// get memory page from memory address	
 			inline const uint32 PageFromAddress(const void* base) const
@@ -96,7 +106,7 @@ namespace xenon
 			}
 
 			// check if the pointer is contained in this memory class range
-			inline const bool Contains(void* base, const uint32 size) const
+			inline const bool Contains(const void* base, const uint32 size) const
 			{
 				if (((uint8*)base < (uint8*)m_base) || (((uint8*)base + size) > ((uint8*)m_base + m_totalSize)))
 					return false;
@@ -104,7 +114,7 @@ namespace xenon
 			}
 
 			// initialize the memory range
-			const bool Initialize(native::IMemory& memory, const uint32 prefferedBase, const uint32 totalVirtualMemoryAvaiable);
+			const bool Initialize(native::IMemory& memory, const uint32 prefferedBase, const uint32 totalVirtualMemoryAvaiable, const bool writeWatch);
 
 			// allocate memory
 			void* Allocate(const uint32 size, const bool top, const uint32 flags);
@@ -115,5 +125,11 @@ namespace xenon
 
 		MemoryClass m_virtual;
 		MemoryClass m_physical;
+
+		// write tracking for the physical memory
+		std::mutex				m_writeWatchLock;		// serializes CollectWrites
+		std::atomic< uint32 >	m_writeEpoch;			// last opened write epoch
+		std::vector< uint32 >	m_pageWriteEpochs;		// per physical page, epoch of the last collected write
+		std::vector< void* >	m_writtenPages;			// temporary table for the OS query (one entry per physical page)
 	};
 } // xenon
\ No newline at end of file
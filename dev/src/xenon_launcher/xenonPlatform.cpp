@@ -55,6 +55,7 @@ namespace xenon
 		, m_traceFile(nullptr)
 		, m_platformLogFileEnabled(false)
 		, m_timeBase(nullptr)
+		, m_gpuReplayFrames(0)
 	{
 	}
 
@@ -339,6 +340,19 @@ namespace xenon
 			}
 		}
 
+		// GPU dump replay
+		if (commandline.HasOption("gpureplay"))
+		{
+			m_gpuReplayPath = commandline.GetOptionValueW("gpureplay");
+			m_gpuReplayFrames = 100;
+
+			const auto numFramesText = commandline.GetOptionValueA("gpureplayframes");
+			if (!numFramesText.empty() && atoi(numFramesText.c_str()) > 0)
+				m_gpuReplayFrames = atoi(numFramesText.c_str());
+
+			GLog.Log("Runtime: GPU dump '%ls' will be replayed %u times, application will not run", m_gpuReplayPath.c_str(), m_gpuReplayFrames);
+		}
+
 		GLog.Log("Runtime: Xenon platform initialized");
 		return true;
 	}
@@ -400,6 +414,10 @@ namespace xenon
 
 	int Platform::RunImage(const runtime::Image& image)
 	{
+		// replay GPU dump instead of running the application
+		if (!m_gpuReplayPath.empty())
+			return m_graphics->ReplayDump(m_gpuReplayPath, m_gpuReplayFrames) ? 0 : -1;
+
 		// bind code image
 		m_kernel->SetCode(image.GetCodeTable());
 
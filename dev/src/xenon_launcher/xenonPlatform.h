@@ -106,6 +106,10 @@ namespace xenon
 
 		// external exit
 		bool m_userExitRequested;
+
+		// GPU dump to replay instead of running the image
+		std::wstring m_gpuReplayPath;
+		uint32 m_gpuReplayFrames;
 	};
 
 	//---------------------------------------------------------------------------
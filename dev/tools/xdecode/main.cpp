@@ -0,0 +1,75 @@
+// XDecodeTest - compares the table driven PPC instruction decoder with the reference decoder
+// Returns the number of mismatches, the post build step fails if there are any
+
+#include "../../src/xenon_decompiler/xenonInstructionDecodingHelpers.h"
+#include "xenonDecodingTest.h"
+
+#include <stdio.h>
+
+//---------------------------------------------------------------------------
+
+static const bool CompareOperands(const decoding::Instruction::Operand& a, const decoding::Instruction::Operand& b)
+{
+	return (a.m_type == b.m_type) && (a.m_scale == b.m_scale) && (a.m_reg == b.m_reg) && (a.m_imm == b.m_imm) && (a.m_index == b.m_index) && (a.m_segment == b.m_segment);
+}
+
+static const bool CompareInstructions(const decoding::Instruction& a, const decoding::Instruction& b)
+{
+	if (a.GetCodeSize() != b.GetCodeSize()) return false;
+	if (a.GetOpcode() != b.GetOpcode()) return false;
+	if (!CompareOperands(a.GetArg0(), b.GetArg0())) return false;
+	if (!CompareOperands(a.GetArg1(), b.GetArg1())) return false;
+	if (!CompareOperands(a.GetArg2(), b.GetArg2())) return false;
+	if (!CompareOperands(a.GetArg3(), b.GetArg3())) return false;
+	if (!CompareOperands(a.GetArg4(), b.GetArg4())) return false;
+	if (!CompareOperands(a.GetArg5(), b.GetArg5())) return false;
+	return true;
+}
+
+uint32 CPU_XenonPPCDecodingTest::VerifyDecoding(const CPU_XenonPPC& cpu, const uint32 numRandomSamples)
+{
+	// all combinations of the primary opcode and the bits 21-31 (covers all of the extended opcode fields) with random operands, followed by fully random words
+	const uint32 numOpcodeSamples = 64 << 11;
+	uint32 numMismatches = 0;
+	uint32 random = 0x2545F491;
+	for (uint32 i=0; i<numOpcodeSamples + numRandomSamples; ++i)
+	{
+		random ^= random << 13;
+		random ^= random >> 17;
+		random ^= random << 5;
+
+		const uint32 instrWord = (i < numOpcodeSamples) ? (((i >> 11) << 26) | (random & 0x03FFF800) | (i & 0x7FF)) : random;
+		const uint32 data = EndianReverse32(instrWord);
+
+		// most of the tested words are not valid instructions, don't report them
+		decoding::Instruction refOp, tableOp;
+		const uint32 refSize = DecodeInstructionReference(&cpu, (const uint8*)&data, refOp, false);
+		const uint32 tableSize = cpu.DecodeInstruction((const uint8*)&data, tableOp, false);
+		if (refSize == tableSize && (!refSize || CompareInstructions(refOp, tableOp)))
+			continue;
+
+		// report only the first few
+		if (numMismatches < 32)
+		{
+			printf("Decoding table mismatch for 0x%08X, reference: '%s' (%u bytes), table: '%s' (%u bytes)\n", 
+				instrWord, refOp.GetName(), refSize, tableOp.GetName(), tableSize);
+		}
+
+		numMismatches += 1;
+	}
+
+	printf("Found %u decoding table mismatches in %u tested instructions\n", numMismatches, numOpcodeSamples + numRandomSamples);
+	return numMismatches;
+}
+
+//---------------------------------------------------------------------------
+
+int main(int argc, const char** argv)
+{
+	// number of fully random instruction words, can be given on the command line
+	const uint32 numRandomSamples = (argc >= 2 && atoi(argv[1]) > 0) ? (uint32)atoi(argv[1]) : (1 << 20);
+
+	const uint32 numMismatches = CPU_XenonPPCDecodingTest::VerifyDecoding(CPU_XenonPPC::GetInstance(), numRandomSamples);
+	printf("%s: Decoding\n", numMismatches ? "FAILED" : "PASSED");
+	return (int)numMismatches;
+}
@@ -0,0 +1,15 @@
+#pragma once
+
+#include "../../src/xenon_decompiler/xenonCPU.h"
+
+/// Decoding test, compares the table driven decoder of the CPU with the reference decoder
+/// NOTE: this is a friend of the CPU, the reference decoder needs the same opcode and register maps
+class CPU_XenonPPCDecodingTest
+{
+public:
+	// reference decoder with the opcode matching written as nested switches, slow but simple
+	static uint32 DecodeInstructionReference(const CPU_XenonPPC* self, const uint8* inputStream, decoding::Instruction& outOp, const bool reportErrors);
+
+	// compare the table driven decoder with the reference decoder, tests all primary and extended opcode combinations and given number of random instruction words, returns number of mismatches
+	static uint32 VerifyDecoding(const CPU_XenonPPC& cpu, const uint32 numRandomSamples);
+};
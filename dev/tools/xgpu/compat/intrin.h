@@ -0,0 +1,13 @@
+#pragma once
+
+// MSVC intrinsics header mapped to the gcc/clang one
+#include <x86intrin.h>
+#include <cpuid.h>
+
+// the cpuid.h macro has different arguments, __cpuidex is provided by cpuid.h already
+#undef __cpuid
+
+static inline void __cpuid(int info[4], const int function)
+{
+	__cpuid_count(function, 0, info[0], info[1], info[2], info[3]);
+}
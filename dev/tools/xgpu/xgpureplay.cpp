@@ -0,0 +1,84 @@
+// xgpureplay - replays a .gpu dump through the PM4 executor and the null rendering layer
+// Only the GPU command processor is compiled in (XENON_GPU_STANDALONE), no kernel, CPU, window or GPU device is needed
+
+#include "../../src/xenon_launcher/build.h"
+#include "../../src/xenon_launcher/xenonGPUExecutor.h"
+#include "../../src/xenon_launcher/xenonGPUDumpReplay.h"
+#include "../../src/xenon_launcher/xenonGPUNullAbstractLayer.h"
+#include "../../src/xenon_launcher/xenonGPUShaderStore.h"
+
+xenon::Platform GPlatform;
+
+int main(int argc, const char** argv)
+{
+	// -statebenchmark replays the dump with each kind of the state cache and measures the draws per second
+	const bool stateBenchmark = (argc >= 2) && !strcmp(argv[1], "-statebenchmark");
+	if (stateBenchmark)
+	{
+		argc -= 1;
+		argv += 1;
+	}
+
+	if (argc < 2)
+	{
+		fprintf(stderr, "Usage: xgpureplay [-statebenchmark] <dump.gpu> [numFrames] [shaderCachePath]\n");
+		return 1;
+	}
+
+	const std::wstring dumpPath = launcher::AnsiToUnicode(argv[1]);
+	const uint32 numFrames = (argc >= 3 && atoi(argv[2]) > 0) ? (uint32)atoi(argv[2]) : 100;
+
+	// physical memory is placed at the same address as in the launcher, the dumped memory blocks use absolute addresses
+	const uint32 physicalMemoryBase = 0xC0000000;
+	const uint32 physicalMemorySize = 256 << 20;
+	if (!GPlatform.GetMemory().Initialize(physicalMemoryBase, physicalMemorySize))
+		return 2;
+
+	// load the dump
+	CXenonGPUDumpReplay replay;
+	if (!replay.Load(dumpPath))
+		return 3;
+
+	for (const auto& block : replay.GetDump().m_memoryBlocks)
+	{
+		if (!GPlatform.GetMemory().Contains(block.m_address, block.m_size))
+		{
+			GLog.Err("Memory block at 0x%08X (size %u) is outside of the physical memory", block.m_address, block.m_size);
+			return 3;
+		}
+	}
+
+	// optional persistent shader storage, the decompiled microcode is reused between runs
+	CXenonGPUShaderStore* shaderStore = nullptr;
+	if (argc >= 4)
+	{
+		shaderStore = new CXenonGPUShaderStore();
+		if (!shaderStore->Open(launcher::AnsiToUnicode(argv[3])))
+		{
+			GLog.Warn("Failed to open shader cache '%s', shaders will not be cached", argv[3]);
+			delete shaderStore;
+			shaderStore = nullptr;
+		}
+	}
+
+	// headless pipeline
+	bool ok = false;
+	{
+		CXenonGPUNullAbstractLayer nullLayer(shaderStore);
+		if (!nullLayer.Initialize())
+			return 4;
+
+		CXenonGPUExecutor executor(&nullLayer, std::wstring());
+		ok = stateBenchmark ? replay.RunStateBenchmark(executor, nullLayer, numFrames) : replay.Run(executor, &nullLayer, numFrames);
+	}
+
+	GLog.Log("GPU Replay: %llu interrupts raised", GPlatform.GetKernel().GetNumInterrupts());
+
+	if (shaderStore)
+	{
+		shaderStore->Close();
+		delete shaderStore;
+	}
+
+	return ok ? 0 : 5;
+}
@@ -0,0 +1,305 @@
+// xgputest - tests of the backend independent GPU code, built in the standalone configuration (XENON_GPU_STANDALONE)
+// Returns the number of failed tests
+
+#include "../../src/xenon_launcher/build.h"
+#include "../../src/xenon_launcher/xenonGPUTextures.h"
+#include "../../src/xenon_launcher/xenonGPUTextureConversion.h"
+#include "../../src/xenon_launcher/xenonGPUUtils.h"
+#include "../../src/xenon_launcher/dx11MicrocodeShader.h"
+#include "../../src/xenon_launcher/dx11ShaderTranslator.h"
+
+xenon::Platform GPlatform;
+
+//---------------------------------------------------------------------------
+
+namespace Helper
+{
+	static inline uint32 NextRandom( uint32& state )
+	{
+		state ^= state << 13;
+		state ^= state >> 17;
+		state ^= state << 5;
+		return state;
+	}
+
+	static void FillRandom( std::vector< uint8 >& data, uint32& state )
+	{
+		for ( auto& val : data )
+			val = (uint8) NextRandom( state );
+	}
+
+	static const XenonGPUEndianFormat AllFormats[] = { XenonGPUEndianFormat::FormatUnspecified, XenonGPUEndianFormat::Format8in16, XenonGPUEndianFormat::Format8in32, XenonGPUEndianFormat::Format16in32 };
+
+	// the swap works on the memory words, byte at given address comes from the address xored with this value
+	static uint32 GetSwapAddressXor( const XenonGPUEndianFormat format )
+	{
+		if ( format == XenonGPUEndianFormat::Format8in16 ) return 1;
+		if ( format == XenonGPUEndianFormat::Format8in32 ) return 3;
+		if ( format == XenonGPUEndianFormat::Format16in32 ) return 2;
+		return 0;
+	}
+
+	static uint32 GetBlockSizeLog( const uint32 blockSize )
+	{
+		uint32 ret = 0;
+		while ( (1U << ret) < blockSize )
+			ret += 1;
+		return ret;
+	}
+
+	static uint32 GetTiledOffset( const XenonGPUUntileInfo& info, const uint32 x, const uint32 y )
+	{
+		const uint32 bppLog = GetBlockSizeLog( info.m_blockSize );
+		const uint32 srcY = info.m_sourceOffsetY + y;
+		const uint32 srcOffsetY = XenonTextureInfo::TiledOffset2DOuter( srcY, info.m_sourceWidthInBlocks, bppLog );
+		return (XenonTextureInfo::TiledOffset2DInner( info.m_sourceOffsetX + x, srcY, bppLog, srcOffsetY ) >> bppLog) * info.m_blockSize;
+	}
+
+	// size of the source memory touched by the untiling
+	static uint32 ComputeUntileSourceSize( const XenonGPUUntileInfo& info )
+	{
+		uint32 maxOffset = 0;
+		for ( uint32 y=0; y<info.m_copyHeight; ++y )
+			for ( uint32 x=0; x<info.m_copyWidth; ++x )
+				maxOffset = std::max< uint32 >( maxOffset, GetTiledOffset( info, x, y ) + info.m_blockSize );
+
+		return maxOffset;
+	}
+
+	// expected untiling result, computed byte by byte from the source memory addresses
+	static void UntileExpected( const XenonGPUUntileInfo& info, const std::vector< uint8 >& src, std::vector< uint8 >& dest )
+	{
+		const uint32 swapXor = GetSwapAddressXor( info.m_endianess );
+		for ( uint32 y=0; y<info.m_copyHeight; ++y )
+		{
+			for ( uint32 x=0; x<info.m_copyWidth; ++x )
+			{
+				const uint32 destOffset = y*info.m_destRowPitch + x*info.m_blockSize;
+				if ( destOffset >= info.m_destMaxOffset )
+					break;
+
+				const uint32 srcOffset = GetTiledOffset( info, x, y );
+				for ( uint32 i=0; i<info.m_blockSize; ++i )
+					dest[ destOffset + i ] = src[ (srcOffset + i) ^ swapXor ];
+			}
+		}
+	}
+
+	// single EXEC_END block with one ALU instruction: export(exportReg) = max(r0, r0)
+	static void BuildExportShader( const uint32 exportReg, uint32* words )
+	{
+		memset( words, 0, sizeof(uint32) * 6 );
+
+		// CF: EXEC_END, address 1, one ALU instruction
+		words[0] = 1 | (1 << 12);
+		words[1] = (2 << 12);
+
+		// ALU: vector MAXv from register sources, exported with full write mask
+		words[3] = exportReg | (1 << 15) | (0xF << 16);
+		words[5] = (2 << 24) | (1U << 29) | (1U << 30) | (1U << 31);
+	}
+}
+
+//---------------------------------------------------------------------------
+
+// endianess conversion, all formats and lengths, including the tails that don't fill the whole word
+static bool TestEndianessConversion()
+{
+	uint32 state = 0x12345678;
+
+	std::vector< uint8 > src( 4096 + 64 ), destA( src.size() ), destB( src.size() ), expected( src.size() );
+	Helper::FillRandom( src, state );
+
+	for ( const auto format : Helper::AllFormats )
+	{
+		const uint32 swapXor = Helper::GetSwapAddressXor( format );
+		const uint32 wordSize = (format == XenonGPUEndianFormat::Format8in16) ? 2 : 4;
+
+		for ( uint32 length=0; length<=src.size(); length = (length < 256) ? (length + 1) : (length * 2) )
+		{
+			memset( &destA[0], 0xCD, destA.size() );
+			memset( &destB[0], 0xCD, destB.size() );
+			memset( &expected[0], 0xCD, expected.size() );
+
+			const uint32 wholeWords = length & ~(wordSize - 1);
+			for ( uint32 i=0; i<wholeWords; ++i )
+				expected[i] = src[ i ^ swapXor ];
+			for ( uint32 i=wholeWords; i<length; ++i )
+				expected[i] = src[i];
+
+			XenonGPUConvertEndianess( &destA[0], &src[0], length, format );
+			XenonGPUConvertEndianessReference( &destB[0], &src[0], length, format );
+
+			if ( destB != expected )
+			{
+				GLog.Err( "Reference endianess conversion is wrong, format %d, length %u", (uint32) format, length );
+				return false;
+			}
+
+			if ( destA != expected )
+			{
+				GLog.Err( "Endianess conversion is wrong, format %d, length %u", (uint32) format, length );
+				return false;
+			}
+		}
+	}
+
+	return true;
+}
+
+// untiling, all block sizes (including blocks smaller than the swapped word), packed and unpacked layouts
+static bool TestUntileSurface()
+{
+	uint32 state = 0x87654321;
+
+	const uint32 blockSizes[] = { 1, 2, 4, 8, 16 };
+	const uint32 widths[] = { 32, 64, 160 };
+	const uint32 offsets[][2] = { { 0, 0 }, { 16, 0 }, { 0, 16 }, { 3, 5 } };
+
+	for ( const auto blockSize : blockSizes )
+	{
+		for ( const auto width : widths )
+		{
+			for ( const auto& offset : offsets )
+			{
+				for ( const auto format : Helper::AllFormats )
+				{
+					XenonGPUUntileInfo info;
+					info.m_blockSize = blockSize;
+					info.m_sourceWidthInBlocks = width;
+					info.m_sourceOffsetX = offset[0];
+					info.m_sourceOffsetY = offset[1];
+					info.m_copyWidth = width - offset[0] - 1; // odd row end
+					info.m_copyHeight = 40;
+					info.m_destRowPitch = (info.m_copyWidth * blockSize + 255) & ~255;
+					info.m_destMaxOffset = info.m_destRowPitch * info.m_copyHeight - 3 * blockSize; // clipped last row
+					info.m_endianess = format;
+
+					// whole words are always readable
+					std::vector< uint8 > src( Helper::ComputeUntileSourceSize( info ) + 16 );
+					Helper::FillRandom( src, state );
+
+					std::vector< uint8 > destA( info.m_destRowPitch * info.m_copyHeight, 0xCD );
+					std::vector< uint8 > destB( destA );
+					std::vector< uint8 > expected( destA );
+
+					Helper::UntileExpected( info, src, expected );
+					XenonGPUUntileSurface( info, &src[0], &destA[0] );
+					XenonGPUUntileSurfaceReference( info, &src[0], &destB[0] );
+
+					if ( destB != expected )
+					{
+						GLog.Err( "Reference untiling is wrong, block size %u, width %u, offset %u,%u, format %d", blockSize, width, offset[0], offset[1], (uint32) format );
+						return false;
+					}
+
+					if ( destA != expected )
+					{
+						GLog.Err( "Untiling is wrong, block size %u, width %u, offset %u,%u, format %d", blockSize, width, offset[0], offset[1], (uint32) format );
+						return false;
+					}
+				}
+			}
+		}
+	}
+
+	return true;
+}
+
+// microcode to HLSL translation, does not need D3D
+static bool TestShaderTranslation()
+{
+	uint32 vertexWords[6], pixelWords[6];
+	Helper::BuildExportShader( 62, vertexWords ); // position
+	Helper::BuildExportShader( 0, pixelWords ); // color 0
+
+	std::unique_ptr< CDX11MicrocodeShader > vertexMicrocode( CDX11MicrocodeShader::ExtractVertexShader( vertexWords, sizeof(vertexWords), 1 ) );
+	std::unique_ptr< CDX11MicrocodeShader > pixelMicrocode( CDX11MicrocodeShader::ExtractPixelShader( pixelWords, sizeof(pixelWords), 2 ) );
+	if ( !vertexMicrocode || !pixelMicrocode )
+	{
+		GLog.Err( "Failed to decompile the test microcode" );
+		return false;
+	}
+
+	// vertex shader
+	CDX11ShaderTranslator::VertexContext vertexContext;
+	std::string vertexCode;
+	if ( !CDX11ShaderTranslator::TranslateVertexShader( *vertexMicrocode, vertexContext, std::wstring(), vertexCode ) )
+	{
+		GLog.Err( "Failed to translate vertex shader" );
+		return false;
+	}
+
+	if ( vertexCode.find( "void main(" ) == std::string::npos || vertexCode.find( "ret.out_POSITION.xyzw = float4(MAXv(regs, (regs.R0),(regs.R0))).xyzw;" ) == std::string::npos )
+	{
+		GLog.Err( "Unexpected vertex shader code:\n%s", vertexCode.c_str() );
+		return false;
+	}
+
+	// pixel shader
+	CDX11ShaderTranslator::PixelContext pixelContext;
+	pixelContext.m_interp = 1;
+	std::string pixelCode;
+	if ( !CDX11ShaderTranslator::TranslatePixelShader( *pixelMicrocode, pixelContext, std::wstring(), pixelCode ) )
+	{
+		GLog.Err( "Failed to translate pixel shader" );
+		return false;
+	}
+
+	if ( pixelCode.find( "void main(" ) == std::string::npos || pixelCode.find( "ret.out_COLOR0.xyzw = float4(MAXv(regs, (regs.R0),(regs.R0))).xyzw;" ) == std::string::npos )
+	{
+		GLog.Err( "Unexpected pixel shader code:\n%s", pixelCode.c_str() );
+		return false;
+	}
+
+	// the translation must be deterministic, the compiled shaders are stored by the microcode and context hash
+	std::string pixelCode2;
+	CDX11ShaderTranslator::TranslatePixelShader( *pixelMicrocode, pixelContext, std::wstring(), pixelCode2 );
+	if ( pixelCode != pixelCode2 )
+	{
+		GLog.Err( "Pixel shader translation is not deterministic" );
+		return false;
+	}
+
+	// wrong shader type
+	std::string wrongCode;
+	if ( CDX11ShaderTranslator::TranslatePixelShader( *vertexMicrocode, pixelContext, std::wstring(), wrongCode ) || CDX11ShaderTranslator::TranslateVertexShader( *pixelMicrocode, vertexContext, std::wstring(), wrongCode ) )
+	{
+		GLog.Err( "Shader of wrong type was translated" );
+		return false;
+	}
+
+	return true;
+}
+
+//---------------------------------------------------------------------------
+
+int main( int argc, const char** argv )
+{
+	struct TestInfo
+	{
+		const char*		m_name;
+		bool			(*m_func)();
+	};
+
+	const TestInfo tests[] =
+	{
+		{ "EndianessConversion", &TestEndianessConversion },
+		{ "UntileSurface", &TestUntileSurface },
+		{ "ShaderTranslation", &TestShaderTranslation },
+	};
+
+	uint32 numFailed = 0;
+	for ( const auto& test : tests )
+	{
+		if ( argc >= 2 && strcmp( argv[1], test.m_name ) )
+			continue;
+
+		const bool ok = test.m_func();
+		GLog.Log( "%s: %s", ok ? "PASSED" : "FAILED", test.m_name );
+		if ( !ok )
+			numFailed += 1;
+	}
+
+	return (int) numFailed;
+}